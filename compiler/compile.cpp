@@ -38,12 +38,85 @@ bool writeFile(const std::string& filename, const std::vector<uint8_t>& data) {
     return true;
 }
 
+// Escape a string for use inside a C string literal (octal escapes avoid
+// the greedy-hex pitfall when the next character is a hex digit)
+std::string cStringLiteral(const std::string& str) {
+    std::ostringstream out;
+    out << '"';
+    for (unsigned char c : str) {
+        if (c == '"' || c == '\\') {
+            out << '\\' << c;
+        } else if (c >= 0x20 && c < 0x7F && c != '?') {
+            out << c;
+        } else {
+            out << '\\' << std::oct << std::setw(3) << std::setfill('0')
+                << static_cast<int>(c) << std::dec;
+        }
+    }
+    out << '"';
+    return out.str();
+}
+
+std::string stringRef(const std::string& str) {
+    return "{" + cStringLiteral(str) + ", " + std::to_string(str.size()) + "}";
+}
+
+// Emit a constexpr ModuleImage next to the byte array so built-in applets can
+// start straight from flash without BytecodeModule::deserialize
+void writeModuleImage(std::ostream& file, const std::string& arrayName,
+                      const BytecodeModule& module, const std::vector<uint8_t>& bytecode) {
+    // Code section sits at the end of the blob, ahead of the optional debug section
+    size_t debugBytes = module.hasDebugInfo() ? 4 + 4 * module.debugLines.size() : 0;
+    size_t codeOffset = bytecode.size() - debugBytes - module.code.size();
+    
+    file << std::dec;
+    auto writeStringTable = [&](const std::string& suffix, const std::vector<std::string>& table) {
+        if (table.empty()) {
+            return;
+        }
+        file << "static constexpr dialos::compiler::StringRef " << arrayName << suffix << "[] = {" << std::endl;
+        for (const auto& str : table) {
+            file << "    " << stringRef(str) << "," << std::endl;
+        }
+        file << "};" << std::endl;
+    };
+    
+    writeStringTable("_CONSTANTS", module.constants);
+    writeStringTable("_GLOBALS", module.globals);
+    
+    if (!module.functions.empty()) {
+        file << "static constexpr dialos::compiler::FunctionRef " << arrayName << "_FUNCTIONS[] = {" << std::endl;
+        for (size_t i = 0; i < module.functions.size(); i++) {
+            uint32_t entry = i < module.functionEntryPoints.size() ? module.functionEntryPoints[i] : 0;
+            int params = i < module.functionParamCounts.size() ? module.functionParamCounts[i] : 0;
+            file << "    {" << stringRef(module.functions[i]) << ", " << entry << ", " << params << "}," << std::endl;
+        }
+        file << "};" << std::endl;
+    }
+    
+    auto tableRef = [&](const std::string& suffix, size_t count) {
+        return count == 0 ? std::string("nullptr, 0")
+                          : arrayName + suffix + ", " + std::to_string(count);
+    };
+    
+    file << "static constexpr dialos::compiler::ModuleImage " << arrayName << "_MODULE = {" << std::endl;
+    file << "    " << module.metadata.version << ", " << module.metadata.heapSize << ", "
+         << stringRef(module.metadata.appName) << ", " << stringRef(module.metadata.appVersion) << ", "
+         << stringRef(module.metadata.author) << "," << std::endl;
+    file << "    " << arrayName << " + " << codeOffset << ", " << module.code.size() << "," << std::endl;
+    file << "    " << tableRef("_CONSTANTS", module.constants.size()) << "," << std::endl;
+    file << "    " << tableRef("_GLOBALS", module.globals.size()) << "," << std::endl;
+    file << "    " << tableRef("_FUNCTIONS", module.functions.size()) << "," << std::endl;
+    file << "    " << module.mainEntryPoint << std::endl;
+    file << "};" << std::endl;
+}
+
 int main(int argc, char* argv[]) {
     if (argc < 2) {
         std::cerr << "Usage: " << argv[0] << " <input.ds|input.dsb> [output.dsb] [--c-array] [--debug]" << std::endl;
         std::cerr << "  input.ds:  Compile dialScript source to bytecode" << std::endl;
         std::cerr << "  input.dsb: Disassemble bytecode file" << std::endl;
-        std::cerr << "  --c-array: Output as C/C++ byte array instead of binary file" << std::endl;
+        std::cerr << "  --c-array: Output as C/C++ byte array (plus constexpr ModuleImage) instead of binary file" << std::endl;
         std::cerr << "  --debug:   Include debug line information in bytecode" << std::endl;
         return 1;
     }
@@ -214,6 +287,8 @@ int main(int argc, char* argv[]) {
         }
         file << std::endl << "};" << std::endl;
         file << std::endl;
+        writeModuleImage(file, arrayName, module, bytecode);
+        file << std::endl;
         
         std::cout << "✓ C array written to " << outputFile << " (" << bytecode.size() << " bytes)" << std::endl;
     } else {
@@ -0,0 +1,195 @@
+/**
+ * Headless dialOS Emulator
+ *
+ * Runs .dsb (or .ds source) files with no window against the software
+ * framebuffer and a virtual clock, as fast as the host allows, and reports
+ * per-frame framebuffer hashes, instructions per second and native call
+ * counts. Meant for checking graphics regressions and performance of a
+ * whole scripts/ directory on a machine without a display.
+ */
+
+#include "headless_platform.h"
+#include "vm/bytecode.h"
+#include "lexer.h"
+#include "parser.h"
+#include "bytecode_compiler.h"
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace dialos;
+
+static void printUsage(const char* program) {
+    std::cerr << "Usage: " << program << " [options] <file.dsb|file.ds>..." << std::endl;
+    std::cerr << std::endl;
+    std::cerr << "  --duration MS    Virtual time limit per script (default 5000)" << std::endl;
+    std::cerr << "  --frame MS       Frame period for hashes (default 16)" << std::endl;
+    std::cerr << "  --slice N        Instructions per VM slice (default 1000)" << std::endl;
+    std::cerr << "  --slice-ms MS    Virtual time a busy slice costs (default 1)" << std::endl;
+    std::cerr << "  --input EVENTS   Scripted input, e.g. 500:turn:1,800:press,900:release," << std::endl;
+    std::cerr << "                   1000:touch:120:60,1050:drag:130:60,1100:lift:130:60" << std::endl;
+    std::cerr << "  --console        Echo script console output" << std::endl;
+    std::cerr << "  --summary        Only print the per-script summary, not every frame" << std::endl;
+}
+
+// Load a bytecode file, or compile a source file
+static bool loadModule(const std::string& path, compiler::BytecodeModule& module, std::string& error) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        error = "could not open file";
+        return false;
+    }
+    std::vector<uint8_t> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    bool isSource = path.size() > 3 && path.compare(path.size() - 3, 3, ".ds") == 0;
+    if (!isSource) {
+        try {
+            module = compiler::BytecodeModule::deserialize(data);
+        } catch (const std::exception& e) {
+            error = std::string("failed to deserialize bytecode: ") + e.what();
+            return false;
+        }
+        return true;
+    }
+
+    compiler::Lexer lexer(std::string(data.begin(), data.end()));
+    compiler::Parser parser(lexer);
+    auto program = parser.parse();
+    if (parser.hasErrors()) {
+        error = "parse error: " + parser.getErrors().front();
+        return false;
+    }
+    compiler::BytecodeCompiler bytecodeCompiler;
+    module = bytecodeCompiler.compile(*program);
+    if (bytecodeCompiler.hasErrors()) {
+        error = "compile error: " + bytecodeCompiler.getErrors().front();
+        return false;
+    }
+    return true;
+}
+
+static std::string hex32(uint32_t value) {
+    char buffer[9];
+    std::snprintf(buffer, sizeof(buffer), "%08x", value);
+    return buffer;
+}
+
+int main(int argc, char** argv) {
+    vm::HeadlessOptions options;
+    bool echoConsole = false;
+    bool summaryOnly = false;
+    std::vector<std::string> files;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        try {
+            if (arg == "--duration" && hasValue) {
+                options.durationMs = static_cast<uint32_t>(std::stoul(argv[++i]));
+            } else if (arg == "--frame" && hasValue) {
+                options.frameMs = static_cast<uint32_t>(std::stoul(argv[++i]));
+            } else if (arg == "--slice" && hasValue) {
+                options.sliceInstructions = static_cast<uint32_t>(std::stoul(argv[++i]));
+            } else if (arg == "--slice-ms" && hasValue) {
+                options.sliceMs = static_cast<uint32_t>(std::stoul(argv[++i]));
+            } else if (arg == "--input" && hasValue) {
+                std::string error;
+                if (!vm::HeadlessPlatform::parseInput(argv[++i], options.input, error)) {
+                    std::cerr << "Error: " << error << std::endl;
+                    return 2;
+                }
+            } else if (arg == "--console") {
+                echoConsole = true;
+            } else if (arg == "--summary") {
+                summaryOnly = true;
+            } else if (!arg.empty() && arg[0] == '-') {
+                printUsage(argv[0]);
+                return 2;
+            } else {
+                files.push_back(arg);
+            }
+        } catch (const std::exception&) {
+            std::cerr << "Error: bad value for " << arg << std::endl;
+            return 2;
+        }
+    }
+    if (files.empty()) {
+        printUsage(argv[0]);
+        return 2;
+    }
+
+    int failed = 0;
+    uint64_t totalInstructions = 0;
+    uint64_t totalWallUs = 0;
+    for (const std::string& path : files) {
+        std::cout << "== " << path << std::endl;
+
+        compiler::BytecodeModule module;
+        std::string error;
+        if (!loadModule(path, module, error)) {
+            std::cout << "result: load error: " << error << std::endl << std::endl;
+            failed++;
+            continue;
+        }
+
+        vm::HeadlessPlatform platform;
+        platform.echoConsole = echoConsole;
+        vm::HeadlessResult result = vm::runHeadless(module, platform, options);
+
+        if (!summaryOnly) {
+            for (const vm::HeadlessResult::Frame& frame : result.changedFrames) {
+                std::cout << "frame " << frame.index << " " << frame.time << "ms " << hex32(frame.hash) << std::endl;
+            }
+        }
+        switch (result.status) {
+            case vm::HeadlessResult::Status::IDLE:
+                std::cout << "result: idle at " << result.virtualMs << "ms" << std::endl;
+                break;
+            case vm::HeadlessResult::Status::TIME_LIMIT:
+                std::cout << "result: running at time limit" << std::endl;
+                break;
+            case vm::HeadlessResult::Status::ERROR:
+                std::cout << "result: error at " << result.virtualMs << "ms: " << result.error << std::endl;
+                failed++;
+                break;
+        }
+        std::cout << "final frame: " << hex32(platform.frameHash()) << " (" << result.changedFrames.size()
+                  << " of " << result.frames << " frames changed, " << result.drawCalls << " draw calls)"
+                  << std::endl;
+        std::ostringstream ips;
+        ips.setf(std::ios::fixed);
+        ips.precision(2);
+        ips << result.instructionsPerSecond() / 1e6;
+        std::cout << "instructions: " << result.instructions << " in " << result.wallUs << "us wall ("
+                  << ips.str() << " M/s), " << result.virtualMs << "ms virtual" << std::endl;
+        if (!result.heapTrace.empty()) {
+            std::cout << "heap: " << result.heapTrace.front() << " bytes after frame 1, peak "
+                      << *std::max_element(result.heapTrace.begin(), result.heapTrace.end()) << ", "
+                      << result.heapTrace.back() << " at the end" << std::endl;
+        }
+
+        // Most-called natives first
+        std::vector<std::pair<std::string, uint64_t>> natives(result.nativeCalls.begin(), result.nativeCalls.end());
+        std::stable_sort(natives.begin(), natives.end(),
+                         [](const std::pair<std::string, uint64_t>& a, const std::pair<std::string, uint64_t>& b) {
+                             return a.second > b.second;
+                         });
+        std::cout << "natives:";
+        for (const auto& native : natives) {
+            std::cout << " " << native.first << "=" << native.second;
+        }
+        std::cout << std::endl << std::endl;
+
+        totalInstructions += result.instructions;
+        totalWallUs += result.wallUs;
+    }
+
+    std::cout << files.size() << " script(s), " << failed << " failed, " << totalInstructions
+              << " instructions in " << totalWallUs << "us" << std::endl;
+    return failed > 0 ? 1 : 0;
+}
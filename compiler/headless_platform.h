@@ -0,0 +1,381 @@
+/**
+ * Headless Platform for dialOS
+ *
+ * Runs scripts with no window: display calls rasterise into the same
+ * 240x240 software framebuffer the SDL emulator shows, time is a virtual
+ * clock the host advances, and input comes from scripted events instead
+ * of the mouse. Used by headless_emulator to check graphics output (frame
+ * hashes) and throughput of scripts in bulk.
+ */
+
+#ifndef DIALOS_HEADLESS_PLATFORM_H
+#define DIALOS_HEADLESS_PLATFORM_H
+
+#include "vm/platform.h"
+#include "vm/vm_core.h"
+#include "vm/vm_value.h"
+#include "vm/framebuffer.h"
+#include "vm/image_codec.h"
+#include "vm/bytecode.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace dialos {
+namespace vm {
+
+class HeadlessPlatform : public PlatformInterface {
+public:
+    static const int DISPLAY_WIDTH = 240;
+    static const int DISPLAY_HEIGHT = 240;
+
+    // A scripted input event (see parseInput)
+    struct InputEvent {
+        enum class Type { TURN, PRESS, RELEASE, TOUCH, DRAG, LIFT };
+        uint32_t time;          // Virtual ms
+        Type type;
+        int a;                  // TURN: delta; TOUCH/DRAG/LIFT: x
+        int b;                  // TOUCH/DRAG/LIFT: y
+    };
+
+    uint32_t now = 0;           // Virtual clock (ms)
+    bool echoConsole = false;   // Print console output to stdout
+    uint32_t drawCalls = 0;     // Display primitives issued
+
+    HeadlessPlatform() : frame_(DISPLAY_WIDTH, DISPLAY_HEIGHT) {}
+
+    const Framebuffer& getFramebuffer() const { return frame_; }
+    Framebuffer& getFramebuffer() { return frame_; }
+
+    // FNV-1a of the framebuffer pixels
+    uint32_t frameHash() const {
+        uint32_t hash = 2166136261u;
+        const uint16_t* pixels = frame_.pixels();
+        for (int i = 0; i < DISPLAY_WIDTH * DISPLAY_HEIGHT; i++) {
+            hash = (hash ^ (pixels[i] & 0xFF)) * 16777619u;
+            hash = (hash ^ (pixels[i] >> 8)) * 16777619u;
+        }
+        return hash;
+    }
+
+    // Apply one input event: update the input state and invoke the
+    // callback the SDL emulator would
+    void deliver(const InputEvent& event) {
+        switch (event.type) {
+            case InputEvent::Type::TURN:
+                encoderPosition_ += event.a;
+                encoderDelta_ += event.a;
+                invokeCallback("encoder.onTurn", {Value::Int32(event.a)});
+                break;
+            case InputEvent::Type::PRESS:
+            case InputEvent::Type::RELEASE:
+                encoderButton_ = event.type == InputEvent::Type::PRESS;
+                invokeCallback("encoder.onButton", {Value::Bool(encoderButton_)});
+                break;
+            case InputEvent::Type::TOUCH:
+            case InputEvent::Type::DRAG:
+            case InputEvent::Type::LIFT:
+                touchX_ = event.a;
+                touchY_ = event.b;
+                touchPressed_ = event.type != InputEvent::Type::LIFT;
+                invokeCallback(event.type == InputEvent::Type::TOUCH ? "touch.onPress" :
+                               event.type == InputEvent::Type::DRAG ? "touch.onDrag" : "touch.onRelease",
+                               {Value::Int32(touchX_), Value::Int32(touchY_)});
+                break;
+        }
+    }
+
+    // Parse a comma-separated event list, e.g.
+    //   "500:turn:1,800:press,900:release,1000:touch:120:60,1100:lift:120:60"
+    // Events may be given in any order; they are returned sorted by time.
+    // Returns false (with `error` set) on a malformed entry.
+    static bool parseInput(const std::string& spec, std::vector<InputEvent>& events, std::string& error) {
+        size_t start = 0;
+        while (start < spec.size()) {
+            size_t end = spec.find(',', start);
+            if (end == std::string::npos) {
+                end = spec.size();
+            }
+            std::string entry = spec.substr(start, end - start);
+            start = end + 1;
+            if (entry.empty()) {
+                continue;
+            }
+            std::vector<std::string> fields;
+            size_t pos = 0;
+            while (true) {
+                size_t colon = entry.find(':', pos);
+                fields.push_back(entry.substr(pos, colon == std::string::npos ? std::string::npos : colon - pos));
+                if (colon == std::string::npos) {
+                    break;
+                }
+                pos = colon + 1;
+            }
+            InputEvent event = {0, InputEvent::Type::TURN, 0, 0};
+            size_t argCount;
+            const std::string& name = fields.size() > 1 ? fields[1] : std::string();
+            if (name == "turn") {
+                event.type = InputEvent::Type::TURN;
+                argCount = 1;
+            } else if (name == "press" || name == "release") {
+                event.type = name == "press" ? InputEvent::Type::PRESS : InputEvent::Type::RELEASE;
+                argCount = 0;
+            } else if (name == "touch" || name == "drag" || name == "lift") {
+                event.type = name == "touch" ? InputEvent::Type::TOUCH :
+                             name == "drag" ? InputEvent::Type::DRAG : InputEvent::Type::LIFT;
+                argCount = 2;
+            } else {
+                error = "unknown input event '" + entry + "'";
+                return false;
+            }
+            if (fields.size() != 2 + argCount) {
+                error = "wrong number of fields in '" + entry + "'";
+                return false;
+            }
+            try {
+                event.time = static_cast<uint32_t>(std::stoul(fields[0]));
+                event.a = argCount > 0 ? std::stoi(fields[2]) : 0;
+                event.b = argCount > 1 ? std::stoi(fields[3]) : 0;
+            } catch (const std::exception&) {
+                error = "bad number in '" + entry + "'";
+                return false;
+            }
+            events.push_back(event);
+        }
+        std::stable_sort(events.begin(), events.end(),
+                         [](const InputEvent& x, const InputEvent& y) { return x.time < y.time; });
+        return true;
+    }
+
+    // Console
+    void console_print(const std::string& msg) override {
+        if (echoConsole) {
+            std::cout << msg;
+        }
+    }
+    void console_log(const std::string& msg) override { console_print("[INFO] " + msg + "\n"); }
+    void console_warn(const std::string& msg) override { console_print("[WARN] " + msg + "\n"); }
+    void console_error(const std::string& msg) override { console_print("[ERROR] " + msg + "\n"); }
+
+    // Display
+    void display_clear(uint32_t color) override {
+        drawCalls++;
+        frame_.clear(static_cast<uint16_t>(color));
+    }
+    void display_drawText(int x, int y, const std::string& text, uint32_t color, int size) override {
+        drawCalls++;
+        frame_.drawText(x, y, text, static_cast<uint16_t>(color), size);
+    }
+    void display_drawRect(int x, int y, int w, int h, uint32_t color, bool filled) override {
+        drawCalls++;
+        frame_.drawRect(x, y, w, h, static_cast<uint16_t>(color), filled);
+    }
+    void display_drawCircle(int x, int y, int r, uint32_t color, bool filled) override {
+        drawCalls++;
+        frame_.drawCircle(x, y, r, static_cast<uint16_t>(color), filled);
+    }
+    void display_drawLine(int x1, int y1, int x2, int y2, uint32_t color) override {
+        drawCalls++;
+        frame_.drawLine(x1, y1, x2, y2, static_cast<uint16_t>(color));
+    }
+    void display_drawPixel(int x, int y, uint32_t color) override {
+        drawCalls++;
+        frame_.drawPixel(x, y, static_cast<uint16_t>(color));
+    }
+    void display_drawImage(int x, int y, const std::vector<uint8_t>& imageData) override {
+        drawCalls++;
+        frame_.drawImage(x, y, imageData);
+    }
+    void display_drawBitmap(int x, int y, const std::shared_ptr<const Image>& image, int sx, int sy,
+                            int w, int h, int32_t transparent) override {
+        drawCalls++;
+        frame_.pushImage(x, y, w, h, image->pixels.data() + sy * image->width + sx, transparent, image->width);
+    }
+    bool display_setClip(int x, int y, int w, int h) override {
+        frame_.setClip(Rect(x, y, w, h));
+        return true;
+    }
+    void display_clearClip() override { frame_.clearClip(); }
+    void display_setBrightness(int /*level*/) override {}
+    int display_getWidth() override { return DISPLAY_WIDTH; }
+    int display_getHeight() override { return DISPLAY_HEIGHT; }
+
+    // Encoder
+    bool encoder_getButton() override { return encoderButton_; }
+    int encoder_getDelta() override {
+        int delta = encoderDelta_;
+        encoderDelta_ = 0;
+        return delta;
+    }
+    int encoder_getPosition() override { return encoderPosition_; }
+    void encoder_reset() override {
+        encoderPosition_ = 0;
+        encoderDelta_ = 0;
+    }
+
+    // Touch
+    int touch_getX() override { return touchX_; }
+    int touch_getY() override { return touchY_; }
+    bool touch_isPressed() override { return touchPressed_; }
+
+    // System
+    uint32_t system_getTime() override { return now; }
+    void system_sleep(uint32_t ms) override { now += ms; }
+    uint32_t system_getRTC() override { return 1700000000u + now / 1000; }
+
+private:
+    Framebuffer frame_;
+    int encoderPosition_ = 0;
+    int encoderDelta_ = 0;
+    bool encoderButton_ = false;
+    int touchX_ = 0;
+    int touchY_ = 0;
+    bool touchPressed_ = false;
+};
+
+struct HeadlessOptions {
+    uint32_t durationMs = 5000;         // Virtual time limit
+    uint32_t frameMs = 16;              // Frame period (hashes are taken per frame)
+    uint32_t sliceInstructions = 1000;  // Instructions per VM slice
+    uint32_t sliceMs = 1;               // Virtual time a busy slice costs
+    std::vector<HeadlessPlatform::InputEvent> input;
+};
+
+struct HeadlessResult {
+    enum class Status {
+        IDLE,           // Main finished and nothing (timer, input) can run again
+        TIME_LIMIT,     // Still had work when the virtual time ran out
+        ERROR           // Runtime error or out of memory
+    };
+    struct Frame {
+        uint32_t index;             // Frame number (1 = first period)
+        uint32_t time;              // Virtual ms at the end of the frame
+        uint32_t hash;              // HeadlessPlatform::frameHash()
+    };
+
+    Status status = Status::IDLE;
+    std::string error;
+    uint32_t virtualMs = 0;
+    uint32_t frames = 0;                // Frame periods elapsed
+    std::vector<Frame> changedFrames;   // Frames whose pixels were drawn to
+    uint64_t instructions = 0;
+    uint64_t wallUs = 0;
+    uint32_t drawCalls = 0;
+    std::map<std::string, uint64_t> nativeCalls;
+    std::vector<uint32_t> heapTrace;    // VM heap bytes in use at the end of each frame period
+
+    double instructionsPerSecond() const {
+        return wallUs > 0 ? instructions * 1000000.0 / wallUs : 0.0;
+    }
+};
+
+// Run `module` on `platform` against the virtual clock, as fast as the host
+// allows: busy slices cost `sliceMs` of virtual time, and when the script
+// is sleeping or waiting for a timer or input the clock jumps straight to
+// the next deadline. A frame whose pixels changed is recorded at each frame
+// boundary the clock passes.
+inline HeadlessResult runHeadless(const compiler::BytecodeModule& module, HeadlessPlatform& platform,
+                                  const HeadlessOptions& options) {
+    HeadlessResult result;
+    ValuePool pool(module.metadata.heapSize);
+    VMState vm(module, pool, platform);
+    auto wallStart = std::chrono::steady_clock::now();
+
+    platform.now = 0;
+    platform.getFramebuffer().clear(0x0000);
+    platform.getFramebuffer().clearChanged();
+    vm.reset();
+    platform.setVM(&vm);
+    platform.invokeCallback("app.onLoad", std::vector<Value>());
+
+    size_t nextInput = 0;
+    uint32_t frameMs = std::max<uint32_t>(1, options.frameMs);
+    uint32_t nextFrame = frameMs;
+    Framebuffer& frame = platform.getFramebuffer();
+
+    // Close every frame period ending at or before `until`
+    auto closeFrames = [&](uint32_t until) {
+        while (nextFrame <= until) {
+            result.frames++;
+            result.heapTrace.push_back(static_cast<uint32_t>(vm.getHeapUsage()));
+            if (frame.isChanged()) {
+                result.changedFrames.push_back({result.frames, nextFrame, platform.frameHash()});
+                frame.clearChanged();
+            }
+            nextFrame += frameMs;
+        }
+    };
+
+    while (true) {
+        while (nextInput < options.input.size() && options.input[nextInput].time <= platform.now) {
+            platform.deliver(options.input[nextInput++]);
+        }
+        platform.processAsyncCompletions();
+        platform.processIpc();
+        platform.processTimers();
+
+        if (vm.hasError()) {
+            result.status = HeadlessResult::Status::ERROR;
+            result.error = vm.getError();
+            break;
+        }
+        if (vm.isRunning()) {
+            VMResult step = vm.execute(options.sliceInstructions);
+            if (step == VMResult::ERROR || step == VMResult::OUT_OF_MEMORY) {
+                result.status = HeadlessResult::Status::ERROR;
+                result.error = step == VMResult::OUT_OF_MEMORY ? "Out of memory" : vm.getError();
+                break;
+            }
+        }
+
+        // Work out when something can next happen
+        uint64_t next = UINT64_MAX;
+        if ((vm.isRunning() && !vm.isSleeping() && !vm.isAwaiting()) || platform.hasPendingAsync()) {
+            next = platform.now + options.sliceMs;
+        } else {
+            if (vm.isRunning() && vm.isSleeping()) {
+                next = std::max<uint64_t>(vm.getSleepUntil(), platform.now);
+            }
+            uint32_t timerDelay = platform.getNextTimerDelay();
+            if (timerDelay != PlatformInterface::NO_TIMER_DEADLINE) {
+                next = std::min<uint64_t>(next, static_cast<uint64_t>(platform.now) + timerDelay);
+            }
+            if (nextInput < options.input.size()) {
+                next = std::min<uint64_t>(next, options.input[nextInput].time);
+            }
+        }
+        if (next == UINT64_MAX) {
+            // Nothing left that could draw: the last frame is final
+            closeFrames(std::max(platform.now, nextFrame));
+            result.status = HeadlessResult::Status::IDLE;
+            break;
+        }
+        if (next >= options.durationMs) {
+            closeFrames(options.durationMs);
+            platform.now = options.durationMs;
+            result.status = HeadlessResult::Status::TIME_LIMIT;
+            break;
+        }
+        // Nothing changes between now and `next`
+        closeFrames(static_cast<uint32_t>(next));
+        platform.now = static_cast<uint32_t>(std::max<uint64_t>(next, platform.now));
+    }
+
+    result.virtualMs = platform.now;
+    result.instructions = vm.getInstructionCount();
+    result.nativeCalls = vm.getNativeCallCounts();
+    result.drawCalls = platform.drawCalls;
+    result.wallUs = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - wallStart).count());
+    platform.setVM(nullptr);
+    return result;
+}
+
+} // namespace vm
+} // namespace dialos
+
+#endif // DIALOS_HEADLESS_PLATFORM_H
@@ -0,0 +1,111 @@
+/**
+ * Host Input File Implementation
+ */
+
+#include "host_file.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <io.h>
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+namespace dialos {
+namespace vm {
+
+const size_t HostFile::MAP_THRESHOLD;
+
+HostFile::HostFile()
+    : file_(nullptr), mapping_(nullptr), mappedSize_(0)
+#ifdef _WIN32
+      , mappingHandle_(nullptr)
+#endif
+{
+}
+
+HostFile::~HostFile() {
+    close();
+}
+
+bool HostFile::open(const std::string& path) {
+    close();
+    file_ = std::fopen(path.c_str(), "rb");
+    if (file_ == nullptr) {
+        return false;
+    }
+    std::fseek(file_, 0, SEEK_END);
+    long size = std::ftell(file_);
+    std::rewind(file_);
+    if (size < 0) {
+        close();
+        return false;
+    }
+
+    if (static_cast<size_t>(size) >= MAP_THRESHOLD && map(static_cast<size_t>(size))) {
+        reader_.view(mapping_, static_cast<uint32_t>(size));
+        reader_.seek(0);
+        return true;
+    }
+    std::FILE* file = file_;
+    reader_.attach(
+        [file](uint32_t offset, char* dest, size_t length) -> size_t {
+            if (std::fseek(file, static_cast<long>(offset), SEEK_SET) != 0) {
+                return 0;
+            }
+            return std::fread(dest, 1, length, file);
+        },
+        static_cast<uint32_t>(size));
+    return true;
+}
+
+bool HostFile::map(size_t size) {
+#ifdef _WIN32
+    HANDLE handle = reinterpret_cast<HANDLE>(_get_osfhandle(_fileno(file_)));
+    HANDLE mapping = CreateFileMappingA(handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping == nullptr) {
+        return false;
+    }
+    void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, size);
+    if (view == nullptr) {
+        CloseHandle(mapping);
+        return false;
+    }
+    mappingHandle_ = mapping;
+    mapping_ = static_cast<const char*>(view);
+#else
+    void* view = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fileno(file_), 0);
+    if (view == MAP_FAILED) {
+        return false;
+    }
+    // Line scans walk the file front to back
+    ::madvise(view, size, MADV_SEQUENTIAL);
+    mapping_ = static_cast<const char*>(view);
+#endif
+    mappedSize_ = size;
+    return true;
+}
+
+void HostFile::close() {
+    if (mapping_ != nullptr) {
+#ifdef _WIN32
+        UnmapViewOfFile(mapping_);
+        CloseHandle(mappingHandle_);
+        mappingHandle_ = nullptr;
+#else
+        ::munmap(const_cast<char*>(mapping_), mappedSize_);
+#endif
+        mapping_ = nullptr;
+        mappedSize_ = 0;
+    }
+    if (file_ != nullptr) {
+        std::fclose(file_);
+        file_ = nullptr;
+    }
+    reader_.view(nullptr, 0);
+}
+
+} // namespace vm
+} // namespace dialos
@@ -0,0 +1,56 @@
+/**
+ * Host Input File
+ *
+ * A file opened for reading on the emulator's host, behind a FileReader.
+ * Files of MAP_THRESHOLD bytes or more are memory-mapped (mmap, or a file
+ * mapping on Windows), so reads are copies out of the page cache with no
+ * system call per buffer; smaller files, and anything that can't be
+ * mapped, are read through a FILE* in FileReader::BUFFER_SIZE blocks.
+ *
+ * The mapping is a snapshot of a read-only handle: writing the same file
+ * through another handle meanwhile is not supported.
+ */
+
+#ifndef DIALOS_HOST_FILE_H
+#define DIALOS_HOST_FILE_H
+
+#include "vm/file_reader.h"
+#include <cstdio>
+#include <string>
+
+namespace dialos {
+namespace vm {
+
+class HostFile {
+public:
+    static const size_t MAP_THRESHOLD = 64 * 1024;
+
+    HostFile();
+    ~HostFile();
+
+    HostFile(const HostFile&) = delete;
+    HostFile& operator=(const HostFile&) = delete;
+
+    // false if the file can't be opened
+    bool open(const std::string& path);
+    void close();
+
+    FileReader& reader() { return reader_; }
+    bool mapped() const { return mapping_ != nullptr; }
+
+private:
+    bool map(size_t size);
+
+    std::FILE* file_;
+    const char* mapping_;
+    size_t mappedSize_;
+#ifdef _WIN32
+    void* mappingHandle_;
+#endif
+    FileReader reader_;
+};
+
+} // namespace vm
+} // namespace dialos
+
+#endif // DIALOS_HOST_FILE_H
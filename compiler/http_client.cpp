@@ -0,0 +1,549 @@
+/**
+ * Host HTTP Client Implementation
+ */
+
+#include "http_client.h"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+
+#ifndef _WIN32
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+#endif
+
+namespace dialos {
+namespace vm {
+
+const int64_t HttpResponse::INVALID_LENGTH;
+const size_t HttpClient::MAX_IDLE_PER_HOST;
+const uint32_t HttpClient::IDLE_TIMEOUT_MS;
+
+namespace {
+
+const size_t READ_BUFFER_SIZE = 16 * 1024;
+const size_t MAX_HEAD_SIZE = 16 * 1024;
+// fetch() reserves up to this much for a body of advertised length; a
+// bigger one grows as it arrives
+const size_t MAX_BODY_RESERVE = 1024 * 1024;
+
+std::string lower(std::string text) {
+    std::transform(text.begin(), text.end(), text.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return text;
+}
+
+std::string trim(const std::string& text) {
+    size_t first = text.find_first_not_of(" \t");
+    if (first == std::string::npos) {
+        return "";
+    }
+    size_t last = text.find_last_not_of(" \t\r");
+    return text.substr(first, last - first + 1);
+}
+
+// Status line and headers; false if malformed
+bool parseHead(const std::string& head, HttpResponse& response) {
+    size_t lineEnd = head.find("\r\n");
+    std::string statusLine = head.substr(0, lineEnd);
+    if (statusLine.compare(0, 5, "HTTP/") != 0) {
+        return false;
+    }
+    size_t space = statusLine.find(' ');
+    if (space == std::string::npos) {
+        return false;
+    }
+    response.http11 = statusLine.compare(0, 8, "HTTP/1.1") == 0;
+    response.status = std::atoi(statusLine.c_str() + space + 1);
+    response.headers.clear();
+    size_t pos = lineEnd == std::string::npos ? head.size() : lineEnd + 2;
+    while (pos < head.size()) {
+        size_t end = head.find("\r\n", pos);
+        if (end == std::string::npos) {
+            end = head.size();
+        }
+        size_t colon = head.find(':', pos);
+        if (colon != std::string::npos && colon < end) {
+            response.headers.push_back(std::make_pair(lower(trim(head.substr(pos, colon - pos))),
+                                                      trim(head.substr(colon + 1, end - colon - 1))));
+        }
+        pos = end + 2;
+    }
+    return response.status >= 100;
+}
+
+} // namespace
+
+#ifndef _WIN32
+
+// A socket with its receive buffer; bytes read past one response stay in
+// the buffer for the next
+struct HttpClient::Connection {
+    int fd = -1;
+    std::string key;                    // "host:port"
+    std::vector<char> buffer;
+    size_t begin = 0;                   // Unread bytes are buffer[begin, end)
+    size_t end = 0;
+    std::string out;                    // Request being sent
+    std::string line;                   // Head / chunk-size line being read
+    std::chrono::steady_clock::time_point idleSince;
+
+    ~Connection() {
+        if (fd >= 0) {
+            ::close(fd);
+        }
+    }
+
+    bool open(const HttpUrl& url, int timeoutMs, std::string& error) {
+        addrinfo hints;
+        std::memset(&hints, 0, sizeof(hints));
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        addrinfo* found = nullptr;
+        std::string port = std::to_string(url.port);
+        if (::getaddrinfo(url.host.c_str(), port.c_str(), &hints, &found) != 0 || found == nullptr) {
+            error = "Cannot resolve " + url.host;
+            return false;
+        }
+        for (addrinfo* ai = found; ai != nullptr && fd < 0; ai = ai->ai_next) {
+            fd = ::socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+            if (fd < 0) {
+                continue;
+            }
+            timeval tv;
+            tv.tv_sec = timeoutMs / 1000;
+            tv.tv_usec = (timeoutMs % 1000) * 1000;
+            ::setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+            ::setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+            if (::connect(fd, ai->ai_addr, ai->ai_addrlen) != 0) {
+                ::close(fd);
+                fd = -1;
+            }
+        }
+        ::freeaddrinfo(found);
+        if (fd < 0) {
+            error = "Cannot connect to " + url.host + ":" + port;
+            return false;
+        }
+        int one = 1;
+        ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        buffer.resize(READ_BUFFER_SIZE);
+        return true;
+    }
+
+    bool sendAll(const std::string& data) {
+        size_t sent = 0;
+        while (sent < data.size()) {
+            ssize_t n = ::send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+            if (n <= 0) {
+                return false;
+            }
+            sent += static_cast<size_t>(n);
+        }
+        return true;
+    }
+
+    // Read more into the buffer: bytes read, 0 at end of stream, -1 on
+    // error or timeout
+    ssize_t fill() {
+        if (begin == end) {
+            begin = end = 0;
+        }
+        ssize_t n = ::recv(fd, buffer.data() + end, buffer.size() - end, 0);
+        if (n > 0) {
+            end += static_cast<size_t>(n);
+        }
+        return n;
+    }
+
+    // Read through the next "\r\n" (or "\r\n\r\n") into `line`, without it
+    bool readUntil(const char* terminator, size_t limit, bool& nothingRead) {
+        size_t length = std::strlen(terminator);
+        line.clear();
+        nothingRead = true;
+        while (true) {
+            if (begin < end) {
+                nothingRead = false;
+                size_t searchFrom = line.size() >= length ? line.size() - (length - 1) : 0;
+                line.append(buffer.data() + begin, end - begin);
+                size_t found = line.find(terminator, searchFrom);
+                if (found != std::string::npos) {
+                    // Hand back what follows the terminator
+                    begin = end - (line.size() - found - length);
+                    line.resize(found);
+                    return true;
+                }
+                begin = end;
+                if (line.size() > limit) {
+                    return false;
+                }
+            }
+            if (end == buffer.size()) {
+                begin = end = 0;
+            }
+            if (fill() <= 0) {
+                return false;
+            }
+        }
+    }
+
+    // Pass `length` body bytes to `onBody` (UNKNOWN_LENGTH: until the
+    // server closes the connection)
+    bool readBody(int64_t length, const HttpClient::BodyHandler& onBody, bool& aborted) {
+        while (length != 0) {
+            if (begin == end) {
+                ssize_t n = fill();
+                if (n == 0 && length == DownloadWriter::UNKNOWN_LENGTH) {
+                    return true;
+                }
+                if (n <= 0) {
+                    return false;
+                }
+            }
+            size_t take = end - begin;
+            if (length != DownloadWriter::UNKNOWN_LENGTH && static_cast<int64_t>(take) > length) {
+                take = static_cast<size_t>(length);
+            }
+            if (onBody && !onBody(buffer.data() + begin, take)) {
+                aborted = true;
+                return false;
+            }
+            begin += take;
+            if (length != DownloadWriter::UNKNOWN_LENGTH) {
+                length -= static_cast<int64_t>(take);
+            }
+        }
+        return true;
+    }
+};
+
+#else
+
+struct HttpClient::Connection {
+    std::string key;
+};
+
+#endif
+
+bool HttpUrl::parse(const std::string& url, HttpUrl& out) {
+    const std::string scheme = "http://";
+    if (url.compare(0, scheme.size(), scheme) != 0) {
+        return false;
+    }
+    size_t hostStart = scheme.size();
+    size_t slash = url.find('/', hostStart);
+    std::string authority = url.substr(hostStart, slash == std::string::npos ? std::string::npos : slash - hostStart);
+    out.path = slash == std::string::npos ? "/" : url.substr(slash);
+    out.port = 80;
+    size_t colon = authority.rfind(':');
+    if (colon != std::string::npos) {
+        int port = std::atoi(authority.c_str() + colon + 1);
+        if (port <= 0 || port > 65535) {
+            return false;
+        }
+        out.port = static_cast<uint16_t>(port);
+        authority.resize(colon);
+    }
+    out.host = authority;
+    return !out.host.empty();
+}
+
+std::string HttpResponse::header(const std::string& name) const {
+    for (const auto& entry : headers) {
+        if (entry.first == name) {
+            return entry.second;
+        }
+    }
+    return "";
+}
+
+int64_t HttpResponse::contentLength() const {
+    std::string value = header("content-length");
+    if (value.empty()) {
+        return DownloadWriter::UNKNOWN_LENGTH;
+    }
+    // Digits only (no sign, no blanks), and few enough not to overflow
+    if (value.size() > 18 || value.find_first_not_of("0123456789") != std::string::npos) {
+        return INVALID_LENGTH;
+    }
+    return std::strtoll(value.c_str(), nullptr, 10);
+}
+
+HttpClient::HttpClient(int timeoutMs) : timeoutMs_(timeoutMs), keepAlive_(true) {}
+
+HttpClient::~HttpClient() = default;
+
+HttpClient::ConnectionPtr HttpClient::takeIdle(const std::string& key) {
+    std::lock_guard<std::mutex> guard(mutex_);
+    auto it = idle_.find(key);
+    if (it == idle_.end()) {
+        return nullptr;
+    }
+    auto now = std::chrono::steady_clock::now();
+    std::vector<ConnectionPtr>& pool = it->second;
+    while (!pool.empty()) {
+        // Most recently used first: the least likely to have been dropped
+        ConnectionPtr connection = std::move(pool.back());
+        pool.pop_back();
+        if (now - connection->idleSince < std::chrono::milliseconds(IDLE_TIMEOUT_MS)) {
+            return connection;
+        }
+    }
+    return nullptr;
+}
+
+void HttpClient::putIdle(ConnectionPtr connection) {
+    connection->idleSince = std::chrono::steady_clock::now();
+    std::lock_guard<std::mutex> guard(mutex_);
+    std::vector<ConnectionPtr>& pool = idle_[connection->key];
+    if (pool.size() >= MAX_IDLE_PER_HOST) {
+        pool.erase(pool.begin());
+    }
+    pool.push_back(std::move(connection));
+}
+
+void HttpClient::closeIdle() {
+    std::lock_guard<std::mutex> guard(mutex_);
+    idle_.clear();
+}
+
+HttpClient::Stats HttpClient::getStats() const {
+    std::lock_guard<std::mutex> guard(mutex_);
+    return stats_;
+}
+
+HttpClient::Outcome HttpClient::exchange(Connection& connection, const std::string& method, const HttpUrl& target,
+                                         const Headers& headers, const std::string& body,
+                                         const HeadHandler& onHead, const BodyHandler& onBody, bool& reusable,
+                                         std::string& error) {
+#ifdef _WIN32
+    (void)connection; (void)method; (void)target; (void)headers; (void)body; (void)onHead; (void)onBody;
+    reusable = false;
+    error = "Socket HTTP client not available on Windows";
+    return Outcome::FAILED;
+#else
+    reusable = false;
+    std::string& out = connection.out;
+    out.clear();
+    out += method;
+    out += ' ';
+    out += target.path;
+    out += " HTTP/1.1\r\nHost: ";
+    out += target.host;
+    if (target.port != 80) {
+        out += ':';
+        out += std::to_string(target.port);
+    }
+    out += keepAlive_ ? "\r\nConnection: keep-alive" : "\r\nConnection: close";
+    out += "\r\nUser-Agent: dialOS HTTP Client/1.1\r\n";
+    for (const auto& header : headers) {
+        out += header.first;
+        out += ": ";
+        out += header.second;
+        out += "\r\n";
+    }
+    if (!body.empty() || method == "POST") {
+        out += "Content-Length: ";
+        out += std::to_string(body.size());
+        out += "\r\n";
+    }
+    out += "\r\n";
+    out += body;
+    if (!connection.sendAll(out)) {
+        error = "Failed to send the request";
+        return Outcome::STALE;
+    }
+
+    bool nothingRead = false;
+    if (!connection.readUntil("\r\n\r\n", MAX_HEAD_SIZE, nothingRead)) {
+        if (nothingRead) {
+            error = "Connection closed before the response";
+            return Outcome::STALE;
+        }
+        error = connection.line.size() > MAX_HEAD_SIZE ? "Response head too large" : "Incomplete response head";
+        return Outcome::FAILED;
+    }
+    HttpResponse response;
+    if (!parseHead(connection.line, response)) {
+        error = "Malformed response";
+        return Outcome::FAILED;
+    }
+    if (response.contentLength() == HttpResponse::INVALID_LENGTH) {
+        error = "Malformed Content-Length: " + response.header("content-length");
+        return Outcome::FAILED;
+    }
+    std::string persistence = lower(response.header("connection"));
+    bool persistent = keepAlive_ && (response.http11 ? persistence != "close" : persistence == "keep-alive");
+    if (onHead && !onHead(response)) {
+        error = "Response rejected";
+        return Outcome::FAILED;
+    }
+    bool noBody = method == "HEAD" || response.status == 204 || response.status == 304 || response.status < 200;
+    if (noBody) {
+        reusable = persistent;
+        return Outcome::OK;
+    }
+
+    bool aborted = false;
+    if (lower(response.header("transfer-encoding")).find("chunked") != std::string::npos) {
+        // <hex size>[;ext]\r\n<data>\r\n ... 0\r\n[trailers]\r\n
+        while (true) {
+            if (!connection.readUntil("\r\n", 1024, nothingRead)) {
+                error = "Connection lost in a chunked body";
+                return Outcome::FAILED;
+            }
+            char* sizeEnd = nullptr;
+            long long size = std::strtoll(connection.line.c_str(), &sizeEnd, 16);
+            if (sizeEnd == connection.line.c_str() || size < 0) {
+                error = "Malformed chunk size";
+                return Outcome::FAILED;
+            }
+            if (size == 0) {
+                break;
+            }
+            if (!connection.readBody(size, onBody, aborted) || !connection.readUntil("\r\n", 2, nothingRead) ||
+                !connection.line.empty()) {
+                error = aborted ? "Transfer aborted" : "Connection lost in a chunked body";
+                return Outcome::FAILED;
+            }
+        }
+        // Trailers, up to the empty line
+        do {
+            if (!connection.readUntil("\r\n", MAX_HEAD_SIZE, nothingRead)) {
+                error = "Connection lost in the trailers";
+                return Outcome::FAILED;
+            }
+        } while (!connection.line.empty());
+        reusable = persistent;
+        return Outcome::OK;
+    }
+
+    int64_t length = response.contentLength();
+    if (!connection.readBody(length, onBody, aborted)) {
+        error = aborted ? "Transfer aborted" : "Connection lost with the body incomplete";
+        return Outcome::FAILED;
+    }
+    // A body that ran to the end of the stream leaves nothing to reuse
+    reusable = persistent && length != DownloadWriter::UNKNOWN_LENGTH;
+    return Outcome::OK;
+#endif
+}
+
+bool HttpClient::request(const std::string& method, const std::string& url, const Headers& headers,
+                         const std::string& body, const HeadHandler& onHead, const BodyHandler& onBody,
+                         std::string& error) {
+    HttpUrl target;
+    if (!HttpUrl::parse(url, target)) {
+        error = "Invalid URL: " + url;
+        return false;
+    }
+    std::string key = target.host + ":" + std::to_string(target.port);
+    {
+        std::lock_guard<std::mutex> guard(mutex_);
+        stats_.requests++;
+    }
+
+    // A pooled connection may have been closed by the server meanwhile;
+    // that shows before any response byte, and the request goes again on
+    // a fresh connection
+    ConnectionPtr connection = keepAlive_ ? takeIdle(key) : nullptr;
+    bool reused = connection != nullptr;
+    while (true) {
+        if (!connection) {
+#ifdef _WIN32
+            error = "Socket HTTP client not available on Windows";
+            return false;
+#else
+            connection.reset(new Connection());
+            connection->key = key;
+            if (!connection->open(target, timeoutMs_, error)) {
+                return false;
+            }
+#endif
+        }
+        {
+            std::lock_guard<std::mutex> guard(mutex_);
+            if (reused) {
+                stats_.connectionsReused++;
+            } else {
+                stats_.connectionsOpened++;
+            }
+        }
+        bool reusable = false;
+        Outcome outcome = exchange(*connection, method, target, headers, body, onHead, onBody, reusable, error);
+        if (outcome == Outcome::STALE && reused) {
+            std::lock_guard<std::mutex> guard(mutex_);
+            stats_.retries++;
+            connection.reset();
+            reused = false;
+            continue;
+        }
+        if (outcome == Outcome::OK && reusable) {
+            putIdle(std::move(connection));
+        }
+        return outcome == Outcome::OK;
+    }
+}
+
+bool HttpClient::fetch(const std::string& method, const std::string& url, const std::string& body,
+                       HttpResponse& response, std::string& responseBody, std::string& error,
+                       const Headers& headers) {
+    responseBody.clear();
+    return request(
+        method, url, headers, body,
+        [&](const HttpResponse& head) {
+            response = head;
+            int64_t length = head.contentLength();
+            if (length > 0) {
+                responseBody.reserve(static_cast<size_t>(std::min<int64_t>(length, MAX_BODY_RESERVE)));
+            }
+            return true;
+        },
+        [&](const char* data, size_t length) {
+            responseBody.append(data, length);
+            return true;
+        },
+        error);
+}
+
+std::string HttpClient::download(const std::string& url, const std::string& path, const std::string& filepath,
+                                 DownloadWriter::ProgressHandler progress) {
+    DownloadWriter writer(path);
+    writer.setProgressHandler(progress);
+    Headers headers;
+    uint32_t offset = writer.prepare();
+    if (offset > 0) {
+        headers.push_back(std::make_pair("Range", "bytes=" + std::to_string(offset) + "-"));
+        headers.push_back(std::make_pair("If-Range", writer.validator()));
+    }
+
+    std::string writeError;
+    std::string error;
+    bool ok = request(
+        "GET", url, headers, "",
+        [&](const HttpResponse& response) {
+            std::string validator = response.header("etag");
+            if (validator.empty()) {
+                validator = response.header("last-modified");
+            }
+            return writer.begin(response.status, response.header("content-range"), response.contentLength(),
+                                validator, writeError);
+        },
+        [&](const char* data, size_t length) { return writer.write(data, length, writeError); }, error);
+    if (!ok) {
+        return DownloadWriter::errorReport(writeError.empty() ? error : writeError);
+    }
+    if (!writer.finish(error)) {
+        return DownloadWriter::errorReport(error);
+    }
+    return writer.report(filepath);
+}
+
+} // namespace vm
+} // namespace dialos
@@ -0,0 +1,138 @@
+/**
+ * Host HTTP Client
+ *
+ * HTTP/1.1 client over POSIX sockets for the emulator and the tests (plain
+ * http:// only). Connections are kept alive and pooled per host:port, so
+ * the app store's run of small requests - index, metadata, icons, then a
+ * .dsb - pays for one TCP handshake instead of one per request. Each
+ * pooled connection keeps its receive buffer and request buffer, so a
+ * request on a warm connection allocates nothing on the socket path.
+ *
+ * Bodies are streamed to a handler block by block, decoding chunked
+ * transfer encoding on the way. A request that finds its pooled
+ * connection closed by the server (idle timeout) is retried once on a
+ * fresh one. Thread-safe: workers share one client and its pool.
+ *
+ * On Windows the SDL platform keeps using WinHTTP and request() reports
+ * an error.
+ */
+
+#ifndef DIALOS_HTTP_CLIENT_H
+#define DIALOS_HTTP_CLIENT_H
+
+#include "vm/http_download.h"
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace dialos {
+namespace vm {
+
+struct HttpUrl {
+    std::string host;
+    uint16_t port = 80;
+    std::string path = "/";
+
+    // "http://host[:port][/path]"; false for anything else
+    static bool parse(const std::string& url, HttpUrl& out);
+};
+
+struct HttpResponse {
+    static const int64_t INVALID_LENGTH = -2;
+
+    int status = 0;
+    bool http11 = false;
+    std::vector<std::pair<std::string, std::string>> headers;   // Names lower-cased
+
+    // Value of header `name` (lower case), or ""
+    std::string header(const std::string& name) const;
+    // Content-Length, DownloadWriter::UNKNOWN_LENGTH if there is none, or
+    // INVALID_LENGTH if it isn't a plain decimal number
+    int64_t contentLength() const;
+};
+
+class HttpClient {
+public:
+    typedef std::vector<std::pair<std::string, std::string>> Headers;
+    // Response head, before any body; return false to drop the body
+    typedef std::function<bool(const HttpResponse&)> HeadHandler;
+    // A block of body bytes; return false to abort the transfer
+    typedef std::function<bool(const char* data, size_t length)> BodyHandler;
+
+    struct Stats {
+        uint32_t requests = 0;
+        uint32_t connectionsOpened = 0;
+        uint32_t connectionsReused = 0;
+        uint32_t retries = 0;           // Pooled connections found dead
+    };
+
+    static const size_t MAX_IDLE_PER_HOST = 4;
+    static const uint32_t IDLE_TIMEOUT_MS = 30000;
+
+    explicit HttpClient(int timeoutMs = 10000);
+    ~HttpClient();
+
+    HttpClient(const HttpClient&) = delete;
+    HttpClient& operator=(const HttpClient&) = delete;
+
+    // Off: every request opens its own connection and asks the server to
+    // close it ("Connection: close")
+    void setKeepAlive(bool keepAlive) { keepAlive_ = keepAlive; }
+
+    /**
+     * Send one request and stream the answer.
+     * @return false with `error` set if the request couldn't be made, the
+     *         connection failed midway or a handler aborted
+     */
+    bool request(const std::string& method, const std::string& url, const Headers& headers,
+                 const std::string& body, const HeadHandler& onHead, const BodyHandler& onBody,
+                 std::string& error);
+
+    // Send one request and collect the whole body (http.get / http.post)
+    bool fetch(const std::string& method, const std::string& url, const std::string& body,
+               HttpResponse& response, std::string& responseBody, std::string& error,
+               const Headers& headers = Headers());
+
+    /**
+     * Download `url` to `path` on the host file system through a
+     * DownloadWriter: resumes a part file left by an earlier attempt and
+     * reports progress as chunks are written.
+     * @return the http.download answer (DownloadWriter::report/errorReport)
+     */
+    std::string download(const std::string& url, const std::string& path, const std::string& filepath,
+                         DownloadWriter::ProgressHandler progress);
+
+    // Close all pooled connections
+    void closeIdle();
+
+    Stats getStats() const;
+
+private:
+    struct Connection;
+    typedef std::unique_ptr<Connection> ConnectionPtr;
+
+    enum class Outcome { OK, FAILED, STALE };
+
+    // A pooled connection to `key`, or nullptr
+    ConnectionPtr takeIdle(const std::string& key);
+    void putIdle(ConnectionPtr connection);
+    Outcome exchange(Connection& connection, const std::string& method, const HttpUrl& target,
+                     const Headers& headers, const std::string& body, const HeadHandler& onHead,
+                     const BodyHandler& onBody, bool& reusable, std::string& error);
+
+    int timeoutMs_;
+    bool keepAlive_;
+    mutable std::mutex mutex_;
+    std::map<std::string, std::vector<ConnectionPtr>> idle_;
+    Stats stats_;
+};
+
+} // namespace vm
+} // namespace dialos
+
+#endif // DIALOS_HTTP_CLIENT_H
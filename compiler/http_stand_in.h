@@ -0,0 +1,347 @@
+/**
+ * Stand-in HTTP Server for Tests
+ *
+ * Serves in-memory files on 127.0.0.1 (an ephemeral port), one thread per
+ * connection, so the host HTTP client and the http.* natives can be
+ * tested and benchmarked without a network. Understands what the client
+ * uses: HTTP/1.1 keep-alive (HTTP/1.0 and "Connection: close" end the
+ * connection after the response), ETag, Last-Modified and Cache-Control,
+ * If-None-Match / If-Modified-Since (304), "Range: bytes=<n>-" and If-Range.
+ * Full bodies can be sent with chunked encoding, a response can be cut
+ * short after a given number of body bytes to simulate a dropped
+ * connection or sent with a bogus Content-Length, idle keep-alive connections can be closed the way a server's
+ * idle timeout would, and POST echoes the request body.
+ *
+ * POSIX only, like the client it exercises.
+ */
+
+#ifndef DIALOS_HTTP_STAND_IN_H
+#define DIALOS_HTTP_STAND_IN_H
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace dialos {
+namespace vm {
+
+class HttpStandIn {
+public:
+    HttpStandIn()
+        : listenFd_(-1), port_(0), stop_(false), requests_(0), connections_(0), idleGeneration_(0), chunked_(false),
+          dropAfter_(-1) {
+        listenFd_ = ::socket(AF_INET, SOCK_STREAM, 0);
+        int one = 1;
+        ::setsockopt(listenFd_, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        sockaddr_in addr;
+        std::memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        addr.sin_port = 0;
+        socklen_t length = sizeof(addr);
+        if (::bind(listenFd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0 &&
+            ::listen(listenFd_, 64) == 0 &&
+            ::getsockname(listenFd_, reinterpret_cast<sockaddr*>(&addr), &length) == 0) {
+            port_ = ntohs(addr.sin_port);
+        }
+        thread_ = std::thread([this]() { run(); });
+    }
+
+    ~HttpStandIn() {
+        stop_ = true;
+        thread_.join();
+        for (auto& worker : workers_) {
+            worker.join();
+        }
+        ::close(listenFd_);
+    }
+
+    // "http://127.0.0.1:<port><path>"
+    std::string url(const std::string& path) const {
+        return "http://127.0.0.1:" + std::to_string(port_) + path;
+    }
+
+    void setFile(const std::string& path, const std::string& body, const std::string& etag,
+                 const std::string& lastModified = "", const std::string& cacheControl = "") {
+        std::lock_guard<std::mutex> guard(mutex_);
+        files_[path] = File{body, etag, lastModified, cacheControl};
+    }
+
+    // Send full bodies to HTTP/1.1 requests with chunked encoding
+    void setChunked(bool chunked) { chunked_ = chunked; }
+
+    // Close the connection of the next response after `bytes` body bytes
+    void dropNextAfter(long bytes) {
+        std::lock_guard<std::mutex> guard(mutex_);
+        dropAfter_ = bytes;
+    }
+
+    // Send the next file with `value` as its Content-Length, then close
+    void advertiseNextLength(const std::string& value) {
+        std::lock_guard<std::mutex> guard(mutex_);
+        lengthOverride_ = value;
+    }
+
+    // Close every connection now waiting for its next request
+    void closeIdle() { idleGeneration_++; }
+
+    int requests() const { return requests_; }
+    int connections() const { return connections_; }
+
+    // Head of the last request, verbatim
+    std::string lastRequest() {
+        std::lock_guard<std::mutex> guard(mutex_);
+        return lastRequest_;
+    }
+
+private:
+    struct File {
+        std::string body;
+        std::string etag;
+        std::string lastModified;
+        std::string cacheControl;
+    };
+
+    void run() {
+        while (!stop_) {
+            pollfd pfd = {listenFd_, POLLIN, 0};
+            if (::poll(&pfd, 1, 20) <= 0) {
+                continue;
+            }
+            int fd = ::accept(listenFd_, nullptr, nullptr);
+            if (fd >= 0) {
+                connections_++;
+                workers_.push_back(std::thread([this, fd]() {
+                    serveConnection(fd);
+                    ::close(fd);
+                }));
+            }
+        }
+    }
+
+    static std::string header(const std::string& head, const std::string& name) {
+        std::string lowerHead = head;
+        for (char& c : lowerHead) {
+            c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        }
+        size_t pos = lowerHead.find("\r\n" + name + ":");
+        if (pos == std::string::npos) {
+            return "";
+        }
+        pos += name.size() + 3;
+        size_t end = head.find("\r\n", pos);
+        size_t first = head.find_first_not_of(' ', pos);
+        return head.substr(first, end - first);
+    }
+
+    static bool sendAll(int fd, const char* data, size_t length) {
+        while (length > 0) {
+            ssize_t n = ::send(fd, data, length, MSG_NOSIGNAL);
+            if (n <= 0) {
+                return false;
+            }
+            data += n;
+            length -= static_cast<size_t>(n);
+        }
+        return true;
+    }
+
+    // Wait for bytes, giving up when the server stops or, for a connection
+    // between requests, when closeIdle() is called
+    bool receive(int fd, std::string& into, bool idle) {
+        char buffer[16384];
+        int generation = idleGeneration_;
+        while (!stop_ && !(idle && generation != idleGeneration_)) {
+            pollfd pfd = {fd, POLLIN, 0};
+            if (::poll(&pfd, 1, 20) <= 0) {
+                continue;
+            }
+            ssize_t n = ::recv(fd, buffer, sizeof(buffer), 0);
+            if (n <= 0) {
+                return false;
+            }
+            into.append(buffer, static_cast<size_t>(n));
+            return true;
+        }
+        return false;
+    }
+
+    void serveConnection(int fd) {
+        std::string pending;
+        while (true) {
+            size_t headEnd;
+            while ((headEnd = pending.find("\r\n\r\n")) == std::string::npos) {
+                if (!receive(fd, pending, pending.empty())) {
+                    return;
+                }
+            }
+            std::string head = pending.substr(0, headEnd + 2);
+            size_t bodyLength = std::strtoul(header(head, "content-length").c_str(), nullptr, 10);
+            while (pending.size() < headEnd + 4 + bodyLength) {
+                if (!receive(fd, pending, false)) {
+                    return;
+                }
+            }
+            std::string body = pending.substr(headEnd + 4, bodyLength);
+            pending.erase(0, headEnd + 4 + bodyLength);
+
+            std::string requestLine = head.substr(0, head.find("\r\n"));
+            bool http11 = requestLine.find("HTTP/1.1") != std::string::npos;
+            std::string connection = header(head, "connection");
+            for (char& c : connection) {
+                c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+            }
+            bool keepAlive = http11 ? connection != "close" : connection == "keep-alive";
+            if (!respond(fd, head, body, http11, keepAlive) || !keepAlive) {
+                return;
+            }
+        }
+    }
+
+    // Send one response; false if the connection must close
+    bool respond(int fd, const std::string& head, const std::string& body, bool http11, bool keepAlive) {
+        requests_++;
+        std::string method = head.substr(0, head.find(' '));
+        std::string path = head.substr(head.find(' ') + 1);
+        path.resize(path.find(' '));
+
+        File file;
+        bool found;
+        long dropAfter;
+        std::string lengthOverride;
+        {
+            std::lock_guard<std::mutex> guard(mutex_);
+            lastRequest_ = head;
+            auto it = files_.find(path);
+            found = it != files_.end();
+            if (found) {
+                file = it->second;
+            }
+            dropAfter = dropAfter_;
+            dropAfter_ = -1;
+            lengthOverride.swap(lengthOverride_);
+        }
+        const std::string version = http11 ? "HTTP/1.1 " : "HTTP/1.0 ";
+        const std::string persistence = keepAlive ? "Connection: keep-alive\r\n" : "Connection: close\r\n";
+        if (method == "POST") {
+            std::string echo = "posted:" + body;
+            std::string response = version + "200 OK\r\n" + persistence + "Content-Length: " +
+                                   std::to_string(echo.size()) + "\r\n\r\n" + echo;
+            return sendAll(fd, response.data(), response.size());
+        }
+        if (!found) {
+            std::string response = version + "404 Not Found\r\n" + persistence + "Content-Length: 0\r\n\r\n";
+            return sendAll(fd, response.data(), response.size());
+        }
+
+        std::string validators;
+        if (!file.etag.empty()) {
+            validators += "ETag: " + file.etag + "\r\n";
+        }
+        if (!file.lastModified.empty()) {
+            validators += "Last-Modified: " + file.lastModified + "\r\n";
+        }
+        if (!file.cacheControl.empty()) {
+            validators += "Cache-Control: " + file.cacheControl + "\r\n";
+        }
+        std::string ifNoneMatch = header(head, "if-none-match");
+        std::string ifModifiedSince = header(head, "if-modified-since");
+        if ((!ifNoneMatch.empty() && ifNoneMatch == file.etag) ||
+            (ifNoneMatch.empty() && !ifModifiedSince.empty() && ifModifiedSince == file.lastModified)) {
+            std::string response = version + "304 Not Modified\r\n" + persistence + validators + "\r\n";
+            return sendAll(fd, response.data(), response.size());
+        }
+
+        if (!lengthOverride.empty()) {
+            std::string response = version + "200 OK\r\nConnection: close\r\nContent-Length: " + lengthOverride +
+                                   "\r\n" + validators + "\r\n" + file.body;
+            sendAll(fd, response.data(), response.size());
+            return false;
+        }
+
+        // Honour "bytes=<n>-" unless If-Range names another version
+        size_t first = 0;
+        std::string range = header(head, "range");
+        std::string ifRange = header(head, "if-range");
+        bool partial = range.compare(0, 6, "bytes=") == 0 && (ifRange.empty() || ifRange == file.etag);
+        if (partial) {
+            first = std::strtoul(range.c_str() + 6, nullptr, 10);
+            if (first >= file.body.size()) {
+                std::string response =
+                    version + "416 Range Not Satisfiable\r\n" + persistence + "Content-Length: 0\r\n\r\n";
+                return sendAll(fd, response.data(), response.size());
+            }
+        }
+        size_t length = file.body.size() - first;
+        bool chunked = chunked_ && http11 && !partial;
+        std::string response = version + (partial ? "206 Partial Content\r\n" : "200 OK\r\n") + persistence;
+        if (chunked) {
+            response += "Transfer-Encoding: chunked\r\n";
+        } else {
+            response += "Content-Length: " + std::to_string(length) + "\r\n";
+        }
+        if (partial) {
+            response += "Content-Range: bytes " + std::to_string(first) + "-" + std::to_string(file.body.size() - 1) +
+                        "/" + std::to_string(file.body.size()) + "\r\n";
+        }
+        response += validators + "\r\n";
+        if (dropAfter >= 0 && static_cast<size_t>(dropAfter) < length) {
+            sendAll(fd, response.data(), response.size());
+            sendAll(fd, file.body.data() + first, static_cast<size_t>(dropAfter));
+            return false;
+        }
+        if (!chunked) {
+            response.append(file.body, first, length);
+            return sendAll(fd, response.data(), response.size());
+        }
+        // Uneven chunk sizes, to exercise the client's parser
+        size_t pos = 0;
+        size_t size = 1000;
+        while (pos < length) {
+            size_t n = std::min(size, length - pos);
+            char line[32];
+            std::snprintf(line, sizeof(line), "%zx\r\n", n);
+            response += line;
+            response.append(file.body, pos, n);
+            response += "\r\n";
+            pos += n;
+            size = size * 3 + 7;
+        }
+        response += "0\r\n\r\n";
+        return sendAll(fd, response.data(), response.size());
+    }
+
+    int listenFd_;
+    uint16_t port_;
+    std::atomic<bool> stop_;
+    std::atomic<int> requests_;
+    std::atomic<int> connections_;
+    std::atomic<int> idleGeneration_;
+    std::atomic<bool> chunked_;
+    std::thread thread_;
+    std::vector<std::thread> workers_;
+    std::mutex mutex_;
+    std::map<std::string, File> files_;
+    std::string lastRequest_;
+    long dropAfter_;
+    std::string lengthOverride_;
+};
+
+} // namespace vm
+} // namespace dialos
+
+#endif // DIALOS_HTTP_STAND_IN_H
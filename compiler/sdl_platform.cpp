@@ -3,6 +3,9 @@
  */
 
 #include "sdl_platform.h"
+#include "http_client.h"
+#include "vm/http_cache.h"
+#include "vm/json.h"
 #include "vm/vm_core.h"
 #include "vm/vm_value.h"
 #include <algorithm>
@@ -33,9 +36,17 @@ const uint8_t GPIO_INPUT = 0;
 const uint8_t GPIO_OUTPUT = 1;
 const uint8_t GPIO_INPUT_PULLUP = 2;
 
+const uint32_t SDLPlatform::NO_TIMEOUT;
+
+// Room for the app store index, metadata and a few applets
+static const size_t HTTP_CACHE_BUDGET = 4 * 1024 * 1024;
+
 SDLPlatform::SDLPlatform()
     : window_(nullptr), renderer_(nullptr), font_(nullptr), fontPath_(""), initialized_(false),
       shouldQuit_(false), backgroundColor_(0x000000FF), brightness_(255),
+      frame_(DISPLAY_WIDTH, DISPLAY_HEIGHT), frameTexture_(nullptr),
+      shownEncoderPosition_(-1), overlayTargets_(false), presentNeeded_(true),
+      panelDrawnAt_(0), consoleDrawnRevision_(0),
       encoder_{false, false, 0, 0, std::chrono::steady_clock::now()},
       touch_{false, false, 0, 0, std::chrono::steady_clock::now()},
       rfid_{false, "", std::chrono::steady_clock::now()},
@@ -43,9 +54,21 @@ SDLPlatform::SDLPlatform()
       startTime_(std::chrono::steady_clock::now()), rtcOffset_(0),
       i2c_{0, {}, {}, 0, {}},
       power_{75, false, std::chrono::steady_clock::now()}, consoleLog_(50),
-      outputLog_(50) {}
+      outputLog_(50), uiThread_(std::this_thread::get_id()),
+      http_(new HttpClient()) {
+  std::string cacheDir = fileSystemRoot_ + ".http_cache";
+  std::error_code ec;
+  std::filesystem::create_directories(cacheDir, ec);
+  httpCache_.reset(new HttpCache(
+      std::unique_ptr<HttpCache::Store>(new HttpCache::DirectoryStore(cacheDir)),
+      HTTP_CACHE_BUDGET));
+}
 
-SDLPlatform::~SDLPlatform() { cleanup(); }
+SDLPlatform::~SDLPlatform() {
+  // Workers log through this object; let them finish first
+  joinAsyncWorkers();
+  cleanup();
+}
 
 bool SDLPlatform::initialize(const std::string &title) {
   if (initialized_)
@@ -92,6 +115,20 @@ bool SDLPlatform::initialize(const std::string &title) {
     return false;
   }
 
+  // The display framebuffer is uploaded into this once per changed frame
+  // and scaled up by the renderer
+  frameTexture_ = SDL_CreateTexture(renderer_, SDL_PIXELFORMAT_RGB565,
+                                    SDL_TEXTUREACCESS_STREAMING, DISPLAY_WIDTH,
+                                    DISPLAY_HEIGHT);
+  if (!frameTexture_) {
+    std::cerr << "Display texture creation failed: " << SDL_GetError()
+              << std::endl;
+    cleanup();
+    return false;
+  }
+  frame_.clear(0x0000);
+  overlayTargets_ = SDL_RenderTargetSupported(renderer_) == SDL_TRUE;
+
   // Try to load a font with multiple fallbacks
   const char *fontPaths[] = {
       "C:/Windows/Fonts/arial.ttf",                      // Windows Arial
@@ -121,6 +158,15 @@ bool SDLPlatform::initialize(const std::string &title) {
     std::cout << "Please ensure you have system fonts installed." << std::endl;
   }
 
+  // Async completions arrive on worker threads; a user event wakes a
+  // waitEvents() sleeping in SDL_WaitEvent
+  setAsyncWakeHandler([]() {
+    SDL_Event wake;
+    SDL_zero(wake);
+    wake.type = SDL_USEREVENT;
+    SDL_PushEvent(&wake);
+  });
+
   initialized_ = true;
   console_log("dialOS SDL Emulator initialized");
   console_log("Hardware simulation active:");
@@ -136,6 +182,14 @@ bool SDLPlatform::initialize(const std::string &title) {
 }
 
 void SDLPlatform::cleanup() {
+  // Textures belong to the renderer and the atlases are keyed by font
+  clearTextCaches();
+  destroyOverlays();
+  if (frameTexture_) {
+    SDL_DestroyTexture(frameTexture_);
+    frameTexture_ = nullptr;
+  }
+
   // Clean up font cache
   for (auto& fontPair : fontCache_) {
     if (fontPair.second) {
@@ -191,136 +245,179 @@ bool SDLPlatform::pollEvents() {
 
   SDL_Event event;
   while (SDL_PollEvent(&event)) {
-    switch (event.type) {
-    case SDL_QUIT:
-      shouldQuit_ = true;
+    if (!handleEvent(event)) {
       return false;
+    }
+  }
 
-    case SDL_KEYDOWN:
-
-      switch (event.key.keysym.sym) {
-      case SDLK_ESCAPE:
-        shouldQuit_ = true;
-        return false;
-
-      case SDLK_r:
-        // Simulate RFID card
-        rfid_.cardPresent = !rfid_.cardPresent;
-        if (rfid_.cardPresent) {
-          // Generate a random UID
-          std::stringstream ss;
-          ss << std::hex << std::setfill('0');
-          for (int i = 0; i < 4; i++) {
-            ss << std::setw(2) << (rand() % 256);
-          }
-          rfid_.cardUID = ss.str();
-          console_log("RFID card detected: " + rfid_.cardUID);
-        } else {
-          console_log("RFID card removed");
-        }
-        break;
+  // Hand finished async natives and IPC messages back to the VM, then fire
+  // due timers
+  flushDeferredConsole();
+  processAsyncCompletions();
+  processIpc();
+  processTimers();
 
-      case SDLK_b:
-        // Simulate buzzer beep
-        buzzer_beep(1000, 200);
-        break;
-      }
-      break;
+  // SDLPlatform does not trigger lifecycle callbacks itself; the host
+  // (test harness or main runtime) should invoke app.onLoad when the
+  // VM is ready. SDLPlatform only delivers input/timer events.
 
-    case SDL_MOUSEWHEEL:
-      // Simulate rotary encoder
-      {
-        int oldPosition = encoder_.position;
-        encoder_.position += event.wheel.y;
-        encoder_.lastUpdate = std::chrono::steady_clock::now();
-
-        // Invoke encoder.onTurn callback if registered
-        int delta = encoder_.position - oldPosition;
-        if (delta != 0) {
-          std::vector<Value> args = {Value::Int32(delta)};
-          invokeCallback("encoder.onTurn", args);
-        }
-      }
-      break;
+  updateInputs();
+  return true;
+}
 
-    case SDL_MOUSEBUTTONDOWN:
-      if (event.button.button == SDL_BUTTON_LEFT) {
-        // Left mouse button - touch screen in display area
-        int mouseX = (event.button.x - DEBUG_PANEL_WIDTH) / WINDOW_SCALE;
-        int mouseY = event.button.y / WINDOW_SCALE;
-
-        if (isInCircularDisplay(mouseX, mouseY)) {
-          touch_.pressed = true;
-          touch_.x = mouseX;
-          touch_.y = mouseY;
-          touch_.lastUpdate = std::chrono::steady_clock::now();
-
-          // Invoke touch.onPress callback
-          std::vector<Value> args = {Value::Int32(mouseX),
-                                     Value::Int32(mouseY)};
-          invokeCallback("touch.onPress", args);
-        }
-      } else if (event.button.button == SDL_BUTTON_RIGHT) {
-        // Right mouse button - encoder button
-        encoder_.pressed = true;
-        encoder_.lastUpdate = std::chrono::steady_clock::now();
-
-        // Invoke encoder.onButton callback
-        std::vector<Value> args = {Value::Bool(true)};
-        invokeCallback("encoder.onButton", args);
-      }
-      break;
+bool SDLPlatform::waitEvents(uint32_t timeoutMs) {
+  if (!initialized_)
+    return false;
 
-    case SDL_MOUSEBUTTONUP:
-      if (event.button.button == SDL_BUTTON_LEFT) {
-        int mouseX = (event.button.x - DEBUG_PANEL_WIDTH) / WINDOW_SCALE;
-        int mouseY = event.button.y / WINDOW_SCALE;
+  // Sleep in the OS until input or the deadline; no frame spinning
+  SDL_Event event;
+  int got;
+  if (timeoutMs == NO_TIMEOUT) {
+    got = SDL_WaitEvent(&event);
+  } else {
+    got = SDL_WaitEventTimeout(&event, static_cast<int>(std::min<uint32_t>(timeoutMs, INT32_MAX)));
+  }
+  if (got && !handleEvent(event)) {
+    return false;
+  }
+  return pollEvents();
+}
 
-        touch_.pressed = false;
+bool SDLPlatform::handleEvent(const SDL_Event &event) {
+  switch (event.type) {
+  case SDL_QUIT:
+    shouldQuit_ = true;
+    return false;
 
-        // Invoke touch.onRelease callback if in display
-        if (isInCircularDisplay(mouseX, mouseY)) {
-          std::vector<Value> args = {Value::Int32(mouseX),
-                                     Value::Int32(mouseY)};
-          invokeCallback("touch.onRelease", args);
-        }
-      } else if (event.button.button == SDL_BUTTON_RIGHT) {
-        encoder_.pressed = false;
+  case SDL_WINDOWEVENT:
+    // Exposed, resized, restored...: the window needs drawing even if
+    // nothing in it changed
+    presentNeeded_ = true;
+    break;
 
-        // Invoke encoder.onButton callback for release
-        std::vector<Value> args = {Value::Bool(false)};
-        invokeCallback("encoder.onButton", args);
-      }
-      break;
+  case SDL_RENDER_TARGETS_RESET:
+  case SDL_RENDER_DEVICE_RESET:
+    // The overlay textures lost their contents
+    panelOverlay_.valid = false;
+    consoleOverlay_.valid = false;
+    presentNeeded_ = true;
+    break;
 
-    case SDL_MOUSEMOTION:
-      if (touch_.pressed) {
-        int mouseX = (event.motion.x - DEBUG_PANEL_WIDTH) / WINDOW_SCALE;
-        int mouseY = event.motion.y / WINDOW_SCALE;
+  case SDL_KEYDOWN:
 
-        if (isInCircularDisplay(mouseX, mouseY)) {
-          touch_.x = mouseX;
-          touch_.y = mouseY;
-          touch_.lastUpdate = std::chrono::steady_clock::now();
+    switch (event.key.keysym.sym) {
+    case SDLK_ESCAPE:
+      shouldQuit_ = true;
+      return false;
 
-          // Invoke touch.onDrag callback
-          std::vector<Value> args = {Value::Int32(mouseX),
-                                     Value::Int32(mouseY)};
-          invokeCallback("touch.onDrag", args);
+    case SDLK_r:
+      // Simulate RFID card
+      rfid_.cardPresent = !rfid_.cardPresent;
+      if (rfid_.cardPresent) {
+        // Generate a random UID
+        std::stringstream ss;
+        ss << std::hex << std::setfill('0');
+        for (int i = 0; i < 4; i++) {
+          ss << std::setw(2) << (rand() % 256);
         }
+        rfid_.cardUID = ss.str();
+        console_log("RFID card detected: " + rfid_.cardUID);
+      } else {
+        console_log("RFID card removed");
       }
       break;
+
+    case SDLK_b:
+      // Simulate buzzer beep
+      buzzer_beep(1000, 200);
+      break;
     }
-  }
+    break;
+
+  case SDL_MOUSEWHEEL:
+    // Simulate rotary encoder
+    {
+      int oldPosition = encoder_.position;
+      encoder_.position += event.wheel.y;
+      encoder_.lastUpdate = std::chrono::steady_clock::now();
+
+      // Invoke encoder.onTurn callback if registered
+      int delta = encoder_.position - oldPosition;
+      if (delta != 0) {
+        std::vector<Value> args = {Value::Int32(delta)};
+        invokeCallback("encoder.onTurn", args);
+      }
+    }
+    break;
+
+  case SDL_MOUSEBUTTONDOWN:
+    if (event.button.button == SDL_BUTTON_LEFT) {
+      // Left mouse button - touch screen in display area
+      int mouseX = (event.button.x - DEBUG_PANEL_WIDTH) / WINDOW_SCALE;
+      int mouseY = event.button.y / WINDOW_SCALE;
+
+      if (isInCircularDisplay(mouseX, mouseY)) {
+        touch_.pressed = true;
+        touch_.x = mouseX;
+        touch_.y = mouseY;
+        touch_.lastUpdate = std::chrono::steady_clock::now();
+
+        // Invoke touch.onPress callback
+        std::vector<Value> args = {Value::Int32(mouseX),
+                                   Value::Int32(mouseY)};
+        invokeCallback("touch.onPress", args);
+      }
+    } else if (event.button.button == SDL_BUTTON_RIGHT) {
+      // Right mouse button - encoder button
+      encoder_.pressed = true;
+      encoder_.lastUpdate = std::chrono::steady_clock::now();
+
+      // Invoke encoder.onButton callback
+      std::vector<Value> args = {Value::Bool(true)};
+      invokeCallback("encoder.onButton", args);
+    }
+    break;
 
-  // Process timers once per poll cycle (after all events handled)
-  processTimers();
+  case SDL_MOUSEBUTTONUP:
+    if (event.button.button == SDL_BUTTON_LEFT) {
+      int mouseX = (event.button.x - DEBUG_PANEL_WIDTH) / WINDOW_SCALE;
+      int mouseY = event.button.y / WINDOW_SCALE;
 
-  // SDLPlatform does not trigger lifecycle callbacks itself; the host
-  // (test harness or main runtime) should invoke app.onLoad when the
-  // VM is ready. SDLPlatform only delivers input/timer events.
+      touch_.pressed = false;
 
-  updateInputs();
+      // Invoke touch.onRelease callback if in display
+      if (isInCircularDisplay(mouseX, mouseY)) {
+        std::vector<Value> args = {Value::Int32(mouseX),
+                                   Value::Int32(mouseY)};
+        invokeCallback("touch.onRelease", args);
+      }
+    } else if (event.button.button == SDL_BUTTON_RIGHT) {
+      encoder_.pressed = false;
+
+      // Invoke encoder.onButton callback for release
+      std::vector<Value> args = {Value::Bool(false)};
+      invokeCallback("encoder.onButton", args);
+    }
+    break;
+
+  case SDL_MOUSEMOTION:
+    if (touch_.pressed) {
+      int mouseX = (event.motion.x - DEBUG_PANEL_WIDTH) / WINDOW_SCALE;
+      int mouseY = event.motion.y / WINDOW_SCALE;
+
+      if (isInCircularDisplay(mouseX, mouseY)) {
+        touch_.x = mouseX;
+        touch_.y = mouseY;
+        touch_.lastUpdate = std::chrono::steady_clock::now();
+
+        // Invoke touch.onDrag callback
+        std::vector<Value> args = {Value::Int32(mouseX),
+                                   Value::Int32(mouseY)};
+        invokeCallback("touch.onDrag", args);
+      }
+    }
+    break;
+  }
   return true;
 }
 
@@ -328,22 +425,131 @@ void SDLPlatform::present() {
   if (!initialized_)
     return;
 
-  // Note: We don't clear here - display_clear() does that explicitly
-  // This allows drawing commands to accumulate in the render buffer
+  // The display is the software framebuffer, uploaded only when it (or the
+  // encoder ring drawn over it) changed
+  bool changed = uploadFrame();
+  int windowWidth, windowHeight;
+  SDL_GetWindowSize(window_, &windowWidth, &windowHeight);
+  int consoleX = DEBUG_PANEL_WIDTH + DISPLAY_SCALED_WIDTH;
 
-  // Draw debug panel
-  renderDebugPanel();
+  if (overlayTargets_) {
+    changed = updateDebugPanel() || changed;
+    changed = updateConsoleArea() || changed;
+    if (!changed && !presentNeeded_)
+      return; // The window already shows all of this
+  }
+  presentNeeded_ = false;
 
-  // Draw circular mask for display
-  drawCircularMask();
+  SDL_SetRenderDrawColor(renderer_, 0, 0, 0, 255);
+  SDL_RenderClear(renderer_);
+  SDL_Rect displayRect = {DEBUG_PANEL_WIDTH, 0, DISPLAY_SCALED_WIDTH,
+                          DISPLAY_SCALED_HEIGHT};
+  SDL_RenderCopy(renderer_, frameTexture_, nullptr, &displayRect);
+
+  if (overlayTargets_) {
+    if (panelOverlay_.valid) {
+      SDL_Rect panelRect = {0, 0, panelOverlay_.width, panelOverlay_.height};
+      SDL_RenderCopy(renderer_, panelOverlay_.texture, nullptr, &panelRect);
+    }
+    if (consoleOverlay_.valid) {
+      SDL_Rect consoleRect = {consoleX, 0, consoleOverlay_.width,
+                              consoleOverlay_.height};
+      SDL_RenderCopy(renderer_, consoleOverlay_.texture, nullptr,
+                     &consoleRect);
+    }
+  } else {
+    // No render targets: draw the overlays straight into every frame
+    renderDebugPanel();
+    renderConsoleArea(consoleX, windowHeight);
+  }
+
+  SDL_RenderPresent(renderer_);
+}
+
+bool SDLPlatform::beginOverlay(Overlay &overlay, int width, int height) {
+  if (overlay.texture && (overlay.width != width || overlay.height != height)) {
+    SDL_DestroyTexture(overlay.texture);
+    overlay.texture = nullptr;
+  }
+  if (!overlay.texture) {
+    overlay.texture =
+        SDL_CreateTexture(renderer_, SDL_PIXELFORMAT_ARGB8888,
+                          SDL_TEXTUREACCESS_TARGET, width, height);
+    overlay.width = width;
+    overlay.height = height;
+    overlay.valid = false;
+  }
+  if (!overlay.texture || SDL_SetRenderTarget(renderer_, overlay.texture) != 0)
+    return false;
+  SDL_SetRenderDrawColor(renderer_, 0, 0, 0, 255);
+  SDL_RenderClear(renderer_);
+  overlay.valid = true;
+  return true;
+}
 
-  // Draw encoder position indicator
-  drawEncoderIndicator();
+void SDLPlatform::endOverlay() { SDL_SetRenderTarget(renderer_, nullptr); }
 
-  // Draw console area
-  renderConsoleArea();
+void SDLPlatform::destroyOverlays() {
+  for (Overlay *overlay : {&panelOverlay_, &consoleOverlay_}) {
+    if (overlay->texture)
+      SDL_DestroyTexture(overlay->texture);
+    *overlay = Overlay();
+  }
+}
 
-  SDL_RenderPresent(renderer_);
+bool SDLPlatform::updateDebugPanel() {
+  if (!vm_)
+    return false;
+
+  // Inputs and errors show at once; counters that tick with every
+  // instruction or millisecond are refreshed a few times a second
+  std::string inputs = std::to_string(vm_->isRunning()) + '|' +
+                       (vm_->hasError() ? vm_->getError() : std::string()) +
+                       '|' + std::to_string(encoder_.position) + '|' +
+                       std::to_string(encoder_.pressed) + '|' +
+                       std::to_string(touch_.pressed) + '|' +
+                       std::to_string(touch_.x) + ',' +
+                       std::to_string(touch_.y) + '|' + rfid_.cardUID +
+                       std::to_string(rfid_.cardPresent) + '|' +
+                       std::to_string(power_.batteryLevel) +
+                       std::to_string(power_.charging) + '|' +
+                       std::to_string(buzzer_.isPlaying) + ',' +
+                       std::to_string(buzzer_.frequency);
+  std::string counters = std::to_string(vm_->getPC()) + '|' +
+                         std::to_string(vm_->getStackSize()) + '|' +
+                         std::to_string(vm_->getCallStackDepth()) + '|' +
+                         std::to_string(vm_->getHeapUsage());
+  uint32_t now = system_getTime();
+  bool ticked = counters != panelCounters_ || now / 1000 != panelDrawnAt_ / 1000;
+  bool stale = !panelOverlay_.valid || inputs != panelInputs_ ||
+               (ticked && now - panelDrawnAt_ >= PANEL_REFRESH_MS);
+  if (!stale)
+    return false;
+
+  if (!beginOverlay(panelOverlay_, DEBUG_PANEL_WIDTH, WINDOW_HEIGHT))
+    return false;
+  renderDebugPanel();
+  endOverlay();
+  panelInputs_ = inputs;
+  panelCounters_ = counters;
+  panelDrawnAt_ = now;
+  return true;
+}
+
+bool SDLPlatform::updateConsoleArea() {
+  int windowWidth, windowHeight;
+  SDL_GetWindowSize(window_, &windowWidth, &windowHeight);
+  uint32_t revision = consoleLog_.revision + outputLog_.revision;
+  if (consoleOverlay_.valid && revision == consoleDrawnRevision_ &&
+      consoleOverlay_.height == windowHeight)
+    return false;
+
+  if (!beginOverlay(consoleOverlay_, CONSOLE_WIDTH, windowHeight))
+    return false;
+  renderConsoleArea(0, windowHeight);
+  endOverlay();
+  consoleDrawnRevision_ = revision;
+  return true;
 }
 
 void SDLPlatform::display_clear(uint32_t color) {
@@ -351,45 +557,22 @@ void SDLPlatform::display_clear(uint32_t color) {
     return;
 
   backgroundColor_ = color;
-  Color bgColor(color);
-
-  // Clear entire window with black
-  SDL_SetRenderDrawColor(renderer_, 0, 0, 0, 255);
-  SDL_RenderClear(renderer_);
-
-  // Fill circular display area with specified color
-  SDL_SetRenderDrawColor(renderer_, bgColor.r, bgColor.g, bgColor.b, bgColor.a);
-
-  for (int y = 0; y < DISPLAY_HEIGHT; y++) {
-    for (int x = 0; x < DISPLAY_WIDTH; x++) {
-      if (isInCircularDisplay(x, y)) {
-        SDL_Rect rect = {DEBUG_PANEL_WIDTH + x * WINDOW_SCALE, y * WINDOW_SCALE,
-                         WINDOW_SCALE, WINDOW_SCALE};
-        SDL_RenderFillRect(renderer_, &rect);
-      }
-    }
-  }
+  frame_.clear(static_cast<uint16_t>(color));
 }
 
 void SDLPlatform::display_drawText(int x, int y, const std::string &text,
                                    uint32_t color, int size) {
-  if (!initialized_ || !font_)
+  if (!initialized_)
     return;
 
-  renderText(DEBUG_PANEL_WIDTH + x * WINDOW_SCALE, y * WINDOW_SCALE, text, Color(color), size);
+  frame_.drawText(x, y, text, static_cast<uint16_t>(color), size);
 }
 
 void SDLPlatform::display_drawPixel(int x, int y, uint32_t color) {
-  if (!initialized_ || !isInCircularDisplay(x, y))
+  if (!initialized_)
     return;
 
-  Color pixelColor(color);
-  SDL_SetRenderDrawColor(renderer_, pixelColor.r, pixelColor.g, pixelColor.b,
-                         pixelColor.a);
-
-  SDL_Rect rect = {DEBUG_PANEL_WIDTH + x * WINDOW_SCALE, y * WINDOW_SCALE,
-                   WINDOW_SCALE, WINDOW_SCALE};
-  SDL_RenderFillRect(renderer_, &rect);
+  frame_.drawPixel(x, y, static_cast<uint16_t>(color));
 }
 
 void SDLPlatform::display_drawLine(int x1, int y1, int x2, int y2,
@@ -399,17 +582,7 @@ void SDLPlatform::display_drawLine(int x1, int y1, int x2, int y2,
     return;
   }
 
-  Color lineColor(color);
-  SDL_SetRenderDrawColor(renderer_, lineColor.r, lineColor.g, lineColor.b,
-                         lineColor.a);
-
-  // Scale coordinates and offset
-  x1 = DEBUG_PANEL_WIDTH + x1 * WINDOW_SCALE;
-  y1 = y1 * WINDOW_SCALE;
-  x2 = DEBUG_PANEL_WIDTH + x2 * WINDOW_SCALE;
-  y2 = y2 * WINDOW_SCALE;
-
-  SDL_RenderDrawLine(renderer_, x1, y1, x2, y2);
+  frame_.drawLine(x1, y1, x2, y2, static_cast<uint16_t>(color));
 }
 
 void SDLPlatform::display_drawRect(int x, int y, int w, int h, uint32_t color,
@@ -417,18 +590,7 @@ void SDLPlatform::display_drawRect(int x, int y, int w, int h, uint32_t color,
   if (!initialized_)
     return;
 
-  Color rectColor(color);
-  SDL_SetRenderDrawColor(renderer_, rectColor.r, rectColor.g, rectColor.b,
-                         rectColor.a);
-
-  SDL_Rect rect = {DEBUG_PANEL_WIDTH + x * WINDOW_SCALE, y * WINDOW_SCALE,
-                   w * WINDOW_SCALE, h * WINDOW_SCALE};
-
-  if (filled) {
-    SDL_RenderFillRect(renderer_, &rect);
-  } else {
-    SDL_RenderDrawRect(renderer_, &rect);
-  }
+  frame_.drawRect(x, y, w, h, static_cast<uint16_t>(color), filled);
 }
 
 void SDLPlatform::display_drawCircle(int x, int y, int radius, uint32_t color,
@@ -436,76 +598,15 @@ void SDLPlatform::display_drawCircle(int x, int y, int radius, uint32_t color,
   if (!initialized_)
     return;
 
-  Color circleColor(color);
-  SDL_SetRenderDrawColor(renderer_, circleColor.r, circleColor.g, circleColor.b,
-                         circleColor.a);
-
-  if (filled) {
-    // Filled circle using midpoint circle algorithm
-    int cx = 0;
-    int cy = radius;
-    int d = 1 - radius;
-
-    auto drawHorizontalLine = [&](int x1, int x2, int scanY) {
-      for (int i = x1; i <= x2; i++) {
-        display_drawPixel(i, scanY, color);
-      }
-    };
-
-    // Draw initial horizontal lines
-    drawHorizontalLine(x - cy, x + cy, y); // Center horizontal line
-
-    while (cx < cy) {
-      if (d < 0) {
-        d += 2 * cx + 3;
-      } else {
-        d += 2 * (cx - cy) + 5;
-        cy--;
-      }
-      cx++;
-
-      // Draw horizontal lines at each y level (4-way symmetry)
-      drawHorizontalLine(x - cx, x + cx, y + cy); // Bottom
-      drawHorizontalLine(x - cx, x + cx, y - cy); // Top
-      drawHorizontalLine(x - cy, x + cy, y + cx); // Lower middle
-      drawHorizontalLine(x - cy, x + cy, y - cx); // Upper middle
-    }
-  } else {
-    // Outline circle using Bresenham's circle algorithm
-    int cx = 0;
-    int cy = radius;
-    int d = 3 - 2 * radius;
-
-    auto drawCirclePoints = [&](int cx, int cy) {
-      display_drawPixel(x + cx, y + cy, color);
-      display_drawPixel(x - cx, y + cy, color);
-      display_drawPixel(x + cx, y - cy, color);
-      display_drawPixel(x - cx, y - cy, color);
-      display_drawPixel(x + cy, y + cx, color);
-      display_drawPixel(x - cy, y + cx, color);
-      display_drawPixel(x + cy, y - cx, color);
-      display_drawPixel(x - cy, y - cx, color);
-    };
-
-    drawCirclePoints(cx, cy);
-
-    while (cy >= cx) {
-      cx++;
-      if (d > 0) {
-        cy--;
-        d = d + 4 * (cx - cy) + 10;
-      } else {
-        d = d + 4 * cx + 6;
-      }
-      drawCirclePoints(cx, cy);
-    }
-  }
+  frame_.drawCircle(x, y, radius, static_cast<uint16_t>(color), filled);
 }
 
 void SDLPlatform::display_setBrightness(int brightness) {
   brightness_ = static_cast<uint8_t>(std::max(0, std::min(255, brightness)));
-  // In a real implementation, this would affect the backlight
-  // Here we could modify the alpha channel of all rendering
+  // Dim the uploaded frame the way the backlight would
+  if (frameTexture_)
+    SDL_SetTextureColorMod(frameTexture_, brightness_, brightness_, brightness_);
+  presentNeeded_ = true;
 }
 
 int SDLPlatform::display_getWidth() { return DISPLAY_WIDTH; }
@@ -588,9 +689,17 @@ int SDLPlatform::file_open(const std::string &path, const std::string &mode) {
   int handle = nextFileHandle_++;
   FileHandle &fh = fileHandles_[handle];
 
-  // Open the file
-  fh.stream.open(fullPath, openMode);
-  if (!fh.stream.is_open()) {
+  // Open the file; reads go through a read-ahead buffer, or a mapping for
+  // large files
+  bool opened;
+  if (openMode == std::ios_base::in) {
+    fh.input.reset(new HostFile());
+    opened = fh.input->open(fullPath);
+  } else {
+    fh.stream.open(fullPath, openMode);
+    opened = fh.stream.is_open();
+  }
+  if (!opened) {
     console_error("Failed to open file: " + fullPath);
     fileHandles_.erase(handle);
     return -1;
@@ -612,21 +721,51 @@ std::string SDLPlatform::file_read(int handle, int size) {
   }
 
   FileHandle &fh = it->second;
-  if (fh.mode != "r" && fh.mode != "read") {
+  if (!fh.input) {
     console_error("File not opened for reading");
     return "";
   }
 
-  std::vector<char> buffer(size);
-  fh.stream.read(buffer.data(), size);
-
-  std::streamsize bytesRead = fh.stream.gcount();
-  std::string result(buffer.data(), bytesRead);
+  std::string result(size > 0 ? size : 0, '\0');
+  result.resize(fh.input->reader().read(&result[0], result.size()));
 
-  console_log("File read: " + std::to_string(bytesRead) + " bytes");
+  console_log("File read: " + std::to_string(result.size()) + " bytes");
   return result;
 }
 
+FileReader *SDLPlatform::inputReader(int handle) {
+  auto it = fileHandles_.find(handle);
+  if (it == fileHandles_.end() || !it->second.input) {
+    console_error("Invalid file handle for reading: " + std::to_string(handle));
+    return nullptr;
+  }
+  return &it->second.input->reader();
+}
+
+bool SDLPlatform::file_readLine(int handle, std::string &line) {
+  FileReader *reader = inputReader(handle);
+  return reader != nullptr && reader->readLine(line);
+}
+
+int SDLPlatform::file_readBytes(int handle, char *dest, int size) {
+  FileReader *reader = inputReader(handle);
+  if (reader == nullptr) {
+    return -1;
+  }
+  return static_cast<int>(reader->read(dest, size > 0 ? size : 0));
+}
+
+bool SDLPlatform::file_seek(int handle, int position) {
+  FileReader *reader = inputReader(handle);
+  return reader != nullptr && position >= 0 &&
+         reader->seek(static_cast<uint32_t>(position));
+}
+
+int SDLPlatform::file_tell(int handle) {
+  FileReader *reader = inputReader(handle);
+  return reader != nullptr ? static_cast<int>(reader->tell()) : -1;
+}
+
 int SDLPlatform::file_write(int handle, const std::string &data) {
   auto it = fileHandles_.find(handle);
   if (it == fileHandles_.end() || !it->second.isOpen) {
@@ -664,6 +803,7 @@ void SDLPlatform::file_close(int handle) {
   FileHandle &fh = it->second;
   if (fh.isOpen) {
     fh.stream.close();
+    fh.input.reset();
     fh.isOpen = false;
     console_log("File closed: " + fh.path);
   }
@@ -787,127 +927,6 @@ void SDLPlatform::buzzer_beep(int frequency, int duration) {
 
 void SDLPlatform::buzzer_stop() { buzzer_.isPlaying = false; }
 
-// === Timer Operations (Stubs) ===
-
-int SDLPlatform::timer_setTimeout(int ms) {
-  // TODO: Implement timer system
-  console_log("setTimeout: " + std::to_string(ms) + "ms");
-  console_warn("NOT IMPLEMENTED: os.timer.setTimeout - timer system missing");
-  return -1; // Not implemented
-}
-
-// New: register interval callback
-int SDLPlatform::timer_setInterval(const Value &callback, int ms) {
-  // console_log("[DEBUG] setInterval: " + std::to_string(ms) + "ms");
-
-  if (!callback.isFunction()) {
-    console_warn("timer_setInterval called with non-function callback");
-    return -1;
-  }
-
-  // console_log("[DEBUG] Callback is function: " + callback.toString());
-
-  TimerEntry entry;
-  entry.id = nextTimerId_++;
-  entry.callback = callback; // copy Value
-  entry.intervalMs = std::max(1, ms);
-  entry.nextFire = std::chrono::steady_clock::now() +
-                   std::chrono::milliseconds(entry.intervalMs);
-  entry.repeating = true;
-
-  timers_[entry.id] = entry;
-
-  // console_log("[DEBUG] Registered timer id=" + std::to_string(entry.id) + "
-  // with " + std::to_string(timers_.size()) + " total timers");
-  return entry.id;
-}
-
-void SDLPlatform::timer_clearTimeout(int id) {
-  console_log("clearTimeout: " + std::to_string(id));
-  console_warn("NOT IMPLEMENTED: os.timer.clearTimeout - timer system missing");
-  // Not implemented
-}
-
-void SDLPlatform::timer_clearInterval(int id) {
-  console_log("clearInterval: " + std::to_string(id));
-  auto it = timers_.find(id);
-  if (it != timers_.end()) {
-    timers_.erase(it);
-    console_log("Cleared timer id=" + std::to_string(id));
-  } else {
-    console_warn("clearInterval: timer id not found: " + std::to_string(id));
-  }
-}
-
-void SDLPlatform::processTimers() {
-  if (timers_.empty()) {
-    // console_log("[DEBUG] No active timers to process");
-    return;
-  }
-
-  // console_log("[DEBUG] Processing " + std::to_string(timers_.size()) + "
-  // timers");
-
-  auto now = std::chrono::steady_clock::now();
-  std::vector<int> firedIds;
-
-  for (auto &kv : timers_) {
-    TimerEntry &entry = kv.second;
-    // console_log(std::string("[DEBUG] Timer ") + std::to_string(entry.id) + "
-    // check: now >= nextFire = " +
-    //            (now >= entry.nextFire ? "true" : "false"));
-
-    if (now >= entry.nextFire) {
-      // console_log("[DEBUG] Timer " + std::to_string(entry.id) + " firing!");
-
-      // Fire the callback synchronously via VM
-      // Build empty args vector (timers don't pass args by default)
-      std::vector<Value> args;
-
-      // Use PlatformInterface invocation which will call vm_->invokeFunction
-      bool attempted = false;
-      bool success = false;
-
-      // console_log(std::string("[DEBUG] VM state: vm_=") + (vm_ ? "valid" :
-      // "null") +
-      //            " isRunning=" + (vm_ && vm_->isRunning() ? "true" : "false")
-      //            + " hasError=" + (vm_ && vm_->hasError() ? "true" :
-      //            "false"));
-
-      if (vm_ != nullptr && vm_->isRunning() && !vm_->hasError()) {
-        attempted = true;
-        // console_log("[DEBUG] Attempting to invoke timer callback");
-        // Directly invoke the function value
-        success = vm_->invokeFunction(entry.callback, args);
-        // console_log(std::string("[DEBUG] Callback invocation result: ") +
-        // (success ? "success" : "failed"));
-
-        // If the VM entered an error state during invocation, stop scheduling
-        // further callbacks
-        if (vm_->hasError() && !vm_->isRunning()) {
-          console_warn(
-              "VM entered error state during timer callback; clearing timers");
-          // Clear all timers to avoid further invocations
-          timers_.clear();
-          break;
-        }
-      } else {
-        // console_log("[DEBUG] Skipping timer callback - VM not ready");
-      }
-
-      // Only warn if we attempted invocation and it failed. If we didn't
-      // attempt because the VM isn't running, avoid spamming the log.
-      if (attempted && !success) {
-        console_warn("Timer callback id=" + std::to_string(entry.id) +
-                     " failed to invoke");
-      }
-
-      // Schedule next fire
-      entry.nextFire = now + std::chrono::milliseconds(entry.intervalMs);
-    }
-  }
-}
-
 // === Memory Operations (Stubs) ===
 
 int SDLPlatform::memory_getAvailable() {
@@ -960,32 +979,64 @@ void SDLPlatform::system_setRTC(uint32_t timestamp) {
 
 // === Console Operations ===
 
+bool SDLPlatform::deferConsole(void (SDLPlatform::*fn)(const std::string &),
+                               const std::string &msg) {
+  if (std::this_thread::get_id() == uiThread_) {
+    return false;
+  }
+  std::lock_guard<std::mutex> guard(deferredMutex_);
+  deferredConsole_.push_back([this, fn, msg]() { (this->*fn)(msg); });
+  return true;
+}
+
+void SDLPlatform::flushDeferredConsole() {
+  std::vector<std::function<void()>> pending;
+  {
+    std::lock_guard<std::mutex> guard(deferredMutex_);
+    pending.swap(deferredConsole_);
+  }
+  for (auto &call : pending) {
+    call();
+  }
+}
+
 void SDLPlatform::console_print(const std::string &msg) {
+  if (deferConsole(&SDLPlatform::console_print, msg))
+    return;
   std::cout << msg << std::flush;
   outputLog_.addText(msg);
 }
 
 void SDLPlatform::console_println(const std::string &msg) {
+  if (deferConsole(&SDLPlatform::console_println, msg))
+    return;
   std::cout << msg << std::endl;
   outputLog_.addText(msg + "\n");
 }
 
 void SDLPlatform::console_log(const std::string &msg) {
+  if (deferConsole(&SDLPlatform::console_log, msg))
+    return;
   std::cout << "[INFO] " << msg << std::endl;
   consoleLog_.addText("[INFO] " + msg + "\n");
   addDebugMessage(msg);
 }
 
 void SDLPlatform::console_warn(const std::string &msg) {
+  if (deferConsole(&SDLPlatform::console_warn, msg))
+    return;
   std::cout << "[WARN] " << msg << std::endl;
   outputLog_.addText("[WARN] " + msg + "\n");
 }
 
 void SDLPlatform::console_error(const std::string &msg) {
+  if (deferConsole(&SDLPlatform::console_error, msg))
+    return;
   std::cerr << "[ERROR] " << msg << std::endl;
   outputLog_.addText("[ERROR] " + msg + "\n");
 }
 
+
 void SDLPlatform::console_clear() { outputLog_.clear(); }
 
 // Private helper methods
@@ -996,84 +1047,80 @@ bool SDLPlatform::isInCircularDisplay(int x, int y) const {
   return (dx * dx + dy * dy) <= (DISPLAY_RADIUS * DISPLAY_RADIUS);
 }
 
-void SDLPlatform::drawCircularMask() {
-  if (!initialized_)
-    return;
+bool SDLPlatform::uploadFrame() {
+  if (!frameTexture_)
+    return false;
+  if (!frame_.isChanged() && encoder_.position == shownEncoderPosition_)
+    return false;
 
-  // Draw border around circular display (gray ring at the edge)
-  SDL_SetRenderDrawColor(renderer_, 64, 64, 64, 255);
+  void *pixels = nullptr;
+  int pitch = 0;
+  if (SDL_LockTexture(frameTexture_, nullptr, &pixels, &pitch) != 0)
+    return false;
+  uint16_t *out = static_cast<uint16_t *>(pixels);
+  int stride = pitch / static_cast<int>(sizeof(uint16_t));
 
+  // Only the round panel is visible
+  frame_.copyCircular(out, stride, DISPLAY_RADIUS, 0x0000);
+  drawCircularMask(out, stride);
+  drawEncoderIndicator(out, stride);
+
+  SDL_UnlockTexture(frameTexture_);
+  frame_.clearChanged();
+  shownEncoderPosition_ = encoder_.position;
+  return true;
+}
+
+void SDLPlatform::drawCircularMask(uint16_t *pixels, int stride) {
   // Border: 2-pixel ring just inside the display radius
   // This keeps it fully visible within the display bounds
   int outerRadius = DISPLAY_RADIUS;     // 120 - edge of circle
   int innerRadius = DISPLAY_RADIUS - 2; // 118 - 2 pixels inward
 
-  for (int y = 0; y < DISPLAY_HEIGHT; y++) {
-    for (int x = 0; x < DISPLAY_WIDTH; x++) {
-      int dx = x - CENTER_X;
-      int dy = y - CENTER_Y;
-      int distSq = dx * dx + dy * dy;
-
-      // Draw pixels in the border ring (between inner and outer radius)
-      if (distSq >= (innerRadius * innerRadius) &&
-          distSq <= (outerRadius * outerRadius)) {
-
-        SDL_Rect rect = {DEBUG_PANEL_WIDTH + x * WINDOW_SCALE, y * WINDOW_SCALE,
-                         WINDOW_SCALE, WINDOW_SCALE};
-        SDL_RenderFillRect(renderer_, &rect);
+  if (ringPixels_.empty()) {
+    for (int y = 0; y < DISPLAY_HEIGHT; y++) {
+      for (int x = 0; x < DISPLAY_WIDTH; x++) {
+        int dx = x - CENTER_X;
+        int dy = y - CENTER_Y;
+        int distSq = dx * dx + dy * dy;
+
+        // Pixels in the border ring (between inner and outer radius)
+        if (distSq >= (innerRadius * innerRadius) &&
+            distSq <= (outerRadius * outerRadius)) {
+          ringPixels_.push_back({static_cast<int16_t>(x), static_cast<int16_t>(y),
+                                 atan2f((float)dy, (float)dx)});
+        }
       }
     }
   }
-}
 
-void SDLPlatform::drawEncoderIndicator() {
-  if (!initialized_)
-    return;
+  // Gray ring at the edge (RGB565 of 64, 64, 64)
+  for (const RingPixel &ring : ringPixels_) {
+    pixels[ring.y * stride + ring.x] = 0x4208;
+  }
+}
 
+void SDLPlatform::drawEncoderIndicator(uint16_t *pixels, int stride) {
   // Calculate angle from encoder position
   // M5 Dial has 64 pulses per revolution, so normalize to 0-360 degrees
   const int PULSES_PER_REV = 64;
   float angle =
       (encoder_.position % PULSES_PER_REV) * (2.0f * 3.14159f / PULSES_PER_REV);
 
-  // Draw a small arc section of the border in orange to indicate position
-  // Orange color (RGB565: 0xFD20 -> RGB888: 255, 165, 0)
-  SDL_SetRenderDrawColor(renderer_, 255, 165, 0, 255);
-
-  // Use same radius range as the border
-  int outerRadius = DISPLAY_RADIUS;     // 120 - edge of circle
-  int innerRadius = DISPLAY_RADIUS - 2; // 118 - 2 pixels inward
-
   // Draw a small arc (about 5 degrees on each side of the position)
   const float arcSpan = 0.08f; // radians (~5 degrees)
 
-  for (int y = 0; y < DISPLAY_HEIGHT; y++) {
-    for (int x = 0; x < DISPLAY_WIDTH; x++) {
-      int dx = x - CENTER_X;
-      int dy = y - CENTER_Y;
-      int distSq = dx * dx + dy * dy;
-
-      // Check if pixel is in the border ring
-      if (distSq >= (innerRadius * innerRadius) &&
-          distSq <= (outerRadius * outerRadius)) {
-
-        // Calculate angle of this pixel
-        float pixelAngle = atan2((float)dy, (float)dx);
-
-        // Normalize angle difference to -PI to PI range
-        float angleDiff = pixelAngle - angle;
-        while (angleDiff > 3.14159f)
-          angleDiff -= 2.0f * 3.14159f;
-        while (angleDiff < -3.14159f)
-          angleDiff += 2.0f * 3.14159f;
-
-        // Draw if within arc span
-        if (fabs(angleDiff) <= arcSpan) {
-          SDL_Rect rect = {DEBUG_PANEL_WIDTH + x * WINDOW_SCALE,
-                           y * WINDOW_SCALE, WINDOW_SCALE, WINDOW_SCALE};
-          SDL_RenderFillRect(renderer_, &rect);
-        }
-      }
+  for (const RingPixel &ring : ringPixels_) {
+    // Normalize angle difference to -PI to PI range
+    float angleDiff = ring.angle - angle;
+    while (angleDiff > 3.14159f)
+      angleDiff -= 2.0f * 3.14159f;
+    while (angleDiff < -3.14159f)
+      angleDiff += 2.0f * 3.14159f;
+
+    // Orange (RGB565 0xFD20) if within arc span
+    if (fabs(angleDiff) <= arcSpan) {
+      pixels[ring.y * stride + ring.x] = 0xFD20;
     }
   }
 }
@@ -1102,9 +1149,35 @@ void SDLPlatform::renderText(int x, int y, const std::string &text,
                              const Color &color, int size) {
   // Get font of appropriate size
   TTF_Font* textFont = getFontOfSize(size);
-  if (!textFont)
+  if (!textFont || text.empty())
+    return;
+
+  CachedText *cached = findCachedText(textFont, text, color);
+  if (cached && !cached->texture) {
+    // Second time this string is drawn: give it a texture of its own
+    SDL_Surface *surface =
+        TTF_RenderText_Solid(textFont, text.c_str(), color.toSDL());
+    if (surface) {
+      cached->texture = SDL_CreateTextureFromSurface(renderer_, surface);
+      cached->width = surface->w;
+      cached->height = surface->h;
+      SDL_FreeSurface(surface);
+    }
+  }
+  if (cached && cached->texture) {
+    // Use actual coordinates without scaling for console text
+    SDL_Rect destRect = {x, y, cached->width * size, cached->height * size};
+    SDL_RenderCopy(renderer_, cached->texture, nullptr, &destRect);
+    return;
+  }
+
+  const GlyphAtlas *atlas = getGlyphAtlas(textFont);
+  if (atlas) {
+    drawTextFromAtlas(*atlas, x, y, text, color, size);
     return;
+  }
 
+  // No atlas (texture creation failed): render the string directly
   SDL_Surface *surface =
       TTF_RenderText_Solid(textFont, text.c_str(), color.toSDL());
   if (!surface)
@@ -1116,7 +1189,6 @@ void SDLPlatform::renderText(int x, int y, const std::string &text,
     return;
   }
 
-  // Use actual coordinates without scaling for console text
   SDL_Rect destRect = {x, y, surface->w*size, surface->h*size};
 
   SDL_RenderCopy(renderer_, texture, nullptr, &destRect);
@@ -1125,6 +1197,163 @@ void SDLPlatform::renderText(int x, int y, const std::string &text,
   SDL_FreeSurface(surface);
 }
 
+SDLPlatform::GlyphAtlas *SDLPlatform::getGlyphAtlas(TTF_Font *font) {
+  auto it = glyphAtlases_.find(font);
+  if (it != glyphAtlases_.end())
+    return it->second.texture ? &it->second : nullptr;
+
+  // Built once per font; a failed build is remembered too
+  GlyphAtlas &atlas = glyphAtlases_[font];
+
+  // Render each glyph and lay the cells out in shelves
+  const SDL_Color white = {255, 255, 255, 255};
+  SDL_Surface *cells[GLYPH_COUNT] = {};
+  int shelfX = 0, shelfY = 0, shelfHeight = 0;
+  for (int i = 0; i < GLYPH_COUNT; i++) {
+    cells[i] = TTF_RenderGlyph_Solid(font, static_cast<Uint16>(GLYPH_FIRST + i), white);
+    int w = cells[i] ? cells[i]->w : 0;
+    int h = cells[i] ? cells[i]->h : 0;
+    if (shelfX + w > GLYPH_ATLAS_WIDTH) {
+      shelfX = 0;
+      shelfY += shelfHeight;
+      shelfHeight = 0;
+    }
+    atlas.glyphs[i] = {shelfX, shelfY, w, h};
+    shelfX += w;
+    shelfHeight = std::max(shelfHeight, h);
+  }
+  atlas.width = GLYPH_ATLAS_WIDTH;
+  atlas.height = std::max(1, shelfY + shelfHeight);
+
+  // Solid glyphs are 8-bit with index 0 as background: copy the set pixels
+  // as opaque white so the texture can be tinted with any colour
+  std::vector<uint32_t> pixels(static_cast<size_t>(atlas.width) * atlas.height, 0);
+  for (int i = 0; i < GLYPH_COUNT; i++) {
+    SDL_Surface *cell = cells[i];
+    if (!cell)
+      continue;
+    if (cell->format->format == SDL_PIXELFORMAT_INDEX8) {
+      const SDL_Rect &dest = atlas.glyphs[i];
+      for (int row = 0; row < cell->h; row++) {
+        const uint8_t *src = static_cast<const uint8_t *>(cell->pixels) + row * cell->pitch;
+        uint32_t *dst = &pixels[(dest.y + row) * atlas.width + dest.x];
+        for (int col = 0; col < cell->w; col++) {
+          if (src[col])
+            dst[col] = 0xFFFFFFFF;
+        }
+      }
+    }
+    SDL_FreeSurface(cell);
+  }
+
+  atlas.texture = SDL_CreateTexture(renderer_, SDL_PIXELFORMAT_ARGB8888,
+                                    SDL_TEXTUREACCESS_STATIC, atlas.width, atlas.height);
+  if (!atlas.texture) {
+    std::cerr << "Glyph atlas creation failed: " << SDL_GetError() << std::endl;
+    return nullptr;
+  }
+  SDL_UpdateTexture(atlas.texture, nullptr, pixels.data(), atlas.width * sizeof(uint32_t));
+  SDL_SetTextureBlendMode(atlas.texture, SDL_BLENDMODE_BLEND);
+  return &atlas;
+}
+
+void SDLPlatform::drawTextFromAtlas(const GlyphAtlas &atlas, int x, int y,
+                                    const std::string &text, const Color &color,
+                                    int size) {
+  // Characters outside the atlas show as '?'
+  auto cellOf = [&atlas](char c) -> const SDL_Rect & {
+    int index = static_cast<unsigned char>(c) - GLYPH_FIRST;
+    if (index < 0 || index >= GLYPH_COUNT)
+      index = '?' - GLYPH_FIRST;
+    return atlas.glyphs[index];
+  };
+
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+  // One textured quad per glyph, submitted as a single batch
+  textVertices_.clear();
+  textIndices_.clear();
+  const SDL_Color tint = color.toSDL();
+  float penX = static_cast<float>(x);
+  for (char c : text) {
+    const SDL_Rect &cell = cellOf(c);
+    float left = penX, top = static_cast<float>(y);
+    float right = left + cell.w * size, bottom = top + cell.h * size;
+    float u0 = static_cast<float>(cell.x) / atlas.width;
+    float v0 = static_cast<float>(cell.y) / atlas.height;
+    float u1 = static_cast<float>(cell.x + cell.w) / atlas.width;
+    float v1 = static_cast<float>(cell.y + cell.h) / atlas.height;
+    int base = static_cast<int>(textVertices_.size());
+    textVertices_.push_back({{left, top}, tint, {u0, v0}});
+    textVertices_.push_back({{right, top}, tint, {u1, v0}});
+    textVertices_.push_back({{right, bottom}, tint, {u1, v1}});
+    textVertices_.push_back({{left, bottom}, tint, {u0, v1}});
+    const int quad[] = {0, 1, 2, 0, 2, 3};
+    for (int corner : quad)
+      textIndices_.push_back(base + corner);
+    penX = right;
+  }
+  SDL_RenderGeometry(renderer_, atlas.texture, textVertices_.data(),
+                     static_cast<int>(textVertices_.size()), textIndices_.data(),
+                     static_cast<int>(textIndices_.size()));
+#else
+  // No geometry API: tint the atlas once and copy glyph by glyph
+  SDL_SetTextureColorMod(atlas.texture, color.r, color.g, color.b);
+  SDL_SetTextureAlphaMod(atlas.texture, color.a);
+  int penX = x;
+  for (char c : text) {
+    const SDL_Rect &cell = cellOf(c);
+    SDL_Rect destRect = {penX, y, cell.w * size, cell.h * size};
+    SDL_RenderCopy(renderer_, atlas.texture, &cell, &destRect);
+    penX += cell.w * size;
+  }
+#endif
+}
+
+SDLPlatform::CachedText *SDLPlatform::findCachedText(TTF_Font *font,
+                                                     const std::string &text,
+                                                     const Color &color) {
+  if (text.size() > TEXT_CACHE_MAX_LENGTH)
+    return nullptr;
+
+  // Key: font, colour, then the string
+  const uint8_t rgba[] = {color.r, color.g, color.b, color.a};
+  textKey_.assign(reinterpret_cast<const char *>(&font), sizeof(font));
+  textKey_.append(reinterpret_cast<const char *>(rgba), sizeof(rgba));
+  textKey_.append(text);
+
+  auto it = textCacheIndex_.find(textKey_);
+  if (it != textCacheIndex_.end()) {
+    textCache_.splice(textCache_.begin(), textCache_, it->second);
+    return &textCache_.front();
+  }
+
+  // First sighting: remember the key only
+  if (textCache_.size() >= TEXT_CACHE_SIZE) {
+    CachedText &oldest = textCache_.back();
+    if (oldest.texture)
+      SDL_DestroyTexture(oldest.texture);
+    textCacheIndex_.erase(oldest.key);
+    textCache_.pop_back();
+  }
+  textCache_.push_front({textKey_, nullptr, 0, 0});
+  textCacheIndex_[textKey_] = textCache_.begin();
+  return nullptr;
+}
+
+void SDLPlatform::clearTextCaches() {
+  for (CachedText &entry : textCache_) {
+    if (entry.texture)
+      SDL_DestroyTexture(entry.texture);
+  }
+  textCache_.clear();
+  textCacheIndex_.clear();
+  for (auto &atlasPair : glyphAtlases_) {
+    if (atlasPair.second.texture)
+      SDL_DestroyTexture(atlasPair.second.texture);
+  }
+  glyphAtlases_.clear();
+}
+
 void SDLPlatform::addDebugMessage(const std::string &msg) {
   debugMessages_.push_back(msg);
 
@@ -1228,31 +1457,30 @@ void SDLPlatform::display_drawImage(int x, int y,
   if (imageData.size() < 4 + (width * height * 2))
     return; // RGB565 = 2 bytes per pixel
 
-  // Draw the image pixel by pixel
-  for (int row = 0; row < height; row++) {
-    for (int col = 0; col < width; col++) {
-      if (!isInCircularDisplay(x + col, y + row))
-        continue;
-
-      int index = 4 + ((row * width + col) * 2);
-      uint16_t rgb565 = (imageData[index] << 8) | imageData[index + 1];
-
-      Color color(rgb565);
-      SDL_SetRenderDrawColor(renderer_, color.r, color.g, color.b, color.a);
-
-      // Scale coordinates for display
-      int scaledX = DEBUG_PANEL_WIDTH + (x + col) * WINDOW_SCALE;
-      int scaledY = (y + row) * WINDOW_SCALE;
-      SDL_Rect pixel = {scaledX, scaledY, WINDOW_SCALE, WINDOW_SCALE};
-      SDL_RenderFillRect(renderer_, &pixel);
-    }
-  }
+  frame_.drawImage(x, y, imageData);
 
   console_log("display_drawImage: drew " + std::to_string(width) + "x" +
               std::to_string(height) + " image at (" + std::to_string(x) + "," +
               std::to_string(y) + ")");
 }
 
+void SDLPlatform::display_drawBitmap(
+    int x, int y, const std::shared_ptr<const Image> &image, int sx,
+    int sy, int w, int h, int32_t transparent) {
+  if (!initialized_)
+    return;
+
+  frame_.pushImage(x, y, w, h, image->pixels.data() + sy * image->width + sx,
+                   transparent, image->width);
+}
+
+bool SDLPlatform::display_setClip(int x, int y, int w, int h) {
+  frame_.setClip(Rect(x, y, w, h));
+  return true;
+}
+
+void SDLPlatform::display_clearClip() { frame_.clearClip(); }
+
 // === System Extended Operations ===
 
 void SDLPlatform::system_yield() {
@@ -1494,6 +1722,69 @@ std::string SDLPlatform::wifi_scan() {
 
 // === HTTP Operations ===
 
+#ifndef _WIN32
+// Body of the answer, like the WinHTTP path; transport failures as a JSON error.
+// GETs go through the response cache.
+std::string SDLPlatform::httpFetch(const std::string &method,
+                                   const std::string &url,
+                                   const std::string &data) {
+  std::string body;
+  std::string error;
+  bool ok;
+  if (method == "GET") {
+    HttpCache::Response response;
+    HttpCache::Source source = HttpCache::Source::NETWORK;
+    ok = httpCache_->get(
+        url,
+        [this, &url](const HttpCache::Headers &headers,
+                     HttpCache::Response &fetched, std::string &fetchError) {
+          HttpResponse head;
+          if (!http_->fetch("GET", url, "", head, fetched.body, fetchError,
+                            headers)) {
+            return false;
+          }
+          fetched.status = head.status;
+          fetched.etag = head.header("etag");
+          fetched.lastModified = head.header("last-modified");
+          fetched.cacheControl = head.header("cache-control");
+          return true;
+        },
+        response, error, &source);
+    if (ok) {
+      HttpCache::Stats stats = httpCache_->getStats();
+      const char *from = source == HttpCache::Source::CACHE ? "cache"
+                         : source == HttpCache::Source::REVALIDATED
+                             ? "cache, revalidated"
+                             : "network";
+      console_log("HTTP GET completed: " + std::to_string(response.status) +
+                  ", " + std::to_string(response.body.length()) +
+                  " bytes from " + from + " (cache: " +
+                  std::to_string(stats.hits) + " hits, " +
+                  std::to_string(stats.revalidated) + " revalidated, " +
+                  std::to_string(stats.misses) + " misses, " +
+                  std::to_string(stats.bytesSaved) + " bytes saved)");
+      body = std::move(response.body);
+    }
+  } else {
+    HttpResponse response;
+    ok = http_->fetch(method, url, data, response, body, error);
+    if (ok) {
+      console_log("HTTP " + method + " completed: " +
+                  std::to_string(response.status) + ", " +
+                  std::to_string(body.length()) + " bytes received");
+    }
+  }
+  if (!ok) {
+    console_error("HTTP " + method + " error: " + error);
+    std::string message = "{\"status\":\"error\",\"message\":";
+    json::appendQuoted(error, message);
+    message += "}";
+    return message;
+  }
+  return body;
+}
+#endif
+
 std::string SDLPlatform::http_get(const std::string &url) {
   console_log("http_get: url=" + url);
 
@@ -1523,9 +1814,7 @@ std::string SDLPlatform::http_get(const std::string &url) {
            "\"}";
   }
 #else
-  console_warn("HTTP GET not supported on this platform");
-  return "{\"status\":\"error\",\"message\":\"HTTP not supported on this "
-         "platform\"}";
+  return httpFetch("GET", url, "");
 #endif
 }
 
@@ -1560,9 +1849,7 @@ std::string SDLPlatform::http_post(const std::string &url,
            "\"}";
   }
 #else
-  console_warn("HTTP POST not supported on this platform");
-  return "{\"status\":\"error\",\"message\":\"HTTP not supported on this "
-         "platform\"}";
+  return httpFetch("POST", url, data);
 #endif
 }
 
@@ -1575,6 +1862,18 @@ std::string SDLPlatform::http_download(const std::string &url,
     return "{\"status\":\"error\",\"message\":\"WiFi not connected\"}";
   }
 
+  // The body streams into <file>.part under the simulated root
+  std::string fullPath = fileSystemRoot_ + filepath;
+  std::error_code ec;
+  std::filesystem::path parent = std::filesystem::path(fullPath).parent_path();
+  if (!parent.empty()) {
+    std::filesystem::create_directories(parent, ec);
+  }
+  DownloadWriter::ProgressHandler progress =
+      [this, url](uint32_t received, int64_t total) {
+        http_reportProgress(url, received, total);
+      };
+
 // Use Windows HTTP API for real HTTP download
 #ifdef _WIN32
   try {
@@ -1585,34 +1884,43 @@ std::string SDLPlatform::http_download(const std::string &url,
     }
 
     // Download file using HTTP GET and save to disk
-    std::string downloadResult = executeHTTPDownload(host, path, filepath);
-    return downloadResult;
+    return executeHTTPDownload(host, path, fullPath, filepath, progress);
 
   } catch (const std::exception &e) {
     console_error("HTTP DOWNLOAD error: " + std::string(e.what()));
-    return "{\"status\":\"error\",\"message\":\"" + std::string(e.what()) +
-           "\"}";
+    return DownloadWriter::errorReport(e.what());
   }
 #else
-  console_warn("HTTP DOWNLOAD not supported on this platform");
-  return "{\"status\":\"error\",\"message\":\"HTTP not supported on this "
-         "platform\"}";
+  std::string result = http_->download(url, fullPath, filepath, progress);
+  console_log("HTTP download: " + result);
+  return result;
 #endif
 }
 
-// === IPC Operations ===
-
-bool SDLPlatform::ipc_send(const std::string &appId,
-                           const std::string &message) {
-  // TODO: Implement IPC simulation
-  console_log("ipc_send: to=" + appId + " msg=" + message);
-  console_warn("NOT IMPLEMENTED: os.ipc.send - IPC simulation missing");
-  return false; // Not implemented
-}
-
-void SDLPlatform::ipc_broadcast(const std::string &message) {
-  console_log("ipc_broadcast: " + message);
-  console_warn("NOT IMPLEMENTED: os.ipc.broadcast - IPC simulation missing");
+AsyncToken SDLPlatform::async_begin(NativeFunctionID id,
+                                    const std::vector<std::string> &args) {
+  // Only HTTP goes to a worker; the connectivity check stays on this thread
+  // so a failed request reports synchronously as before
+  if (!wifiConnected_) {
+    return NO_ASYNC;
+  }
+  switch (id) {
+  case NativeFunctionID::HTTP_GET: {
+    std::string url = args[0];
+    return startAsyncWorker([this, url]() { return http_get(url); });
+  }
+  case NativeFunctionID::HTTP_POST: {
+    std::string url = args[0], data = args[1];
+    return startAsyncWorker([this, url, data]() { return http_post(url, data); });
+  }
+  case NativeFunctionID::HTTP_DOWNLOAD: {
+    std::string url = args[0], filepath = args[1];
+    return startAsyncWorker(
+        [this, url, filepath]() { return http_download(url, filepath); });
+  }
+  default:
+    return NO_ASYNC;
+  }
 }
 
 // Attempt to locate a source file for a given bytecode path
@@ -1930,19 +2238,14 @@ void SDLPlatform::renderDebugPanel() {
   renderText(10, yPos, "ESC: Exit", Color(0xCCCCCCFF), 1);
 }
 
-void SDLPlatform::renderConsoleArea() {
+void SDLPlatform::renderConsoleArea(int consoleX, int consoleHeight) {
   if (!initialized_)
     return;
 
-  // Get actual current window size
-  int windowWidth, windowHeight;
-  SDL_GetWindowSize(window_, &windowWidth, &windowHeight);
-
-  // Console area starts to the right of the debug panel and display
-  int consoleX = DEBUG_PANEL_WIDTH + DISPLAY_SCALED_WIDTH;
+  // Console area starts to the right of the debug panel and display (or at
+  // the left edge of its own overlay texture)
   int consoleY = 0;
   int consoleWidth = CONSOLE_WIDTH;
-  int consoleHeight = windowHeight;
 
   // Fill console background
   SDL_SetRenderDrawColor(renderer_, 30, 30, 30, 255); // Dark gray
@@ -2172,157 +2475,171 @@ std::string SDLPlatform::executeHTTPRequest(const std::string &method,
 #endif
 }
 
-std::string SDLPlatform::executeHTTPDownload(const std::string &host,
-                                             const std::string &path,
-                                             const std::string &filepath) {
+std::string SDLPlatform::executeHTTPDownload(
+    const std::string &host, const std::string &path,
+    const std::string &fullPath, const std::string &filepath,
+    DownloadWriter::ProgressHandler progress) {
 #ifdef _WIN32
-  try {
-    // Parse host and port
-    std::string hostname = host;
-    int port = 80; // default HTTP port
-
-    size_t colonPos = host.find(':');
-    if (colonPos != std::string::npos) {
-      hostname = host.substr(0, colonPos);
-      std::string portStr = host.substr(colonPos + 1);
-      port = std::stoi(portStr);
+  // Handles close however the download ends
+  struct Handles {
+    HINTERNET session = NULL, connect = NULL, request = NULL;
+    ~Handles() {
+      if (request)
+        WinHttpCloseHandle(request);
+      if (connect)
+        WinHttpCloseHandle(connect);
+      if (session)
+        WinHttpCloseHandle(session);
     }
-
-    console_log("HTTP download connecting to host: " + hostname +
-                " port: " + std::to_string(port));
-
-    // Convert strings to wide strings for Windows API
-    std::wstring_convert<std::codecvt_utf8<wchar_t>> converter;
-    std::wstring wHost = converter.from_bytes(hostname);
-    std::wstring wPath = converter.from_bytes(path);
-
-    // Initialize WinHTTP
-    HINTERNET hSession = WinHttpOpen(
-        L"dialOS HTTP Client/1.0", WINHTTP_ACCESS_TYPE_DEFAULT_PROXY,
-        WINHTTP_NO_PROXY_NAME, WINHTTP_NO_PROXY_BYPASS, 0);
-
-    if (!hSession) {
-      throw std::runtime_error("Failed to initialize WinHTTP session");
-    }
-
-    // Connect to the server with correct port
-    HINTERNET hConnect = WinHttpConnect(hSession, wHost.c_str(),
-                                        static_cast<INTERNET_PORT>(port), 0);
-
-    if (!hConnect) {
-      WinHttpCloseHandle(hSession);
-      throw std::runtime_error("Failed to connect to host: " + hostname + ":" +
-                               std::to_string(port));
+  } h;
+
+  // Parse host and port
+  std::string hostname = host;
+  int port = 80; // default HTTP port
+
+  size_t colonPos = host.find(':');
+  if (colonPos != std::string::npos) {
+    hostname = host.substr(0, colonPos);
+    std::string portStr = host.substr(colonPos + 1);
+    port = std::stoi(portStr);
+  }
+
+  console_log("HTTP download connecting to host: " + hostname +
+              " port: " + std::to_string(port));
+
+  // Convert strings to wide strings for Windows API
+  std::wstring_convert<std::codecvt_utf8<wchar_t>> converter;
+  std::wstring wHost = converter.from_bytes(hostname);
+  std::wstring wPath = converter.from_bytes(path);
+
+  // Initialize WinHTTP
+  h.session = WinHttpOpen(L"dialOS HTTP Client/1.0",
+                          WINHTTP_ACCESS_TYPE_DEFAULT_PROXY,
+                          WINHTTP_NO_PROXY_NAME, WINHTTP_NO_PROXY_BYPASS, 0);
+  if (!h.session) {
+    throw std::runtime_error("Failed to initialize WinHTTP session");
+  }
+
+  // Connect to the server with correct port
+  h.connect = WinHttpConnect(h.session, wHost.c_str(),
+                             static_cast<INTERNET_PORT>(port), 0);
+  if (!h.connect) {
+    throw std::runtime_error("Failed to connect to host: " + hostname + ":" +
+                             std::to_string(port));
+  }
+
+  // Create an HTTP request handle for GET
+  h.request = WinHttpOpenRequest(h.connect, L"GET", wPath.c_str(), NULL,
+                                 WINHTTP_NO_REFERER,
+                                 WINHTTP_DEFAULT_ACCEPT_TYPES,
+                                 WINHTTP_FLAG_REFRESH);
+  if (!h.request) {
+    throw std::runtime_error("Failed to create HTTP request");
+  }
+
+  // Ask for the rest of an interrupted download, if it is still current
+  DownloadWriter writer(fullPath);
+  writer.setProgressHandler(progress);
+  uint32_t offset = writer.prepare();
+  std::wstring wHeaders;
+  if (offset > 0) {
+    wHeaders = L"Range: bytes=" + std::to_wstring(offset) + L"-\r\nIf-Range: " +
+               converter.from_bytes(writer.validator()) + L"\r\n";
+  }
+
+  // Send the request
+  BOOL bResults = WinHttpSendRequest(
+      h.request,
+      wHeaders.empty() ? WINHTTP_NO_ADDITIONAL_HEADERS : wHeaders.c_str(),
+      wHeaders.empty() ? 0 : static_cast<DWORD>(-1L), WINHTTP_NO_REQUEST_DATA,
+      0, 0, 0);
+  if (!bResults) {
+    throw std::runtime_error("Failed to send HTTP request");
+  }
+
+  // End the request
+  bResults = WinHttpReceiveResponse(h.request, NULL);
+  if (!bResults) {
+    throw std::runtime_error("Failed to receive HTTP response");
+  }
+
+  // Response head: status, length, range and validator
+  DWORD status = 0;
+  DWORD statusSize = sizeof(status);
+  WinHttpQueryHeaders(h.request,
+                      WINHTTP_QUERY_STATUS_CODE | WINHTTP_QUERY_FLAG_NUMBER,
+                      WINHTTP_HEADER_NAME_BY_INDEX, &status, &statusSize,
+                      WINHTTP_NO_HEADER_INDEX);
+  auto queryHeader = [&](DWORD info) -> std::string {
+    DWORD size = 0;
+    WinHttpQueryHeaders(h.request, info, WINHTTP_HEADER_NAME_BY_INDEX,
+                        WINHTTP_NO_OUTPUT_BUFFER, &size,
+                        WINHTTP_NO_HEADER_INDEX);
+    if (GetLastError() != ERROR_INSUFFICIENT_BUFFER || size == 0) {
+      return "";
     }
-
-    // Create an HTTP request handle for GET
-    HINTERNET hRequest = WinHttpOpenRequest(
-        hConnect, L"GET", wPath.c_str(), NULL, WINHTTP_NO_REFERER,
-        WINHTTP_DEFAULT_ACCEPT_TYPES, WINHTTP_FLAG_REFRESH);
-
-    if (!hRequest) {
-      WinHttpCloseHandle(hConnect);
-      WinHttpCloseHandle(hSession);
-      throw std::runtime_error("Failed to create HTTP request");
-    }
-
-    // Send the request
-    BOOL bResults = WinHttpSendRequest(hRequest, WINHTTP_NO_ADDITIONAL_HEADERS,
-                                       0, WINHTTP_NO_REQUEST_DATA, 0, 0, 0);
-
-    if (!bResults) {
-      WinHttpCloseHandle(hRequest);
-      WinHttpCloseHandle(hConnect);
-      WinHttpCloseHandle(hSession);
-      throw std::runtime_error("Failed to send HTTP request");
+    std::wstring value(size / sizeof(wchar_t), L'\0');
+    if (!WinHttpQueryHeaders(h.request, info, WINHTTP_HEADER_NAME_BY_INDEX,
+                             &value[0], &size, WINHTTP_NO_HEADER_INDEX)) {
+      return "";
     }
-
-    // End the request
-    bResults = WinHttpReceiveResponse(hRequest, NULL);
-    if (!bResults) {
-      WinHttpCloseHandle(hRequest);
-      WinHttpCloseHandle(hConnect);
-      WinHttpCloseHandle(hSession);
-      throw std::runtime_error("Failed to receive HTTP response");
+    value.resize(size / sizeof(wchar_t));
+    return converter.to_bytes(value);
+  };
+  std::string validator = queryHeader(WINHTTP_QUERY_ETAG);
+  if (validator.empty()) {
+    validator = queryHeader(WINHTTP_QUERY_LAST_MODIFIED);
+  }
+  std::string length = queryHeader(WINHTTP_QUERY_CONTENT_LENGTH);
+  int64_t contentLength = length.empty()
+                              ? DownloadWriter::UNKNOWN_LENGTH
+                              : std::strtoll(length.c_str(), nullptr, 10);
+
+  std::string error;
+  if (!writer.begin(static_cast<int>(status),
+                    queryHeader(WINHTTP_QUERY_CONTENT_RANGE), contentLength,
+                    validator, error)) {
+    throw std::runtime_error(error);
+  }
+
+  // Hand the body to the writer as it arrives; it writes whole chunks
+  std::vector<char> buffer(DownloadWriter::CHUNK_SIZE);
+  DWORD dwSize = 0;
+  DWORD dwDownloaded = 0;
+  do {
+    // Check for available data
+    if (!WinHttpQueryDataAvailable(h.request, &dwSize)) {
+      throw std::runtime_error("Error in WinHttpQueryDataAvailable");
     }
+    if (dwSize == 0)
+      break;
+    if (dwSize > buffer.size())
+      dwSize = static_cast<DWORD>(buffer.size());
 
-    // Create filesystem root if it doesn't exist
-    std::filesystem::create_directories(fileSystemRoot_);
-
-    // Convert dialOS path to full filesystem path
-    std::string fullPath = fileSystemRoot_ + filepath;
-
-    // Create parent directories if they don't exist
-    std::filesystem::path filePath(fullPath);
-    if (filePath.has_parent_path()) {
-      std::filesystem::create_directories(filePath.parent_path());
+    // Read the data
+    if (!WinHttpReadData(h.request, buffer.data(), dwSize, &dwDownloaded)) {
+      throw std::runtime_error("Error in WinHttpReadData");
     }
-
-    // Open output file for binary write
-    std::ofstream outFile(fullPath, std::ios::binary);
-    if (!outFile.is_open()) {
-      WinHttpCloseHandle(hRequest);
-      WinHttpCloseHandle(hConnect);
-      WinHttpCloseHandle(hSession);
-      throw std::runtime_error("Failed to open output file: " + fullPath);
+    if (!writer.write(buffer.data(), dwDownloaded, error)) {
+      throw std::runtime_error(error);
     }
+  } while (dwSize > 0);
 
-    // Read and write data in chunks
-    DWORD dwSize = 0;
-    DWORD dwDownloaded = 0;
-    size_t totalBytes = 0;
-
-    do {
-      // Check for available data
-      if (!WinHttpQueryDataAvailable(hRequest, &dwSize)) {
-        outFile.close();
-        WinHttpCloseHandle(hRequest);
-        WinHttpCloseHandle(hConnect);
-        WinHttpCloseHandle(hSession);
-        throw std::runtime_error("Error in WinHttpQueryDataAvailable");
-      }
-
-      if (dwSize == 0)
-        break;
-
-      // Allocate buffer for this chunk
-      std::vector<char> buffer(dwSize);
-
-      // Read the data
-      if (!WinHttpReadData(hRequest, buffer.data(), dwSize, &dwDownloaded)) {
-        outFile.close();
-        WinHttpCloseHandle(hRequest);
-        WinHttpCloseHandle(hConnect);
-        WinHttpCloseHandle(hSession);
-        throw std::runtime_error("Error in WinHttpReadData");
-      }
-
-      // Write to file
-      outFile.write(buffer.data(), dwDownloaded);
-      totalBytes += dwDownloaded;
-
-    } while (dwSize > 0);
-
-    outFile.close();
-
-    // Clean up
-    WinHttpCloseHandle(hRequest);
-    WinHttpCloseHandle(hConnect);
-    WinHttpCloseHandle(hSession);
-
-    console_log("HTTP download completed: " + std::to_string(totalBytes) +
-                " bytes written to " + fullPath);
-    return "{\"status\":\"success\",\"bytes\":" + std::to_string(totalBytes) +
-           ",\"filepath\":\"" + filepath + "\"}";
-
-  } catch (const std::exception &e) {
-    console_error("HTTP download error: " + std::string(e.what()));
-    return "{\"status\":\"error\",\"message\":\"" + std::string(e.what()) +
-           "\"}";
+  if (!writer.finish(error)) {
+    throw std::runtime_error(error);
   }
+
+  console_log("HTTP download completed: " + std::to_string(writer.bytes()) +
+              " bytes written to " + fullPath);
+  return writer.report(filepath);
 #else
-  return "{\"status\":\"error\",\"message\":\"HTTP download not supported on "
-         "this platform\"}";
+  (void)host;
+  (void)path;
+  (void)fullPath;
+  (void)filepath;
+  (void)progress;
+  return DownloadWriter::errorReport(
+      "HTTP download not supported on this platform");
 #endif
 }
 
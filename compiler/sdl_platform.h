@@ -14,22 +14,34 @@
 #define DIALOS_SDL_PLATFORM_H
 
 #include "vm/platform.h"
+#include "vm/framebuffer.h"
+#include "vm/http_download.h"
+#include "vm/image_codec.h"
 #include "vm/vm_value.h"
+#include "host_file.h"
 #include <SDL.h>
 #include <SDL_ttf.h>
 #include <SDL_mixer.h>
 #include <cstdint>
 #include <string>
 #include <chrono>
+#include <list>
 #include <map>
+#include <unordered_map>
 #include <vector>
 #include <memory>
 #include <fstream>
 #include <filesystem>
+#include <functional>
+#include <mutex>
+#include <thread>
 
 namespace dialos {
 namespace vm {
 
+class HttpCache;
+class HttpClient;
+
 // Color utilities
 struct Color {
     uint8_t r, g, b, a;
@@ -81,6 +93,10 @@ public:
     
     // Main emulator loop control
     bool pollEvents();
+    // Block until an SDL event arrives or timeoutMs passes (NO_TIMEOUT waits
+    // indefinitely), then handle all pending events like pollEvents()
+    bool waitEvents(uint32_t timeoutMs);
+    static const uint32_t NO_TIMEOUT = NO_TIMER_DEADLINE;
     void present();
     bool shouldQuit() const { return shouldQuit_; }
     
@@ -136,6 +152,10 @@ public:
     bool file_exists(const std::string& path) override;
     bool file_delete(const std::string& path) override;
     int file_size(const std::string& path) override;
+    bool file_readLine(int handle, std::string& line) override;
+    int file_readBytes(int handle, char* dest, int size) override;
+    bool file_seek(int handle, int position) override;
+    int file_tell(int handle) override;
     
     // === GPIO Operations ===
     void gpio_pinMode(int pin, int mode) override;
@@ -153,12 +173,8 @@ public:
     void buzzer_beep(int frequency, int duration) override;
     void buzzer_stop() override;
     
-    // === Timer Operations ===
-    int timer_setTimeout(int ms) override;
-    // New: accept callback Value and interval ms
-    int timer_setInterval(const Value& callback, int ms) override;
-    void timer_clearTimeout(int id) override;
-    void timer_clearInterval(int id) override;
+    // Timer operations come from PlatformInterface (shared TimerService);
+    // pollEvents() fires due timers
     
     // === Memory Operations ===
     int memory_getAvailable() override;
@@ -174,6 +190,10 @@ public:
     // === Display Operations ===
     void display_setTitle(const std::string& title) override;
     void display_drawImage(int x, int y, const std::vector<uint8_t>& imageData) override;
+    void display_drawBitmap(int x, int y, const std::shared_ptr<const Image>& image,
+                            int sx, int sy, int w, int h, int32_t transparent) override;
+    bool display_setClip(int x, int y, int w, int h) override;
+    void display_clearClip() override;
     
     // === System Operations ===
     void system_yield() override;
@@ -213,6 +233,8 @@ public:
     std::string http_get(const std::string& url) override;
     std::string http_post(const std::string& url, const std::string& data) override;
     std::string http_download(const std::string& url, const std::string& filepath) override;
+    // http.* run on worker threads; completions wake waitEvents()
+    AsyncToken async_begin(NativeFunctionID id, const std::vector<std::string>& args) override;
     
     // === App Management Operations ===
     std::string app_install(const std::string& dsbFilePath, const std::string& appId) override;
@@ -222,10 +244,6 @@ public:
     std::string app_launch(const std::string& appId) override;
     std::string app_validate(const std::string& dsbFilePath) override;
     
-    // === IPC Operations ===
-    bool ipc_send(const std::string& appId, const std::string& message) override;
-    void ipc_broadcast(const std::string& message) override;
-    
     // === Buzzer Operations ===
     void buzzer_playMelody(const std::vector<int>& notes) override;
     
@@ -240,6 +258,9 @@ public:
     // Output capture for VM programs
     void captureOutput(const std::string& output) { outputLog_.addText(output); }
     
+    // The 240x240 RGB565 display contents, as the device would show them
+    const Framebuffer& getFramebuffer() const { return frame_; }
+    
 private:
     // Internal helpers
     TTF_Font* getFontOfSize(int size);
@@ -259,6 +280,34 @@ private:
     // Display state
     uint32_t backgroundColor_;
     uint8_t brightness_;
+    Framebuffer frame_;                 // display.* draws here
+    SDL_Texture* frameTexture_;         // Streaming RGB565 copy of frame_
+    int shownEncoderPosition_;          // Encoder ring in the uploaded frame
+    struct RingPixel {
+        int16_t x, y;
+        float angle;
+    };
+    std::vector<RingPixel> ringPixels_; // Border ring, computed once
+    
+    // The debug panel and console beside the display are each rendered
+    // into a texture of their own, redrawn only when what they show
+    // changes; present() just copies them. When nothing at all changed
+    // the window already shows the frame and present() does nothing.
+    struct Overlay {
+        SDL_Texture* texture = nullptr;     // Render target
+        int width = 0;
+        int height = 0;
+        bool valid = false;                 // Holds the current contents
+    };
+    static const uint32_t PANEL_REFRESH_MS = 250;  // Live counters (PC, heap, time) redraw at most this often
+    bool overlayTargets_;               // Renderer supports target textures
+    bool presentNeeded_;                // Window exposed, resized or dimmed
+    Overlay panelOverlay_;
+    Overlay consoleOverlay_;
+    std::string panelInputs_;           // Panel state last drawn: inputs, errors
+    std::string panelCounters_;         // ... and the live counters
+    uint32_t panelDrawnAt_;
+    uint32_t consoleDrawnRevision_;
     
     // Input state
     struct {
@@ -323,15 +372,24 @@ private:
     std::string wifiSSID_;
     std::string wifiIP_;
     
+    // Shared by the HTTP workers so requests reuse pooled connections
+    std::unique_ptr<HttpClient> http_;
+    // GET responses, under <fileSystemRoot_>.http_cache (POSIX hosts)
+    std::unique_ptr<HttpCache> httpCache_;
+    
     // HTTP helper functions
     bool parseURL(const std::string& url, std::string& host, std::string& path);
     std::string executeHTTPRequest(const std::string& method, const std::string& host, 
                                    const std::string& path, const std::string& data);
-    std::string executeHTTPDownload(const std::string& host, const std::string& path, const std::string& filepath);
+    std::string executeHTTPDownload(const std::string& host, const std::string& path, const std::string& fullPath,
+                                    const std::string& filepath, DownloadWriter::ProgressHandler progress);
+    // POSIX hosts: one request through http_ (GET / POST)
+    std::string httpFetch(const std::string& method, const std::string& url, const std::string& data);
     
     // File system simulation
     struct FileHandle {
-        std::fstream stream;
+        std::fstream stream;                // Write and append modes
+        std::unique_ptr<HostFile> input;    // Read mode: buffered or mapped
         std::string path;
         std::string mode;
         bool isOpen;
@@ -339,6 +397,8 @@ private:
         FileHandle() : isOpen(false) {}
     };
     std::map<int, FileHandle> fileHandles_;
+    // Reader of a handle opened for reading, or nullptr (logged)
+    FileReader* inputReader(int handle);
     int nextFileHandle_ = 1;
     std::string fileSystemRoot_ = "./sdl_filesystem/";  // Local directory for simulated files
     
@@ -349,9 +409,12 @@ private:
         std::string buffer;
         size_t maxLines;
         
+        uint32_t revision = 0;      // Bumped by every change
+        
         ConsoleLog(size_t max = 50) : maxLines(max) {}
         
         void addText(const std::string& text) {
+            revision++;
             buffer += text;
             // Keep only last maxLines lines
             size_t lines = 0;
@@ -386,6 +449,7 @@ private:
         }
         
         void clear() {
+            revision++;
             buffer.clear();
         }
     };
@@ -393,32 +457,72 @@ private:
     ConsoleLog consoleLog_;
     ConsoleLog outputLog_;
     
+    // Console calls made by async workers are replayed on the UI thread
+    std::thread::id uiThread_;
+    std::mutex deferredMutex_;
+    std::vector<std::function<void()>> deferredConsole_;
+    bool deferConsole(void (SDLPlatform::*fn)(const std::string&), const std::string& msg);
+    void flushDeferredConsole();
+    
     // Helper methods
+    bool handleEvent(const SDL_Event& event);  // false on quit
     bool isInCircularDisplay(int x, int y) const;
     void scaleCoordinates(int& x, int& y) const;
-    void drawCircularMask();
-    void drawEncoderIndicator();
+    bool uploadFrame();         // false if the texture was already current
+    void drawCircularMask(uint16_t* pixels, int stride);
+    void drawEncoderIndicator(uint16_t* pixels, int stride);
     void updateInputs();
     void renderText(int x, int y, const std::string& text, const Color& color, int size);
+    
+    // Text rendering caches. Each font gets an atlas of its printable ASCII
+    // glyphs, rendered white once and tinted per draw, so a string costs one
+    // batched geometry call instead of a TTF render and a texture upload.
+    // Strings drawn again in a later frame (labels, log lines) get their own
+    // texture in a small LRU; a string is only given a texture the second
+    // time it is seen, so counters and clocks don't churn the cache.
+    static const int GLYPH_FIRST = 32;          // ' '
+    static const int GLYPH_COUNT = 95;          // ' '..'~'
+    static const int GLYPH_ATLAS_WIDTH = 512;
+    static const size_t TEXT_CACHE_SIZE = 64;
+    static const size_t TEXT_CACHE_MAX_LENGTH = 128;
+    
+    struct GlyphAtlas {
+        SDL_Texture* texture = nullptr;         // nullptr if the build failed
+        int width = 0;
+        int height = 0;
+        SDL_Rect glyphs[GLYPH_COUNT];           // Cell of each glyph in the atlas
+    };
+    struct CachedText {
+        std::string key;
+        SDL_Texture* texture;                   // nullptr until seen twice
+        int width;
+        int height;
+    };
+    
+    std::map<TTF_Font*, GlyphAtlas> glyphAtlases_;
+    std::list<CachedText> textCache_;           // Most recently used first
+    std::unordered_map<std::string, std::list<CachedText>::iterator> textCacheIndex_;
+    std::string textKey_;                       // Scratch, reused per lookup
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+    std::vector<SDL_Vertex> textVertices_;      // Scratch quads for one string
+    std::vector<int> textIndices_;
+#endif
+    
+    GlyphAtlas* getGlyphAtlas(TTF_Font* font);
+    void drawTextFromAtlas(const GlyphAtlas& atlas, int x, int y, const std::string& text, const Color& color, int size);
+    CachedText* findCachedText(TTF_Font* font, const std::string& text, const Color& color);
+    void clearTextCaches();
     void addDebugMessage(const std::string& msg);
-    void renderConsoleArea();
+    void renderConsoleArea(int consoleX, int consoleHeight);
     void renderLogWindow(int x, int y, int width, int height, const std::string& title, const ConsoleLog& log);
     void renderDebugPanel();
-    // Timer processing called from pollEvents/present
-    void processTimers();
-
-    // Timer entry
-    struct TimerEntry {
-        int id;
-        Value callback;
-        int intervalMs;
-        std::chrono::steady_clock::time_point nextFire;
-        bool repeating;
-    };
-
-    // Timer container
-    std::map<int, TimerEntry> timers_;
-    int nextTimerId_ = 1;
+    // Redraw an overlay if what it shows changed; true if it was redrawn
+    bool updateDebugPanel();
+    bool updateConsoleArea();
+    // Make `overlay` a width x height render target and draw into it
+    bool beginOverlay(Overlay& overlay, int width, int height);
+    void endOverlay();
+    void destroyOverlays();
 };
 
 } // namespace vm
@@ -0,0 +1,248 @@
+/**
+ * Async Native Test
+ *
+ * Runs http.* natives against an in-process stand-in server whose responses
+ * are held back until the test releases them, and checks that a parked VM
+ * frame resumes with the result, that another VM keeps running meanwhile,
+ * callback-style calls, the worker-thread wake, the synchronous fallback
+ * on platforms without async support, and that file.read never turns a
+ * non-int handle into a real one.
+ */
+
+#include "vm/vm_scheduler.h"
+#include "test_platform.h"
+#include "test_check.h"
+#include <chrono>
+#include <condition_variable>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+
+using namespace dialos;
+
+// Stand-in HTTP server: each request blocks until its URL is released
+class StandInServer {
+public:
+    std::string serve(const std::string& url) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        requests_++;
+        releasedCv_.wait(lock, [&]() { return released_.count(url) > 0; });
+        return "body:" + url;
+    }
+
+    void release(const std::string& url) {
+        std::lock_guard<std::mutex> guard(mutex_);
+        released_.insert(url);
+        releasedCv_.notify_all();
+    }
+
+    int requests() {
+        std::lock_guard<std::mutex> guard(mutex_);
+        return requests_;
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable releasedCv_;
+    std::set<std::string> released_;
+    int requests_ = 0;
+};
+
+// TestPlatform whose http.get runs on a worker against the stand-in server
+class AsyncTestPlatform : public vm::TestPlatform {
+public:
+    explicit AsyncTestPlatform(StandInServer& server) : server_(server) {}
+    ~AsyncTestPlatform() { joinAsyncWorkers(); }
+
+    vm::AsyncToken async_begin(vm::NativeFunctionID id, const std::vector<std::string>& args) override {
+        if (id != vm::NativeFunctionID::HTTP_GET) {
+            return vm::NO_ASYNC;
+        }
+        std::string url = args[0];
+        return startAsyncWorker([this, url]() { return server_.serve(url); });
+    }
+
+private:
+    StandInServer& server_;
+};
+
+// Counts wakeups raised from worker threads
+class WakeSignal {
+public:
+    void notify() {
+        std::lock_guard<std::mutex> guard(mutex_);
+        count_++;
+        cv_.notify_all();
+    }
+
+    // Wait until at least `count` wakeups happened (false on timeout)
+    bool waitFor(int count) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        return cv_.wait_for(lock, std::chrono::seconds(5), [&]() { return count_ >= count; });
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    int count_ = 0;
+};
+
+// One VM with its own module, heap and platform
+struct Applet {
+    compiler::BytecodeModule module;
+    std::unique_ptr<vm::ValuePool> pool;
+    std::unique_ptr<vm::VMState> vm;
+
+    Applet(const std::string& source, vm::PlatformInterface& platform)
+        : module(vm::compileScript(source)) {
+        pool.reset(new vm::ValuePool(4096));
+        vm.reset(new vm::VMState(module, *pool, platform));
+    }
+};
+
+static void testParkAndResume() {
+    std::cout << "parked frame resumes, other VM keeps running" << std::endl;
+    uint32_t clock = 0;
+    StandInServer server;
+    AsyncTestPlatform fetchPlatform(server);
+    vm::TestPlatform counterPlatform;
+    fetchPlatform.sharedClock = &clock;
+    counterPlatform.sharedClock = &clock;
+
+    Applet fetcher("var r: \"\";\n"
+                   "os.console.print(\"start \");\n"
+                   "assign r os.http.get(\"http://local/a\");\n"
+                   "os.console.print(r);\n",
+                   fetchPlatform);
+    Applet counter("var n: 0;\n"
+                   "while (n < 3) {\n"
+                   "    assign n n + 1;\n"
+                   "    os.console.print(\"B\");\n"
+                   "    os.system.yield();\n"
+                   "}\n",
+                   counterPlatform);
+
+    WakeSignal wakes;
+    vm::VMScheduler scheduler(counterPlatform);
+    scheduler.setWakeHandler([&]() { wakes.notify(); });
+    vm::VMScheduler::TaskId fetchId = scheduler.add(*fetcher.vm, vm::VMScheduler::TaskConfig());
+    vm::VMScheduler::TaskId counterId = scheduler.add(*counter.vm, vm::VMScheduler::TaskConfig());
+
+    // The counter finishes while the request is still outstanding
+    uint32_t wait = 0;
+    for (int i = 0; i < 20 && wait == 0; i++) {
+        wait = scheduler.tick();
+    }
+    CHECK(counterPlatform.output == "BBB", "counter ran to completion: " << counterPlatform.output);
+    CHECK(fetchPlatform.output == "start ", "fetcher parked: " << fetchPlatform.output);
+    CHECK(scheduler.getTaskInfo(fetchId)->status == vm::VMTaskStatus::WAITING_ASYNC,
+          "fetcher waiting on async");
+    CHECK(scheduler.getTaskInfo(counterId)->status == vm::VMTaskStatus::FINISHED, "counter finished");
+    CHECK(wait == vm::VMScheduler::NO_DEADLINE, "host may block until woken, got " << wait);
+    CHECK(fetchPlatform.hasPendingAsync(), "request pending");
+
+    // Completing the request wakes the host from the worker thread
+    server.release("http://local/a");
+    CHECK(wakes.waitFor(1), "worker completion woke the host");
+    scheduler.tick();
+    CHECK(fetchPlatform.output == "start body:http://local/a", "resumed with result: " << fetchPlatform.output);
+    CHECK(scheduler.getTaskInfo(fetchId)->status == vm::VMTaskStatus::FINISHED, "fetcher finished");
+    CHECK(!fetchPlatform.hasPendingAsync(), "nothing pending");
+    CHECK(!fetcher.vm->hasError(), "no VM error: " << fetcher.vm->getError());
+    CHECK(server.requests() == 1, "one request served");
+}
+
+static void testCallbackStyle() {
+    std::cout << "callback-style calls" << std::endl;
+    StandInServer server;
+    AsyncTestPlatform platform(server);
+    WakeSignal wakes;
+    platform.setAsyncWakeHandler([&]() { wakes.notify(); });
+
+    Applet app("var token: 0;\n"
+               "function onDone(body: string): void {\n"
+               "    os.console.print(\"|\" + body);\n"
+               "}\n"
+               "assign token os.http.get(\"http://local/b\", onDone);\n"
+               "os.http.get(\"http://local/c\", onDone);\n"
+               "os.console.print(\"sent\");\n",
+               platform);
+    app.vm->reset();
+
+    // Main code runs to the end without waiting for either response
+    CHECK(app.vm->execute(1000) == vm::VMResult::FINISHED, "main code finished");
+    CHECK(platform.output == "sent", "no result yet: " << platform.output);
+    CHECK(app.vm->getGlobals().at("token").int32Val > 0, "call returned a token");
+
+    // Responses arrive out of order; each callback gets its own result
+    server.release("http://local/c");
+    CHECK(wakes.waitFor(1), "first completion woke the host");
+    platform.processAsyncCompletions();
+    CHECK(platform.output == "sent|body:http://local/c", "first callback: " << platform.output);
+
+    server.release("http://local/b");
+    CHECK(wakes.waitFor(2), "second completion woke the host");
+    platform.processAsyncCompletions();
+    CHECK(platform.output == "sent|body:http://local/c|body:http://local/b",
+          "second callback: " << platform.output);
+    CHECK(!app.vm->hasError(), "no VM error: " << app.vm->getError());
+}
+
+static void testSynchronousFallback() {
+    std::cout << "synchronous fallback" << std::endl;
+    vm::TestPlatform platform;  // No async_begin override
+
+    Applet app("var token: 1;\n"
+               "function onDone(body: string): void {\n"
+               "    os.console.print(\"cb\" + body);\n"
+               "}\n"
+               "os.console.print(os.http.get(\"http://local/d\"));\n"
+               "assign token os.http.get(\"http://local/d\", onDone);\n"
+               "if (token = 0) {\n"
+               "    os.console.print(\" zero\");\n"
+               "}\n",
+               platform);
+    app.vm->reset();
+
+    CHECK(app.vm->execute(1000) == vm::VMResult::FINISHED, "runs straight through");
+    CHECK(platform.output == "{}cb{} zero", "inline result and immediate callback: " << platform.output);
+    CHECK(!app.vm->isAwaiting(), "never parked");
+    CHECK(!app.vm->hasError(), "no VM error: " << app.vm->getError());
+}
+
+// Records the handle and size file.read is called with
+class FileReadPlatform : public vm::TestPlatform {
+public:
+    std::string file_read(int handle, int size) override {
+        calls += std::to_string(handle) + "," + std::to_string(size) + "|";
+        return "";
+    }
+    std::string calls;
+};
+
+static void testFileReadArguments() {
+    std::cout << "file.read arguments" << std::endl;
+    FileReadPlatform platform;
+
+    Applet app("os.file.read(0, 8);\n"
+               "os.file.read(null, 8);\n"
+               "os.file.read(\"2\", null);\n",
+               platform);
+    app.vm->reset();
+
+    CHECK(app.vm->execute(1000) == vm::VMResult::FINISHED, "runs straight through");
+    CHECK(platform.calls == "0,8|-1,8|-1,0|", "non-int handle is -1, non-int size 0: " << platform.calls);
+}
+
+int main() {
+    std::cout << "=== Async Native Test ===" << std::endl << std::endl;
+
+    testParkAndResume();
+    testCallbackStyle();
+    testSynchronousFallback();
+    testFileReadArguments();
+
+    return test::summary();
+}
@@ -0,0 +1,41 @@
+/**
+ * Checks for host-side tests
+ *
+ * CHECK(cond, msg) reports a failed condition and counts it; `msg` may
+ * chain stream output (CHECK(x == 1, "x is " << x)). A test's main()
+ * ends with `return test::summary();`, which prints the verdict and
+ * gives the process exit code.
+ */
+
+#ifndef DIALOS_TEST_CHECK_H
+#define DIALOS_TEST_CHECK_H
+
+#include <iostream>
+
+namespace dialos {
+namespace test {
+
+inline int failures = 0;
+
+inline int summary() {
+    std::cout << std::endl;
+    if (failures > 0) {
+        std::cerr << failures << " check(s) failed" << std::endl;
+        return 1;
+    }
+    std::cout << "=== All checks passed ===" << std::endl;
+    return 0;
+}
+
+} // namespace test
+} // namespace dialos
+
+#define CHECK(cond, msg)                                                  \
+    do {                                                                  \
+        if (!(cond)) {                                                    \
+            std::cerr << "  FAIL: " << msg << std::endl;                  \
+            ::dialos::test::failures++;                                   \
+        }                                                                 \
+    } while (0)
+
+#endif // DIALOS_TEST_CHECK_H
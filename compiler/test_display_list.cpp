@@ -0,0 +1,231 @@
+/**
+ * Display List / Dirty Tiles Test
+ *
+ * Checks command bounds and the tile diff that decides what reaches the
+ * panel, using a toy rasteriser (text draws one solid cell per character,
+ * shaded by the character) over a 240x240 RGB565 frame. Then reports the
+ * bytes a frame costs for a full-redraw applet and a partial-update applet
+ * that both change one digit of a counter. Also checks text measurement,
+ * and that a label centred with display.measureText lands where expected.
+ */
+
+#include "headless_platform.h"
+#include "test_platform.h"
+#include "vm/display_list.h"
+#include "vm/dirty_tiles.h"
+#include "test_check.h"
+#include <iostream>
+#include <vector>
+
+using namespace dialos;
+
+static const int SIZE = 240;
+
+static bool same(const vm::Rect& a, const vm::Rect& b) {
+    return a.x == b.x && a.y == b.y && a.w == b.w && a.h == b.h;
+}
+
+// Fill `area` (clipped) of the frame
+static void fill(std::vector<uint16_t>& frame, const vm::Rect& area, uint16_t color) {
+    vm::Rect clipped = area.intersected(vm::Rect(0, 0, SIZE, SIZE));
+    for (int32_t y = clipped.y; y < clipped.y + clipped.h; y++) {
+        for (int32_t x = clipped.x; x < clipped.x + clipped.w; x++) {
+            frame[y * SIZE + x] = color;
+        }
+    }
+}
+
+// Rasterise clears, filled rects and single-line text; marks the tiles
+static void draw(const vm::DisplayList& list, std::vector<uint16_t>& frame, vm::DirtyTiles& tiles) {
+    for (const auto& command : list.commands()) {
+        switch (command.op) {
+            case vm::DisplayList::Op::CLEAR:
+                fill(frame, vm::Rect(0, 0, SIZE, SIZE), static_cast<uint16_t>(command.color));
+                break;
+            case vm::DisplayList::Op::RECT:
+                fill(frame, list.bounds(command), static_cast<uint16_t>(command.color));
+                break;
+            case vm::DisplayList::Op::TEXT: {
+                const std::string& text = list.text(command);
+                int32_t cellW = vm::DisplayList::GLYPH_WIDTH * command.size;
+                int32_t cellH = vm::DisplayList::GLYPH_HEIGHT * command.size;
+                for (size_t i = 0; i < text.size(); i++) {
+                    fill(frame, vm::Rect(command.x + static_cast<int32_t>(i) * cellW, command.y, cellW, cellH),
+                         static_cast<uint16_t>(command.color ^ static_cast<uint8_t>(text[i])));
+                }
+                break;
+            }
+            default:
+                break;
+        }
+        tiles.mark(list.bounds(command));
+    }
+}
+
+static void testBounds() {
+    std::cout << "command bounds" << std::endl;
+    vm::DisplayList list(SIZE, SIZE);
+    list.drawText(10, 20, "abc", 0xFFFF, 2);
+    CHECK(same(list.bounds(list.commands()[0]), vm::Rect(10, 20, 36, 16)), "text: 3 cells of 12x16");
+    list.drawText(10, 100, "a\nb", 0xFFFF, 1);
+    CHECK(same(list.bounds(list.commands()[1]), vm::Rect(0, 100, SIZE, SIZE - 100)), "multi-line text");
+    list.drawText(230, 0, "wrap", 0xFFFF, 1);
+    CHECK(list.bounds(list.commands()[2]).x == 0, "text past the edge wraps");
+    list.drawCircle(120, 120, 10, 0, true);
+    CHECK(same(list.bounds(list.commands()[3]), vm::Rect(110, 110, 21, 21)), "circle");
+    list.drawLine(50, 60, 10, 20, 0);
+    CHECK(same(list.bounds(list.commands()[4]), vm::Rect(10, 20, 41, 41)), "line, either direction");
+    list.drawRect(20, 20, -5, 10, 0, true);
+    CHECK(same(list.bounds(list.commands()[5]), vm::Rect(16, 20, 5, 10)), "negative width");
+    list.drawRect(-10, 230, 30, 30, 0, true);
+    CHECK(same(list.bounds(list.commands()[6]), vm::Rect(0, 230, 20, 10)), "clipped to the screen");
+    CHECK(same(list.dirty(), vm::Rect(0, 0, SIZE, SIZE)), "dirty is the union");
+
+    std::vector<uint8_t> image = {0, 2, 0, 1, 0xF8, 0x00, 0x07, 0xE0};
+    list.drawImage(5, 6, image);
+    CHECK(list.commands().back().op == vm::DisplayList::Op::IMAGE &&
+          same(list.bounds(list.commands().back()), vm::Rect(5, 6, 2, 1)), "image");
+    CHECK(list.imageData(list.commands().back())[0] == 0xF8, "image pixels kept");
+    size_t count = list.commands().size();
+    list.drawImage(0, 0, std::vector<uint8_t>{0, 9, 0, 9, 1});
+    CHECK(list.commands().size() == count, "truncated image dropped");
+
+    list.clear(0);
+    CHECK(list.commands().size() == 1, "clear discards what it paints over");
+    list.reset();
+    CHECK(list.empty() && list.dirty().empty(), "reset");
+}
+
+static void testTiles() {
+    std::cout << "tile diff" << std::endl;
+    std::vector<uint16_t> frame(SIZE * SIZE, 0);
+    vm::DirtyTiles tiles(SIZE, SIZE);
+    std::vector<vm::Rect> pushed;
+    vm::DirtyTiles::PushHandler collect = [&](const vm::Rect& area) { pushed.push_back(area); };
+
+    tiles.mark(vm::Rect(0, 0, SIZE, SIZE));
+    size_t pixels = tiles.collect(frame.data(), SIZE, collect);
+    CHECK(pixels == SIZE * SIZE, "first frame sends everything");
+    CHECK(pushed.size() == 1 && same(pushed[0], vm::Rect(0, 0, SIZE, SIZE)), "merged into one rect");
+    CHECK(!tiles.any(), "marks cleared");
+
+    // Repaint identical content: nothing to send
+    pushed.clear();
+    tiles.mark(vm::Rect(0, 0, SIZE, SIZE));
+    CHECK(tiles.collect(frame.data(), SIZE, collect) == 0 && pushed.empty(), "unchanged pixels are not sent");
+
+    // Two separate changes: two rects, each only its tiles
+    fill(frame, vm::Rect(20, 20, 4, 4), 0x1234);
+    fill(frame, vm::Rect(200, 100, 30, 20), 0x4321);
+    tiles.mark(vm::Rect(0, 0, SIZE, SIZE));
+    pushed.clear();
+    pixels = tiles.collect(frame.data(), SIZE, collect);
+    CHECK(pushed.size() == 2, "two changed areas, got " << pushed.size());
+    CHECK(pushed.size() == 2 && same(pushed[0], vm::Rect(16, 16, 16, 16)), "first area is one tile");
+    CHECK(pushed.size() == 2 && same(pushed[1], vm::Rect(192, 96, 48, 32)), "second area spans 3x2 tiles");
+    CHECK(pixels == 16 * 16 + 48 * 32, "pixel count");
+
+    // A change in an unmarked tile is not looked at
+    fill(frame, vm::Rect(100, 100, 1, 1), 0xFFFF);
+    tiles.mark(vm::Rect(0, 0, 16, 16));
+    CHECK(tiles.collect(frame.data(), SIZE, collect) == 0, "only marked tiles are hashed");
+
+    // After invalidate() marked tiles are sent even if unchanged
+    tiles.invalidate();
+    tiles.mark(vm::Rect(0, 0, 16, 16));
+    CHECK(tiles.collect(frame.data(), SIZE, collect) == 256, "invalidated tile resent");
+}
+
+// One counter frame: clear + title + value (full redraw), or just the value
+// box (partial update)
+static void counterFrame(vm::DisplayList& list, int value, bool fullRedraw) {
+    if (fullRedraw) {
+        list.clear(0);
+        list.drawRect(0, 0, SIZE, 20, 0x001F, true);
+        list.drawText(5, 5, "Counter", 0xFFFF, 1);
+        list.drawRect(40, 200, 160, 10, 0x07E0, true);
+    } else {
+        list.drawRect(60, 100, 120, 32, 0, true);
+    }
+    list.drawText(60, 100, std::to_string(value), 0xFFFF, 4);
+}
+
+static void testFrameCost() {
+    std::cout << "bytes per frame" << std::endl;
+    const bool modes[] = {true, false};
+    for (bool fullRedraw : modes) {
+        std::vector<uint16_t> frame(SIZE * SIZE, 0);
+        vm::DirtyTiles tiles(SIZE, SIZE);
+        vm::DisplayList list(SIZE, SIZE);
+        vm::DirtyTiles::PushHandler ignore = [](const vm::Rect&) {};
+
+        // First frame paints the whole scene
+        counterFrame(list, 1000, true);
+        draw(list, frame, tiles);
+        list.reset();
+        tiles.collect(frame.data(), SIZE, ignore);
+
+        // 1000 -> 1001 changes the last digit only
+        counterFrame(list, 1001, fullRedraw);
+        size_t commands = list.commands().size();
+        int32_t dirty = list.dirty().area();
+        draw(list, frame, tiles);
+        list.reset();
+        size_t bytes = tiles.collect(frame.data(), SIZE, ignore) * sizeof(uint16_t);
+
+        CHECK(bytes > 0, "the digit is sent");
+        CHECK(bytes <= 2 * 32 * 48, "only the tiles under the changed digit, got " << bytes);
+        std::cout << "  " << (fullRedraw ? "full redraw:    " : "partial update: ") << commands
+                  << " commands, " << dirty * 2 << " bytes touched, " << bytes << " bytes sent (vs "
+                  << SIZE * SIZE * 2 << " for the whole screen)" << std::endl;
+    }
+}
+
+static const char* CENTRED_SCRIPT = R"(
+var text: "Hello";
+var m: os.display.measureText(text, 2);
+os.display.drawText(120 - m.width / 2, 120 - m.height / 2, text, 65535, 2);
+var lines: os.display.measureText("ab\nabcd");
+os.display.drawPixel(lines.width, lines.height, 65535);
+)";
+
+static void testMeasure() {
+    std::cout << "text measurement" << std::endl;
+    int32_t w, h;
+    vm::DisplayList::measureText("abc", 2, w, h);
+    CHECK(w == 36 && h == 16, "one line, size 2: " << w << "x" << h);
+    vm::DisplayList::measureText("ab\r\nabcd\n", 1, w, h);
+    CHECK(w == 24 && h == 24, "longest of three lines: " << w << "x" << h);
+    vm::DisplayList::measureText("", 3, w, h);
+    CHECK(w == 0 && h == 24, "empty text is one line high");
+    vm::DisplayList::measureText(std::string(60, 'x'), 1, w, h);
+    CHECK(w == 360 && h == 8, "not wrapped");
+
+    vm::HeadlessPlatform platform;
+    vm::HeadlessResult result = vm::runHeadless(vm::compileScript(CENTRED_SCRIPT), platform, vm::HeadlessOptions());
+    CHECK(result.status == vm::HeadlessResult::Status::IDLE, "script runs: " << result.error);
+    // "Hello" at size 2 is 60x16: exactly centred at (90, 112)
+    const uint16_t* pixels = platform.getFramebuffer().pixels();
+    vm::Rect lit;
+    for (int32_t y = 0; y < SIZE; y++) {
+        for (int32_t x = 0; x < SIZE; x++) {
+            if (pixels[y * SIZE + x] != 0 && !(x == 24 && y == 16)) {
+                lit = lit.united(vm::Rect(x, y, 1, 1));
+            }
+        }
+    }
+    CHECK(!lit.empty() && lit.intersected(vm::Rect(90, 112, 60, 16)).area() == lit.area(),
+          "label inside its measured box, lit " << lit.x << "," << lit.y << " " << lit.w << "x" << lit.h);
+    CHECK(pixels[16 * SIZE + 24] != 0, "size defaults to 1");
+}
+
+int main() {
+    std::cout << "=== Display List Test ===" << std::endl << std::endl;
+
+    testBounds();
+    testTiles();
+    testFrameCost();
+    testMeasure();
+
+    return test::summary();
+}
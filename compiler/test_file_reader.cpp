@@ -0,0 +1,356 @@
+/**
+ * File Reader Test
+ *
+ * The read-ahead buffer behind os.file.readLine / readBytes / seek / tell:
+ * line splitting across buffer fills ("\r\n" straddling a boundary, empty
+ * lines, a last line without a newline), seeks inside the buffered window
+ * that don't touch the file, large reads that bypass the buffer, and the
+ * host file that maps large files instead of reading them. A script then
+ * walks a small file through the natives, and a large log is scanned by
+ * line, by byte block and with the old fixed-size os.file.read loop.
+ */
+
+#include "host_file.h"
+#include "test_platform.h"
+#include "vm/file_reader.h"
+#include "vm/vm_core.h"
+#include "test_check.h"
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+
+using namespace dialos;
+
+static const size_t BUFFER = vm::FileReader::BUFFER_SIZE;
+
+// Serve `text` to a reader through positional reads
+static void attachString(vm::FileReader& reader, const std::string& text) {
+    reader.attach(
+        [&text](uint32_t offset, char* dest, size_t size) -> size_t {
+            if (offset >= text.size()) {
+                return 0;
+            }
+            size_t n = std::min(size, text.size() - offset);
+            text.copy(dest, n, offset);
+            return n;
+        },
+        static_cast<uint32_t>(text.size()));
+}
+
+static std::vector<std::string> readLines(vm::FileReader& reader) {
+    std::vector<std::string> lines;
+    std::string line;
+    while (reader.readLine(line)) {
+        lines.push_back(line);
+    }
+    return lines;
+}
+
+static void testLines() {
+    std::cout << "lines across buffer fills" << std::endl;
+    // The first line ends with "\r" as the last byte of the first buffer
+    std::string first(BUFFER - 1, 'a');
+    std::string text = first + "\r\n\nsecond\r\n" + std::string(3 * BUFFER, 'b') + "\nlast";
+
+    for (int pass = 0; pass < 2; pass++) {
+        vm::FileReader reader;
+        if (pass == 0) {
+            attachString(reader, text);
+        } else {
+            reader.view(text.data(), static_cast<uint32_t>(text.size()));
+        }
+        std::vector<std::string> lines = readLines(reader);
+        const char* how = pass == 0 ? "buffered" : "viewed";
+        CHECK(lines.size() == 5, how << ": " << lines.size() << " lines");
+        if (lines.size() == 5) {
+            CHECK(lines[0] == first, how << ": \\r\\n split across fills");
+            CHECK(lines[1].empty(), how << ": empty line");
+            CHECK(lines[2] == "second", how << ": " << lines[2]);
+            CHECK(lines[3].size() == 3 * BUFFER, how << ": line longer than the buffer");
+            CHECK(lines[4] == "last", how << ": last line without a newline");
+        }
+        CHECK(reader.tell() == text.size(), how << ": at the end");
+        if (pass == 0) {
+            CHECK(reader.fills() == (text.size() + BUFFER - 1) / BUFFER, "one fill per buffer: " << reader.fills());
+        } else {
+            CHECK(reader.viewing() && reader.fills() == 0, "a view never fills");
+        }
+    }
+
+    vm::FileReader empty;
+    std::string nothing;
+    attachString(empty, nothing);
+    std::string line = "stale";
+    CHECK(!empty.readLine(line) && line.empty(), "empty file has no lines");
+}
+
+static void testSeekAndRead() {
+    std::cout << "seek, tell and block reads" << std::endl;
+    std::string text;
+    for (int i = 0; i < 4 * static_cast<int>(BUFFER); i++) {
+        text += static_cast<char>(i % 251);
+    }
+    vm::FileReader reader;
+    attachString(reader, text);
+
+    char block[64];
+    CHECK(reader.read(block, 10) == 10 && block[9] == text[9], "small read");
+    CHECK(reader.fills() == 1, "buffered");
+    CHECK(reader.seek(100) && reader.tell() == 100, "seek forward");
+    CHECK(reader.read(block, 4) == 4 && block[0] == text[100], "read after seek");
+    CHECK(reader.seek(0) && reader.read(block, 1) == 1 && block[0] == text[0], "seek back");
+    CHECK(reader.fills() == 1, "seeks inside the window don't refill: " << reader.fills());
+
+    std::vector<char> large(2 * BUFFER);
+    uint32_t fillsBefore = reader.fills();
+    CHECK(reader.seek(static_cast<uint32_t>(BUFFER)), "seek past the window");
+    CHECK(reader.read(large.data(), large.size()) == large.size() &&
+          std::string(large.data(), large.size()) == text.substr(BUFFER, 2 * BUFFER), "large read");
+    CHECK(reader.fills() == fillsBefore + 1, "large read goes straight to the source");
+
+    CHECK(!reader.seek(static_cast<uint32_t>(text.size()) + 1), "seek past the end refused");
+    CHECK(reader.seek(static_cast<uint32_t>(text.size()) - 3), "seek near the end");
+    CHECK(reader.read(block, sizeof(block)) == 3, "short read at the end");
+    CHECK(reader.read(block, sizeof(block)) == 0, "nothing past the end");
+}
+
+static std::string tempPath(const char* name) {
+    return (std::filesystem::temp_directory_path() / name).string();
+}
+
+// A log of `bytes` or a little more, "\n"-terminated lines
+static std::string writeLog(const std::string& path, size_t bytes, int& lines) {
+    std::string text;
+    lines = 0;
+    while (text.size() < bytes) {
+        text += "12:" + std::to_string(lines % 60) + " encoder delta " + std::to_string(lines * 7 % 13) +
+                (lines % 5 == 0 ? " ERROR\n" : " ok\n");
+        lines++;
+    }
+    std::ofstream(path, std::ios::binary) << text;
+    return text;
+}
+
+static void testHostFile() {
+    std::cout << "host file: mapped and buffered" << std::endl;
+    int lines = 0;
+    std::string bigPath = tempPath("dialos_file_reader_big.log");
+    writeLog(bigPath, 100 * 1024, lines);
+    vm::HostFile file;
+    CHECK(file.open(bigPath), "open large file");
+    CHECK(file.mapped() && file.reader().viewing(), "large file is mapped");
+    CHECK(readLines(file.reader()).size() == static_cast<size_t>(lines), "all lines through the mapping");
+
+    std::string smallPath = tempPath("dialos_file_reader_small.log");
+    int smallLines = 0;
+    writeLog(smallPath, 2000, smallLines);
+    CHECK(file.open(smallPath), "reopen with a small file");
+    CHECK(!file.mapped() && !file.reader().viewing(), "small file is buffered");
+    CHECK(readLines(file.reader()).size() == static_cast<size_t>(smallLines), "all lines through the buffer");
+    CHECK(!file.open(tempPath("dialos_file_reader_missing.log")), "missing file");
+
+    std::filesystem::remove(bigPath);
+    std::filesystem::remove(smallPath);
+}
+
+// Read-only files on the host behind the file natives
+class FilePlatform : public vm::TestPlatform {
+public:
+    int file_open(const std::string& path, const std::string& mode) override {
+        if (mode != "r") {
+            return -1;
+        }
+        std::unique_ptr<vm::HostFile> file(new vm::HostFile());
+        if (!file->open(path)) {
+            return -1;
+        }
+        files_[next_] = std::move(file);
+        return next_++;
+    }
+    std::string file_read(int handle, int size) override {
+        vm::FileReader* reader = find(handle);
+        if (reader == nullptr || size <= 0) {
+            return "";
+        }
+        std::string data(static_cast<size_t>(size), '\0');
+        data.resize(reader->read(&data[0], data.size()));
+        return data;
+    }
+    void file_close(int handle) override { files_.erase(handle); }
+    bool file_readLine(int handle, std::string& line) override {
+        vm::FileReader* reader = find(handle);
+        return reader != nullptr && reader->readLine(line);
+    }
+    int file_readBytes(int handle, char* dest, int size) override {
+        vm::FileReader* reader = find(handle);
+        return reader != nullptr ? static_cast<int>(reader->read(dest, static_cast<size_t>(size))) : -1;
+    }
+    bool file_seek(int handle, int position) override {
+        vm::FileReader* reader = find(handle);
+        return reader != nullptr && position >= 0 && reader->seek(static_cast<uint32_t>(position));
+    }
+    int file_tell(int handle) override {
+        vm::FileReader* reader = find(handle);
+        return reader != nullptr ? static_cast<int>(reader->tell()) : -1;
+    }
+
+private:
+    vm::FileReader* find(int handle) {
+        auto it = files_.find(handle);
+        return it != files_.end() ? &it->second->reader() : nullptr;
+    }
+
+    std::map<int, std::unique_ptr<vm::HostFile>> files_;
+    int next_ = 1;
+};
+
+// Scripts run inside a function taking the file's path, so their variables
+// are locals, which may hold null without the VM flagging a null global
+static std::string inMain(const std::string& path, const std::string& body) {
+    return "function main(path: string): void {\nvar h: os.file.open(path, \"r\");" + body + "}\nmain(\"" + path +
+           "\");\n";
+}
+
+// Run to the end; `us` gets the execution time, compiling aside
+static bool runScript(const std::string& source, vm::TestPlatform& platform, std::string& error,
+                      double* us = nullptr) {
+    compiler::BytecodeModule module = vm::compileScript(source);
+    vm::ValuePool pool(256 * 1024);
+    vm::VMState vm(module, pool, platform);
+    vm.reset();
+    auto start = std::chrono::steady_clock::now();
+    vm::VMResult result = vm.execute(100000000);
+    if (us != nullptr) {
+        *us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    }
+    error = vm.getError();
+    return result == vm::VMResult::FINISHED;
+}
+
+static void testScript() {
+    std::cout << "readLine / readBytes / seek / tell from a script" << std::endl;
+    std::string path = tempPath("dialos_file_reader_script.txt");
+    std::ofstream(path, std::ios::binary) << "wifi=home\r\nvolume=7\n\nAB";
+
+    std::string script = inMain(path, R"(
+var line: os.file.readLine(h);
+while (line != null) {
+    os.console.print(`[${line}]`);
+    assign line os.file.readLine(h);
+}
+os.console.print(`|${os.file.tell(h)}|`);
+os.console.print(os.file.seek(h, 5));
+var bytes: [];
+var n: os.file.readBytes(h, bytes, 4);
+os.console.print(`|${n}:${bytes.length}:${bytes[0]}:${bytes[3]}|`);
+os.console.print(os.file.seek(h, 1000));
+os.file.seek(h, 21);
+assign n os.file.readBytes(h, bytes, 16);
+os.console.print(`|${n}:${bytes[0]}:${bytes[1]}|`);
+os.file.close(h);
+)");
+    FilePlatform platform;
+    std::string error;
+    CHECK(runScript(script, platform, error), "script finishes: " << error);
+    const std::string expected = "[wifi=home][volume=7][][AB]|23|true|4:4:104:101|false|2:65:66|";
+    CHECK(platform.output == expected, "output: " << platform.output);
+    std::filesystem::remove(path);
+}
+
+static void testThroughput() {
+    std::cout << "scanning a log" << std::endl;
+    int lines = 0;
+    std::string path = tempPath("dialos_file_reader_scan.log");
+    std::string text = writeLog(path, 100 * 1024, lines);
+
+    // Lines counted three ways: whole lines, newline bytes in 4 KB blocks,
+    // and the fixed-size reads scripts had before (which can only total
+    // up bytes; strings can't be split in a script)
+    std::string byLine = inMain(path, R"(
+var count: 0;
+var line: os.file.readLine(h);
+while (line != null) {
+    assign count count + 1;
+    assign line os.file.readLine(h);
+}
+os.file.close(h);
+os.console.print(count);
+)");
+    std::string byBlock = inMain(path, R"(
+var count: 0;
+var block: [];
+var n: os.file.readBytes(h, block, 4096);
+while (n > 0) {
+    for (var i: 0; i < n; assign i i + 1;) {
+        if (block[i] = 10) {
+            assign count count + 1;
+        }
+    }
+    assign n os.file.readBytes(h, block, 4096);
+}
+os.file.close(h);
+os.console.print(count);
+)");
+    std::string byChunk = inMain(path, R"(
+var total: 0;
+var chunk: os.file.read(h, 64);
+while (chunk.length > 0) {
+    assign total total + chunk.length;
+    assign chunk os.file.read(h, 64);
+}
+os.file.close(h);
+os.console.print(total);
+)");
+    const char* names[3] = {"readLine", "readBytes(4096)", "read(64)"};
+    const std::string* scripts[3] = {&byLine, &byBlock, &byChunk};
+    const std::string expected[3] = {std::to_string(lines), std::to_string(lines), std::to_string(text.size())};
+    std::cout << "  " << text.size() / 1024 << " KB, " << lines << " lines:";
+    for (int i = 0; i < 3; i++) {
+        FilePlatform platform;
+        std::string error;
+        double us = 0;
+        bool ok = runScript(*scripts[i], platform, error, &us);
+        CHECK(ok, names[i] << " script finishes: " << error);
+        CHECK(platform.output == expected[i], names[i] << ": " << platform.output << ", expected " << expected[i]);
+        std::cout << " " << names[i] << " " << static_cast<int>(us) << " us" << (i < 2 ? "," : "");
+    }
+    std::cout << std::endl;
+
+    // The reader alone, mapped vs buffered
+    const int runs = 50;
+    for (int mapped = 1; mapped >= 0; mapped--) {
+        size_t count = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (int run = 0; run < runs; run++) {
+            vm::FileReader reader;
+            vm::HostFile file;
+            if (mapped) {
+                file.open(path);
+            } else {
+                attachString(reader, text);
+            }
+            count += readLines(mapped ? file.reader() : reader).size();
+        }
+        double perScan = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() /
+                         runs;
+        CHECK(count == static_cast<size_t>(lines) * runs, "lines per scan");
+        std::cout << "  " << (mapped ? "mapped" : "buffered") << ": " << static_cast<int>(perScan) << " us per scan ("
+                  << static_cast<int>(text.size() / perScan) << " MB/s)" << std::endl;
+    }
+    std::filesystem::remove(path);
+}
+
+int main() {
+    std::cout << "=== File Reader Test ===" << std::endl << std::endl;
+
+    testLines();
+    testSeekAndRead();
+    testHostFile();
+    testScript();
+    testThroughput();
+
+    return test::summary();
+}
@@ -0,0 +1,211 @@
+/**
+ * Software Framebuffer Test
+ *
+ * Checks the RGB565 rasterisers pixel by pixel: clipping, rect and line
+ * shapes, circle symmetry, the built-in font and its wrapping, images, and
+ * the round-panel mask. Also replays a mixed display list command by
+ * command and checks that nothing lands outside the bounds the dirty-tile
+ * tracking relies on.
+ */
+
+#include "vm/framebuffer.h"
+#include "vm/display_list.h"
+#include "test_check.h"
+#include <iostream>
+#include <vector>
+
+using namespace dialos;
+
+static const int SIZE = 240;
+static const uint16_t WHITE = 0xFFFF;
+
+// Pixels of `fb` that are not 0
+static int countSet(const vm::Framebuffer& fb) {
+    int count = 0;
+    for (int i = 0; i < fb.width() * fb.height(); i++) {
+        count += fb.pixels()[i] != 0;
+    }
+    return count;
+}
+
+static void testPrimitives() {
+    std::cout << "primitives" << std::endl;
+    vm::Framebuffer fb(SIZE, SIZE);
+    CHECK(fb.isChanged(), "a new frame needs uploading");
+    fb.clearChanged();
+    fb.drawPixel(-1, 5, WHITE);
+    fb.drawPixel(SIZE, 5, WHITE);
+    CHECK(countSet(fb) == 0, "off-screen pixels are clipped");
+    fb.drawPixel(3, 4, 0x1234);
+    CHECK(fb.pixel(3, 4) == 0x1234 && fb.isChanged(), "pixel");
+    CHECK(fb.pixel(-5, 0) == 0, "reading outside the frame");
+
+    fb.clear(0);
+    fb.drawRect(2, 3, 10, 5, WHITE, false);
+    CHECK(countSet(fb) == 2 * 10 + 2 * 3, "rect outline pixel count, got " << countSet(fb));
+    CHECK(fb.pixel(2, 3) && fb.pixel(11, 7) && !fb.pixel(5, 5) && !fb.pixel(12, 3), "rect outline shape");
+
+    fb.clear(0);
+    fb.drawRect(20, 20, -5, 10, WHITE, true);
+    CHECK(countSet(fb) == 50 && fb.pixel(16, 20) && !fb.pixel(15, 20) && !fb.pixel(21, 20),
+          "negative width extends left");
+
+    fb.clear(0);
+    fb.drawLine(0, 0, 4, 4, WHITE);
+    CHECK(countSet(fb) == 5 && fb.pixel(2, 2), "diagonal line");
+    fb.clear(0);
+    fb.drawLine(9, 3, 0, 0, WHITE);
+    CHECK(countSet(fb) == 10 && fb.pixel(0, 0) && fb.pixel(9, 3), "shallow line, either direction");
+    fb.clear(0);
+    fb.drawLine(5, 0, 5, 9, WHITE);
+    CHECK(countSet(fb) == 10, "vertical line");
+
+    fb.clear(0);
+    fb.drawCircle(120, 120, 10, WHITE, false);
+    bool symmetric = true;
+    for (int dy = -10; dy <= 10; dy++) {
+        for (int dx = -10; dx <= 10; dx++) {
+            uint16_t p = fb.pixel(120 + dx, 120 + dy);
+            symmetric = symmetric && p == fb.pixel(120 - dx, 120 + dy) && p == fb.pixel(120 + dy, 120 + dx);
+        }
+    }
+    CHECK(symmetric, "circle outline is 8-way symmetric");
+    CHECK(fb.pixel(130, 120) && fb.pixel(120, 110) && !fb.pixel(120, 120), "circle outline extremes");
+    std::vector<uint16_t> outline(fb.pixels(), fb.pixels() + SIZE * SIZE);
+    fb.clear(0);
+    fb.drawCircle(120, 120, 10, WHITE, true);
+    bool covers = true;
+    for (int i = 0; i < SIZE * SIZE; i++) {
+        covers = covers && (!outline[i] || fb.pixels()[i]);
+    }
+    CHECK(covers, "filled circle covers its outline");
+    CHECK(fb.pixel(120, 120) && !fb.pixel(131, 120), "filled circle interior");
+    fb.clear(0);
+    fb.drawCircle(50, 50, 0, WHITE, true);
+    CHECK(countSet(fb) == 1, "radius 0 is one pixel");
+
+    fb.clear(0);
+    std::vector<uint8_t> image = {0, 2, 0, 1, 0xF8, 0x00, 0x07, 0xE0};
+    fb.drawImage(SIZE - 1, 0, image);
+    CHECK(fb.pixel(SIZE - 1, 0) == 0xF800 && countSet(fb) == 1, "image: big-endian pixels, clipped");
+    fb.drawImage(0, 0, std::vector<uint8_t>{0, 9, 0, 9, 1});
+    CHECK(countSet(fb) == 1, "truncated image ignored");
+}
+
+static void testText() {
+    std::cout << "text" << std::endl;
+    vm::Framebuffer fb(SIZE, SIZE);
+    fb.drawText(0, 0, "A", WHITE, 1);
+    // First column of 'A' is 0x7C: rows 2..6
+    CHECK(!fb.pixel(0, 1) && fb.pixel(0, 2) && fb.pixel(0, 6) && !fb.pixel(0, 7), "glyph column");
+    CHECK(!fb.pixel(5, 3), "sixth column is spacing");
+    int single = countSet(fb);
+
+    fb.clear(0);
+    fb.drawText(10, 10, "A", WHITE, 2);
+    CHECK(countSet(fb) == single * 4, "size 2 doubles each font pixel");
+    CHECK(fb.pixel(10, 14) && fb.pixel(11, 15) && !fb.pixel(10, 13), "scaled glyph position");
+
+    fb.clear(0);
+    fb.drawText(0, 0, "A\nA", WHITE, 1);
+    CHECK(fb.pixel(0, 8 + 2), "newline starts a row down at x = 0");
+    fb.clear(0);
+    fb.drawText(SIZE - 3, 20, "A", WHITE, 1);
+    CHECK(countSet(fb) == single && fb.pixel(0, 28 + 2), "text past the edge wraps");
+
+    fb.clear(0);
+    fb.drawText(0, 0, " ~\t", WHITE, 1);
+    CHECK(countSet(fb) > 0 && !fb.pixel(12, 3), "unprintable characters only advance");
+}
+
+static void testBoundsAgree() {
+    std::cout << "rasterised pixels stay inside command bounds" << std::endl;
+    vm::DisplayList list(SIZE, SIZE);
+    list.drawText(10, 20, "Hello, dial!", WHITE, 2);
+    list.drawText(200, 100, "wrapping text", WHITE, 1);
+    list.drawText(5, 150, "two\nlines", WHITE, 3);
+    list.drawRect(30, 30, -20, 40, WHITE, false);
+    list.drawRect(100, 10, 50, 20, WHITE, true);
+    list.drawCircle(120, 120, 60, WHITE, false);
+    list.drawCircle(10, 230, 25, WHITE, true);
+    list.drawLine(239, 0, 0, 239, WHITE);
+    list.drawLine(17, 200, 90, 181, WHITE);
+    list.drawPixel(7, 7, WHITE);
+    list.drawImage(220, 220, std::vector<uint8_t>{0, 30, 0, 30});  // truncated: dropped
+    std::vector<uint8_t> image = {0, 3, 0, 2};
+    image.resize(4 + 3 * 2 * 2, 0xFF);
+    list.drawImage(238, 50, image);
+
+    for (size_t i = 0; i < list.commands().size(); i++) {
+        vm::DisplayList single(SIZE, SIZE);
+        vm::Framebuffer fb(SIZE, SIZE);
+        const vm::DisplayList::Command& command = list.commands()[i];
+        vm::Rect bounds = list.bounds(command);
+        // Replay just this command through a one-command list
+        switch (command.op) {
+            case vm::DisplayList::Op::TEXT:
+                single.drawText(command.x, command.y, list.text(command), command.color, command.size);
+                break;
+            case vm::DisplayList::Op::RECT:
+                single.drawRect(command.x, command.y, command.w, command.h, command.color, command.filled);
+                break;
+            case vm::DisplayList::Op::CIRCLE:
+                single.drawCircle(command.x, command.y, command.w, command.color, command.filled);
+                break;
+            case vm::DisplayList::Op::LINE:
+                single.drawLine(command.x, command.y, command.w, command.h, command.color);
+                break;
+            case vm::DisplayList::Op::PIXEL:
+                single.drawPixel(command.x, command.y, command.color);
+                break;
+            case vm::DisplayList::Op::IMAGE:
+                single.drawImage(command.x, command.y, image);
+                break;
+            default:
+                break;
+        }
+        fb.draw(single);
+        int outside = 0;
+        for (int y = 0; y < SIZE; y++) {
+            for (int x = 0; x < SIZE; x++) {
+                bool in = x >= bounds.x && x < bounds.x + bounds.w && y >= bounds.y && y < bounds.y + bounds.h;
+                outside += fb.pixel(x, y) != 0 && !in;
+            }
+        }
+        CHECK(outside == 0, "command " << i << ": " << outside << " pixels outside its bounds");
+        CHECK(countSet(fb) > 0, "command " << i << " drew something");
+    }
+}
+
+static void testCircularCopy() {
+    std::cout << "round panel mask" << std::endl;
+    vm::Framebuffer fb(SIZE, SIZE);
+    fb.clear(WHITE);
+    std::vector<uint16_t> out(SIZE * SIZE, 0x1111);
+    fb.copyCircular(out.data(), SIZE, 120, 0);
+    CHECK(out[0] == 0 && out[SIZE * SIZE - 1] == 0, "corners are masked");
+    CHECK(out[120 * SIZE + 120] == WHITE, "centre is visible");
+    CHECK(out[120 * SIZE + 0] == WHITE && out[119 * SIZE + 0] == 0, "edge follows dx^2 + dy^2 <= r^2");
+    int visible = 0;
+    for (uint16_t p : out) {
+        visible += p == WHITE;
+    }
+    int expected = 0;
+    for (int y = 0; y < SIZE; y++) {
+        for (int x = 0; x < SIZE; x++) {
+            expected += (x - 120) * (x - 120) + (y - 120) * (y - 120) <= 120 * 120;
+        }
+    }
+    CHECK(visible == expected, "visible pixels " << visible << ", expected " << expected);
+}
+
+int main() {
+    std::cout << "=== Framebuffer Test ===" << std::endl << std::endl;
+
+    testPrimitives();
+    testText();
+    testBoundsAgree();
+    testCircularCopy();
+
+    return test::summary();
+}
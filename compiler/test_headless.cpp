@@ -0,0 +1,192 @@
+/**
+ * Headless Runner Test
+ *
+ * Runs small scripts through runHeadless() on the virtual clock: frame
+ * hashes must be reproducible and follow what the script draws, scripted
+ * input must reach the callbacks at the right virtual time, and the VM's
+ * instruction and native call counters must add up. A script polling
+ * getSize/getPosition/measureText for 10,000 frames must not grow the heap.
+ */
+
+#include "headless_platform.h"
+#include "test_platform.h"
+#include "test_check.h"
+#include <algorithm>
+#include <iostream>
+
+using namespace dialos;
+
+// Counts to three, one step every 100 ms, then finishes
+static const char* COUNTER = R"(
+var count: 0;
+while (count < 3) {
+    assign count count + 1;
+    os.display.clear(0);
+    os.display.drawText(100, 100, count, 65535, 2);
+    os.system.sleep(100);
+}
+)";
+
+// Redraws on every encoder turn
+static const char* ON_TURN = R"(
+var position: 0;
+function onTurn(delta: int): void {
+    assign position position + delta;
+    os.display.clear(0);
+    os.display.drawText(100, 100, position, 2016, 3);
+}
+os.encoder.onTurn(onTurn);
+os.display.drawCircle(120, 120, 50, 63488, false);
+)";
+
+static void testCounter() {
+    std::cout << "frames follow the virtual clock" << std::endl;
+    compiler::BytecodeModule module = vm::compileScript(COUNTER);
+    vm::HeadlessOptions options;
+
+    vm::HeadlessPlatform first;
+    vm::HeadlessResult a = vm::runHeadless(module, first, options);
+    CHECK(a.status == vm::HeadlessResult::Status::IDLE, "script runs to completion");
+    CHECK(a.virtualMs == 300, "three 100 ms sleeps, ended at " << a.virtualMs);
+    CHECK(a.changedFrames.size() == 3, "one changed frame per count, got " << a.changedFrames.size());
+    if (a.changedFrames.size() == 3) {
+        CHECK(a.changedFrames[0].time == 16 && a.changedFrames[1].time == 112 &&
+              a.changedFrames[2].time == 208, "frames close after each redraw");
+        CHECK(a.changedFrames[0].hash != a.changedFrames[1].hash, "each count looks different");
+    }
+    CHECK(a.drawCalls == 6, "clear + text three times");
+    CHECK(a.nativeCalls["display.clear"] == 3 && a.nativeCalls["display.drawText"] == 3 &&
+          a.nativeCalls["system.sleep"] == 3, "native call counts");
+    CHECK(a.instructions > 0, "instructions counted");
+
+    vm::HeadlessPlatform second;
+    vm::HeadlessResult b = vm::runHeadless(module, second, options);
+    bool same = a.changedFrames.size() == b.changedFrames.size();
+    for (size_t i = 0; same && i < a.changedFrames.size(); i++) {
+        same = a.changedFrames[i].hash == b.changedFrames[i].hash;
+    }
+    CHECK(same && a.instructions == b.instructions, "a second run is identical");
+}
+
+static void testInput() {
+    std::cout << "scripted input" << std::endl;
+    compiler::BytecodeModule module = vm::compileScript(ON_TURN);
+    vm::HeadlessOptions options;
+    std::string error;
+    CHECK(vm::HeadlessPlatform::parseInput("1000:turn:-2,500:turn:5", options.input, error), error);
+    CHECK(options.input.size() == 2 && options.input[0].time == 500, "events sorted by time");
+
+    vm::HeadlessPlatform platform;
+    vm::HeadlessResult result = vm::runHeadless(module, platform, options);
+    CHECK(result.status == vm::HeadlessResult::Status::IDLE, "idle once the input is used up");
+    CHECK(result.changedFrames.size() == 3, "circle, then one frame per turn, got " << result.changedFrames.size());
+    if (result.changedFrames.size() == 3) {
+        CHECK(result.changedFrames[1].time == 512 && result.changedFrames[2].time == 1008,
+              "turns land in the frames after 500 and 1000 ms");
+    }
+    CHECK(result.virtualMs == 1000, "clock jumped straight between events, ended at " << result.virtualMs);
+
+    // The final frame is what drawing "3" directly gives
+    vm::Framebuffer expected(240, 240);
+    expected.clear(0);
+    expected.drawText(100, 100, "3", 2016, 3);
+    bool match = true;
+    for (int i = 0; i < 240 * 240; i++) {
+        match = match && expected.pixels()[i] == platform.getFramebuffer().pixels()[i];
+    }
+    CHECK(match, "framebuffer shows position 3");
+
+    std::vector<vm::HeadlessPlatform::InputEvent> events;
+    CHECK(!vm::HeadlessPlatform::parseInput("100:spin:1", events, error), "unknown event rejected");
+    CHECK(!vm::HeadlessPlatform::parseInput("100:touch:5", events, error), "missing coordinate rejected");
+}
+
+// Polls the size/position natives every frame, into the VM's result
+// objects and into one of its own
+static const char* POLLING = R"(
+class Point {
+    x: int;
+    y: int;
+    pressed: bool;
+    constructor(x: int, y: int) {
+        assign this.x x;
+        assign this.y y;
+        assign this.pressed false;
+    }
+}
+var mine: Point(0, 0);
+var frame: 0;
+var touches: 0;
+var total: 0;
+while (frame < 10000) {
+    var size: os.display.getSize();
+    var pos: os.touch.getPosition();
+    var text: os.display.measureText("Score", 2);
+    os.touch.getPosition(mine);
+    if (pos.pressed) {
+        assign touches touches + 1;
+    }
+    assign total size.width + text.width + mine.x;
+    os.system.sleep(16);
+    assign frame frame + 1;
+}
+os.display.drawText(0, 0, total, 65535, 1);
+os.display.drawText(0, 20, touches, 65535, 1);
+)";
+
+static void testPollingHeap() {
+    std::cout << "heap while polling for 10000 frames" << std::endl;
+    compiler::BytecodeModule module = vm::compileScript(POLLING);
+    vm::HeadlessOptions options;
+    options.durationMs = 200000;
+    std::string error;
+    CHECK(vm::HeadlessPlatform::parseInput("80000:touch:30:40,80160:lift:30:40", options.input, error), error);
+
+    vm::HeadlessPlatform platform;
+    vm::HeadlessResult result = vm::runHeadless(module, platform, options);
+    CHECK(result.status == vm::HeadlessResult::Status::IDLE, "script finishes: " << result.error);
+    CHECK(result.heapTrace.size() >= 10000, "one heap sample per frame, got " << result.heapTrace.size());
+    if (result.heapTrace.size() >= 10000) {
+        uint32_t settled = result.heapTrace[1];
+        uint32_t peak = *std::max_element(result.heapTrace.begin(), result.heapTrace.end());
+        CHECK(peak == settled && result.heapTrace.back() == settled,
+              "heap flat after the first frames: " << settled << " bytes, peak " << peak);
+        std::cout << "  " << result.heapTrace.size() << " frames: heap " << result.heapTrace.front() << " -> "
+                  << result.heapTrace.back() << " bytes, peak " << peak << std::endl;
+    }
+
+    // 240 + 60 + the last touch x, and the ten frames the finger was down
+    vm::Framebuffer expected(240, 240);
+    expected.clear(0);
+    expected.drawText(0, 0, "330", 65535, 1);
+    expected.drawText(0, 20, "10", 65535, 1);
+    CHECK(std::equal(expected.pixels(), expected.pixels() + 240 * 240, platform.getFramebuffer().pixels()),
+          "results read back correctly");
+}
+
+static void testLimits() {
+    std::cout << "busy scripts and errors" << std::endl;
+    compiler::BytecodeModule busy = vm::compileScript("var n: 0;\nwhile (true) { assign n n + 1; }\n");
+    vm::HeadlessOptions options;
+    options.durationMs = 50;
+    vm::HeadlessPlatform platform;
+    vm::HeadlessResult result = vm::runHeadless(busy, platform, options);
+    CHECK(result.status == vm::HeadlessResult::Status::TIME_LIMIT, "busy loop stops at the time limit");
+    CHECK(result.instructions >= 50 * options.sliceInstructions, "one slice per virtual ms");
+
+    compiler::BytecodeModule failing = vm::compileScript("var a: 1;\nvar b: a / 0;\n");
+    vm::HeadlessPlatform other;
+    result = vm::runHeadless(failing, other, options);
+    CHECK(result.status == vm::HeadlessResult::Status::ERROR && !result.error.empty(), "runtime error reported");
+}
+
+int main() {
+    std::cout << "=== Headless Runner Test ===" << std::endl << std::endl;
+
+    testCounter();
+    testInput();
+    testPollingHeap();
+    testLimits();
+
+    return test::summary();
+}
@@ -0,0 +1,182 @@
+/**
+ * HTTP Cache Test
+ *
+ * The response cache in front of the host HTTP client, against a
+ * stand-in server on the loopback interface with a clock the test moves:
+ * fresh entries served without a request, ETag and Last-Modified
+ * revalidation (304), a changed resource, no-store, the byte budget with
+ * least recently used eviction, and the index surviving a restart.
+ */
+
+#include "http_client.h"
+#include "http_stand_in.h"
+#include "vm/http_cache.h"
+#include "test_check.h"
+#include <filesystem>
+#include <iostream>
+
+using namespace dialos;
+
+static int64_t now = 1000;
+
+// A cache in `dir` whose requests go through `client`
+struct CachedClient {
+    vm::HttpClient& client;
+    vm::HttpCache cache;
+    std::string lastRequestHeaders;
+
+    CachedClient(vm::HttpClient& client, const std::string& dir, size_t budget)
+        : client(client), cache(std::unique_ptr<vm::HttpCache::Store>(new vm::HttpCache::DirectoryStore(dir)),
+                                budget) {
+        cache.setClock([]() { return now; });
+    }
+
+    std::string get(const std::string& url, vm::HttpCache::Source& source) {
+        vm::HttpCache::Response response;
+        std::string error;
+        bool ok = cache.get(
+            url,
+            [this, &url](const vm::HttpCache::Headers& headers, vm::HttpCache::Response& fetched,
+                         std::string& fetchError) {
+                lastRequestHeaders.clear();
+                for (const auto& header : headers) {
+                    lastRequestHeaders += header.first + ": " + header.second + "\n";
+                }
+                vm::HttpResponse head;
+                if (!client.fetch("GET", url, "", head, fetched.body, fetchError, headers)) {
+                    return false;
+                }
+                fetched.status = head.status;
+                fetched.etag = head.header("etag");
+                fetched.lastModified = head.header("last-modified");
+                fetched.cacheControl = head.header("cache-control");
+                return true;
+            },
+            response, error, &source);
+        return ok ? response.body : "error: " + error;
+    }
+};
+
+static void testFreshness(vm::HttpStandIn& server, const std::string& dir) {
+    std::cout << "fresh, revalidated, changed" << std::endl;
+    std::string index = "{\"applets\":[{\"id\":\"hello-world\",\"version\":\"1.0.0\"}]}";
+    server.setFile("/appstore/index.json", index, "\"i1\"", "", "max-age=60");
+    vm::HttpClient client;
+    CachedClient cached(client, dir, 64 * 1024);
+    vm::HttpCache::Source source;
+
+    CHECK(cached.get(server.url("/appstore/index.json"), source) == index && source == vm::HttpCache::Source::NETWORK,
+          "first visit downloads");
+    int requests = server.requests();
+    now += 30;
+    CHECK(cached.get(server.url("/appstore/index.json"), source) == index && source == vm::HttpCache::Source::CACHE,
+          "second visit served from the cache");
+    CHECK(server.requests() == requests, "no request while fresh");
+
+    now += 60;
+    CHECK(cached.get(server.url("/appstore/index.json"), source) == index &&
+          source == vm::HttpCache::Source::REVALIDATED, "stale entry revalidated");
+    CHECK(cached.lastRequestHeaders == "If-None-Match: \"i1\"\n", "conditional: " << cached.lastRequestHeaders);
+    CHECK(server.requests() == requests + 1, "one request to revalidate");
+    CHECK(cached.get(server.url("/appstore/index.json"), source) == index && source == vm::HttpCache::Source::CACHE,
+          "fresh again after the 304");
+
+    std::string updated = "{\"applets\":[{\"id\":\"hello-world\",\"version\":\"1.1.0\"}]}";
+    server.setFile("/appstore/index.json", updated, "\"i2\"", "", "max-age=60");
+    now += 61;
+    CHECK(cached.get(server.url("/appstore/index.json"), source) == updated &&
+          source == vm::HttpCache::Source::NETWORK, "changed index downloaded");
+    now += 1;
+    CHECK(cached.get(server.url("/appstore/index.json"), source) == updated && source == vm::HttpCache::Source::CACHE,
+          "new version cached");
+
+    // Last-Modified only, no max-age: revalidated on every use
+    std::string meta = "{\"id\":\"clock\",\"size\":1234}";
+    server.setFile("/appstore/clock.json", meta, "", "Tue, 28 Oct 2025 10:00:00 GMT");
+    cached.get(server.url("/appstore/clock.json"), source);
+    CHECK(cached.get(server.url("/appstore/clock.json"), source) == meta &&
+          source == vm::HttpCache::Source::REVALIDATED, "Last-Modified revalidation");
+    CHECK(cached.lastRequestHeaders == "If-Modified-Since: Tue, 28 Oct 2025 10:00:00 GMT\n",
+          "conditional: " << cached.lastRequestHeaders);
+
+    server.setFile("/api/session", "token", "\"s\"", "", "no-store");
+    cached.get(server.url("/api/session"), source);
+    CHECK(cached.get(server.url("/api/session"), source) == "token" && source == vm::HttpCache::Source::NETWORK,
+          "no-store not cached");
+    CHECK(cached.get(server.url("/missing"), source).empty(), "404 passed through");
+
+    vm::HttpCache::Stats stats = cached.cache.getStats();
+    CHECK(stats.hits == 3 && stats.revalidated == 2 && stats.misses == 6, "hits " << stats.hits << ", revalidated "
+                                                                              << stats.revalidated << ", misses "
+                                                                              << stats.misses);
+    CHECK(stats.bytesSaved == 3 * index.size() + updated.size() + meta.size(), "bytes saved " << stats.bytesSaved);
+    CHECK(stats.entries == 2 && stats.bytes == updated.size() + meta.size(), "entries " << stats.entries);
+}
+
+static void testBudget(vm::HttpStandIn& server, const std::string& dir) {
+    std::cout << "budget and eviction" << std::endl;
+    vm::HttpClient client;
+    CachedClient cached(client, dir, 10000);
+    vm::HttpCache::Source source;
+    for (int i = 0; i < 4; i++) {
+        server.setFile("/apps/" + std::to_string(i) + ".dsb", std::string(3000, static_cast<char>('a' + i)),
+                       "\"" + std::to_string(i) + "\"", "", "max-age=600");
+    }
+    cached.get(server.url("/apps/0.dsb"), source);
+    cached.get(server.url("/apps/1.dsb"), source);
+    cached.get(server.url("/apps/2.dsb"), source);
+    cached.get(server.url("/apps/0.dsb"), source);     // 1 is now the least recently used
+    cached.get(server.url("/apps/3.dsb"), source);
+    vm::HttpCache::Stats stats = cached.cache.getStats();
+    CHECK(stats.evictions == 1 && stats.entries == 3 && stats.bytes == 9000, "evicted " << stats.evictions);
+    CHECK(cached.get(server.url("/apps/0.dsb"), source).size() == 3000 && source == vm::HttpCache::Source::CACHE,
+          "recently used entry kept");
+    CHECK(cached.get(server.url("/apps/1.dsb"), source).size() == 3000 && source == vm::HttpCache::Source::NETWORK,
+          "least recently used entry evicted");
+
+    server.setFile("/apps/huge.dsb", std::string(20000, 'x'), "\"h\"", "", "max-age=600");
+    cached.get(server.url("/apps/huge.dsb"), source);
+    CHECK(cached.cache.getStats().bytes <= 10000, "larger than the budget: not kept");
+}
+
+static void testRestart(vm::HttpStandIn& server, const std::string& dir) {
+    std::cout << "index survives a restart" << std::endl;
+    vm::HttpClient client;
+    vm::HttpCache::Source source;
+    std::string body = std::string(5000, 'r');
+    server.setFile("/apps/restart.dsb", body, "\"r\"", "", "max-age=600");
+    {
+        CachedClient cached(client, dir, 64 * 1024);
+        cached.get(server.url("/apps/restart.dsb"), source);
+    }
+    CachedClient reopened(client, dir, 64 * 1024);
+    CHECK(reopened.get(server.url("/apps/restart.dsb"), source) == body && source == vm::HttpCache::Source::CACHE,
+          "served from the reopened cache");
+
+    // A body lost behind the cache's back is fetched again
+    for (const auto& file : std::filesystem::directory_iterator(dir)) {
+        if (file.path().extension() == ".body") {
+            std::filesystem::remove(file.path());
+        }
+    }
+    CHECK(reopened.get(server.url("/apps/restart.dsb"), source) == body && source == vm::HttpCache::Source::NETWORK,
+          "missing body refetched");
+}
+
+int main() {
+    std::cout << "=== HTTP Cache Test ===" << std::endl << std::endl;
+
+    std::string root = (std::filesystem::temp_directory_path() / "dialos_http_cache_test").string();
+    std::filesystem::remove_all(root);
+    for (const char* name : {"/freshness", "/budget", "/restart"}) {
+        std::filesystem::create_directories(root + name);
+    }
+
+    vm::HttpStandIn server;
+    testFreshness(server, root + "/freshness");
+    testBudget(server, root + "/budget");
+    testRestart(server, root + "/restart");
+    std::filesystem::remove_all(root);
+
+    return test::summary();
+}
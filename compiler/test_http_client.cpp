@@ -0,0 +1,226 @@
+/**
+ * HTTP Client Test
+ *
+ * The host HTTP/1.1 client against a stand-in app store on the loopback
+ * interface: the real appstore/index.json and .dsb files compiled from
+ * scripts/, served plain and chunked. Checks that a run of requests
+ * shares one pooled connection, that a connection the server closed while
+ * idle is replaced transparently, that a bogus Content-Length fails the
+ * request, that workers can share the client, and
+ * measures request latency with and without keep-alive and .dsb
+ * throughput.
+ */
+
+#include "http_client.h"
+#include "http_stand_in.h"
+#include "test_platform.h"
+#include "test_check.h"
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+using namespace dialos;
+
+static std::string readFile(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    std::stringstream data;
+    data << in.rdbuf();
+    return data.str();
+}
+
+// The app store as the device sees it: the index and a few applets
+struct AppStore {
+    std::string index;
+    std::vector<std::pair<std::string, std::string>> applets;   // URL path, .dsb bytes
+};
+
+static AppStore publish(vm::HttpStandIn& server) {
+    AppStore store;
+    store.index = readFile(DIALOS_REPO_DIR "/appstore/index.json");
+    server.setFile("/appstore/index.json", store.index, "\"index-1\"");
+    const char* scripts[] = {"hello_world", "counter_applet", "sample_calculator", "appstore"};
+    for (const char* name : scripts) {
+        compiler::BytecodeModule module =
+            vm::compileScript(readFile(std::string(DIALOS_REPO_DIR "/scripts/") + name + ".ds"));
+        std::vector<uint8_t> bytes = module.serialize();
+        std::string path = std::string("/applets/") + name + ".dsb";
+        store.applets.push_back(std::make_pair(path, std::string(bytes.begin(), bytes.end())));
+        server.setFile(path, store.applets.back().second, "\"" + std::to_string(bytes.size()) + "\"");
+    }
+    return store;
+}
+
+static bool get(vm::HttpClient& client, const std::string& url, std::string& body, int& status) {
+    vm::HttpResponse response;
+    std::string error;
+    bool ok = client.fetch("GET", url, "", response, body, error);
+    status = response.status;
+    return ok;
+}
+
+static void testFetch(vm::HttpStandIn& server, const AppStore& store) {
+    std::cout << "index and applets over one connection" << std::endl;
+    CHECK(!store.index.empty(), "appstore/index.json found");
+    for (bool chunked : {false, true}) {
+        server.setChunked(chunked);
+        int connectionsBefore = server.connections();
+        vm::HttpClient client;
+        std::string body;
+        int status = 0;
+        CHECK(get(client, server.url("/appstore/index.json"), body, status) && status == 200,
+              "index fetched, status " << status);
+        CHECK(body == store.index, "index body" << (chunked ? " (chunked)" : ""));
+        for (const auto& applet : store.applets) {
+            CHECK(get(client, server.url(applet.first), body, status) && status == 200, applet.first);
+            CHECK(body == applet.second, applet.first << " body" << (chunked ? " (chunked)" : ""));
+        }
+        CHECK(get(client, server.url("/applets/missing.dsb"), body, status) && status == 404 && body.empty(),
+              "404 answered, status " << status);
+
+        vm::HttpResponse response;
+        std::string error;
+        CHECK(client.fetch("POST", server.url("/api/rate"), "{\"stars\":5}", response, body, error) &&
+              body == "posted:{\"stars\":5}", "post echoed: " << body << error);
+
+        vm::HttpClient::Stats stats = client.getStats();
+        CHECK(server.connections() - connectionsBefore == 1, "one connection, got "
+                                                                 << server.connections() - connectionsBefore);
+        CHECK(stats.requests == store.applets.size() + 3 && stats.connectionsOpened == 1 &&
+              stats.connectionsReused == stats.requests - 1, "reused " << stats.connectionsReused);
+    }
+    server.setChunked(false);
+}
+
+static void testIdleClosed(vm::HttpStandIn& server) {
+    std::cout << "connection closed by the server while pooled" << std::endl;
+    vm::HttpClient client;
+    std::string body;
+    int status = 0;
+    CHECK(get(client, server.url("/appstore/index.json"), body, status), "first request");
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    server.closeIdle();
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    CHECK(get(client, server.url("/appstore/index.json"), body, status) && status == 200,
+          "second request succeeds on a fresh connection");
+    vm::HttpClient::Stats stats = client.getStats();
+    CHECK(stats.retries == 1 && stats.connectionsOpened == 2, "retried " << stats.retries);
+
+    // No keep-alive: a connection per request, none pooled
+    client.setKeepAlive(false);
+    int connectionsBefore = server.connections();
+    for (int i = 0; i < 3; i++) {
+        get(client, server.url("/appstore/index.json"), body, status);
+    }
+    CHECK(server.connections() - connectionsBefore == 3, "keep-alive off opens a connection per request");
+    CHECK(server.lastRequest().find("Connection: close") != std::string::npos, "asks the server to close");
+
+    std::string error;
+    vm::HttpResponse response;
+    CHECK(!client.fetch("GET", "https://example.com/", "", response, body, error) && !error.empty(),
+          "https refused: " << error);
+}
+
+static void testBadLength(vm::HttpStandIn& server) {
+    std::cout << "bogus Content-Length" << std::endl;
+    vm::HttpClient client;
+    vm::HttpResponse response;
+    std::string body;
+    std::string error;
+    for (const char* value : {"-2", "12abc", "+5"}) {
+        server.advertiseNextLength(value);
+        CHECK(!client.fetch("GET", server.url("/appstore/index.json"), "", response, body, error) &&
+              error.find("Content-Length") != std::string::npos, value << " rejected: " << error);
+    }
+
+    // Far more than is sent: nothing is reserved up front, and the body
+    // comes up short when the server closes
+    server.advertiseNextLength("999999999999999999");
+    CHECK(!client.fetch("GET", server.url("/appstore/index.json"), "", response, body, error) &&
+          body.capacity() < 4 * 1024 * 1024, "huge length fails cleanly: " << error);
+}
+
+static void testWorkers(vm::HttpStandIn& server, const AppStore& store) {
+    std::cout << "workers sharing the client" << std::endl;
+    vm::HttpClient client;
+    const int workers = 4;
+    const int rounds = 25;
+    std::vector<std::thread> threads;
+    std::vector<int> good(workers, 0);
+    for (int w = 0; w < workers; w++) {
+        threads.push_back(std::thread([&, w]() {
+            for (int i = 0; i < rounds; i++) {
+                const auto& applet = store.applets[(w + i) % store.applets.size()];
+                std::string body;
+                int status = 0;
+                if (get(client, server.url(applet.first), body, status) && body == applet.second) {
+                    good[w]++;
+                }
+            }
+        }));
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    int total = 0;
+    for (int count : good) {
+        total += count;
+    }
+    vm::HttpClient::Stats stats = client.getStats();
+    CHECK(total == workers * rounds, "all transfers intact: " << total);
+    CHECK(stats.connectionsOpened <= static_cast<uint32_t>(workers) + vm::HttpClient::MAX_IDLE_PER_HOST,
+          "connections stay pooled: " << stats.connectionsOpened);
+}
+
+static void benchmark(vm::HttpStandIn& server, const AppStore& store) {
+    std::cout << "benchmark" << std::endl;
+    const int runs = 200;
+    for (bool keepAlive : {false, true}) {
+        vm::HttpClient client;
+        client.setKeepAlive(keepAlive);
+        std::string body;
+        int status = 0;
+        get(client, server.url("/appstore/index.json"), body, status);
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < runs; i++) {
+            get(client, server.url("/appstore/index.json"), body, status);
+        }
+        double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / runs;
+        std::cout << "  index.json, " << (keepAlive ? "pooled:     " : "new socket: ") << static_cast<int>(us)
+                  << " us per request" << std::endl;
+    }
+
+    // Throughput: the largest applet, padded out so timing isn't all latency
+    std::string big;
+    while (big.size() < 1024 * 1024) {
+        big += store.applets[0].second;
+    }
+    server.setFile("/applets/big.dsb", big, "\"big\"");
+    vm::HttpClient client;
+    std::string body;
+    int status = 0;
+    const int transfers = 20;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < transfers; i++) {
+        get(client, server.url("/applets/big.dsb"), body, status);
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    CHECK(body == big, "large body intact");
+    std::cout << "  " << big.size() / 1024 << " KB .dsb: " << static_cast<int>(transfers * big.size() / seconds / 1e6)
+              << " MB/s" << std::endl;
+}
+
+int main() {
+    std::cout << "=== HTTP Client Test ===" << std::endl << std::endl;
+
+    vm::HttpStandIn server;
+    AppStore store = publish(server);
+    testFetch(server, store);
+    testIdleClosed(server);
+    testBadLength(server);
+    testWorkers(server, store);
+    benchmark(server, store);
+
+    return test::summary();
+}
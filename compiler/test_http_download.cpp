@@ -0,0 +1,241 @@
+/**
+ * HTTP Download Test
+ *
+ * Downloads from a stand-in server on the loopback interface through the
+ * host HTTP client and the streaming DownloadWriter: a whole file in
+ * fixed-size chunks with progress and CRC, a dropped connection resumed
+ * with a range request, a resource that changed in between (restarts
+ * from zero), and a script that follows http.download through
+ * http.onProgress while the transfer runs on a worker thread.
+ */
+
+#include "http_client.h"
+#include "http_stand_in.h"
+#include "test_platform.h"
+#include "vm/json.h"
+#include "vm/vm_core.h"
+#include "test_check.h"
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+using namespace dialos;
+
+static std::string makeBlob(size_t size, uint32_t seed) {
+    std::string blob(size, '\0');
+    for (size_t i = 0; i < size; i++) {
+        seed = seed * 1103515245u + 12345u;
+        blob[i] = static_cast<char>(seed >> 16);
+    }
+    return blob;
+}
+
+static std::string readFile(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    std::stringstream data;
+    data << in.rdbuf();
+    return data.str();
+}
+
+static bool exists(const std::string& path) {
+    return std::filesystem::exists(path);
+}
+
+// The answer's fields, parsed
+struct Report {
+    std::string status;
+    int bytes = -1;
+    int resumed = -1;
+    std::string crc32;
+    std::string message;
+};
+
+static Report parseReport(const std::string& text) {
+    vm::ValuePool pool(4096);
+    vm::Value value;
+    std::string error;
+    Report report;
+    if (!vm::json::parse(text.data(), text.size(), pool, value, error) || !value.isObject()) {
+        report.status = "unparsable: " + text;
+        return report;
+    }
+    auto& fields = value.objVal->fields;
+    report.status = fields["status"].toString();
+    report.message = fields["message"].toString();
+    report.crc32 = fields["crc32"].toString();
+    if (fields["bytes"].isInt32()) {
+        report.bytes = fields["bytes"].int32Val;
+    }
+    if (fields["resumed"].isInt32()) {
+        report.resumed = fields["resumed"].int32Val;
+    }
+    return report;
+}
+
+static std::string hex(uint32_t value) {
+    char text[9];
+    std::snprintf(text, sizeof(text), "%08x", static_cast<unsigned>(value));
+    return text;
+}
+
+static void testCrc() {
+    std::cout << "crc32" << std::endl;
+    CHECK(vm::crc32(0, "123456789", 9) == 0xCBF43926u, "check value");
+    uint32_t split = vm::crc32(vm::crc32(0, "12345", 5), "6789", 4);
+    CHECK(split == 0xCBF43926u, "incremental update matches one pass");
+}
+
+static void testWholeFile(vm::HttpStandIn& server, const std::string& dir) {
+    std::cout << "whole file in chunks" << std::endl;
+    const size_t size = 5 * vm::DownloadWriter::CHUNK_SIZE + 123;
+    std::string blob = makeBlob(size, 1);
+    server.setFile("/apps/big.dsb", blob, "\"v1\"");
+
+    std::string path = dir + "/big.dsb";
+    std::vector<std::pair<uint32_t, int64_t>> reports;
+    vm::HttpClient client;
+    Report report = parseReport(client.download(server.url("/apps/big.dsb"), path, "/apps/big.dsb",
+                                                [&](uint32_t received, int64_t total) {
+                                                    reports.push_back(std::make_pair(received, total));
+                                                }));
+    CHECK(report.status == "success", "downloaded: " << report.status << " " << report.message);
+    CHECK(report.bytes == static_cast<int>(size) && report.resumed == 0, "size " << report.bytes);
+    CHECK(report.crc32 == hex(vm::crc32(0, blob.data(), blob.size())), "crc " << report.crc32);
+    CHECK(readFile(path) == blob, "file content");
+    CHECK(!exists(path + ".part") && !exists(path + ".etag"), "no leftovers");
+
+    // One report per chunk written: five full ones and the short tail
+    CHECK(reports.size() == 6, "progress reports: " << reports.size());
+    bool rising = true;
+    for (size_t i = 0; i < reports.size(); i++) {
+        rising = rising && reports[i].second == static_cast<int64_t>(size) &&
+                 (i == 0 || reports[i].first > reports[i - 1].first);
+    }
+    CHECK(rising, "progress rises towards the announced total");
+    CHECK(!reports.empty() && reports.back().first == size, "last report is the whole file");
+
+    Report missing = parseReport(client.download(server.url("/apps/none.dsb"), dir + "/none.dsb", "/none.dsb", nullptr));
+    CHECK(missing.status == "error" && missing.message == "HTTP 404", "404 reported: " << missing.message);
+    CHECK(!exists(dir + "/none.dsb") && !exists(dir + "/none.dsb.part"), "nothing written for a 404");
+}
+
+static void testResume(vm::HttpStandIn& server, const std::string& dir) {
+    std::cout << "dropped connection resumes" << std::endl;
+    const size_t size = 200000;
+    std::string blob = makeBlob(size, 2);
+    server.setFile("/apps/resume.dsb", blob, "\"r1\"");
+    std::string path = dir + "/resume.dsb";
+    vm::HttpClient client;
+
+    server.dropNextAfter(70000);
+    Report cut = parseReport(client.download(server.url("/apps/resume.dsb"), path, "/resume.dsb", nullptr));
+    CHECK(cut.status == "error", "cut transfer fails: " << cut.status);
+    CHECK(!exists(path), "no file under the real name");
+    CHECK(exists(path + ".part") && std::filesystem::file_size(path + ".part") == 70000,
+          "received bytes kept in the part file");
+    CHECK(readFile(path + ".etag") == "\"r1\"", "validator kept");
+
+    Report rest = parseReport(client.download(server.url("/apps/resume.dsb"), path, "/resume.dsb", nullptr));
+    std::string request = server.lastRequest();
+    CHECK(request.find("Range: bytes=70000-") != std::string::npos &&
+          request.find("If-Range: \"r1\"") != std::string::npos, "range request: " << request);
+    CHECK(rest.status == "success" && rest.resumed == 70000 && rest.bytes == static_cast<int>(size),
+          "resumed: " << rest.status << " " << rest.message << " resumed " << rest.resumed);
+    CHECK(rest.crc32 == hex(vm::crc32(0, blob.data(), blob.size())), "crc covers the resumed prefix");
+    CHECK(readFile(path) == blob, "file content after resume");
+
+    // The resource changes between the attempts: If-Range fails, start over
+    std::remove(path.c_str());
+    server.dropNextAfter(50000);
+    client.download(server.url("/apps/resume.dsb"), path, "/resume.dsb", nullptr);
+    std::string updated = makeBlob(size + 1000, 3);
+    server.setFile("/apps/resume.dsb", updated, "\"r2\"");
+    Report fresh = parseReport(client.download(server.url("/apps/resume.dsb"), path, "/resume.dsb", nullptr));
+    CHECK(fresh.status == "success" && fresh.resumed == 0, "restarted: " << fresh.status << " " << fresh.resumed);
+    CHECK(readFile(path) == updated, "new version, not spliced");
+}
+
+// TestPlatform whose http.download runs on a worker through the host client
+class DownloadPlatform : public vm::TestPlatform {
+public:
+    explicit DownloadPlatform(const std::string& root) : root_(root) {}
+    ~DownloadPlatform() { joinAsyncWorkers(); }
+
+    std::string http_download(const std::string& url, const std::string& filepath) override {
+        return vm::HttpClient().download(url, root_ + filepath, filepath,
+                                         [this, url](uint32_t received, int64_t total) {
+                                             http_reportProgress(url, received, total);
+                                         });
+    }
+
+    vm::AsyncToken async_begin(vm::NativeFunctionID id, const std::vector<std::string>& args) override {
+        if (id != vm::NativeFunctionID::HTTP_DOWNLOAD) {
+            return vm::NO_ASYNC;
+        }
+        std::string url = args[0], filepath = args[1];
+        return startAsyncWorker([this, url, filepath]() { return http_download(url, filepath); });
+    }
+
+private:
+    std::string root_;
+};
+
+static void testScript(vm::HttpStandIn& server, const std::string& dir) {
+    std::cout << "http.download with http.onProgress from a script" << std::endl;
+    const size_t size = 300000;
+    std::string blob = makeBlob(size, 4);
+    server.setFile("/apps/clock.dsb", blob, "\"c1\"");
+
+    std::string script = R"(
+var reports: 0;
+var last: 0;
+var total: 0;
+function onProgress(url: string, received: int, size: int): void {
+    assign reports reports + 1;
+    assign last received;
+    assign total size;
+}
+os.http.onProgress(onProgress);
+var result: os.http.download(")" + server.url("/apps/clock.dsb") + R"(", "/clock.dsb");
+os.console.print(`${result.status} ${result.bytes} ${result.crc32} ${last}/${total} ${reports > 0}`);
+)";
+    DownloadPlatform platform(dir);
+    compiler::BytecodeModule module = vm::compileScript(script);
+    vm::ValuePool pool(16 * 1024);
+    vm::VMState vm(module, pool, platform);
+    vm.reset();
+
+    // The VM parks on the download; progress callbacks run while it waits
+    vm::VMResult result = vm.execute(10000);
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (result == vm::VMResult::YIELD && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        platform.processAsyncCompletions();
+        result = vm.execute(10000);
+    }
+    CHECK(result == vm::VMResult::FINISHED, "script finishes: " << vm.getError());
+    std::string expected = "success " + std::to_string(size) + " " + hex(vm::crc32(0, blob.data(), blob.size())) +
+                           " " + std::to_string(size) + "/" + std::to_string(size) + " true";
+    CHECK(platform.output == expected, "output: " << platform.output);
+    CHECK(readFile(dir + "/clock.dsb") == blob, "file content");
+}
+
+int main() {
+    std::cout << "=== HTTP Download Test ===" << std::endl << std::endl;
+
+    std::string dir = (std::filesystem::temp_directory_path() / "dialos_http_download_test").string();
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+
+    vm::HttpStandIn server;
+    testCrc();
+    testWholeFile(server, dir);
+    testResume(server, dir);
+    testScript(server, dir);
+    std::filesystem::remove_all(dir);
+
+    return test::summary();
+}
@@ -0,0 +1,201 @@
+/**
+ * Idle Manager Test
+ *
+ * Checks the global next-wake computation (earliest deadline across
+ * sources, holds, light-sleep threshold, clock wrap), the wake handler
+ * that re-plans a shallow wait, and a tickless host loop: two schedulers
+ * with interval timers share a virtual clock, and the idle loop jumps it
+ * straight to each deadline as its simulated sleep. The loop should wake
+ * exactly once per deadline and spend the rest of the time asleep.
+ */
+
+#include "vm/idle_manager.h"
+#include "vm/vm_scheduler.h"
+#include "test_platform.h"
+#include "test_check.h"
+#include <algorithm>
+#include <iostream>
+
+using namespace dialos;
+
+static void testPlan() {
+    std::cout << "earliest deadline across sources" << std::endl;
+    vm::IdleManager idle(20);
+    vm::IdleManager::SourceId a = idle.addSource("a");
+    vm::IdleManager::SourceId b = idle.addSource("b");
+    CHECK(idle.getSourceName(b) == "b", "source name");
+
+    vm::IdleManager::Plan plan = idle.plan(0);
+    CHECK(plan.state == vm::PowerState::ACTIVE, "unreported sources count as busy");
+
+    idle.update(a, 0, 200);
+    idle.update(b, 10, 40);
+    plan = idle.plan(20);
+    CHECK(plan.state == vm::PowerState::LIGHT_SLEEP, "long wait allows light sleep");
+    CHECK(plan.sleepMs == 30, "sleep until b's deadline, got " << plan.sleepMs);
+    CHECK(plan.wakeSource == b, "b owns the earliest deadline");
+
+    plan = idle.plan(40);
+    CHECK(plan.state == vm::PowerState::IDLE && plan.sleepMs == 10, "short wait only idles");
+    CHECK(idle.plan(60).state == vm::PowerState::ACTIVE, "overdue deadline means work");
+
+    idle.update(b, 60, vm::IdleManager::NO_DEADLINE);
+    plan = idle.plan(60);
+    CHECK(plan.sleepMs == 140 && plan.wakeSource == a, "event-only source has no deadline");
+
+    idle.update(b, 60, vm::IdleManager::NO_DEADLINE, true);
+    plan = idle.plan(60);
+    CHECK(plan.state == vm::PowerState::IDLE && plan.sleepMs == 140, "hold keeps the system out of light sleep");
+
+    idle.update(b, 60, vm::IdleManager::NO_DEADLINE);
+    idle.setLightSleepEnabled(false);
+    CHECK(idle.plan(60).state == vm::PowerState::IDLE, "light sleep disabled");
+    idle.setLightSleepEnabled(true);
+
+    idle.removeSource(a);
+    plan = idle.plan(60);
+    CHECK(plan.state == vm::PowerState::LIGHT_SLEEP && plan.sleepMs == vm::IdleManager::NO_DEADLINE &&
+          plan.wakeSource == vm::IdleManager::INVALID_SOURCE, "nothing scheduled: sleep until woken");
+
+    idle.update(b, 0xFFFFFFF0u, 0x30);
+    plan = idle.plan(0x00000010u);
+    CHECK(plan.sleepMs == 0x10, "deadline across clock wrap, got " << plan.sleepMs);
+}
+
+static void testResidency() {
+    std::cout << "residency accounting" << std::endl;
+    vm::IdleManager idle(20);
+    vm::IdleManager::SourceId source = idle.addSource("vm");
+    idle.resetStats(0);
+
+    // 5 ms of work, then a 100 ms light sleep cut short by input after 60
+    idle.update(source, 5, 100);
+    vm::IdleManager::Plan plan = idle.idle(5, [](vm::PowerState state, uint32_t ms) {
+        CHECK(state == vm::PowerState::LIGHT_SLEEP && ms == 100, "sleep callback gets the plan");
+        return 60u;
+    });
+    CHECK(plan.state == vm::PowerState::LIGHT_SLEEP, "planned light sleep");
+
+    // 3 ms of work, then a short wait
+    idle.update(source, 68, 10);
+    idle.idle(68, [](vm::PowerState, uint32_t ms) { return ms; });
+
+    // Busy source: no sleep at all
+    idle.update(source, 80, 0);
+    bool slept = false;
+    plan = idle.idle(80, [&](vm::PowerState, uint32_t) { slept = true; return 0u; });
+    CHECK(plan.state == vm::PowerState::ACTIVE && !slept, "busy system does not sleep");
+
+    vm::IdleManager::Stats stats = idle.getStats();
+    CHECK(stats.residencyMs[static_cast<int>(vm::PowerState::ACTIVE)] == 10,
+          "active time between sleeps, got " << stats.residencyMs[static_cast<int>(vm::PowerState::ACTIVE)]);
+    CHECK(stats.residencyMs[static_cast<int>(vm::PowerState::LIGHT_SLEEP)] == 60, "light sleep time actually slept");
+    CHECK(stats.residencyMs[static_cast<int>(vm::PowerState::IDLE)] == 10, "idle time");
+    CHECK(stats.entries[static_cast<int>(vm::PowerState::LIGHT_SLEEP)] == 1 &&
+          stats.entries[static_cast<int>(vm::PowerState::IDLE)] == 1, "entry counts");
+    CHECK(stats.totalMs() == 80 && stats.percent(vm::PowerState::LIGHT_SLEEP) == 75, "percentages");
+
+    idle.resetStats(80);
+    CHECK(idle.getStats().totalMs() == 0, "stats reset");
+}
+
+static void testWakeHandler() {
+    std::cout << "released hold re-plans an idle wait" << std::endl;
+    vm::IdleManager idle(20);
+    vm::IdleManager::SourceId net = idle.addSource("net");
+    int wakes = 0;
+    idle.setWakeHandler([&]() { wakes++; });
+
+    idle.update(net, 0, vm::IdleManager::NO_DEADLINE, true);
+    idle.update(net, 0, vm::IdleManager::NO_DEADLINE, false);
+    CHECK(wakes == 0, "no wake while nobody sleeps");
+
+    idle.update(net, 0, vm::IdleManager::NO_DEADLINE, true);
+    vm::IdleManager::Plan plan = idle.idle(0, [&](vm::PowerState state, uint32_t) {
+        CHECK(state == vm::PowerState::IDLE, "hold forces a shallow wait");
+        idle.update(net, 2, 500, true);
+        CHECK(wakes == 0, "still held: keep waiting");
+        // The request completes on another task
+        idle.update(net, 5, 500, false);
+        return 5u;
+    });
+    CHECK(plan.state == vm::PowerState::IDLE, "idle plan");
+    CHECK(wakes == 1, "wait interrupted once, got " << wakes);
+    CHECK(idle.plan(5).state == vm::PowerState::LIGHT_SLEEP, "re-plan goes deeper");
+}
+
+static void testTicklessLoop() {
+    std::cout << "tickless loop over two schedulers" << std::endl;
+    uint32_t clock = 0;
+    const uint32_t RUN_MS = 1000;
+
+    vm::TestPlatform platformA, platformB;
+    platformA.sharedClock = &clock;
+    platformB.sharedClock = &clock;
+    compiler::BytecodeModule moduleA = vm::compileScript(
+        "var ticks: 0;\n"
+        "function onTick(): void { assign ticks ticks + 1; }\n"
+        "os.timer.setInterval(onTick, 100);\n");
+    compiler::BytecodeModule moduleB = vm::compileScript(
+        "var ticks: 0;\n"
+        "function onTick(): void { assign ticks ticks + 1; }\n"
+        "os.timer.setInterval(onTick, 250);\n");
+    vm::ValuePool poolA(4096), poolB(4096);
+    vm::VMState stateA(moduleA, poolA, platformA);
+    vm::VMState stateB(moduleB, poolB, platformB);
+
+    // One scheduler per "core", as on the device
+    vm::VMScheduler schedulerA(platformA), schedulerB(platformB);
+    vm::VMScheduler::TaskConfig config;
+    config.keepAlive = true;
+    schedulerA.add(stateA, config);
+    schedulerB.add(stateB, config);
+
+    vm::IdleManager idle;
+    vm::IdleManager::SourceId sourceA = idle.addSource("runtime0");
+    vm::IdleManager::SourceId sourceB = idle.addSource("runtime1");
+    idle.resetStats(clock);
+
+    // Simulated sleep: jump the virtual clock, never past the end of the run
+    vm::IdleManager::SleepFn sleep = [&](vm::PowerState, uint32_t ms) {
+        uint32_t slept = std::min(ms, RUN_MS - clock);
+        clock += slept;
+        return slept;
+    };
+
+    int wakeups = 0;
+    while (clock < RUN_MS) {
+        idle.update(sourceA, clock, schedulerA.tick());
+        idle.update(sourceB, clock, schedulerB.tick());
+        if (idle.idle(clock, sleep).state != vm::PowerState::ACTIVE) {
+            wakeups++;
+        }
+    }
+    // Run what fell due at the very end
+    schedulerA.tick();
+    schedulerB.tick();
+
+    CHECK(stateA.getGlobals().at("ticks").int32Val == 10, "100 ms interval fired 10 times");
+    CHECK(stateB.getGlobals().at("ticks").int32Val == 4, "250 ms interval fired 4 times");
+    // Distinct deadlines up to 1000: 100..1000 step 100, plus 250 and 750
+    CHECK(wakeups == 12, "one wakeup per deadline instead of per ms, got " << wakeups);
+
+    vm::IdleManager::Stats stats = idle.getStats();
+    CHECK(stats.totalMs() == RUN_MS, "all time accounted, got " << stats.totalMs());
+    CHECK(stats.residencyMs[static_cast<int>(vm::PowerState::LIGHT_SLEEP)] == RUN_MS,
+          "every gap spent in light sleep");
+    CHECK(stats.entries[static_cast<int>(vm::PowerState::LIGHT_SLEEP)] == 12, "light sleep entries");
+    std::cout << "  " << wakeups << " wakeups in " << RUN_MS << " ms, light sleep "
+              << stats.percent(vm::PowerState::LIGHT_SLEEP) << "%" << std::endl;
+}
+
+int main() {
+    std::cout << "=== Idle Manager Test ===" << std::endl << std::endl;
+
+    testPlan();
+    testResidency();
+    testWakeHandler();
+    testTicklessLoop();
+
+    return test::summary();
+}
@@ -0,0 +1,268 @@
+/**
+ * Image Codec and display.loadImage Test
+ *
+ * Round-trips pixels through the raw, RLE and QOI codecs, rejects broken
+ * data, checks the shared cache's hits and budget, and runs scripts that
+ * load images from a file, a data: string and a byte array and draw them
+ * (whole, as a region, keyed) into the headless framebuffer. Finally times
+ * an icon grid drawn from loaded images against the byte-array path.
+ */
+
+#include "headless_platform.h"
+#include "test_platform.h"
+#include "vm/image_cache.h"
+#include "vm/image_codec.h"
+#include "test_check.h"
+#include <chrono>
+#include <iostream>
+#include <map>
+#include <sstream>
+
+using namespace dialos;
+
+// A 32x32 icon: flat background, a filled square and a gradient stripe
+static std::vector<uint16_t> makeIcon() {
+    std::vector<uint16_t> pixels(32 * 32, 0x0000);
+    for (int y = 0; y < 32; y++) {
+        for (int x = 0; x < 32; x++) {
+            if (x >= 8 && x < 24 && y >= 8 && y < 24) {
+                pixels[y * 32 + x] = 0x07E0;
+            } else if (y == 30) {
+                pixels[y * 32 + x] = static_cast<uint16_t>(x << 11);
+            }
+        }
+    }
+    return pixels;
+}
+
+static std::string base64(const std::vector<uint8_t>& data) {
+    static const char* ALPHABET = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    std::string out;
+    for (size_t i = 0; i < data.size(); i += 3) {
+        uint32_t chunk = data[i] << 16;
+        if (i + 1 < data.size()) chunk |= data[i + 1] << 8;
+        if (i + 2 < data.size()) chunk |= data[i + 2];
+        out += ALPHABET[(chunk >> 18) & 63];
+        out += ALPHABET[(chunk >> 12) & 63];
+        out += i + 1 < data.size() ? ALPHABET[(chunk >> 6) & 63] : '=';
+        out += i + 2 < data.size() ? ALPHABET[chunk & 63] : '=';
+    }
+    return out;
+}
+
+static std::string byteArray(const std::vector<uint8_t>& data) {
+    std::ostringstream out;
+    out << "[";
+    for (size_t i = 0; i < data.size(); i++) {
+        out << (i ? ", " : "") << static_cast<int>(data[i]);
+    }
+    out << "]";
+    return out.str();
+}
+
+static void testCodecs() {
+    std::cout << "codecs" << std::endl;
+    std::vector<uint16_t> icon = makeIcon();
+    std::string error;
+
+    vm::Image raw;
+    std::vector<uint8_t> rawData = vm::image::encodeRaw(32, 32, icon.data());
+    CHECK(vm::image::decode(rawData.data(), rawData.size(), raw, error) && raw.pixels == icon, "raw: " << error);
+
+    vm::Image rle;
+    std::vector<uint8_t> rleData = vm::image::encodeRle(32, 32, icon.data());
+    CHECK(vm::image::decode(rleData.data(), rleData.size(), rle, error) && rle.pixels == icon, "RLE: " << error);
+    CHECK(rleData.size() * 5 < rawData.size(), "RLE shrinks flat art, " << rleData.size() << " bytes");
+    std::vector<uint16_t> noise(300);
+    for (size_t i = 0; i < noise.size(); i++) {
+        noise[i] = static_cast<uint16_t>(i * 7919 + (i % 3 == 0 ? 0 : i * i));
+    }
+    std::vector<uint8_t> noiseData = vm::image::encodeRle(20, 15, noise.data());
+    CHECK(vm::image::decode(noiseData.data(), noiseData.size(), rle, error) && rle.pixels == noise,
+          "RLE with literal runs: " << error);
+
+    // QOI from RGBA that is exactly representable in RGB565, with a hole
+    std::vector<uint8_t> rgba(32 * 32 * 4);
+    for (int i = 0; i < 32 * 32; i++) {
+        rgba[i * 4] = static_cast<uint8_t>((icon[i] >> 11) << 3);
+        rgba[i * 4 + 1] = static_cast<uint8_t>(((icon[i] >> 5) & 0x3F) << 2);
+        rgba[i * 4 + 2] = static_cast<uint8_t>((icon[i] & 0x1F) << 3);
+        rgba[i * 4 + 3] = i < 32 ? 0 : 255;
+    }
+    vm::Image qoi;
+    std::vector<uint8_t> qoiData = vm::image::encodeQoi(32, 32, rgba.data());
+    CHECK(vm::image::decode(qoiData.data(), qoiData.size(), qoi, error), "QOI: " << error);
+    CHECK(qoi.transparent == 0xF81F && qoi.pixels[0] == 0xF81F, "clear pixels become the key");
+    CHECK(std::equal(icon.begin() + 32, icon.end(), qoi.pixels.begin() + 32), "QOI colours");
+    CHECK(qoiData.size() < rawData.size() / 4, "QOI shrinks flat art, " << qoiData.size() << " bytes");
+
+    // Every prefix of valid data is rejected without reading past it
+    bool rejected = true;
+    for (const std::vector<uint8_t>* data : {&rawData, &rleData, &qoiData}) {
+        for (size_t size = 0; size + 1 < data->size(); size += 7) {
+            std::vector<uint8_t> prefix(data->begin(), data->begin() + size);
+            vm::Image out;
+            rejected = rejected && !vm::image::decode(prefix.data(), prefix.size(), out, error);
+        }
+    }
+    CHECK(rejected, "truncated data");
+    std::vector<uint8_t> huge = {'D', 'R', 'L', 'E', 0xFF, 0xFF, 0xFF, 0xFF};
+    CHECK(!vm::image::decode(huge.data(), huge.size(), raw, error) && !error.empty(), "oversized image");
+
+    std::vector<uint8_t> bytes;
+    CHECK(vm::image::decodeBase64(base64(qoiData), bytes) && bytes == qoiData, "base64 round trip");
+    CHECK(vm::image::decodeBase64("aGk\n=", bytes) && bytes == std::vector<uint8_t>({'h', 'i'}), "base64 padding");
+    CHECK(!vm::image::decodeBase64("a$b", bytes), "base64 garbage");
+}
+
+static void testCache() {
+    std::cout << "cache" << std::endl;
+    std::vector<uint16_t> icon = makeIcon();
+    std::vector<uint8_t> data = vm::image::encodeRle(32, 32, icon.data());
+    size_t imageBytes = sizeof(vm::Image) + 32 * 32 * 2;
+    vm::ImageCache cache(imageBytes * 2);
+    std::string error;
+
+    vm::ImageCache::ImagePtr first = cache.load("a", data.data(), data.size(), error);
+    vm::ImageCache::ImagePtr again = cache.load("a", data.data(), data.size(), error);
+    CHECK(first && first == again, "second load is the cached image");
+    CHECK(cache.getStats().decodes == 1 && cache.getStats().hits == 1, "one decode, one hit");
+
+    cache.load("b", data.data(), data.size(), error);
+    cache.load("c", data.data(), data.size(), error);
+    CHECK(cache.find("a") && !cache.find("b") && cache.find("c"), "held image kept, oldest unused one evicted");
+    first.reset();
+    again.reset();
+    cache.setBudget(0);
+    CHECK(!cache.find("a") && cache.getStats().bytes == 0, "nothing held, nothing kept");
+    CHECK(!cache.load("bad", data.data(), 5, error) && !error.empty(), "decode errors are reported");
+    CHECK(vm::ImageCache::dataKey(data.data(), data.size()) != vm::ImageCache::dataKey(data.data(), 9),
+          "data keys differ by content");
+}
+
+// Headless platform with a tiny in-memory filesystem
+class FilePlatform : public vm::HeadlessPlatform {
+public:
+    std::map<std::string, std::string> files;
+    std::map<int, std::string> open;
+    int reads = 0;
+
+    int file_size(const std::string& path) override {
+        auto it = files.find(path);
+        return it == files.end() ? -1 : static_cast<int>(it->second.size());
+    }
+    int file_open(const std::string& path, const std::string& /*mode*/) override {
+        if (!files.count(path)) {
+            return -1;
+        }
+        int handle = static_cast<int>(open.size()) + 1;
+        open[handle] = path;
+        return handle;
+    }
+    std::string file_read(int handle, int size) override {
+        reads++;
+        return files[open[handle]].substr(0, size);
+    }
+    void file_close(int handle) override { open.erase(handle); }
+};
+
+static void testScripts() {
+    std::cout << "display.loadImage and drawImage" << std::endl;
+    std::vector<uint16_t> icon = makeIcon();
+    std::vector<uint8_t> rle = vm::image::encodeRle(32, 32, icon.data());
+    std::vector<uint16_t> dot(4 * 4, 0xF800);
+    dot[0] = 0x001F;
+    std::vector<uint8_t> raw = vm::image::encodeRaw(4, 4, dot.data());
+
+    std::string source =
+        "var fromFile: os.display.loadImage(\"/icons/test.rle\");\n"
+        "var again: os.display.loadImage(\"/icons/test.rle\");\n"
+        "var fromData: os.display.loadImage(\"data:image/x-rle;base64," + base64(rle) + "\");\n"
+        "var fromArray: os.display.loadImage(" + byteArray(raw) + ");\n"
+        "var missing: os.display.loadImage(\"/icons/none.qoi\");\n"
+        "os.display.clear(65535);\n"
+        "os.display.drawImage(10, 10, fromFile);\n"
+        "os.display.drawImage(100, 10, fromData, 0);\n"
+        "os.display.drawImageRegion(50, 50, fromFile, 8, 8, 4, 4);\n"
+        "os.display.drawImage(-2, 200, fromArray);\n"
+        "os.display.drawImage(60, 60, missing);\n"
+        "var sizes: fromFile.width + fromArray.height;\n";
+    compiler::BytecodeModule module = vm::compileScript(source);
+
+    FilePlatform platform;
+    platform.files["/icons/test.rle"] = std::string(rle.begin(), rle.end());
+    vm::HeadlessResult result = vm::runHeadless(module, platform, vm::HeadlessOptions());
+    CHECK(result.status == vm::HeadlessResult::Status::IDLE, "script runs: " << result.error);
+    CHECK(platform.reads == 1, "the file is read once, then cached");
+
+    const vm::Framebuffer& fb = platform.getFramebuffer();
+    CHECK(fb.pixel(10, 10) == 0x0000 && fb.pixel(20, 20) == 0x07E0 && fb.pixel(42, 10) == 0xFFFF,
+          "whole image from a file");
+    CHECK(fb.pixel(100, 10) == 0xFFFF && fb.pixel(110, 20) == 0x07E0, "black keyed out of the data: image");
+    CHECK(fb.pixel(50, 50) == 0x07E0 && fb.pixel(53, 53) == 0x07E0 && fb.pixel(54, 54) == 0xFFFF,
+          "region of the image");
+    CHECK(fb.pixel(0, 200) == 0xF800 && fb.pixel(1, 203) == 0xF800 && fb.pixel(2, 200) == 0xFFFF,
+          "byte array image clipped at the edge");
+    CHECK(fb.pixel(60, 60) == 0xFFFF, "a failed load draws nothing");
+    CHECK(platform.drawCalls == 5, "one call per image drawn, got " << platform.drawCalls);
+}
+
+static double msPerRun(int runs, const std::function<void()>& step) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < runs; i++) {
+        step();
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count() / 1000.0 / runs;
+}
+
+static void testIconGrid() {
+    std::cout << "icon grid redraw" << std::endl;
+    std::vector<uint16_t> icon = makeIcon();
+    std::string data = byteArray(vm::image::encodeRaw(32, 32, icon.data()));
+    // 6 x 6 grid of 32x32 icons, redrawn 200 times
+    std::string grid =
+        "var row: 0;\n"
+        "var frame: 0;\n"
+        "while (frame < 200) {\n"
+        "    assign row 0;\n"
+        "    while (row < 36) {\n"
+        "        os.display.drawImage(8 + (row % 6) * 38, 8 + (row / 6) * 38, ICON);\n"
+        "        assign row row + 1;\n"
+        "    }\n"
+        "    assign frame frame + 1;\n"
+        "}\n";
+    auto withIcon = [&grid](const std::string& prelude, const std::string& icon) {
+        std::string source = grid;
+        source.replace(source.find("ICON"), 4, icon);
+        return vm::compileScript(prelude + source);
+    };
+    compiler::BytecodeModule loaded = withIcon("var icon: os.display.loadImage(" + data + ");\n", "icon");
+    compiler::BytecodeModule arrays = withIcon("var icon: " + data + ";\n", "icon");
+    // A 2KB icon as an array of boxed bytes doesn't fit the default heap
+    loaded.metadata.heapSize = arrays.metadata.heapSize = 1024 * 1024;
+
+    vm::HeadlessOptions options;
+    options.sliceInstructions = 100000;
+    vm::HeadlessPlatform a, b;
+    double loadedMs = msPerRun(3, [&]() { vm::runHeadless(loaded, a, options); }) / 200;
+    double arrayMs = msPerRun(3, [&]() { vm::runHeadless(arrays, b, options); }) / 200;
+    bool same = true;
+    for (int i = 0; i < 240 * 240; i++) {
+        same = same && a.getFramebuffer().pixels()[i] == b.getFramebuffer().pixels()[i];
+    }
+    CHECK(same && a.drawCalls == b.drawCalls && a.drawCalls == 3 * 200 * 36, "both paths draw the same grid");
+    std::cout << "  36 icons: " << loadedMs << " ms per frame from loaded images, " << arrayMs
+              << " ms from byte arrays" << std::endl;
+}
+
+int main() {
+    std::cout << "=== Image Test ===" << std::endl << std::endl;
+
+    testCodecs();
+    testCache();
+    testScripts();
+    testIconGrid();
+
+    return test::summary();
+}
@@ -0,0 +1,324 @@
+/**
+ * IPC Bus Test
+ *
+ * Checks the bus on its own (routing, mailbox and arena back-pressure, ring
+ * wrap-around, slot reclaim), under concurrent senders, and end to end: two
+ * applets exchange os.ipc messages through ipc.onMessage, first on one
+ * scheduler and then on one scheduler thread each, like the firmware's
+ * runtime-per-core setup. Finally, the string collection that runs after
+ * every delivered message.
+ */
+
+#include "vm/ipc_bus.h"
+#include "vm/vm_scheduler.h"
+#include "test_platform.h"
+#include "test_check.h"
+#include <atomic>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace dialos;
+
+static vm::IpcBus::SendResult sendText(vm::IpcBus& bus, const std::string& from, const std::string& to,
+                                       const std::string& text) {
+    return bus.send(from, to, text.data(), text.size());
+}
+
+static std::string text(const vm::IpcBus::Message& message) {
+    return std::string(message.data(), message.size());
+}
+
+static void testRouting() {
+    std::cout << "routing and mailbox limits" << std::endl;
+    vm::IpcBus bus(256, 2);
+    int wakes = 0;
+    CHECK(bus.join("a", nullptr), "join a");
+    CHECK(bus.join("b", [&wakes]() { wakes++; }), "join b");
+    CHECK(!bus.join("b", nullptr), "duplicate id rejected");
+
+    CHECK(sendText(bus, "a", "c", "x") == vm::IpcBus::SendResult::NO_SUCH_APP, "unknown receiver");
+    CHECK(sendText(bus, "a", "b", "one") == vm::IpcBus::SendResult::OK, "first send");
+    CHECK(sendText(bus, "a", "b", "two") == vm::IpcBus::SendResult::OK, "second send");
+    CHECK(sendText(bus, "a", "b", "three") == vm::IpcBus::SendResult::MAILBOX_FULL, "mailbox full");
+    CHECK(wakes == 2, "receiver woken per delivered message, got " << wakes);
+    CHECK(bus.pending("b") == 2 && bus.pending("a") == 0, "pending counts");
+
+    vm::IpcBus::Message message;
+    CHECK(bus.receive("b", message) && text(message) == "one" && message.sender() == "a", "FIFO, sender kept");
+    CHECK(bus.receive("b", message) && text(message) == "two", "second message");
+    CHECK(!bus.receive("b", message), "mailbox drained");
+    CHECK(text(message) == "two", "failed receive leaves the held message alone");
+
+    CHECK(bus.join("c", nullptr), "join c");
+    CHECK(bus.broadcast("a", "all", 3) == 2, "broadcast skips the sender");
+    CHECK(bus.pending("b") == 1 && bus.pending("c") == 1 && bus.pending("a") == 0, "broadcast fan-out");
+
+    bus.leave("c");
+    CHECK(sendText(bus, "a", "c", "x") == vm::IpcBus::SendResult::NO_SUCH_APP, "left app unreachable");
+}
+
+static void testArena() {
+    std::cout << "arena reuse and wrap-around" << std::endl;
+    vm::IpcBus bus(32, 8);
+    bus.join("a", nullptr);
+    bus.join("b", nullptr);
+
+    CHECK(sendText(bus, "a", "b", std::string(40, 'x')) == vm::IpcBus::SendResult::NO_SPACE, "larger than the arena");
+    CHECK(sendText(bus, "a", "b", std::string(20, 'x')) == vm::IpcBus::SendResult::OK, "fits");
+    CHECK(sendText(bus, "a", "b", std::string(20, 'y')) == vm::IpcBus::SendResult::NO_SPACE, "arena full");
+    {
+        vm::IpcBus::Message message;
+        CHECK(bus.receive("b", message) && message.size() == 20, "receive");
+        CHECK(bus.arenaUsed() == 20, "slot held while the message lives");
+    }
+    CHECK(bus.arenaUsed() == 0, "slot reclaimed when the message is dropped");
+
+    // Two 12-byte messages, free the first, then one that only fits at the start
+    CHECK(sendText(bus, "a", "b", "AAAAAAAAAAAA") == vm::IpcBus::SendResult::OK, "x");
+    CHECK(sendText(bus, "a", "b", "BBBBBBBBBBBB") == vm::IpcBus::SendResult::OK, "y");
+    vm::IpcBus::Message first;
+    bus.receive("b", first);
+    CHECK(text(first) == "AAAAAAAAAAAA", "x intact");
+    first = vm::IpcBus::Message();
+    CHECK(sendText(bus, "a", "b", "CCCCCCCCCC") == vm::IpcBus::SendResult::OK, "z wraps to the start");
+    vm::IpcBus::Message second, third;
+    CHECK(bus.receive("b", second) && text(second) == "BBBBBBBBBBBB", "y intact");
+    CHECK(bus.receive("b", third) && text(third) == "CCCCCCCCCC", "wrapped z intact");
+    CHECK(third.data() < second.data(), "z was placed before y");
+    second = vm::IpcBus::Message();
+    third = vm::IpcBus::Message();
+    CHECK(bus.arenaUsed() == 0, "padding reclaimed with its neighbours");
+
+    CHECK(bus.send("a", "b", "", 0) == vm::IpcBus::SendResult::OK, "empty message");
+    sendText(bus, "a", "b", "unread");
+    bus.leave("b");
+    CHECK(bus.arenaUsed() == 0, "leaving frees unread messages");
+}
+
+static void testConcurrentSenders() {
+    std::cout << "concurrent senders" << std::endl;
+    const int SENDERS = 4;
+    const int PER_SENDER = 20000;
+    vm::IpcBus bus(512, 16);
+    bus.join("sink", nullptr);
+
+    std::atomic<long> rejected(0);
+    std::vector<std::thread> senders;
+    for (int s = 0; s < SENDERS; s++) {
+        std::string id = "s" + std::to_string(s);
+        bus.join(id, nullptr);
+        senders.push_back(std::thread([&bus, &rejected, id]() {
+            for (int seq = 0; seq < PER_SENDER; seq++) {
+                // Variable sizes so slots wrap at arbitrary offsets
+                std::string payload = std::to_string(seq) + std::string(seq % 37, '.');
+                while (bus.send(id, "sink", payload.data(), payload.size()) != vm::IpcBus::SendResult::OK) {
+                    rejected++;
+                    std::this_thread::yield();
+                }
+            }
+        }));
+    }
+
+    std::vector<int> next(SENDERS, 0);
+    bool intact = true;
+    int received = 0;
+    while (received < SENDERS * PER_SENDER) {
+        vm::IpcBus::Message message;
+        if (!bus.receive("sink", message)) {
+            std::this_thread::yield();
+            continue;
+        }
+        int sender = std::stoi(message.sender().substr(1));
+        std::string expected = std::to_string(next[sender]) + std::string(next[sender] % 37, '.');
+        if (text(message) != expected) {
+            intact = false;
+        }
+        next[sender]++;
+        received++;
+    }
+    for (auto& sender : senders) {
+        sender.join();
+    }
+
+    CHECK(intact, "every message intact and in per-sender order");
+    CHECK(bus.arenaUsed() == 0, "arena empty afterwards, used " << bus.arenaUsed());
+    std::cout << "  " << received << " messages, senders were pushed back " << rejected.load()
+              << " times" << std::endl;
+}
+
+static const int MESSAGES = 50;
+
+static const char* PING_SCRIPT =
+    "var sent: 0;\n"
+    "var rejected: 0;\n"
+    "var replies: 0;\n"
+    "function onMessage(msg: string, from: string): void {\n"
+    "    if (from = \"pong\") {\n"
+    "        if (msg = \"hello\") {\n"
+    "            assign replies replies + 1;\n"
+    "        }\n"
+    "    }\n"
+    "}\n"
+    "os.ipc.onMessage(onMessage);\n"
+    "while (sent < 50) {\n"
+    "    if (os.ipc.send(\"pong\", \"hello\")) {\n"
+    "        assign sent sent + 1;\n"
+    "    } else {\n"
+    "        assign rejected rejected + 1;\n"
+    "    }\n"
+    "}\n";
+
+static const char* PONG_SCRIPT =
+    "var received: 0;\n"
+    "var echoed: 0;\n"
+    "function onMessage(msg: string, from: string): void {\n"
+    "    assign received received + 1;\n"
+    "    if (os.ipc.send(from, msg)) {\n"
+    "        assign echoed echoed + 1;\n"
+    "    }\n"
+    "}\n"
+    "os.ipc.onMessage(onMessage);\n";
+
+// One applet: module, heap, platform and VM
+struct Applet {
+    vm::TestPlatform platform;
+    compiler::BytecodeModule module;
+    vm::ValuePool pool;
+    vm::VMState state;
+
+    Applet(const char* source)
+        : module(vm::compileScript(source)), pool(8192), state(module, pool, platform) {}
+
+    int global(const char* name) const { return state.getGlobals().at(name).int32Val; }
+};
+
+static vm::VMScheduler::TaskConfig keepAlive() {
+    vm::VMScheduler::TaskConfig config;
+    config.keepAlive = true;
+    return config;
+}
+
+static void testPingPong() {
+    std::cout << "applets exchange messages on one scheduler" << std::endl;
+    vm::IpcBus bus(1024, 8);
+    Applet ping(PING_SCRIPT);
+    Applet pong(PONG_SCRIPT);
+    CHECK(ping.platform.attachIpc(&bus, "ping"), "ping joins");
+    CHECK(pong.platform.attachIpc(&bus, "pong"), "pong joins");
+
+    vm::VMScheduler scheduler(ping.platform);
+    scheduler.add(ping.state, keepAlive());
+    scheduler.add(pong.state, keepAlive());
+    int passes = 0;
+    while (scheduler.tick() == 0 && passes < 10000) {
+        passes++;
+    }
+
+    CHECK(!ping.state.hasError() && !pong.state.hasError(), "no VM error: " << ping.state.getError() << pong.state.getError());
+    CHECK(ping.global("sent") == MESSAGES, "ping sent all, got " << ping.global("sent"));
+    CHECK(pong.global("received") == MESSAGES, "pong received all, got " << pong.global("received"));
+    CHECK(pong.global("echoed") == MESSAGES, "pong echoed all, got " << pong.global("echoed"));
+    CHECK(ping.global("replies") == MESSAGES, "ping got every echo, got " << ping.global("replies"));
+    CHECK(ping.global("rejected") > 0, "full mailbox pushed back on the sender");
+    CHECK(bus.arenaUsed() == 0, "no slot leaked");
+    std::cout << "  " << passes << " passes, " << ping.global("rejected") << " rejected sends" << std::endl;
+}
+
+static void testPingPongThreads() {
+    std::cout << "applets exchange messages across threads" << std::endl;
+    vm::IpcBus bus(1024, 8);
+    Applet ping(PING_SCRIPT);
+    Applet pong(PONG_SCRIPT);
+    ping.platform.attachIpc(&bus, "ping");
+    pong.platform.attachIpc(&bus, "pong");
+
+    std::atomic<bool> done(false);
+    std::thread pongThread([&]() {
+        vm::VMScheduler scheduler(pong.platform);
+        scheduler.add(pong.state, keepAlive());
+        while (!done.load()) {
+            scheduler.tick();
+            std::this_thread::yield();
+        }
+    });
+
+    // Run until ping has sent everything and pong has taken it all
+    vm::VMScheduler scheduler(ping.platform);
+    scheduler.add(ping.state, keepAlive());
+    for (int pass = 0; pass < 1000000; pass++) {
+        scheduler.tick();
+        if (ping.state.hasError() || (ping.global("sent") == MESSAGES && bus.pending("pong") == 0)) {
+            break;
+        }
+        std::this_thread::yield();
+    }
+    done = true;
+    pongThread.join();
+    // Collect the last echoes
+    while (bus.pending("ping") > 0 && !ping.state.hasError()) {
+        scheduler.tick();
+    }
+
+    // Echoes are fire-and-forget: the ones that found ping's mailbox full
+    // while ping was busy sending were refused, never half-delivered
+    CHECK(!ping.state.hasError() && !pong.state.hasError(), "no VM error: " << ping.state.getError() << pong.state.getError());
+    CHECK(ping.global("sent") == MESSAGES && pong.global("received") == MESSAGES, "all delivered");
+    CHECK(ping.global("replies") == pong.global("echoed"), "every accepted echo arrived, "
+          << ping.global("replies") << " of " << pong.global("echoed"));
+    std::cout << "  " << pong.global("echoed") << " echoes accepted, "
+              << MESSAGES - pong.global("echoed") << " refused" << std::endl;
+    CHECK(bus.arenaUsed() == 0, "no slot leaked");
+}
+
+// Strings reachable through a cyclic object and an array survive every
+// collection; message temporaries don't
+static void testStringCollection() {
+    std::cout << "strings collected between callbacks" << std::endl;
+    Applet app("class Node {\n"
+               "    name: string;\n"
+               "    next: Node;\n"
+               "    constructor(name: string) {\n"
+               "        assign this.name name;\n"
+               "    }\n"
+               "}\n"
+               "var head: Node(\"kept\" + \"-field\");\n"
+               "assign head.next head;\n"
+               "var items: [head, \"kept\" + \"-item\"];\n");
+    app.state.reset();
+    CHECK(app.state.execute(1000) == vm::VMResult::FINISHED, "script finishes: " << app.state.getError());
+    app.state.collectStrings();
+    size_t settled = app.pool.getAllocated();
+
+    for (int pass = 0; pass < 3; pass++) {
+        for (int i = 0; i < 20; i++) {
+            std::string text = "message " + std::to_string(pass * 100 + i);
+            app.state.makeString(text.data(), text.size());
+        }
+        CHECK(app.pool.getAllocated() > settled, "temporaries allocated");
+        app.state.collectStrings();
+        CHECK(app.pool.getAllocated() == settled, "pass " << pass << ": temporaries freed, "
+              << app.pool.getAllocated() << " bytes in use, expected " << settled);
+    }
+    const vm::Value& head = app.state.getGlobals().at("head");
+    const vm::Value& items = app.state.getGlobals().at("items");
+    CHECK(head.isObject() && head.objVal->fields.at("name").toString() == "kept-field", "field string kept");
+    CHECK(items.isArray() && items.arrayVal->elements[1].toString() == "kept-item", "array string kept");
+    std::string again = "kept-item";
+    vm::Value interned = app.state.makeString(again.data(), again.size());
+    CHECK(interned.stringVal == items.arrayVal->elements[1].stringVal, "kept string still interned");
+}
+
+int main() {
+    std::cout << "=== IPC Bus Test ===" << std::endl << std::endl;
+
+    testRouting();
+    testArena();
+    testConcurrentSenders();
+    testPingPong();
+    testPingPongThreads();
+    testStringCollection();
+
+    return test::summary();
+}
@@ -0,0 +1,197 @@
+/**
+ * JSON Test
+ *
+ * Parses documents straight into pool values (nesting, escapes, numbers,
+ * malformed input, the depth limit), round-trips them through stringify,
+ * and runs a script that reads a platform's JSON answer with json.parse
+ * and serialises one of its own objects. Finally times parsing a large
+ * document.
+ */
+
+#include "test_platform.h"
+#include "vm/json.h"
+#include "vm/vm_core.h"
+#include "test_check.h"
+#include <chrono>
+#include <iostream>
+
+using namespace dialos;
+
+static bool parse(const std::string& text, vm::ValuePool& pool, vm::Value& out, std::string& error) {
+    return vm::json::parse(text.data(), text.size(), pool, out, error);
+}
+
+static std::string roundTrip(const std::string& text) {
+    vm::ValuePool pool(64 * 1024);
+    vm::Value value;
+    std::string error;
+    std::string out;
+    if (!parse(text, pool, value, error)) {
+        return "error: " + error;
+    }
+    vm::json::stringify(value, out);
+    return out;
+}
+
+static void testParse() {
+    std::cout << "parse" << std::endl;
+    vm::ValuePool pool(64 * 1024);
+    vm::Value value;
+    std::string error;
+
+    CHECK(parse(" {\"ssid\": \"home\", \"rssi\": -61, \"secure\": true, \"channels\": [1, 6, 11], \"ip\": null} ",
+                pool, value, error), error);
+    CHECK(value.isObject() && value.objVal->fields.size() == 5, "object with five members");
+    if (value.isObject()) {
+        auto& fields = value.objVal->fields;
+        CHECK(fields["ssid"].isString() && *fields["ssid"].stringVal == "home", "string member");
+        CHECK(fields["rssi"].isInt32() && fields["rssi"].int32Val == -61, "integer member");
+        CHECK(fields["secure"].isBool() && fields["secure"].boolVal, "bool member");
+        CHECK(fields["ip"].isNull(), "null member");
+        CHECK(fields["channels"].isArray() && fields["channels"].arrayVal->elements.size() == 3 &&
+              fields["channels"].arrayVal->elements[2].int32Val == 11, "array member");
+    }
+
+    CHECK(parse("[2147483647, 2147483648, 1.5, -2e3, 0]", pool, value, error), error);
+    if (value.isArray() && value.arrayVal->elements.size() == 5) {
+        const auto& numbers = value.arrayVal->elements;
+        CHECK(numbers[0].isInt32() && numbers[0].int32Val == 2147483647, "int32 max stays an integer");
+        CHECK(numbers[1].isFloat32(), "past int32 becomes a float");
+        CHECK(numbers[2].isFloat32() && numbers[2].float32Val == 1.5f, "fraction");
+        CHECK(numbers[3].isFloat32() && numbers[3].float32Val == -2000.0f, "exponent");
+        CHECK(numbers[4].isInt32() && numbers[4].int32Val == 0, "zero");
+    } else {
+        CHECK(false, "array of five numbers");
+    }
+
+    CHECK(parse("\"tab\\there \\\"q\\\" \\u00e9 \\ud83d\\ude00 \\/\"", pool, value, error), error);
+    CHECK(value.isString() && *value.stringVal == "tab\there \"q\" \xc3\xa9 \xf0\x9f\x98\x80 /", "escapes and UTF-8");
+
+    const char* broken[] = {"", "{", "[1,]", "{\"a\" 1}", "{a: 1}", "tru", "01", "1.", "\"open", "\"a\nb\"",
+                            "[1] 2", "\"\\x\"", "-", "{\"a\":1,}"};
+    for (const char* text : broken) {
+        CHECK(!parse(text, pool, value, error) && !error.empty(), "rejects '" << text << "'");
+    }
+    CHECK(!parse("{\"a\":}", pool, value, error) && error.find("byte 5") != std::string::npos,
+          "error names the offset: " << error);
+
+    std::string deep(vm::json::MAX_DEPTH, '[');
+    deep += std::string(vm::json::MAX_DEPTH, ']');
+    CHECK(parse(deep, pool, value, error), "MAX_DEPTH levels parse: " << error);
+    CHECK(!parse("[" + deep + "]", pool, value, error), "one more level is rejected");
+
+    vm::ValuePool tiny(200);
+    CHECK(!parse("[[1],[2],[3],[4],[5],[6],[7],[8]]", tiny, value, error) && error.find("memory") != std::string::npos,
+          "out of heap reported: " << error);
+}
+
+static void testStringify() {
+    std::cout << "stringify" << std::endl;
+    const char* docs[] = {
+        "{\"a\":[1,2,{\"b\":null}],\"c\":\"x\\\"y\\n\",\"d\":false}",
+        "[]",
+        "{}",
+        "[-1,0.25,\"\\u0001\"]",
+    };
+    for (const char* doc : docs) {
+        CHECK(roundTrip(doc) == doc, "round trip of " << doc << ": " << roundTrip(doc));
+    }
+    CHECK(roundTrip("{ \"b\" : 1 , \"a\" : [ ] }") == "{\"a\":[],\"b\":1}", "compact, keys sorted");
+
+    vm::ValuePool pool(4096);
+    vm::Object* self = pool.allocateObject();
+    self->fields["me"] = vm::Value::Object(self);
+    std::string out;
+    CHECK(!vm::json::stringify(vm::Value::Object(self), out), "self-reference is refused");
+}
+
+// Answers wifi.scan the way the platforms do, in JSON
+class ScanPlatform : public vm::TestPlatform {
+public:
+    std::string wifi_scan() override {
+        return "[{\"ssid\":\"home\",\"rssi\":-61,\"secure\":true},"
+               "{\"ssid\":\"cafe \\\"42\\\"\",\"rssi\":-80,\"secure\":false}]";
+    }
+};
+
+static const char* SCRIPT = R"(
+class Settings {
+    name: string;
+    volume: int;
+    constructor(name: string, volume: int) {
+        assign this.name name;
+        assign this.volume volume;
+    }
+}
+var aps: os.json.parse(os.wifi.scan());
+var i: 0;
+while (i < aps.length) {
+    var ap: aps[i];
+    if (ap.secure) {
+        os.console.print(`${ap.ssid} ${ap.rssi} locked|`);
+    } else {
+        os.console.print(`${ap.ssid} ${ap.rssi} open|`);
+    }
+    assign i i + 1;
+}
+var settings: Settings("dial", 7);
+var text: os.json.stringify(settings);
+os.console.print(text);
+var back: os.json.parse(text);
+os.console.print(`|${back.volume + 1}|`);
+os.console.print(os.json.parse("not json"));
+)";
+
+static void testScript() {
+    std::cout << "json.parse / json.stringify from a script" << std::endl;
+    ScanPlatform platform;
+    compiler::BytecodeModule module = vm::compileScript(SCRIPT);
+    vm::ValuePool pool(16 * 1024);
+    vm::VMState vm(module, pool, platform);
+    vm.reset();
+    vm::VMResult result = vm.execute(100000);
+    CHECK(result == vm::VMResult::FINISHED, "script finishes: " << vm.getError());
+    const std::string expected = "home -61 locked|cafe \"42\" -80 open|{\"name\":\"dial\",\"volume\":7}|8|";
+    CHECK(platform.output.compare(0, expected.size(), expected) == 0, "output: " << platform.output);
+    CHECK(platform.output.find("json.parse:") != std::string::npos, "bad text warns: " << platform.output);
+}
+
+static void testThroughput() {
+    std::cout << "throughput" << std::endl;
+    std::string doc = "[";
+    for (int i = 0; i < 500; i++) {
+        if (i > 0) {
+            doc += ",";
+        }
+        doc += "{\"id\":" + std::to_string(i) + ",\"name\":\"App " + std::to_string(i) +
+               "\",\"version\":\"1.0." + std::to_string(i % 7) + "\",\"size\":" + std::to_string(1000 + i * 3) +
+               ",\"tags\":[\"tools\",\"clock\"],\"rating\":4.5}";
+    }
+    doc += "]";
+
+    const int runs = 20;
+    auto start = std::chrono::steady_clock::now();
+    size_t elements = 0;
+    for (int run = 0; run < runs; run++) {
+        vm::ValuePool pool(1024 * 1024);
+        vm::Value value;
+        std::string error;
+        CHECK(parse(doc, pool, value, error), error);
+        elements = value.isArray() ? value.arrayVal->elements.size() : 0;
+    }
+    double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / runs;
+    CHECK(elements == 500, "all records parsed");
+    std::cout << "  " << doc.size() << " bytes, 500 records: " << static_cast<int>(us) << " us per parse ("
+              << static_cast<int>(doc.size() / us) << " MB/s)" << std::endl;
+}
+
+int main() {
+    std::cout << "=== JSON Test ===" << std::endl << std::endl;
+
+    testParse();
+    testStringify();
+    testScript();
+    testThroughput();
+
+    return test::summary();
+}
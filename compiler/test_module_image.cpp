@@ -0,0 +1,110 @@
+/**
+ * Built-in Module Image Test
+ *
+ * Checks that the constexpr ModuleImage descriptors generated into
+ * vm_builtin_applets.h match what BytecodeModule::deserialize produces for
+ * the same blob, that a VM started from the image behaves identically, and
+ * reports applet launch time for both paths.
+ */
+
+#include "vm/vm_core.h"
+#include "vm/module_image.h"
+#include "test_platform.h"
+#include "../src/vm_builtin_applets.h"
+#include "test_check.h"
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+using namespace dialos;
+
+static void compareTables(const compiler::ModuleImage& image, const compiler::BytecodeModule& module) {
+    CHECK(image.heapSize == module.metadata.heapSize, "heap size");
+    CHECK(image.appName.str() == module.metadata.appName, "app name");
+    CHECK(image.mainEntryPoint == module.mainEntryPoint, "main entry point");
+    CHECK(image.codeSize == module.code.size(), "code size");
+    CHECK(std::vector<uint8_t>(image.code, image.code + image.codeSize) == module.code, "code bytes");
+
+    CHECK(image.constantCount == module.constants.size(), "constant count");
+    for (size_t i = 0; i < image.constantCount && i < module.constants.size(); i++) {
+        CHECK(image.constants[i].str() == module.constants[i], "constant " << i);
+    }
+    CHECK(image.globalCount == module.globals.size(), "global count");
+    for (size_t i = 0; i < image.globalCount && i < module.globals.size(); i++) {
+        CHECK(image.globals[i].str() == module.globals[i], "global " << i);
+    }
+    CHECK(image.functionCount == module.functions.size(), "function count");
+    for (size_t i = 0; i < image.functionCount && i < module.functions.size(); i++) {
+        CHECK(image.functions[i].name.str() == module.functions[i], "function name " << i);
+        CHECK(image.functions[i].entryPoint == module.functionEntryPoints[i], "function entry " << i);
+        CHECK(image.functions[i].paramCount == module.functionParamCounts[i], "function params " << i);
+    }
+}
+
+// Run a VM until it finishes (or a fixed budget runs out) and return its console output
+static std::string runToCompletion(vm::VMState& vm, vm::TestPlatform& platform) {
+    vm.reset();
+    for (int slice = 0; slice < 200 && vm.isRunning(); slice++) {
+        vm::VMResult result = vm.execute(100);
+        if (result == vm::VMResult::FINISHED || result == vm::VMResult::ERROR) {
+            break;
+        }
+        platform.now += 100;
+    }
+    return platform.output + (vm.hasError() ? "error: " + vm.getError() : "");
+}
+
+int main() {
+    std::cout << "=== Built-in Module Image Test ===" << std::endl << std::endl;
+
+    const int launches = 2000;
+
+    for (int i = 0; i < BUILTIN_APPLET_REGISTRY_SIZE; i++) {
+        const VMApplet& applet = BUILTIN_APPLET_REGISTRY[i];
+        std::cout << applet.name << " (" << applet.bytecodeSize << " bytes)" << std::endl;
+
+        std::vector<uint8_t> blob(applet.bytecode, applet.bytecode + applet.bytecodeSize);
+        compiler::BytecodeModule module = compiler::BytecodeModule::deserialize(blob);
+        compareTables(*applet.module, module);
+
+        // Same program, same observable behaviour
+        vm::TestPlatform fromFile;
+        vm::ValuePool filePool(module.metadata.heapSize);
+        vm::VMState fileVM(module, filePool, fromFile);
+        std::string expected = runToCompletion(fileVM, fromFile);
+
+        vm::TestPlatform fromImage;
+        vm::ValuePool imagePool(applet.module->heapSize);
+        vm::VMState imageVM(*applet.module, imagePool, fromImage);
+        std::string actual = runToCompletion(imageVM, fromImage);
+
+        CHECK(expected == actual, "output differs: '" << expected << "' vs '" << actual << "'");
+        CHECK(fromFile.drawCalls == fromImage.drawCalls, "draw call count differs");
+
+        // Launch time: deserialize + VM construction vs VM construction from the image
+        typedef std::chrono::steady_clock Clock;
+        vm::TestPlatform platform;
+
+        Clock::time_point start = Clock::now();
+        for (int n = 0; n < launches; n++) {
+            compiler::BytecodeModule m = compiler::BytecodeModule::deserialize(blob);
+            vm::ValuePool pool(m.metadata.heapSize);
+            vm::VMState vm(m, pool, platform);
+            vm.reset();
+        }
+        double deserializeUs = std::chrono::duration<double, std::micro>(Clock::now() - start).count() / launches;
+
+        start = Clock::now();
+        for (int n = 0; n < launches; n++) {
+            vm::ValuePool pool(applet.module->heapSize);
+            vm::VMState vm(*applet.module, pool, platform);
+            vm.reset();
+        }
+        double imageUs = std::chrono::duration<double, std::micro>(Clock::now() - start).count() / launches;
+
+        std::cout << "  launch (deserialize): " << deserializeUs << " us" << std::endl;
+        std::cout << "  launch (flash image): " << imageUs << " us" << std::endl;
+    }
+
+    return test::summary();
+}
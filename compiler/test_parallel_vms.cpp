@@ -0,0 +1,169 @@
+/**
+ * Parallel VM Stress Test
+ *
+ * Runs N independent VMs, each with its own platform, heap and module, on
+ * one thread and then on N threads (one VMScheduler per thread, as the
+ * firmware does with one runtime per core). All VMs draw to one shared
+ * "display" guarded by a lock that platforms batch per scheduler slice.
+ * Checks that results are identical and no draw is lost, and reports the
+ * wall-clock scaling.
+ */
+
+#include "vm/vm_scheduler.h"
+#include "test_platform.h"
+#include "test_check.h"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace dialos;
+
+static const int ITERATIONS = 20000;
+
+// Hardware shared by every VM, whichever thread it runs on
+struct SharedDisplay {
+    std::mutex mutex;
+    long draws = 0;           // Guarded by mutex
+    long acquisitions = 0;    // Guarded by mutex
+};
+
+// Takes the display lock on the first draw of a slice and holds it until
+// endSlice(), like ESP32Platform
+class SharedDisplayPlatform : public vm::TestPlatform {
+public:
+    explicit SharedDisplayPlatform(SharedDisplay& display) : display_(display) {}
+
+    void beginSlice() override { inSlice_ = true; }
+    void endSlice() override {
+        inSlice_ = false;
+        if (held_) {
+            held_ = false;
+            display_.mutex.unlock();
+        }
+    }
+
+    void display_drawPixel(int /*x*/, int /*y*/, uint32_t /*color*/) override {
+        if (!held_) {
+            display_.mutex.lock();
+            display_.acquisitions++;
+            held_ = true;
+        }
+        display_.draws++;
+        if (!inSlice_) {
+            held_ = false;
+            display_.mutex.unlock();
+        }
+    }
+
+private:
+    SharedDisplay& display_;
+    bool inSlice_ = false;
+    bool held_ = false;
+};
+
+// One VM with its own module, heap and platform context
+struct Worker {
+    std::unique_ptr<vm::ValuePool> pool;
+    SharedDisplayPlatform platform;
+    std::unique_ptr<vm::VMState> vm;
+
+    Worker(const compiler::BytecodeModule& module, SharedDisplay& display)
+        : platform(display) {
+        pool.reset(new vm::ValuePool(4096));
+        vm.reset(new vm::VMState(module, *pool, platform));
+    }
+};
+
+// Run a group of VMs to completion on the calling thread
+static void runGroup(const std::vector<Worker*>& group) {
+    if (group.empty()) {
+        return;
+    }
+    vm::VMScheduler scheduler(group.front()->platform);
+    for (Worker* worker : group) {
+        scheduler.add(*worker->vm, vm::VMScheduler::TaskConfig());
+    }
+    while (scheduler.tick() != vm::VMScheduler::NO_DEADLINE) {
+    }
+}
+
+// Run `count` VMs spread over `threads` threads; returns elapsed ms
+static double runParallel(const compiler::BytecodeModule& module, int count, int threads,
+                          SharedDisplay& display, std::vector<std::string>& outputs) {
+    std::vector<std::unique_ptr<Worker>> workers;
+    for (int i = 0; i < count; i++) {
+        workers.push_back(std::unique_ptr<Worker>(new Worker(module, display)));
+    }
+    std::vector<std::vector<Worker*>> groups(threads);
+    for (int i = 0; i < count; i++) {
+        groups[i % threads].push_back(workers[i].get());
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> pool;
+    for (int t = 0; t < threads; t++) {
+        pool.push_back(std::thread(runGroup, groups[t]));
+    }
+    for (auto& thread : pool) {
+        thread.join();
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    outputs.clear();
+    for (const auto& worker : workers) {
+        outputs.push_back(worker->platform.output);
+        CHECK(!worker->vm->hasError(), "VM error: " << worker->vm->getError());
+    }
+    return std::chrono::duration<double, std::milli>(elapsed).count();
+}
+
+int main() {
+    std::cout << "=== Parallel VM Stress Test ===" << std::endl << std::endl;
+
+    // Always exercise real concurrency, even on a single-core host
+    int hardware = static_cast<int>(std::thread::hardware_concurrency());
+    int count = std::max(2, std::min(hardware, 4));
+
+    compiler::BytecodeModule module = vm::compileScript(
+        "var i: 0;\n"
+        "var sum: 0;\n"
+        "while (i < " + std::to_string(ITERATIONS) + ") {\n"
+        "    assign sum sum + i;\n"
+        "    assign i i + 1;\n"
+        "    os.display.drawPixel(0, 0, 0);\n"
+        "}\n"
+        "os.console.print(sum);\n");
+    long expectedSum = static_cast<long>(ITERATIONS) * (ITERATIONS - 1) / 2;
+
+    double baseline = 0;
+    for (int threads = 1; threads <= count; threads++) {
+        SharedDisplay display;
+        std::vector<std::string> outputs;
+        double ms = runParallel(module, count, threads, display, outputs);
+        if (threads == 1) {
+            baseline = ms;
+        }
+
+        std::cout << "  " << count << " VMs on " << threads << " thread(s): " << ms << " ms";
+        if (ms > 0) {
+            std::cout << " (x" << baseline / ms << ")";
+        }
+        std::cout << ", " << display.acquisitions << " lock acquisitions for "
+                  << display.draws << " draws" << std::endl;
+
+        for (const auto& output : outputs) {
+            CHECK(output == std::to_string(expectedSum), "VM result " << output);
+        }
+        CHECK(display.draws == static_cast<long>(count) * ITERATIONS,
+              "no draws lost: " << display.draws);
+        CHECK(display.acquisitions * 10 < display.draws,
+              "display lock batched per slice: " << display.acquisitions);
+    }
+
+    return test::summary();
+}
@@ -0,0 +1,79 @@
+/**
+ * Headless platform for host-side VM tests
+ *
+ * Implements the required PlatformInterface surface with no I/O: console
+ * output is captured into a string, display calls are counted, and time
+ * comes from a virtual clock the test advances explicitly. Several
+ * platforms (one per VM) can share one clock through `sharedClock`.
+ */
+
+#ifndef DIALOS_TEST_PLATFORM_H
+#define DIALOS_TEST_PLATFORM_H
+
+#include "vm/platform.h"
+#include "lexer.h"
+#include "parser.h"
+#include "bytecode_compiler.h"
+#include <string>
+#include <stdexcept>
+
+namespace dialos {
+namespace vm {
+
+class TestPlatform : public PlatformInterface {
+public:
+    std::string output;       // Everything printed through console_*
+    uint32_t now = 0;         // Virtual clock (ms)
+    uint32_t* sharedClock = nullptr;  // Overrides `now` when set
+    int drawCalls = 0;        // Display primitives issued
+
+    // Console
+    void console_print(const std::string& msg) override { output += msg; }
+    void console_log(const std::string& msg) override { output += msg + "\n"; }
+    void console_warn(const std::string& msg) override { output += msg + "\n"; }
+    void console_error(const std::string& msg) override { output += msg + "\n"; }
+
+    // Display
+    void display_clear(uint32_t /*color*/) override { drawCalls++; }
+    void display_drawText(int /*x*/, int /*y*/, const std::string& /*text*/,
+                          uint32_t /*color*/, int /*size*/) override { drawCalls++; }
+    void display_drawRect(int /*x*/, int /*y*/, int /*w*/, int /*h*/,
+                          uint32_t /*color*/, bool /*filled*/) override { drawCalls++; }
+    void display_drawCircle(int /*x*/, int /*y*/, int /*r*/,
+                            uint32_t /*color*/, bool /*filled*/) override { drawCalls++; }
+    void display_drawLine(int /*x1*/, int /*y1*/, int /*x2*/, int /*y2*/,
+                          uint32_t /*color*/) override { drawCalls++; }
+    void display_drawPixel(int /*x*/, int /*y*/, uint32_t /*color*/) override { drawCalls++; }
+    void display_setBrightness(int /*level*/) override {}
+    int display_getWidth() override { return 240; }
+    int display_getHeight() override { return 240; }
+
+    // Encoder
+    bool encoder_getButton() override { return false; }
+    int encoder_getDelta() override { return 0; }
+
+    // System
+    uint32_t system_getTime() override { return sharedClock ? *sharedClock : now; }
+    void system_sleep(uint32_t ms) override { (sharedClock ? *sharedClock : now) += ms; }
+};
+
+// Compile dialScript source to a module, throwing on parse/compile errors
+inline compiler::BytecodeModule compileScript(const std::string& source) {
+    compiler::Lexer lexer(source);
+    compiler::Parser parser(lexer);
+    auto program = parser.parse();
+    if (parser.hasErrors()) {
+        throw std::runtime_error("parse error: " + parser.getErrors().front());
+    }
+    compiler::BytecodeCompiler bytecodeCompiler;
+    compiler::BytecodeModule module = bytecodeCompiler.compile(*program);
+    if (bytecodeCompiler.hasErrors()) {
+        throw std::runtime_error("compile error: " + bytecodeCompiler.getErrors().front());
+    }
+    return module;
+}
+
+} // namespace vm
+} // namespace dialos
+
+#endif // DIALOS_TEST_PLATFORM_H
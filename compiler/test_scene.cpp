@@ -0,0 +1,236 @@
+/**
+ * Retained Scene Test
+ *
+ * Builds a scene of layers, rects, circles, labels and sprites, mutates it
+ * (moves, hides, reorders, removes, restyles) and checks after every
+ * render that the incrementally repainted frame is pixel-identical to the
+ * whole scene drawn from scratch - with and without platform clipping.
+ * Then compares the native calls and wall time of a script animating a
+ * scene through display.moveNode/render against the same frame redrawn
+ * with immediate-mode calls.
+ */
+
+#include "headless_platform.h"
+#include "test_platform.h"
+#include "vm/image_codec.h"
+#include "vm/scene.h"
+#include "test_check.h"
+#include <iostream>
+#include <memory>
+
+using namespace dialos;
+
+// Headless platform that can't clip, like a platform without the hook
+class NoClipPlatform : public vm::HeadlessPlatform {
+public:
+    bool display_setClip(int, int, int, int) override { return false; }
+};
+
+static bool sameFrame(const vm::HeadlessPlatform& a, const vm::HeadlessPlatform& b) {
+    const uint16_t* pa = a.getFramebuffer().pixels();
+    const uint16_t* pb = b.getFramebuffer().pixels();
+    return std::equal(pa, pa + 240 * 240, pb);
+}
+
+// A scene and a mirror of its content, so it can be drawn from scratch
+struct TestScene {
+    vm::Scene scene{240, 240};
+    std::shared_ptr<vm::Image> sprite = std::make_shared<vm::Image>();
+    int32_t hud, panel, title, ball, ring, icon, layerIcon;
+
+    TestScene() {
+        // 16x16 sprite: a green square on a keyed-out magenta border
+        sprite->width = sprite->height = 16;
+        sprite->pixels.assign(256, 0xF81F);
+        for (int y = 2; y < 14; y++) {
+            for (int x = 2; x < 14; x++) {
+                sprite->pixels[y * 16 + x] = static_cast<uint16_t>(0x07E0 + x);
+            }
+        }
+        sprite->transparent = 0xF81F;
+
+        panel = add(vm::Scene::Kind::RECT, vm::Scene::ROOT, 20, 20);
+        node(panel).w = 200;
+        node(panel).h = 120;
+        node(panel).color = 0x18E3;
+        hud = scene.create(vm::Scene::Kind::LAYER, vm::Scene::ROOT);
+        node(hud).x = 10;
+        node(hud).y = 150;
+        title = add(vm::Scene::Kind::TEXT, hud, 10, 10);
+        node(title).text = "Score 0";
+        node(title).size = 2;
+        ring = add(vm::Scene::Kind::CIRCLE, vm::Scene::ROOT, 120, 80);
+        node(ring).w = 30;
+        node(ring).filled = false;
+        node(ring).color = 0xFFE0;
+        ball = add(vm::Scene::Kind::CIRCLE, vm::Scene::ROOT, 60, 60);
+        node(ball).w = 8;
+        node(ball).color = 0xF800;
+        layerIcon = scene.create(vm::Scene::Kind::LAYER, vm::Scene::ROOT);
+        icon = add(vm::Scene::Kind::SPRITE, layerIcon, 150, 40);
+        node(icon).image = sprite;
+    }
+
+    vm::Scene::Node& node(int32_t id) { return *scene.get(id); }
+    int32_t add(vm::Scene::Kind kind, int32_t layer, int x, int y) {
+        int32_t id = scene.create(kind, layer);
+        node(id).x = x;
+        node(id).y = y;
+        return id;
+    }
+};
+
+// Paint the whole scene from scratch, in plain painter's order
+static void drawFromScratch(vm::Scene& scene, vm::HeadlessPlatform& platform) {
+    scene.invalidate();
+    scene.render(platform);
+}
+
+static void testIncremental(vm::HeadlessPlatform& live, const char* label) {
+    std::cout << "incremental repaint (" << label << ")" << std::endl;
+    TestScene test;
+    CHECK(test.scene.render(live) == 1, "first render paints the screen");
+
+    // Each step changes something, then the live frame must match a full redraw
+    struct Step {
+        const char* name;
+        void (*apply)(TestScene&);
+    };
+    const Step steps[] = {
+        {"move ball", [](TestScene& t) { t.node(t.ball).x += 40; t.scene.update(t.ball); }},
+        {"move ball under the ring", [](TestScene& t) { t.node(t.ball).x = 110; t.scene.update(t.ball); }},
+        {"text", [](TestScene& t) { t.node(t.title).text = "Score 120"; t.scene.update(t.title); }},
+        {"move layer", [](TestScene& t) { t.node(t.hud).y = 190; t.scene.update(t.hud); }},
+        {"hide layer", [](TestScene& t) { t.node(t.layerIcon).visible = false; t.scene.update(t.layerIcon); }},
+        {"show layer", [](TestScene& t) { t.node(t.layerIcon).visible = true; t.scene.update(t.layerIcon); }},
+        {"raise panel", [](TestScene& t) { t.node(t.panel).z = 5; t.scene.update(t.panel); }},
+        {"lower panel", [](TestScene& t) { t.node(t.panel).z = -1; t.scene.update(t.panel); }},
+        {"sprite region", [](TestScene& t) { t.node(t.icon).sx = 4; t.node(t.icon).w = 8; t.scene.update(t.icon); }},
+        {"colour", [](TestScene& t) { t.node(t.panel).color = 0x4208; t.scene.update(t.panel); }},
+        {"remove ring", [](TestScene& t) { t.scene.remove(t.ring); }},
+        {"remove layer", [](TestScene& t) { t.scene.remove(t.hud); }},
+        {"background", [](TestScene& t) { t.scene.setBackground(0x0010); }},
+        {"off screen", [](TestScene& t) { t.node(t.ball).x = -100; t.scene.update(t.ball); }},
+    };
+    for (const Step& step : steps) {
+        step.apply(test);
+        live.drawCalls = 0;
+        test.scene.render(live);
+        uint32_t calls = live.drawCalls;
+        vm::HeadlessPlatform reference;
+        drawFromScratch(test.scene, reference);
+        CHECK(sameFrame(live, reference), step.name << ": frame differs from a full redraw");
+        CHECK(calls > 0, step.name << ": nothing repainted");
+    }
+
+    live.drawCalls = 0;
+    CHECK(test.scene.render(live) == 0 && live.drawCalls == 0, "unchanged scene draws nothing");
+    CHECK(test.scene.size() == 4, "live nodes after removals, got " << test.scene.size());
+}
+
+static void testLimits() {
+    std::cout << "limits" << std::endl;
+    vm::Scene scene(240, 240);
+    int32_t rect = scene.create(vm::Scene::Kind::RECT, vm::Scene::ROOT);
+    CHECK(scene.create(vm::Scene::Kind::RECT, rect) == 0, "only layers hold nodes");
+    CHECK(scene.create(vm::Scene::Kind::RECT, 999) == 0, "unknown parent");
+    CHECK(!scene.remove(vm::Scene::ROOT) && scene.get(vm::Scene::ROOT) == nullptr, "root is fixed");
+    CHECK(scene.remove(rect) && !scene.remove(rect) && scene.get(rect) == nullptr, "removed once");
+    CHECK(scene.create(vm::Scene::Kind::RECT, vm::Scene::ROOT) == rect, "ids are reused");
+    while (scene.create(vm::Scene::Kind::RECT, vm::Scene::ROOT) != 0) {
+    }
+    CHECK(scene.size() == vm::Scene::MAX_NODES, "node limit");
+}
+
+static const char* SCENE_SCRIPT = R"(
+class Caption {
+    text: string;
+    constructor(text: string) {
+        assign this.text text;
+    }
+}
+var icon: os.display.loadImage([0, 4, 0, 4, 7, 224, 7, 224, 7, 224, 7, 224, 7, 224, 7, 224, 7, 224, 7, 224,
+                                7, 224, 7, 224, 7, 224, 7, 224, 7, 224, 7, 224, 7, 224, 7, 224]);
+var grid: os.display.createLayer();
+var i: 0;
+while (i < 24) {
+    os.display.createRect(grid, 10 + (i % 6) * 38, 40 + (i / 6) * 38, 30, 30, 8456, true);
+    assign i i + 1;
+}
+var label: os.display.createLabel(0, 10, 10, "Frames", 65535, 2);
+var sprite: os.display.createSprite(0, 0, 200, icon);
+var frame: 0;
+while (frame < 100) {
+    os.display.moveNode(sprite, 10 + frame * 2, 200);
+    if (frame % 25 = 0) {
+        var caption: Caption(`Frame ${frame}`);
+        os.display.setNode(label, caption);
+    }
+    os.display.render(0);
+    assign frame frame + 1;
+}
+)";
+
+static const char* IMMEDIATE_SCRIPT = R"(
+var icon: os.display.loadImage([0, 4, 0, 4, 7, 224, 7, 224, 7, 224, 7, 224, 7, 224, 7, 224, 7, 224, 7, 224,
+                                7, 224, 7, 224, 7, 224, 7, 224, 7, 224, 7, 224, 7, 224, 7, 224]);
+var title: "Frames";
+var frame: 0;
+while (frame < 100) {
+    os.display.clear(0);
+    var i: 0;
+    while (i < 24) {
+        os.display.drawRect(10 + (i % 6) * 38, 40 + (i / 6) * 38, 30, 30, 8456, true);
+        assign i i + 1;
+    }
+    if (frame % 25 = 0) {
+        assign title `Frame ${frame}`;
+    }
+    os.display.drawText(10, 10, title, 65535, 2);
+    os.display.drawImage(10 + frame * 2, 200, icon);
+    assign frame frame + 1;
+}
+)";
+
+static uint64_t totalNatives(const vm::HeadlessResult& result) {
+    uint64_t total = 0;
+    for (const auto& entry : result.nativeCalls) {
+        total += entry.second;
+    }
+    return total;
+}
+
+static void testScripts() {
+    std::cout << "scripted scene vs immediate mode" << std::endl;
+    vm::HeadlessOptions options;
+    options.sliceInstructions = 100000;
+
+    vm::HeadlessPlatform retained;
+    vm::HeadlessResult a = vm::runHeadless(vm::compileScript(SCENE_SCRIPT), retained, options);
+    vm::HeadlessPlatform immediate;
+    vm::HeadlessResult b = vm::runHeadless(vm::compileScript(IMMEDIATE_SCRIPT), immediate, options);
+    CHECK(a.status == vm::HeadlessResult::Status::IDLE, "scene script runs: " << a.error);
+    CHECK(b.status == vm::HeadlessResult::Status::IDLE, "immediate script runs: " << b.error);
+    CHECK(sameFrame(retained, immediate), "both scripts end on the same frame");
+
+    uint64_t sceneNatives = totalNatives(a);
+    uint64_t immediateNatives = totalNatives(b);
+    CHECK(sceneNatives * 5 < immediateNatives, "far fewer native calls, " << sceneNatives << " vs " << immediateNatives);
+    CHECK(a.drawCalls * 3 < b.drawCalls, "far fewer primitives, " << a.drawCalls << " vs " << b.drawCalls);
+    std::cout << "  100 frames: " << sceneNatives << " native calls, " << a.drawCalls << " primitives, "
+              << a.wallUs << " us retained; " << immediateNatives << " native calls, " << b.drawCalls
+              << " primitives, " << b.wallUs << " us immediate" << std::endl;
+}
+
+int main() {
+    std::cout << "=== Scene Test ===" << std::endl << std::endl;
+
+    vm::HeadlessPlatform clipping;
+    testIncremental(clipping, "clipped");
+    NoClipPlatform unclipped;
+    testIncremental(unclipped, "no clip");
+    testLimits();
+    testScripts();
+
+    return test::summary();
+}
@@ -8,14 +8,17 @@
 #include "vm/vm_value.h"
 #include "sdl_platform.h"
 #include "vm/bytecode.h"
+#include "vm/ipc_bus.h"
+#include "vm/idle_manager.h"
 #include <iostream>
 #include <fstream>
 #include <vector>
 #include <chrono>
-#include <thread>
+#include <algorithm>
 #include <sstream>
 #include <filesystem>
 #include <iomanip>
+#include <iterator>
 
 using namespace dialos;
 
@@ -30,7 +33,10 @@ int main(int argc, char** argv) {
     std::cout << std::endl;
     
     if (argc < 2) {
-        std::cerr << "Usage: " << argv[0] << " <bytecode.dsb>" << std::endl;
+        std::cerr << "Usage: " << argv[0] << " <bytecode.dsb> [--snapshot]" << std::endl;
+        std::cerr << std::endl;
+        std::cerr << "  --snapshot     Save the app's state to <bytecode.dsb>.vms on exit and" << std::endl;
+        std::cerr << "                 resume from it on the next start" << std::endl;
         std::cerr << std::endl;
         std::cerr << "Controls:" << std::endl;
         std::cerr << "  Mouse Wheel    - Rotary encoder" << std::endl;
@@ -43,6 +49,8 @@ int main(int argc, char** argv) {
     }
     
     const char* filename = argv[1];
+    bool useSnapshot = argc > 2 && std::string(argv[2]) == "--snapshot";
+    std::string snapshotFile = std::string(filename) + ".vms";
     
     // Load bytecode file
     std::ifstream file(filename, std::ios::binary);
@@ -83,6 +91,10 @@ int main(int argc, char** argv) {
     std::cout << "  Version:  " << module.metadata.version << std::endl;
     std::cout << std::endl;
     
+    // Single-app IPC bus (declared first: it must outlive the platform); lets
+    // a script exercise os.ipc.* by messaging itself
+    vm::IpcBus ipcBus;
+    
     // Initialize SDL platform
     vm::SDLPlatform platform;
     if (!platform.initialize("dialOS Emulator - " + module.metadata.appName)) {
@@ -111,28 +123,63 @@ int main(int argc, char** argv) {
     std::cout << "Close window or press ESC to exit" << std::endl;
     std::cout << std::endl;
     
-    vm.reset();
-    // Host-side lifecycle: invoke app.onLoad if the script registered a handler
+    // Resume from the last session's snapshot, or start main from scratch
+    bool resumed = false;
+    if (useSnapshot) {
+        std::ifstream snapshotIn(snapshotFile, std::ios::binary);
+        std::vector<uint8_t> image((std::istreambuf_iterator<char>(snapshotIn)), std::istreambuf_iterator<char>());
+        auto restoreStart = std::chrono::steady_clock::now();
+        resumed = !image.empty() && vm.restore(image.data(), image.size());
+        if (resumed) {
+            auto restoreUs = std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - restoreStart).count();
+            std::cout << "Resumed from " << snapshotFile << " (" << image.size() << " bytes, "
+                      << restoreUs << " us)" << std::endl;
+        } else if (!image.empty()) {
+            std::cout << "Snapshot " << snapshotFile << " does not match this app; starting fresh" << std::endl;
+        }
+    }
+    if (!resumed) {
+        vm.reset();
+    }
+    // Host-side lifecycle: invoke app.onLoad (or app.onResume) if the script
+    // registered a handler
     platform.setVM(&vm);
-    platform.invokeCallback("app.onLoad", std::vector<vm::Value>());
+    platform.attachIpc(&ipcBus, module.metadata.appName);
+    platform.invokeCallback(resumed ? "app.onResume" : "app.onLoad", std::vector<vm::Value>());
     
     // Main emulation loop
     const uint32_t TARGET_FPS = 60;
     const uint32_t FRAME_TIME_MS = 1000 / TARGET_FPS;
     const uint32_t VM_CYCLES_PER_FRAME = 1000; // Execute up to 1000 instructions per frame
     
-    auto lastFrameTime = std::chrono::steady_clock::now();
     bool running = true;
     bool vmPaused = false;
     bool finalStateShown = false;
     
+    // Same idle accounting as the device; the host has no light sleep, so
+    // both idle states are simulated by blocking in SDL until the deadline
+    vm::IdleManager idleManager;
+    vm::IdleManager::SourceId idleSource = idleManager.addSource(module.metadata.appName);
+    idleManager.resetStats(platform.system_getTime());
+    
     while (running && !platform.shouldQuit()) {
-        auto frameStart = std::chrono::steady_clock::now();
-        
-        // Poll SDL events
-        if (!platform.pollEvents()) {
+        // Block until input arrives or the next timer / sleep deadline is
+        // due; an idle or sleeping script costs no CPU between wakeups
+        bool pumped = true;
+        vm::IdleManager::Plan plan = idleManager.idle(platform.system_getTime(),
+            [&](vm::PowerState, uint32_t ms) {
+                uint32_t start = platform.system_getTime();
+                pumped = platform.waitEvents(ms);
+                return platform.system_getTime() - start;
+            });
+        if (plan.state == vm::PowerState::ACTIVE) {
+            pumped = platform.waitEvents(0);
+        }
+        if (!pumped) {
             break;
         }
+        auto frameStart = std::chrono::steady_clock::now();
         
         // Check if a callback caused a fatal error during event polling
         if (vm.hasError() && !vmPaused) {
@@ -229,12 +276,46 @@ int main(int argc, char** argv) {
         // Present frame
         platform.present();
         
-        // Frame rate limiting
-        auto frameEnd = std::chrono::steady_clock::now();
-        auto frameDuration = std::chrono::duration_cast<std::chrono::milliseconds>(frameEnd - frameStart);
-        
-        if (frameDuration.count() < FRAME_TIME_MS) {
-            std::this_thread::sleep_for(std::chrono::milliseconds(FRAME_TIME_MS - frameDuration.count()));
+        // Work out how long the next wait may block
+        uint32_t waitMs;
+        if (vm.isRunning() && !vmPaused && vm.isAwaiting()) {
+            // Parked in an async native: the completion pushes a wake event
+            waitMs = vm::SDLPlatform::NO_TIMEOUT;
+        } else if (vm.isRunning() && !vmPaused && !vm.isSleeping()) {
+            // Busy script: keep the frame rate cap
+            auto frameDuration = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - frameStart);
+            waitMs = frameDuration.count() < FRAME_TIME_MS
+                         ? static_cast<uint32_t>(FRAME_TIME_MS - frameDuration.count())
+                         : 0;
+        } else if (vm.isRunning() && !vmPaused) {
+            // Sleeping script: wake exactly at its deadline
+            int64_t remaining = static_cast<int64_t>(vm.getSleepUntil()) - platform.system_getTime();
+            waitMs = remaining > 0 ? static_cast<uint32_t>(remaining) : 0;
+        } else {
+            // Finished or paused: only input and timers create work
+            waitMs = vm::SDLPlatform::NO_TIMEOUT;
+        }
+        waitMs = std::min(waitMs, platform.getNextTimerDelay());
+        idleManager.update(idleSource, platform.system_getTime(), waitMs, vm.isRunning() && vm.isAwaiting());
+    }
+    
+    vm::IdleManager::Stats idleStats = idleManager.getStats();
+    std::cout << "Idle residency over " << idleStats.totalMs() << " ms: active "
+              << idleStats.percent(vm::PowerState::ACTIVE) << "%, idle "
+              << idleStats.percent(vm::PowerState::IDLE) << "%, light sleep "
+              << idleStats.percent(vm::PowerState::LIGHT_SLEEP) << "% ("
+              << idleStats.entries[static_cast<int>(vm::PowerState::LIGHT_SLEEP)] << " entries)" << std::endl;
+    
+    if (useSnapshot && !vm.hasError()) {
+        platform.invokeCallback("app.onSuspend", std::vector<vm::Value>());
+        std::vector<uint8_t> image;
+        if (vm.snapshot(image)) {
+            std::ofstream snapshotOut(snapshotFile, std::ios::binary);
+            snapshotOut.write(reinterpret_cast<const char*>(image.data()), image.size());
+            std::cout << "Saved snapshot to " << snapshotFile << " (" << image.size() << " bytes)" << std::endl;
+        } else {
+            std::cout << "App is busy; no snapshot saved" << std::endl;
         }
     }
     
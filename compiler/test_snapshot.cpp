@@ -0,0 +1,268 @@
+/**
+ * VM Snapshot Test
+ *
+ * Snapshots a VM mid-main and after main, restores into a fresh VM for the
+ * same module and checks that execution, the heap graph (shared and cyclic
+ * references), callbacks, timers and loaded images carry over. Then measures applet switch
+ * latency: a cold relaunch (deserialize, construct, run main, onLoad)
+ * against a warm resume (construct, restore, onResume).
+ */
+
+#include "vm/vm_core.h"
+#include "vm/image_cache.h"
+#include "vm/image_codec.h"
+#include "test_platform.h"
+#include "test_check.h"
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace dialos;
+
+static const char* APP_SCRIPT =
+    "class Node {\n"
+    "    value: int;\n"
+    "    next: Node;\n"
+    "    constructor(value: int) {\n"
+    "        assign this.value value;\n"
+    "    }\n"
+    "}\n"
+    "var head: Node(1);\n"
+    "var alias: head;\n"
+    "var items: [1, 2, \"three\"];\n"
+    "var label: \"hello\";\n"
+    "var total: 0;\n"
+    "var ticks: 0;\n"
+    "var suspended: 0;\n"
+    "var resumed: 0;\n"
+    "function onTick(): void { assign ticks ticks + 1; }\n"
+    "function onTurn(delta: int): void { assign total total + delta; }\n"
+    "function onSuspend(): void { assign suspended suspended + 1; }\n"
+    "function onResume(): void { assign resumed resumed + 1; }\n"
+    "assign head.next head;\n"
+    "os.encoder.onTurn(onTurn);\n"
+    "os.timer.setInterval(onTick, 100);\n"
+    "os.app.onSuspend(onSuspend);\n"
+    "os.app.onResume(onResume);\n"
+    "var i: 0;\n"
+    "while (i < 20000) {\n"
+    "    assign total total + 1;\n"
+    "    assign i i + 1;\n"
+    "}\n";
+
+static const uint32_t HEAP = 16384;
+
+// One applet instance: platform, heap and VM
+struct Instance {
+    vm::TestPlatform platform;
+    vm::ValuePool pool;
+    vm::VMState state;
+
+    explicit Instance(const compiler::BytecodeModule& module)
+        : pool(HEAP), state(module, pool, platform) {}
+
+    const vm::Value& global(const char* name) const { return state.getGlobals().at(name); }
+    void runToEnd() {
+        while (state.execute(100000) == vm::VMResult::OK) {
+        }
+    }
+};
+
+static void testMidMain(const compiler::BytecodeModule& module) {
+    std::cout << "snapshot in the middle of main" << std::endl;
+    Instance original(module);
+    original.state.reset();
+    original.state.execute(5000);
+    CHECK(original.state.isRunning(), "main still running");
+
+    std::vector<uint8_t> image;
+    CHECK(original.state.snapshot(image), "snapshot taken");
+
+    Instance copy(module);
+    CHECK(copy.state.restore(image.data(), image.size()), "restored");
+    original.runToEnd();
+    copy.runToEnd();
+
+    CHECK(!copy.state.hasError(), "no VM error: " << copy.state.getError());
+    CHECK(copy.global("i").int32Val == 20000, "loop finished after restore");
+    CHECK(copy.global("total").int32Val == original.global("total").int32Val, "same result as the original");
+    std::cout << "  " << image.size() << " byte image" << std::endl;
+}
+
+static void testAfterMain(const compiler::BytecodeModule& module) {
+    std::cout << "snapshot of a resident applet" << std::endl;
+    Instance original(module);
+    original.state.reset();
+    original.runToEnd();
+    original.platform.now = 50;       // Interval due at 100: 50 ms left
+
+    std::vector<uint8_t> image;
+    CHECK(original.state.snapshot(image), "snapshot taken");
+
+    Instance copy(module);
+    copy.platform.now = 1000;
+    CHECK(copy.state.restore(image.data(), image.size()), "restored");
+
+    const vm::Value& head = copy.global("head");
+    CHECK(head.isObject() && copy.global("alias").objVal == head.objVal, "shared object stays shared");
+    CHECK(head.objVal->fields.at("next").objVal == head.objVal, "cycle preserved");
+    CHECK(head.objVal->fields.at("value").int32Val == 1, "field value");
+    const vm::Value& items = copy.global("items");
+    CHECK(items.isArray() && items.arrayVal->elements.size() == 3 &&
+          items.arrayVal->elements[2].toString() == "three", "array contents");
+    CHECK(copy.global("label").toString() == "hello", "string global");
+
+    CHECK(copy.platform.getNextTimerDelay() == 50, "interval keeps its remaining time, got "
+          << copy.platform.getNextTimerDelay());
+    copy.platform.now = 1050;
+    copy.platform.processTimers();
+    CHECK(copy.global("ticks").int32Val == 1, "interval fires after restore");
+
+    std::vector<vm::Value> args(1, vm::Value::Int32(5));
+    int before = copy.global("total").int32Val;
+    CHECK(copy.platform.invokeCallback("encoder.onTurn", args), "callback registry restored");
+    CHECK(copy.global("total").int32Val == before + 5, "callback ran on restored state");
+
+    // A finished main stays finished: the next slice just reports it
+    CHECK(copy.state.execute(100) == vm::VMResult::FINISHED, "main does not rerun");
+    CHECK(copy.global("i").int32Val == 20000, "globals untouched by resuming");
+}
+
+static void testRejects(const compiler::BytecodeModule& module) {
+    std::cout << "bad images are rejected" << std::endl;
+    Instance original(module);
+    original.state.reset();
+    original.runToEnd();
+    std::vector<uint8_t> image;
+    original.state.snapshot(image);
+
+    Instance truncated(module);
+    CHECK(!truncated.state.restore(image.data(), image.size() / 2), "truncated image");
+    CHECK(truncated.global("total").isNull(), "failed restore leaves the VM reset");
+
+    compiler::BytecodeModule other = vm::compileScript("var x: 1;\n");
+    vm::TestPlatform platform;
+    vm::ValuePool pool(HEAP);
+    vm::VMState stranger(other, pool, platform);
+    CHECK(!stranger.restore(image.data(), image.size()), "image of another module");
+
+    compiler::BytecodeModule scene = vm::compileScript("var box: os.display.createRect(0, 0, 0, 10, 10, 65535, true);\n");
+    Instance withScene(scene);
+    withScene.state.reset();
+    withScene.runToEnd();
+    CHECK(!withScene.state.hasError() && !withScene.state.snapshot(image), "scene nodes can't be snapshotted");
+}
+
+// Counts decoded images drawn
+class BitmapPlatform : public vm::TestPlatform {
+public:
+    int bitmaps = 0;
+
+    void display_drawBitmap(int /*x*/, int /*y*/, const std::shared_ptr<const vm::Image>& /*image*/,
+                            int /*sx*/, int /*sy*/, int /*w*/, int /*h*/, int32_t /*transparent*/) override {
+        bitmaps++;
+    }
+};
+
+static void testImages() {
+    std::cout << "loaded images" << std::endl;
+    std::vector<uint16_t> pixels(4, 0xF800);
+    std::vector<uint8_t> raw = vm::image::encodeRaw(2, 2, pixels.data());
+    std::string bytes;
+    for (size_t i = 0; i < raw.size(); i++) {
+        bytes += (i ? ", " : "") + std::to_string(raw[i]);
+    }
+    compiler::BytecodeModule module = vm::compileScript(
+        "var icon: os.display.loadImage([" + bytes + "]);\n"
+        "function onTurn(delta: int): void { os.display.drawImage(delta, 0, icon); }\n"
+        "os.encoder.onTurn(onTurn);\n");
+
+    std::vector<uint8_t> image;
+    {
+        BitmapPlatform platform;
+        vm::ValuePool pool(HEAP);
+        vm::VMState original(module, pool, platform);
+        original.reset();
+        while (original.execute(100000) == vm::VMResult::OK) {
+        }
+        CHECK(original.snapshot(image), "snapshot taken");
+    }
+
+    BitmapPlatform platform;
+    vm::ValuePool pool(HEAP);
+    vm::VMState copy(module, pool, platform);
+    CHECK(copy.restore(image.data(), image.size()), "restored");
+    std::vector<vm::Value> args(1, vm::Value::Int32(5));
+    platform.invokeCallback("encoder.onTurn", args);
+    CHECK(!copy.hasError() && platform.bitmaps == 1, "the image draws after restore: " << copy.getError());
+
+    // Inline data can't be decoded again once it has left the cache
+    vm::ImageCache::shared().clear();
+    BitmapPlatform evictedPlatform;
+    vm::ValuePool evictedPool(HEAP);
+    vm::VMState evicted(module, evictedPool, evictedPlatform);
+    CHECK(!evicted.restore(image.data(), image.size()), "evicted inline image");
+}
+
+// Time `iterations` runs of `step` in microseconds per run
+template <typename Step>
+static double timeUs(int iterations, Step step) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+        step();
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count() / 1000.0 / iterations;
+}
+
+static void testSwitchLatency(const compiler::BytecodeModule& module) {
+    std::cout << "applet switch latency" << std::endl;
+    const int ITERATIONS = 50;
+    std::vector<uint8_t> bytecode = module.serialize();
+    std::vector<vm::Value> noArgs;
+
+    // Cold: what a relaunch costs without snapshots
+    double coldUs = timeUs(ITERATIONS, [&]() {
+        compiler::BytecodeModule loaded = compiler::BytecodeModule::deserialize(bytecode);
+        Instance app(loaded);
+        app.state.reset();
+        app.platform.invokeCallback("app.onLoad", noArgs);
+        app.runToEnd();
+    });
+
+    // Warm: suspend (onSuspend + snapshot), then resume (restore + onResume)
+    Instance running(module);
+    running.state.reset();
+    running.runToEnd();
+    std::vector<uint8_t> image;
+    int resumedCount = 0;
+    double warmUs = timeUs(ITERATIONS, [&]() {
+        running.platform.invokeCallback("app.onSuspend", noArgs);
+        running.state.snapshot(image);
+        Instance app(module);
+        app.state.restore(image.data(), image.size());
+        app.platform.invokeCallback("app.onResume", noArgs);
+        resumedCount = app.global("resumed").int32Val;
+    });
+
+    CHECK(resumedCount == 1, "onResume fired on the restored VM");
+    CHECK(running.global("suspended").int32Val == ITERATIONS, "onSuspend fired before each snapshot");
+    CHECK(warmUs < coldUs, "resume is faster than a relaunch");
+    std::cout << "  cold relaunch " << coldUs << " us, warm resume " << warmUs << " us ("
+              << image.size() << " byte snapshot)" << std::endl;
+}
+
+int main() {
+    std::cout << "=== VM Snapshot Test ===" << std::endl << std::endl;
+
+    compiler::BytecodeModule module = vm::compileScript(APP_SCRIPT);
+    testMidMain(module);
+    testAfterMain(module);
+    testRejects(module);
+    testImages();
+    testSwitchLatency(module);
+
+    return test::summary();
+}
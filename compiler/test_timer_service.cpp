@@ -0,0 +1,189 @@
+/**
+ * Timer Service Test
+ *
+ * Drives TimerService with a virtual clock: deadline ordering, cancel,
+ * drift-free interval re-arming under late polls, skipped periods, timers
+ * created from callbacks, 32-bit clock wrap, and os.timer.* scripts running
+ * through VMScheduler.
+ */
+
+#include "vm/timer_service.h"
+#include "vm/vm_scheduler.h"
+#include "test_platform.h"
+#include "test_check.h"
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace dialos;
+
+typedef vm::TimerService::TimerId TimerId;
+
+// Records which timers fired, in order
+struct FireLog {
+    std::vector<TimerId> ids;
+    vm::TimerService::FireHandler handler() {
+        return [this](TimerId id, const vm::Value&) { ids.push_back(id); };
+    }
+};
+
+static void testOrdering() {
+    std::cout << "deadline ordering" << std::endl;
+    vm::TimerService timers;
+    FireLog log;
+
+    TimerId c = timers.setTimeout(vm::Value::Null(), 0, 30);
+    TimerId a = timers.setTimeout(vm::Value::Null(), 0, 10);
+    TimerId b = timers.setTimeout(vm::Value::Null(), 0, 20);
+    TimerId b2 = timers.setTimeout(vm::Value::Null(), 0, 20);
+
+    CHECK(timers.nextDelay(0) == 10, "next delay 10, got " << timers.nextDelay(0));
+    CHECK(timers.fireDue(5, log.handler()) == 0, "nothing due at 5");
+    CHECK(timers.fireDue(25, log.handler()) == 3, "three due at 25");
+    CHECK(log.ids.size() == 3 && log.ids[0] == a && log.ids[1] == b && log.ids[2] == b2,
+          "earliest first, FIFO on ties");
+    CHECK(timers.nextDelay(25) == 5, "next delay 5");
+    timers.fireDue(30, log.handler());
+    CHECK(log.ids.back() == c, "last timer fired");
+    CHECK(timers.empty(), "one-shots removed");
+    CHECK(timers.nextDelay(30) == vm::TimerService::NO_DEADLINE, "no deadline when empty");
+}
+
+static void testCancel() {
+    std::cout << "cancel" << std::endl;
+    vm::TimerService timers;
+    FireLog log;
+
+    TimerId a = timers.setTimeout(vm::Value::Null(), 0, 10);
+    TimerId b = timers.setInterval(vm::Value::Null(), 0, 10);
+    CHECK(timers.cancel(a), "cancel pending timeout");
+    CHECK(!timers.cancel(a), "second cancel fails");
+    CHECK(timers.nextDelay(0) == 10, "interval still pending");
+    timers.fireDue(10, log.handler());
+    CHECK(log.ids.size() == 1 && log.ids[0] == b, "cancelled timer never fires");
+
+    CHECK(timers.cancel(b), "cancel interval");
+    CHECK(timers.nextDelay(10) == vm::TimerService::NO_DEADLINE, "stale heap entries ignored");
+
+    // Heavy churn keeps the heap bounded
+    for (int i = 0; i < 1000; i++) {
+        timers.cancel(timers.setTimeout(vm::Value::Null(), 10, 5));
+    }
+    CHECK(timers.empty(), "churn leaves nothing pending");
+    CHECK(timers.fireDue(100, log.handler()) == 0, "nothing fires after churn");
+}
+
+static void testDriftFree() {
+    std::cout << "drift-free intervals" << std::endl;
+    vm::TimerService timers;
+    FireLog log;
+    timers.setInterval(vm::Value::Null(), 0, 100);
+
+    // Poll a few ms late every time; deadlines stay on the 100ms grid
+    uint32_t polls[] = {103, 207, 301, 409, 500};
+    for (uint32_t now : polls) {
+        CHECK(timers.fireDue(now, log.handler()) == 1, "one fire at " << now);
+        uint32_t expected = (now / 100 + 1) * 100 - now;
+        CHECK(timers.nextDelay(now) == expected, "re-armed on grid at " << now << ": "
+              << timers.nextDelay(now) << " vs " << expected);
+    }
+
+    // A stall across several periods fires once and skips the missed ones
+    CHECK(timers.fireDue(1050, log.handler()) == 1, "missed periods collapse into one fire");
+    CHECK(timers.nextDelay(1050) == 50, "next on grid after stall, got " << timers.nextDelay(1050));
+}
+
+static void testCallbackScheduling() {
+    std::cout << "timers created in callbacks" << std::endl;
+    vm::TimerService timers;
+    int fired = 0;
+    TimerId first = timers.setTimeout(vm::Value::Null(), 0, 0);
+
+    vm::TimerService::FireHandler handler = [&](TimerId id, const vm::Value&) {
+        fired++;
+        // A zero-delay timer added from a callback must not run in the
+        // same round
+        if (id == first) {
+            timers.setTimeout(vm::Value::Null(), 0, 0);
+        }
+    };
+    CHECK(timers.fireDue(0, handler) == 1, "new zero-delay timer waits for next round");
+    CHECK(timers.nextDelay(0) == 0, "but is due immediately");
+    CHECK(timers.fireDue(0, handler) == 1, "fires on the next round");
+    CHECK(fired == 2, "two fires");
+
+    // Cancelling an interval from its own callback stops it
+    TimerId self = timers.setInterval(vm::Value::Null(), 0, 10);
+    timers.fireDue(10, [&](TimerId id, const vm::Value&) { timers.cancel(id); });
+    CHECK(timers.empty(), "interval cancelled itself (id " << self << ")");
+}
+
+static void testClockWrap() {
+    std::cout << "clock wrap" << std::endl;
+    vm::TimerService timers;
+    FireLog log;
+    uint32_t now = 0xFFFFFFF0u;
+    timers.setTimeout(vm::Value::Null(), now, 0x20);
+    CHECK(timers.nextDelay(now) == 0x20, "delay across wrap");
+    CHECK(timers.fireDue(0x00000005u, log.handler()) == 0, "not due just after wrap");
+    CHECK(timers.nextDelay(0x00000005u) == 0xB, "remaining after wrap: " << timers.nextDelay(5));
+    CHECK(timers.fireDue(0x00000010u, log.handler()) == 1, "fires after wrap");
+}
+
+static void testScriptTimers() {
+    std::cout << "os.timer through the scheduler" << std::endl;
+    uint32_t clock = 0;
+    vm::TestPlatform platform;
+    platform.sharedClock = &clock;
+
+    compiler::BytecodeModule module = vm::compileScript(
+        "var ticks: 0;\n"
+        "var id: 0;\n"
+        "function onTick(): void {\n"
+        "    assign ticks ticks + 1;\n"
+        "    os.console.print(\"t\");\n"
+        "    if (ticks = 3) {\n"
+        "        os.timer.clearInterval(id);\n"
+        "    }\n"
+        "}\n"
+        "function onTimeout(): void {\n"
+        "    os.console.print(\"o\");\n"
+        "}\n"
+        "assign id os.timer.setInterval(onTick, 100);\n"
+        "os.timer.setTimeout(onTimeout, 250);\n");
+    vm::ValuePool pool(4096);
+    vm::VMState state(module, pool, platform);
+
+    vm::VMScheduler scheduler(platform);
+    vm::VMScheduler::TaskConfig config;
+    config.keepAlive = true;
+    scheduler.add(state, config);
+
+    // Host loop: jump the clock straight to each reported deadline
+    int passes = 0;
+    uint32_t wait = scheduler.tick();
+    while (wait != vm::VMScheduler::NO_DEADLINE && passes < 100) {
+        clock += wait;
+        wait = scheduler.tick();
+        passes++;
+    }
+
+    CHECK(platform.output == "ttot", "fire order: " << platform.output);
+    CHECK(!state.hasError(), "no VM error: " << state.getError());
+    CHECK(!platform.hasTimers(), "all timers done");
+    CHECK(passes == 4, "one pass per deadline, got " << passes);
+    CHECK(clock == 300, "ended at last deadline, got " << clock);
+}
+
+int main() {
+    std::cout << "=== Timer Service Test ===" << std::endl << std::endl;
+
+    testOrdering();
+    testCancel();
+    testDriftFree();
+    testCallbackScheduling();
+    testClockWrap();
+    testScriptTimers();
+
+    return test::summary();
+}
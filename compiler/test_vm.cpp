@@ -105,7 +105,7 @@ public:
     void buzzer_stop() override {}
     
     // Timer (stubs)
-    int timer_setTimeout(int /*ms*/) override { return -1; }
+    int timer_setTimeout(const vm::Value& /*callback*/, int /*ms*/) override { return -1; }
     int timer_setInterval(const vm::Value& /*callback*/, int /*ms*/) override { return -1; }
     void timer_clearTimeout(int /*id*/) override {}
     void timer_clearInterval(int /*id*/) override {}
@@ -0,0 +1,320 @@
+/**
+ * VM Scheduler Test
+ *
+ * Runs several VMs through VMScheduler on a virtual clock and checks slice
+ * interleaving, priorities, sleep deadlines, time budgets, repeat intervals,
+ * event delivery to VMs that stay resident after their main code, and that
+ * an event-driven host loop only wakes for deadlines and posted events.
+ */
+
+#include "vm/vm_scheduler.h"
+#include "test_platform.h"
+#include "test_check.h"
+#include <algorithm>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+using namespace dialos;
+
+// One VM with its own module, heap and platform, all sharing a clock
+struct Applet {
+    compiler::BytecodeModule module;
+    std::unique_ptr<vm::ValuePool> pool;
+    vm::TestPlatform platform;
+    std::unique_ptr<vm::VMState> vm;
+
+    Applet(const std::string& source, uint32_t* clock)
+        : module(vm::compileScript(source)) {
+        platform.sharedClock = clock;
+        pool.reset(new vm::ValuePool(4096));
+        vm.reset(new vm::VMState(module, *pool, platform));
+    }
+};
+
+static std::string printLoop(const std::string& tag, int count) {
+    return "var n: 0;\n"
+           "while (n < " + std::to_string(count) + ") {\n"
+           "    assign n n + 1;\n"
+           "    os.console.print(\"" + tag + "\");\n"
+           "    os.system.yield();\n"
+           "}\n";
+}
+
+static void testRoundRobin() {
+    std::cout << "round robin" << std::endl;
+    uint32_t clock = 0;
+    vm::TestPlatform host;
+    host.sharedClock = &clock;
+
+    Applet a(printLoop("A", 4), &clock);
+    Applet b(printLoop("B", 4), &clock);
+    vm::VMScheduler scheduler(host);
+    vm::VMScheduler::TaskConfig config;
+    vm::VMScheduler::TaskId ida = scheduler.add(*a.vm, config);
+    vm::VMScheduler::TaskId idb = scheduler.add(*b.vm, config);
+
+    for (int i = 0; i < 20 && scheduler.getLiveTaskCount() > 0; i++) {
+        scheduler.tick();
+    }
+
+    CHECK(a.platform.output == "AAAA", "A output: " << a.platform.output);
+    CHECK(b.platform.output == "BBBB", "B output: " << b.platform.output);
+    CHECK(scheduler.getTaskInfo(ida)->status == vm::VMTaskStatus::FINISHED, "A finished");
+    CHECK(scheduler.getTaskInfo(idb)->status == vm::VMTaskStatus::FINISHED, "B finished");
+    // Each yield ends a slice, so both VMs progress one step per pass
+    CHECK(scheduler.getTaskInfo(ida)->slices == scheduler.getTaskInfo(idb)->slices, "equal slices");
+}
+
+static void testPriority() {
+    std::cout << "priority" << std::endl;
+    uint32_t clock = 0;
+    vm::TestPlatform host;
+    host.sharedClock = &clock;
+
+    Applet low(printLoop("L", 2), &clock);
+    Applet high(printLoop("H", 2), &clock);
+    vm::VMScheduler scheduler(host, vm::SchedulePolicy::PRIORITY);
+    vm::VMScheduler::TaskConfig config;
+    config.priority = 1;
+    scheduler.add(*low.vm, config);
+    config.priority = 9;
+    vm::VMScheduler::TaskId highId = scheduler.add(*high.vm, config);
+
+    // A 1ms pass budget with every high-priority slice costing 1ms leaves
+    // no room for the low-priority VM until the high one is done
+    scheduler.setTimeBudget(1);
+    scheduler.setEventPoll(highId, [&clock]() { clock += 1; return false; });
+
+    scheduler.tick();
+    scheduler.tick();
+    CHECK(high.platform.output == "HH", "high ran: " << high.platform.output);
+    CHECK(low.platform.output.empty(), "low starved while high busy: " << low.platform.output);
+
+    for (int i = 0; i < 10 && scheduler.getLiveTaskCount() > 0; i++) {
+        scheduler.tick();
+    }
+    CHECK(low.platform.output == "LL", "low ran afterwards: " << low.platform.output);
+}
+
+static void testSleepDeadline() {
+    std::cout << "sleep deadlines" << std::endl;
+    uint32_t clock = 1000;
+    vm::TestPlatform host;
+    host.sharedClock = &clock;
+
+    Applet sleeper("os.system.sleep(500);\nos.console.print(\"woke\");\n", &clock);
+    vm::VMScheduler scheduler(host);
+    vm::VMScheduler::TaskId id = scheduler.add(*sleeper.vm, vm::VMScheduler::TaskConfig());
+
+    uint32_t wait = scheduler.tick();
+    CHECK(wait == 500, "first wait should be 500, got " << wait);
+    CHECK(scheduler.getTaskInfo(id)->status == vm::VMTaskStatus::SLEEPING, "sleeping");
+
+    clock += 200;
+    wait = scheduler.tick();
+    CHECK(wait == 300, "remaining wait should be 300, got " << wait);
+    CHECK(sleeper.platform.output.empty(), "not woken early");
+
+    clock += 300;
+    scheduler.tick();
+    CHECK(sleeper.platform.output == "woke", "woke after deadline");
+    CHECK(scheduler.getTaskInfo(id)->status == vm::VMTaskStatus::FINISHED, "finished");
+    CHECK(scheduler.tick() == vm::VMScheduler::NO_DEADLINE, "idle scheduler has no deadline");
+}
+
+static void testTimeBudget() {
+    std::cout << "time budget" << std::endl;
+    uint32_t clock = 0;
+    vm::TestPlatform host;
+    host.sharedClock = &clock;
+
+    // Every slice "costs" 10ms of virtual time via the poll hook
+    std::vector<std::unique_ptr<Applet>> applets;
+    vm::VMScheduler scheduler(host);
+    scheduler.setTimeBudget(5);
+    for (int i = 0; i < 3; i++) {
+        applets.emplace_back(new Applet(printLoop(std::string(1, static_cast<char>('x' + i)), 100), &clock));
+        vm::VMScheduler::TaskId id = scheduler.add(*applets.back()->vm, vm::VMScheduler::TaskConfig());
+        scheduler.setEventPoll(id, [&clock]() { clock += 10; return false; });
+    }
+
+    for (int i = 0; i < 30; i++) {
+        CHECK(scheduler.tick() == 0, "budget-limited pass reports more work");
+    }
+    // One slice per pass, rotating fairly across all three VMs
+    for (auto& applet : applets) {
+        CHECK(applet->platform.output.size() == 10, "fair share, got " << applet->platform.output.size());
+    }
+}
+
+static void testRepeatInterval() {
+    std::cout << "repeat interval" << std::endl;
+    uint32_t clock = 0;
+    vm::TestPlatform host;
+    host.sharedClock = &clock;
+
+    Applet ticker("os.console.print(\"t\");\n", &clock);
+    vm::VMScheduler scheduler(host);
+    vm::VMScheduler::TaskConfig config;
+    config.repeat = true;
+    config.repeatIntervalMs = 100;
+    vm::VMScheduler::TaskId id = scheduler.add(*ticker.vm, config);
+
+    for (int i = 0; i < 5; i++) {
+        uint32_t wait = scheduler.tick();
+        CHECK(wait == 100, "repeat wait should be 100, got " << wait);
+        clock += wait;
+    }
+    CHECK(ticker.platform.output == "ttttt", "ran once per interval: " << ticker.platform.output);
+    CHECK(scheduler.getTaskInfo(id)->runCount == 5, "run count");
+}
+
+static void testEventDelivery() {
+    std::cout << "event delivery" << std::endl;
+    uint32_t clock = 0;
+    vm::TestPlatform host;
+    host.sharedClock = &clock;
+
+    Applet listener(
+        "var turns: 0;\n"
+        "function onTurn(delta: int): void {\n"
+        "    assign turns turns + delta;\n"
+        "    os.console.print(`turn ${turns};`);\n"
+        "}\n"
+        "os.encoder.onTurn(onTurn);\n", &clock);
+
+    vm::VMScheduler scheduler(host);
+    vm::VMScheduler::TaskConfig config;
+    config.keepAlive = true;
+    vm::VMScheduler::TaskId id = scheduler.add(*listener.vm, config);
+
+    int pending = 0;
+    vm::TestPlatform* platform = &listener.platform;
+    scheduler.setEventPoll(id, [&pending, platform]() {
+        if (pending == 0) {
+            return false;
+        }
+        std::vector<vm::Value> args;
+        args.push_back(vm::Value::Int32(pending));
+        pending = 0;
+        return platform->invokeCallback("encoder.onTurn", args);
+    });
+
+    CHECK(scheduler.tick() == vm::VMScheduler::NO_DEADLINE, "waiting for events");
+    CHECK(scheduler.getTaskInfo(id)->status == vm::VMTaskStatus::WAITING_EVENT, "resident after main");
+
+    pending = 2;
+    scheduler.tick();
+    pending = 3;
+    scheduler.tick();
+    CHECK(listener.platform.output == "turn 2;turn 5;", "callbacks ran: " << listener.platform.output);
+    CHECK(scheduler.getLiveTaskCount() == 1, "still live");
+}
+
+static void testEventDrivenIdle() {
+    std::cout << "event-driven idle" << std::endl;
+    uint32_t clock = 0;
+    vm::TestPlatform host;
+    host.sharedClock = &clock;
+
+    Applet listener(
+        "function onTurn(delta: int): void {\n"
+        "    os.console.print(`turn ${delta};`);\n"
+        "}\n"
+        "os.encoder.onTurn(onTurn);\n", &clock);
+    Applet ticker(
+        "while (true) {\n"
+        "    os.system.sleep(1000);\n"
+        "    os.console.print(\"s\");\n"
+        "}\n", &clock);
+
+    vm::VMScheduler scheduler(host);
+    int wakes = 0;
+    scheduler.setWakeHandler([&wakes]() { wakes++; });
+    vm::VMScheduler::TaskConfig config;
+    config.keepAlive = true;
+    vm::VMScheduler::TaskId listenerId = scheduler.add(*listener.vm, config);
+    scheduler.add(*ticker.vm, vm::VMScheduler::TaskConfig());
+
+    // Host loop: block until the scheduler deadline or the next input event
+    const uint32_t runMs = 10000;
+    const uint32_t inputAt[] = {2500, 2600, 7000};
+    size_t nextInput = 0;
+    int passes = 0;
+    while (clock < runMs) {
+        uint32_t wait = scheduler.tick();
+        passes++;
+        uint32_t deadline = wait == vm::VMScheduler::NO_DEADLINE ? runMs : std::min(runMs, clock + wait);
+        if (nextInput < 3 && inputAt[nextInput] <= deadline) {
+            clock = inputAt[nextInput++];
+            std::vector<vm::Value> args;
+            args.push_back(vm::Value::Int32(static_cast<int32_t>(nextInput)));
+            scheduler.postEvent(listenerId, "encoder.onTurn", args);
+        } else {
+            clock = deadline;
+        }
+    }
+
+    CHECK(listener.platform.output == "turn 1;turn 2;turn 3;", "posted events: " << listener.platform.output);
+    CHECK(ticker.platform.output == "sssssssss", "sleep expiries: " << ticker.platform.output);
+    CHECK(wakes == 3, "wake handler per post, got " << wakes);
+    CHECK(scheduler.getTaskInfo(listenerId)->eventsDelivered == 3, "events delivered");
+
+    // A 10ms polling loop would have made runMs / 10 passes
+    std::cout << "  passes over " << runMs << "ms: " << passes << " (10ms polling: " << runMs / 10 << ")" << std::endl;
+    CHECK(passes <= 20, "idle loop woke too often: " << passes << " passes");
+
+    CHECK(!scheduler.postEvent(vm::VMScheduler::INVALID_TASK, "encoder.onTurn", std::vector<vm::Value>()),
+          "post to unknown task rejected");
+}
+
+static void testManyVMs() {
+    std::cout << "many VMs" << std::endl;
+    uint32_t clock = 0;
+    vm::TestPlatform host;
+    host.sharedClock = &clock;
+
+    const int count = 16;
+    std::vector<std::unique_ptr<Applet>> applets;
+    vm::VMScheduler scheduler(host);
+    for (int i = 0; i < count; i++) {
+        applets.emplace_back(new Applet(
+            "var i: 0;\n"
+            "while (i < 3) {\n"
+            "    assign i i + 1;\n"
+            "    os.system.sleep(" + std::to_string(10 + i) + ");\n"
+            "}\n"
+            "os.console.print(\"done\");\n", &clock));
+        scheduler.add(*applets.back()->vm, vm::VMScheduler::TaskConfig());
+    }
+
+    int passes = 0;
+    while (scheduler.getLiveTaskCount() > 0 && passes < 1000) {
+        uint32_t wait = scheduler.tick();
+        if (wait != vm::VMScheduler::NO_DEADLINE) {
+            clock += wait;
+        }
+        passes++;
+    }
+    for (auto& applet : applets) {
+        CHECK(applet->platform.output == "done", "VM completed");
+    }
+    // Blocking until the next deadline keeps the pass count small
+    CHECK(passes < 100, "scheduler busy-looped: " << passes << " passes");
+}
+
+int main() {
+    std::cout << "=== VM Scheduler Test ===" << std::endl << std::endl;
+
+    testRoundRobin();
+    testPriority();
+    testSleepDeadline();
+    testTimeBudget();
+    testRepeatInterval();
+    testEventDelivery();
+    testEventDrivenIdle();
+    testManyVMs();
+
+    return test::summary();
+}
@@ -488,6 +488,7 @@ function Update-AppletRegistry {
 // This section is auto-generated - do not edit manually
 #include <stdint.h>
 #include <stddef.h>
+#include "vm/module_image.h"
 // Generated bytecode arrays from dialScript (.ds) files
 
 
@@ -525,6 +526,7 @@ struct VMApplet {
   const char *name;
   const unsigned char *bytecode;
   size_t bytecodeSize;
+  const dialos::compiler::ModuleImage *module;  // pre-deserialized image in flash (nullptr = deserialize bytecode)
   uint32_t executeInterval;  // ms between executions (0 = run once)
   bool repeat;               // true = repeat indefinitely, false = run once
 };
@@ -545,7 +547,7 @@ static const int BUILTIN_APPLET_REGISTRY_SIZE = 0;
             $name = $applet.FileName.ToLower()
             $arrayName = $applet.ArrayName
             # Generate entry using the expected array and size identifiers generated by the compiler
-            $registryCode += "    {`"$name`", $arrayName, ${arrayName}_SIZE, 0, false},`n"
+            $registryCode += "    {`"$name`", $arrayName, ${arrayName}_SIZE, &${arrayName}_MODULE, 0, false},`n"
         }
 
         $registryCode += @"
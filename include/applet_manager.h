@@ -5,6 +5,8 @@
 #include <vector>
 #include <cstdint>
 #include <M5Dial.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
 #include "Encoder.h"
 
 #include "kernel/task.h"
@@ -13,21 +15,80 @@
 #include "kernel/kernel.h"
 #include "vm/platform.h"
 #include "vm/vm_core.h"
+#include "vm/vm_scheduler.h"
+#include "vm/ipc_bus.h"
 #include "vm_builtin_applets.h"
 #include "esp32_platform.h"
+#include "input_source.h"
+#include "power_manager.h"
 
 
-// VM task state structure to avoid static variable conflicts
-struct VMTaskState {
+// Resources for one running VM applet (owned by VMRuntime)
+struct VMAppletInstance {
+  const VMApplet *applet = nullptr;
   dialos::vm::VMState *vmState = nullptr;
   dialos::vm::ValuePool *pool = nullptr;
-  ESP32Platform *platform = nullptr;
-  dialos::compiler::BytecodeModule *module = nullptr;
-  int executionCount = 0;
-  bool initialized = false;
-  bool hasFinished = false;
+  dialos::vm::ESP32Platform *platform = nullptr;
+  dialos::compiler::BytecodeModule *module = nullptr;  // only set when deserialized
+  dialos::vm::VMScheduler::TaskId schedulerId = dialos::vm::VMScheduler::INVALID_TASK;
 };
 
+// Kernel task that runs VM applets through one VMScheduler, instead of one
+// FreeRTOS task (and 16 KB stack) per applet. There is one runtime per CPU
+// core, pinned to it, so independent applets execute in parallel.
+class VMRuntime {
+public:
+    static const int CORE_COUNT = portNUM_PROCESSORS;
+
+    static VMRuntime &forCore(int core);
+    // Runtime for a core-affinity hint: that core's runtime, or the least
+    // loaded one for dialOS::ANY_CORE
+    static VMRuntime &select(int coreHint);
+
+    dialOS::Task *start();                          // create the runtime task (idempotent)
+    void launch(const VMApplet *applet);    // queue an applet to be loaded (or resumed) by the runtime task
+    bool suspend(const char *appletName);   // queue a running applet to be snapshotted into the warm pool and freed
+    size_t getAppletCount();
+    int getCore() const { return core; }
+
+private:
+    explicit VMRuntime(int core);
+
+    static void taskEntry(byte taskId, void *param);
+    void run();
+    void reap();                            // free applets that finished or failed
+    void startApplets();                    // load queued applets and hand them to the scheduler
+    void suspendApplets();                  // snapshot and free applets queued by suspend()
+    VMAppletInstance *load(const VMApplet *applet, bool &resumed);
+    void destroy(VMAppletInstance *inst);
+    void wake();                            // interrupt the runtime's idle wait
+    void drainInput();                      // turn queued input into posted events
+
+    static const uint32_t INSTRUCTION_BUDGET = 1000;
+    static const uint32_t FRAME_INTERVAL_MS = 16;  // display flush cap while busy (~60 FPS)
+
+    int core;                               // core the runtime task is pinned to
+    dialos::vm::ESP32Platform clock;        // time source for the scheduler
+    dialos::vm::VMScheduler scheduler;
+    std::vector<VMAppletInstance *> applets;
+    std::vector<const VMApplet *> launches; // queued by launch(), loaded on the runtime task
+    std::vector<const VMApplet *> suspensions;  // queued by suspend(), snapshotted on the runtime task
+    SemaphoreHandle_t lock;                 // guards scheduler, applets and both queues (launch/suspend run on other tasks)
+    dialOS::Task *task;
+    InputSource::Consumer *input;           // this runtime's input rings
+    dialos::vm::IdleManager::SourceId idleSource;  // reports the next deadline for tickless idle
+    uint32_t lastFrameMs;                   // last display flush
+};
+
+// Launch a registry applet on a VM runtime (see VMRuntime::select for the
+// core hint); returns the runtime task, which loads the applet on its next pass
+dialOS::Task *createVMTask(const char *appletName, int coreHint = dialOS::ANY_CORE);
+
+// Suspend a running applet on whichever runtime has it; its next launch
+// resumes from the snapshot (app.onSuspend / app.onResume fire around it).
+// The runtime does the work on its next pass; false if none runs the applet.
+bool suspendVMApplet(const char *appletName);
+
 class AppletManager {
 public:
     static void start(); // create the kernel task
@@ -60,6 +121,7 @@ private:
     unsigned long lastChangeMs;
     const unsigned long selectionConfirmMs = 1500;
     int lastEncoderValue;
+    const char *foreground;                 // applet launched last (suspended on switch)
 
     static AppletManager *instance;
 };
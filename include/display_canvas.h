@@ -0,0 +1,83 @@
+#ifndef DIALOS_DISPLAY_CANVAS_H
+#define DIALOS_DISPLAY_CANVAS_H
+
+#include <M5Dial.h>
+#include <cstdint>
+#include "vm/display_list.h"
+#include "vm/dirty_tiles.h"
+#include "vm/image_codec.h"
+
+// Off-screen frame for the VM applets. Each applet's display.* calls are
+// recorded into a DisplayList during its slice and rasterised here at the
+// end of it; the panel only receives the 16x16 tiles whose pixels actually
+// changed, pushed with DMA at frame end. A clear-and-redraw that only
+// changes a digit therefore sends a few hundred bytes instead of 115 KB.
+//
+// The canvas is one full-screen RGB565 sprite (115 KB of DMA-capable RAM)
+// shared by all runtimes. If it can't be allocated, ESP32Platform draws
+// straight to the panel as before. Not thread-safe: callers hold the
+// display lock.
+class DisplayCanvas {
+public:
+  // Per-frame instrumentation (a frame is one flush)
+  struct Stats {
+    uint32_t frames = 0;            // flushes that sent something
+    uint32_t commands = 0;          // commands rasterised for the last frame
+    uint32_t dirtyPixels = 0;       // area the last frame's commands touched
+    uint32_t spiBytes = 0;          // pixel bytes sent for the last frame
+    uint32_t rects = 0;             // DMA transfers for the last frame
+    uint32_t rasterUs = 0;          // time spent rasterising the last frame
+    uint32_t flushUs = 0;           // time spent hashing + pushing it
+    uint64_t totalSpiBytes = 0;     // since boot
+  };
+
+  static const int WIDTH = 240;     // M5Dial panel
+  static const int HEIGHT = 240;
+
+  static DisplayCanvas &instance();
+
+  // Allocate the canvas on first use; false means draw directly instead
+  bool begin();
+  bool isActive() const { return buffer != nullptr; }
+
+  // Rasterise a recorded list into the canvas and mark what it touched
+  void draw(const dialos::vm::DisplayList &list);
+
+  // Frame end: push the changed tiles to the panel. Returns the pixel bytes
+  // sent (0 when nothing changed).
+  size_t flush();
+  bool isDirty() const { return tiles.any(); }
+
+  // Something drew on the panel behind the canvas' back: resend every
+  // tile the next frames touch
+  void invalidate() { tiles.invalidate(); }
+
+  const Stats &getStats() const { return stats; }
+
+  // Push the w x h region at (sx, sy) of a decoded image to `target` at
+  // (x, y), skipping `transparent` pixels (-1: none). Whole rows go in one
+  // pushImage, a narrower region row by row.
+  static void pushBitmap(lgfx::LovyanGFX &target, int32_t x, int32_t y,
+                         const dialos::vm::Image &image, int32_t sx, int32_t sy,
+                         int32_t w, int32_t h, int32_t transparent);
+
+private:
+  DisplayCanvas();
+
+  void pushRect(const dialos::vm::Rect &area);
+
+  static const int BAND_ROWS = dialos::vm::DirtyTiles::TILE_SIZE;
+
+  M5Canvas canvas;
+  uint16_t *buffer;               // canvas pixels (byte-swapped RGB565)
+  uint16_t *staging[2];           // DMA bounce buffers, one band each
+  int nextStaging;
+  bool attempted;                 // begin() already tried to allocate
+  dialos::vm::DirtyTiles tiles;
+  Stats stats;
+  uint32_t pendingCommands;       // since the last flush
+  uint32_t pendingDirty;
+  uint32_t pendingRasterUs;
+};
+
+#endif // DIALOS_DISPLAY_CANVAS_H
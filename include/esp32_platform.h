@@ -2,6 +2,7 @@
 #define ESP32_PLATFORM_H
 
 #include "vm/platform.h"
+#include "vm/display_list.h"
 #include <vector>
 #include <string>
 
@@ -13,7 +14,44 @@ class ESP32Platform : public PlatformInterface {
 private:
   int encoderPosition = 0;
 
+  // VMs on both cores share the display, I2C bus and RAMFS. The display
+  // lock is batched: the first draw call of a slice takes it (and starts an
+  // SPI write transaction) and endSlice() releases it.
+  bool inSlice = false;
+  bool displayHeld = false;
+
+  // With the shared DisplayCanvas available, draw calls are recorded here
+  // and rasterised off-screen at the end of the slice (see display_canvas.h)
+  dialos::vm::DisplayList displayList{240, 240};
+  bool canvasChecked = false;
+  bool canvasActive = false;
+  bool useCanvas();
+
+  // Holds the display for one draw call, or joins the slice's batch
+  class DisplayLock {
+  public:
+    explicit DisplayLock(ESP32Platform &platform);
+    ~DisplayLock();
+
+  private:
+    ESP32Platform &platform;
+    bool batched;
+  };
+
 public:
+  // ===== Event Sources =====
+  // True while the applet has encoder.* or touch.* callbacks registered.
+  // Input itself arrives through the VM runtime's input rings.
+  bool hasInputListeners() const;
+
+  // ===== Slice Hooks =====
+  void beginSlice() override;
+  void endSlice() override;
+
+  // Frame end: push what the runtimes drew since the last call to the
+  // panel (changed tiles only). Called by the VM runtimes.
+  static void presentFrame();
+
   // ===== Console Operations =====
   void console_print(const std::string &message) override;
   void console_println(const std::string &message) override;
@@ -34,6 +72,10 @@ public:
   int display_getHeight() override;
   void display_setTitle(const std::string& title) override;
   void display_drawImage(int x, int y, const std::vector<uint8_t>& imageData) override;
+  void display_drawBitmap(int x, int y, const std::shared_ptr<const Image> &image, int sx, int sy,
+                          int w, int h, int32_t transparent) override;
+  bool display_setClip(int x, int y, int w, int h) override;
+  void display_clearClip() override;
 
   // ===== Encoder Operations =====
   bool encoder_getButton() override;
@@ -91,6 +133,10 @@ public:
   bool file_exists(const std::string& path) override;
   bool file_delete(const std::string& path) override;
   int file_size(const std::string& path) override;
+  bool file_readLine(int handle, std::string& line) override;
+  int file_readBytes(int handle, char* dest, int size) override;
+  bool file_seek(int handle, int position) override;
+  int file_tell(int handle) override;
 
   // ===== Directory Operations =====
   std::vector<std::string> dir_list(const std::string& path) override;
@@ -0,0 +1,71 @@
+#ifndef DIALOS_GLYPH_CACHE_H
+#define DIALOS_GLYPH_CACHE_H
+
+#include <M5Dial.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Pre-rasterised glyphs of the built-in 6x8 font. print() decodes and
+// renders every character again on each call; here each printable ASCII
+// glyph is rendered once (into a 6x8 scratch sprite) and kept as a handful
+// of solid rectangles, so drawing a string is one fillRect per rectangle,
+// scaled by the text size. The rectangles are in font pixels, so one
+// cache serves every text size.
+//
+// Layout follows print(): text wraps at the right edge of the target and
+// on '\n', '\r' is skipped, each cell is 6x8 times the size (see
+// DisplayList::textBounds). The whole cache is a few KB of internal RAM.
+// Not thread-safe: callers hold the display lock.
+class GlyphCache {
+public:
+  struct Stats {
+    uint32_t glyphs = 0;            // glyphs rasterised so far
+    uint32_t rects = 0;             // rectangles kept for them
+    uint32_t drawn = 0;             // strings drawn from the cache
+  };
+
+  static GlyphCache &instance();
+
+  // Draw `text` at (x, y) on `target`. Returns false, drawing nothing, if
+  // the text has characters the cache doesn't hold (outside 0x20-0x7E,
+  // e.g. UTF-8); print it instead.
+  bool drawText(lgfx::LovyanGFX &target, int32_t x, int32_t y, const std::string &text,
+                uint32_t color, int size);
+
+  const Stats &getStats() const { return stats; }
+
+private:
+  static const char FIRST = 0x20;
+  static const char LAST = 0x7E;
+  static const int CELL_WIDTH = 6;
+  static const int CELL_HEIGHT = 8;
+
+  // A solid block of a glyph, in font pixels
+  struct Block {
+    uint8_t x, y, w, h;
+  };
+
+  struct Glyph {
+    bool cached = false;
+    uint16_t first = 0;             // into blocks
+    uint8_t count = 0;
+  };
+
+  GlyphCache();
+
+  static bool cacheable(const std::string &text);
+  // Allocate the scratch sprite on first use
+  bool prepare();
+  const Glyph &glyph(char c);
+  void rasterise(Glyph &glyph, char c);
+
+  M5Canvas scratch;
+  bool attempted;
+  bool ready;
+  Glyph glyphs[LAST - FIRST + 1];
+  std::vector<Block> blocks;
+  Stats stats;
+};
+
+#endif // DIALOS_GLYPH_CACHE_H
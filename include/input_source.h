@@ -0,0 +1,66 @@
+#ifndef DIALOS_INPUT_SOURCE_H
+#define DIALOS_INPUT_SOURCE_H
+
+#include <Arduino.h>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <atomic>
+#include "vm/input_ring.h"
+
+// Producer side of the VM input rings. The encoder and button are sampled
+// by a 1 ms esp_timer callback instead of by whichever task happens to
+// look, so steps are recorded (with their timestamp) even while every VM
+// runtime is busy. Touch state is refreshed by M5Dial.update() in loop(),
+// which then calls sampleTouch().
+//
+// Every consumer (one per VM runtime) gets its own rings, one per producer,
+// so each ring has exactly one writer and one reader.
+class InputSource {
+public:
+  typedef void (*WakeFn)(void *context);
+
+  struct Consumer {
+    dialos::vm::InputRing hardware;  // encoder + button (timer callback)
+    dialos::vm::InputRing touch;     // touch (loop task)
+    WakeFn wake = nullptr;           // called after events were queued
+    void *context = nullptr;
+
+    // Producer-only state: steps/button edges not yet queued because the
+    // ring was full are retried on the next sample, so none are lost
+    int32_t pendingSteps = 0;
+    bool reportedButton = false;
+  };
+
+  static const int MAX_CONSUMERS = portNUM_PROCESSORS;
+  static const uint32_t SAMPLE_PERIOD_US = 1000;
+
+  static InputSource &instance();
+
+  bool start();                                   // start sampling (idempotent)
+  Consumer *attach(WakeFn wake, void *context);   // nullptr when all slots are taken
+  void sampleTouch();                             // call after M5Dial.update()
+  bool isTouchDown() const { return touchDown; }  // loop task only
+
+  // Stop the 1 ms sampling while the system idles (wake pins take over)
+  // and restart it afterwards; PCNT keeps counting encoder steps meanwhile
+  void pause();
+  void resume();
+
+private:
+  InputSource();
+
+  static void onSample(void *arg);
+  void sampleHardware();
+  void notify(Consumer &consumer);
+
+  Consumer consumers[MAX_CONSUMERS];
+  std::atomic<int> consumerCount;  // published after the slot is set up
+  esp_timer_handle_t timer;
+
+  int16_t lastCount;               // timer callback only
+  bool touchDown;                  // loop task only
+  int16_t touchX;
+  int16_t touchY;
+};
+
+#endif // DIALOS_INPUT_SOURCE_H
@@ -48,6 +48,8 @@ public:
     size_t write(int handle, const void* data, size_t size);
     bool seek(int handle, size_t position);
     size_t tell(int handle);
+    // Contents of an open file in place, valid until the file is next written
+    bool view(int handle, const uint8_t** data, size_t* size);
     
     // File management
     bool exists(const char* path);
@@ -15,19 +15,24 @@ enum class TaskPriority {
     LOW_PRIORITY = 1    // Low priority (lowest)
 };
 
+// Core affinity for createTask(): a core index, or ANY_CORE to let
+// FreeRTOS place the task
+const int ANY_CORE = -1;
+
 /**
  * @brief Task Control Block - represents a FreeRTOS task
  */
 class Task {
 public:
     Task(const char* name, void (*function)(byte, void*), void* param, 
-         size_t stackSize, TaskPriority priority);
+         size_t stackSize, TaskPriority priority, int core = ANY_CORE);
     ~Task();
     
     // Task information
     const char* getName() const { return name; }
     uint32_t getId() const { return id; }
     TaskPriority getPriority() const { return priority; }
+    int getCore() const { return core; }
     TaskHandle_t getHandle() const { return taskHandle; }
     
     // Task control
@@ -49,6 +54,7 @@ private:
     uint32_t id;
     char name[32];
     TaskPriority priority;
+    int core;
     TaskHandle_t taskHandle;
     
     void (*taskFunction)(byte, void*);
@@ -70,7 +76,8 @@ public:
     // Task management
     Task* createTask(const char* name, void (*function)(byte, void*), 
                      void* param = nullptr, size_t stackSize = 4096,
-                     TaskPriority priority = TaskPriority::NORMAL);
+                     TaskPriority priority = TaskPriority::NORMAL,
+                     int core = ANY_CORE);
     bool destroyTask(uint32_t taskId);
     
     // Task control
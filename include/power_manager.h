@@ -0,0 +1,48 @@
+#ifndef DIALOS_POWER_MANAGER_H
+#define DIALOS_POWER_MANAGER_H
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include "vm/idle_manager.h"
+
+// Tickless idle for the device. Every VM runtime reports its next deadline
+// (VM sleeps, os.timer.*, async I/O in flight) to one IdleManager, and
+// loop() - instead of spinning on delay(1) - sleeps until the earliest of
+// them. Far-off deadlines are spent in light sleep, woken early by the
+// encoder, the button or the touch controller; short ones in a plain
+// blocking wait. Input sampling pauses for the duration, so an idle dial
+// takes no periodic wakeups at all.
+//
+// Light sleep stops the LEDC backlight and the USB console, so it is only
+// used while the display is dark (brightness 0).
+class PowerManager {
+public:
+  static PowerManager &instance();
+
+  void start();                  // call from setup(), on the loop task
+  void idle();                   // call at the end of loop(); returns when there is work
+  void wake();                   // end the current idle wait (task context only)
+
+  dialos::vm::IdleManager &getIdleManager() { return manager; }
+
+private:
+  PowerManager();
+
+  static void IRAM_ATTR onWakePin(void *arg);
+  uint32_t sleep(dialos::vm::PowerState state, uint32_t ms);
+  void lightSleep(uint32_t ms);
+  void armWakeInterrupts();
+  void disarmWakeInterrupts();
+  void logStats(uint32_t now);
+
+  static const uint32_t INPUT_PAUSE_MIN_MS = 10;   // shorter waits keep sampling
+  static const uint32_t STATS_PERIOD_MS = 60000;   // residency log interval
+
+  dialos::vm::IdleManager manager;
+  dialos::vm::IdleManager::SourceId touchSource;   // loop() itself, while a finger is down
+  TaskHandle_t loopTask;
+  uint32_t lastStatsMs;
+};
+
+#endif // DIALOS_POWER_MANAGER_H
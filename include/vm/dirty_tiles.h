@@ -0,0 +1,70 @@
+/**
+ * dialScript Dirty Tiles
+ *
+ * Decides which parts of an off-screen RGB565 frame have to be sent to the
+ * panel. The screen is split into square tiles; drawing marks the tiles it
+ * touches, and at frame end each marked tile is hashed and compared with
+ * the hash of what was last sent. Only tiles whose pixels really changed
+ * are reported, merged into rectangles, so an applet that clears and
+ * redraws the whole screen to update one digit costs one digit's worth of
+ * bus traffic.
+ *
+ * A hash collision would leave a stale tile on screen until it next
+ * changes; with a 32-bit hash per 256-pixel tile that is negligible.
+ */
+
+#ifndef DIALOS_VM_DIRTY_TILES_H
+#define DIALOS_VM_DIRTY_TILES_H
+
+#include "vm/display_list.h"
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace dialos {
+namespace vm {
+
+class DirtyTiles {
+public:
+    static const int TILE_SIZE = 16;
+
+    // Receives one changed rectangle (pixel coordinates, inside the screen)
+    typedef std::function<void(const Rect& area)> PushHandler;
+
+    DirtyTiles(int width, int height);
+
+    // Mark the tiles overlapping `area` (clipped to the screen)
+    void mark(const Rect& area);
+    bool any() const { return markedCount_ > 0; }
+
+    // Forget what the panel shows: the next collect() reports every marked
+    // tile, changed or not (e.g. after something drew around the frame)
+    void invalidate();
+
+    // Hash the marked tiles of `pixels` (`stride` pixels per row), report
+    // the changed ones to `push` as rectangles - runs along a tile row,
+    // joined with the row below when they line up - and clear the marks.
+    // Returns the number of pixels reported.
+    size_t collect(const uint16_t* pixels, int stride, const PushHandler& push);
+
+    int tileColumns() const { return columns_; }
+    int tileRows() const { return rows_; }
+
+private:
+    uint32_t hashTile(const uint16_t* pixels, int stride, int column, int row) const;
+    Rect tileRect(int column, int row) const;
+
+    int width_;
+    int height_;
+    int columns_;
+    int rows_;
+    std::vector<uint8_t> marked_;
+    std::vector<uint32_t> hashes_;      // Of each tile as last reported
+    std::vector<uint8_t> known_;        // hashes_ entry is valid
+    size_t markedCount_;
+};
+
+} // namespace vm
+} // namespace dialos
+
+#endif // DIALOS_VM_DIRTY_TILES_H
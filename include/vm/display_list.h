@@ -0,0 +1,131 @@
+/**
+ * dialScript Display List
+ *
+ * Records display.* calls as commands instead of drawing them, so a
+ * platform can rasterise a whole frame off-screen and push only what
+ * changed. Each command knows its (conservative) screen bounds, which is
+ * what the dirty-region tracking works from.
+ *
+ * Text bounds assume the 6x8 built-in font scaled by the text size; text
+ * containing a newline is taken to run to the bottom of the screen.
+ */
+
+#ifndef DIALOS_VM_DISPLAY_LIST_H
+#define DIALOS_VM_DISPLAY_LIST_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace dialos {
+namespace vm {
+
+struct Image;
+
+// Axis-aligned rectangle in screen pixels (empty when w or h <= 0)
+struct Rect {
+    int32_t x, y, w, h;
+
+    Rect() : x(0), y(0), w(0), h(0) {}
+    Rect(int32_t x, int32_t y, int32_t w, int32_t h) : x(x), y(y), w(w), h(h) {}
+
+    bool empty() const { return w <= 0 || h <= 0; }
+    int32_t area() const { return empty() ? 0 : w * h; }
+    Rect united(const Rect& other) const;       // Bounding box of both
+    Rect intersected(const Rect& other) const;  // Overlap (empty if none)
+};
+
+class DisplayList {
+public:
+    static const int GLYPH_WIDTH = 6;           // Built-in font cell
+    static const int GLYPH_HEIGHT = 8;
+
+    enum class Op : uint8_t {
+        CLEAR,          // color
+        TEXT,           // x, y, color, size, text
+        RECT,           // x, y, w, h, color, filled
+        CIRCLE,         // x, y, r (in w), color, filled
+        LINE,           // x, y to x2 (in w), y2 (in h), color
+        PIXEL,          // x, y, color
+        IMAGE,          // x, y, w, h; big-endian RGB565 pixels in data
+        BITMAP,         // x, y, w, h, colour key (or NO_KEY) in color; decoded image in bitmaps
+        CLIP            // x, y, w, h; w <= 0 removes the clip
+    };
+
+    static const uint32_t NO_KEY = 0xFFFFFFFF;
+
+    // A region of a decoded image, held until the list is reset
+    struct Bitmap {
+        std::shared_ptr<const Image> image;
+        int32_t sx, sy;
+    };
+
+    struct Command {
+        Op op;
+        bool filled;
+        uint8_t size;
+        int32_t x, y, w, h;
+        uint32_t color;
+        uint32_t payload;           // Index into texts (TEXT) or bitmaps (BITMAP), data offset (IMAGE)
+    };
+
+    DisplayList(int width, int height) : width_(width), height_(height) {}
+
+    void clear(uint32_t color);
+    void drawText(int x, int y, const std::string& text, uint32_t color, int size);
+    void drawRect(int x, int y, int w, int h, uint32_t color, bool filled);
+    void drawCircle(int x, int y, int r, uint32_t color, bool filled);
+    void drawLine(int x1, int y1, int x2, int y2, uint32_t color);
+    void drawPixel(int x, int y, uint32_t color);
+    // `image` is the display.drawImage format: width and height as
+    // big-endian uint16, then width*height big-endian RGB565 pixels.
+    // Malformed images are dropped.
+    void drawImage(int x, int y, const std::vector<uint8_t>& image);
+    // The w x h region at (sx, sy) of a decoded image (inside it); pixels
+    // equal to `transparent` are skipped, -1 draws them all. Records a
+    // reference, not a copy.
+    void drawBitmap(int x, int y, const std::shared_ptr<const Image>& image, int sx, int sy, int w, int h,
+                    int32_t transparent);
+    // Later commands (clear included) only touch `area`, until clearClip()
+    void setClip(const Rect& area);
+    void clearClip();
+
+    // Area text drawn at (x, y) covers on a width x height screen
+    // (unclipped; wrapping text runs to the bottom of the screen)
+    static Rect textBounds(int x, int y, const std::string& text, int size, int width, int height);
+    // Size of `text` at `size` without wrapping: the longest line by the
+    // number of lines (one for empty text)
+    static void measureText(const std::string& text, int size, int32_t& width, int32_t& height);
+    // Screen area `command` can touch, clipped to the screen (not to the
+    // clip in effect when it runs; CLIP itself touches nothing)
+    Rect bounds(const Command& command) const;
+    // Union of all command bounds, within their clips
+    const Rect& dirty() const { return dirty_; }
+
+    const std::vector<Command>& commands() const { return commands_; }
+    const std::string& text(const Command& command) const { return texts_[command.payload]; }
+    const uint8_t* imageData(const Command& command) const { return data_.data() + command.payload; }
+    const Bitmap& bitmap(const Command& command) const { return bitmaps_[command.payload]; }
+
+    bool empty() const { return commands_.empty(); }
+    // Drop all commands; keeps the capacity for the next frame
+    void reset();
+
+private:
+    void add(const Command& command);
+
+    int width_;
+    int height_;
+    std::vector<Command> commands_;
+    std::vector<std::string> texts_;
+    std::vector<uint8_t> data_;
+    std::vector<Bitmap> bitmaps_;
+    Rect clip_;                 // Empty when not clipped
+    Rect dirty_;
+};
+
+} // namespace vm
+} // namespace dialos
+
+#endif // DIALOS_VM_DISPLAY_LIST_H
@@ -0,0 +1,85 @@
+/**
+ * dialScript Buffered File Reader
+ *
+ * Read-ahead buffer behind os.file.readLine / readBytes / seek / tell (and
+ * file.read on platforms that use it). A script reading a file line by
+ * line costs one buffer fill per BUFFER_SIZE bytes instead of one
+ * platform read per call, and seeking within the buffered window doesn't
+ * touch the file at all.
+ *
+ * Two sources:
+ *   - attach(): positional reads through a callback, BUFFER_SIZE at a time
+ *   - view(): memory holding the whole file (a host mmap, a RAM file);
+ *     nothing is copied until a line or a block is handed out
+ *
+ * Lines end at "\n"; a "\r" before it is dropped, and a last line without
+ * a newline is still returned. Not thread-safe: one reader per handle.
+ */
+
+#ifndef DIALOS_VM_FILE_READER_H
+#define DIALOS_VM_FILE_READER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace dialos {
+namespace vm {
+
+class FileReader {
+public:
+#if defined(ARDUINO)
+    static const size_t BUFFER_SIZE = 512;
+#else
+    static const size_t BUFFER_SIZE = 16 * 1024;
+#endif
+
+    // Fill `dest` with up to `size` bytes from `offset`; bytes read, 0 at the end
+    typedef std::function<size_t(uint32_t offset, char* dest, size_t size)> Source;
+
+    FileReader();
+
+    FileReader(const FileReader&) = delete;
+    FileReader& operator=(const FileReader&) = delete;
+
+    // Buffered reads from a file of `size` bytes, starting at offset 0
+    void attach(Source source, uint32_t size);
+
+    // Read straight from `size` bytes at `data`. Call again to refresh the
+    // view (the memory may move); the position is kept.
+    void view(const char* data, uint32_t size);
+
+    // Next line without its line ending; false at the end of the file
+    bool readLine(std::string& line);
+
+    // Up to `size` bytes; large reads skip the buffer
+    size_t read(char* dest, size_t size);
+
+    // Move to `position` (at most size()); keeps the buffer if it covers it
+    bool seek(uint32_t position);
+
+    uint32_t tell() const { return position_; }
+    uint32_t size() const { return size_; }
+    bool viewing() const { return !source_; }
+    uint32_t fills() const { return fills_; }       // Source reads so far
+
+private:
+    bool covered() const { return position_ >= windowStart_ && position_ < windowStart_ + windowLength_; }
+    bool fill();                        // Make the window cover position_
+
+    Source source_;
+    std::vector<char> buffer_;
+    const char* window_;                // buffer_ or the view
+    uint32_t windowStart_;              // File offset of window_[0]
+    uint32_t windowLength_;
+    uint32_t position_;
+    uint32_t size_;
+    uint32_t fills_;
+};
+
+} // namespace vm
+} // namespace dialos
+
+#endif // DIALOS_VM_FILE_READER_H
@@ -0,0 +1,89 @@
+/**
+ * dialScript Software Framebuffer
+ *
+ * An RGB565 frame with software rasterisers for every display.* primitive,
+ * following the rules of the device's graphics library: the 6x8 built-in
+ * font scaled by the text size, text that wraps at the right edge and on
+ * '\n', negative rect sizes extending up/left, and the classic midpoint
+ * circles. The emulator draws into one of these and uploads it once per
+ * frame, and tests can read the pixels back.
+ *
+ * Pixels are native-endian RGB565; everything is clipped to the frame,
+ * or to a narrower clip rectangle while one is set.
+ * Runs of pixels go through the vectorised kernels in vm/raster.h.
+ */
+
+#ifndef DIALOS_VM_FRAMEBUFFER_H
+#define DIALOS_VM_FRAMEBUFFER_H
+
+#include "vm/display_list.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace dialos {
+namespace vm {
+
+class Framebuffer {
+public:
+    Framebuffer(int width, int height);
+
+    void clear(uint16_t color);
+    void drawPixel(int x, int y, uint16_t color);
+    void drawLine(int x1, int y1, int x2, int y2, uint16_t color);
+    void drawRect(int x, int y, int w, int h, uint16_t color, bool filled);
+    void drawCircle(int x, int y, int r, uint16_t color, bool filled);
+    // Transparent background; the cursor wraps to x = 0 like the device's
+    void drawText(int x, int y, const std::string& text, uint16_t color, int size);
+    // display.drawImage format (see DisplayList::drawImage); malformed
+    // images are ignored
+    void drawImage(int x, int y, const std::vector<uint8_t>& image);
+    // Native-endian w x h pixels, `stride` pixels per source row (0: w);
+    // pixels equal to `transparent` (0..65535) are skipped, -1 copies
+    // everything
+    void pushImage(int x, int y, int w, int h, const uint16_t* pixels, int32_t transparent = -1,
+                   int stride = 0);
+    // Native-endian w x h pixels over the frame at `alpha` (255 = opaque)
+    void blendImage(int x, int y, int w, int h, const uint16_t* pixels, uint8_t alpha);
+
+    // Restrict all drawing (clear included) to `area` until clearClip()
+    void setClip(const Rect& area);
+    void clearClip();
+
+    // Rasterise a recorded frame
+    void draw(const DisplayList& list);
+
+    // Copy the frame into `out` (`stride` pixels per row), keeping only the
+    // pixels inside the circle of `radius` around the centre - what a round
+    // panel shows - and filling the rest with `outside`
+    void copyCircular(uint16_t* out, int stride, int radius, uint16_t outside) const;
+
+    int width() const { return width_; }
+    int height() const { return height_; }
+    const uint16_t* pixels() const { return pixels_.data(); }
+    uint16_t pixel(int x, int y) const;         // 0 outside the frame
+
+    // Set by every drawing call; the owner clears it once it has uploaded
+    bool isChanged() const { return changed_; }
+    void clearChanged() { changed_ = false; }
+
+private:
+    void fillSpan(int x, int y, int w, uint16_t color);    // Horizontal run
+    void fillBlock(int x, int y, int w, int h, uint16_t color);
+    void drawGlyph(int x, int y, char c, uint16_t color, int size);
+    // Clip a w x h block at (x, y); false if nothing is left. `skipX` and
+    // `skipY` are the source pixels cut off at the left and top.
+    bool clipBlock(int& x, int& y, int& w, int& h, int& skipX, int& skipY) const;
+    void blitBigEndian(int x, int y, int w, int h, const uint8_t* data);
+
+    int width_;
+    int height_;
+    std::vector<uint16_t> pixels_;
+    Rect clip_;                 // Drawable area: the whole frame unless clipped
+    bool changed_;
+};
+
+} // namespace vm
+} // namespace dialos
+
+#endif // DIALOS_VM_FRAMEBUFFER_H
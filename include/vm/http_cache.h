@@ -0,0 +1,144 @@
+/**
+ * dialScript HTTP Response Cache
+ *
+ * GET responses kept by URL in a persistent store (a directory on the
+ * host, or anything else behind HttpCache::Store), so the app store's
+ * index.json and applet metadata aren't downloaded again on every visit.
+ *
+ * Freshness follows the response's Cache-Control: within max-age an entry
+ * is served without any request. Past it (or with no-cache, or no max-age
+ * at all) the entry is revalidated with If-None-Match / If-Modified-Since,
+ * and a 304 serves the cached body. no-store responses are not kept, nor
+ * are responses with neither a validator nor a max-age. Expires is not
+ * looked at.
+ *
+ * Bodies are stored one per entry; an index of the entries, most
+ * recently used first, is kept next to them so the cache survives a
+ * restart. The total body size stays within a byte budget, evicting least
+ * recently used entries first.
+ *
+ * Transport-independent: get() is given a fetch function that sends the
+ * request with the extra (conditional) headers. Thread-safe; requests run
+ * outside the lock.
+ */
+
+#ifndef DIALOS_VM_HTTP_CACHE_H
+#define DIALOS_VM_HTTP_CACHE_H
+
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace dialos {
+namespace vm {
+
+class HttpCache {
+public:
+    // Named blobs; the cache stores "index" and one blob per entry
+    class Store {
+    public:
+        virtual ~Store() {}
+        virtual bool load(const std::string& name, std::string& data) = 0;
+        virtual bool save(const std::string& name, const std::string& data) = 0;
+        virtual void remove(const std::string& name) = 0;
+    };
+
+    // Files in an existing directory
+    class DirectoryStore : public Store {
+    public:
+        explicit DirectoryStore(const std::string& dir) : dir_(dir) {}
+        bool load(const std::string& name, std::string& data) override;
+        bool save(const std::string& name, const std::string& data) override;
+        void remove(const std::string& name) override;
+
+    private:
+        std::string dir_;
+    };
+
+    struct Response {
+        int status = 0;
+        std::string body;
+        std::string etag;
+        std::string lastModified;
+        std::string cacheControl;
+    };
+
+    typedef std::vector<std::pair<std::string, std::string>> Headers;
+    // Send a GET with `headers` added; false with `error` set if no response
+    typedef std::function<bool(const Headers& headers, Response& response, std::string& error)> Fetcher;
+
+    enum class Source { NETWORK, CACHE, REVALIDATED };
+
+    struct Stats {
+        uint32_t hits = 0;              // Served fresh, no request
+        uint32_t revalidated = 0;       // Served after a 304
+        uint32_t misses = 0;            // Body fetched
+        uint32_t evictions = 0;
+        uint64_t bytesSaved = 0;        // Body bytes not transferred (hits + 304s)
+        size_t bytes = 0;               // Bodies currently stored
+        size_t entries = 0;
+    };
+
+    HttpCache(std::unique_ptr<Store> store, size_t budgetBytes);
+    // Writes the index if entries were used since the last write
+    ~HttpCache();
+
+    HttpCache(const HttpCache&) = delete;
+    HttpCache& operator=(const HttpCache&) = delete;
+
+    /**
+     * GET `url` through the cache. A cached entry comes back as status 200
+     * with its validators.
+     * @param source Set to where the body came from
+     * @return false with `error` set if the fetch failed
+     */
+    bool get(const std::string& url, const Fetcher& fetch, Response& response, std::string& error,
+             Source* source = nullptr);
+
+    // Seconds; std::time by default
+    void setClock(std::function<int64_t()> clock) { clock_ = clock; }
+    void setBudget(size_t bytes);
+    void clear();
+    void flush();                       // Write the index now
+    Stats getStats() const;
+
+private:
+    struct Entry {
+        std::string url;
+        std::string name;               // Store name of the body
+        size_t size;
+        int64_t expires;                // Fresh until (clock seconds)
+        std::string etag;
+        std::string lastModified;
+        std::string cacheControl;
+    };
+    typedef std::list<Entry>::iterator EntryRef;
+
+    void loadIndex();
+    void writeIndex();                  // Lock held
+    void drop(EntryRef entry);          // Lock held
+    void trim(size_t incoming);         // Lock held
+    void store(const std::string& url, const Response& response, int64_t now);
+    static int64_t maxAge(const std::string& cacheControl, bool& noStore);
+    static std::string nameFor(const std::string& url);
+
+    std::unique_ptr<Store> store_;
+    mutable std::mutex mutex_;
+    size_t budget_;
+    std::list<Entry> recent_;           // Most recently used first
+    std::map<std::string, EntryRef> entries_;
+    bool indexDirty_;
+    std::function<int64_t()> clock_;
+    Stats stats_;
+};
+
+} // namespace vm
+} // namespace dialos
+
+#endif // DIALOS_VM_HTTP_CACHE_H
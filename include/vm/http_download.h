@@ -0,0 +1,128 @@
+/**
+ * dialScript HTTP Download Writer
+ *
+ * The transport-independent half of http.download: the body is handed
+ * over as it arrives and goes to disk in fixed CHUNK_SIZE writes, so a
+ * download needs one chunk of RAM however large the file is.
+ *
+ * Bytes land in "<path>.part" and the file only appears under its own
+ * name once complete. An interrupted download leaves the part file behind
+ * together with "<path>.etag", the validator (ETag or Last-Modified) it
+ * was fetched under. The next attempt asks for the rest with
+ * "Range: bytes=<n>-" and "If-Range: <validator>"; if the resource
+ * changed meanwhile the server answers 200 and the download restarts
+ * from zero, so stale and fresh bytes are never spliced together.
+ *
+ * Integrity is checked as the data arrives: a 206 must continue exactly
+ * where the part file ends, a body may not outgrow its announced length,
+ * and a running CRC-32 of the whole file (resumed prefix included) is
+ * reported with the result.
+ *
+ * Usage, for any transport:
+ *   DownloadWriter writer(hostPath);
+ *   uint32_t offset = writer.prepare();         // send the range headers
+ *   writer.begin(status, contentRange, length, validator, error);
+ *   writer.write(data, n, error) ...             // per received block
+ *   writer.finish(error);                        // or just destroy it
+ */
+
+#ifndef DIALOS_VM_HTTP_DOWNLOAD_H
+#define DIALOS_VM_HTTP_DOWNLOAD_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace dialos {
+namespace vm {
+
+// Update a CRC-32 (IEEE, as in zip/PNG) with `length` bytes; start from 0
+uint32_t crc32(uint32_t crc, const void* data, size_t length);
+
+class DownloadWriter {
+public:
+#if defined(ARDUINO)
+    static const size_t CHUNK_SIZE = 4 * 1024;
+#else
+    static const size_t CHUNK_SIZE = 16 * 1024;
+#endif
+    static const int64_t UNKNOWN_LENGTH = -1;
+
+    // Called after every chunk written (the last, short one included) with
+    // the bytes on disk so far and the full size (UNKNOWN_LENGTH if the
+    // server didn't say)
+    typedef std::function<void(uint32_t received, int64_t total)> ProgressHandler;
+
+    explicit DownloadWriter(const std::string& path);
+    // Flushes what was received and keeps the part file for a resume
+    ~DownloadWriter();
+
+    DownloadWriter(const DownloadWriter&) = delete;
+    DownloadWriter& operator=(const DownloadWriter&) = delete;
+
+    void setProgressHandler(ProgressHandler handler) { progress_ = handler; }
+
+    /**
+     * Look for an interrupted download of this path.
+     * @return the byte offset to resume from (0 = fetch everything); when
+     *         non-zero, send "Range: bytes=<offset>-" and
+     *         "If-Range: <validator()>"
+     */
+    uint32_t prepare();
+    const std::string& validator() const { return validator_; }
+
+    /**
+     * Accept the response head. 200 starts the file over; 206 must carry a
+     * Content-Range ("bytes a-b/total") starting at the prepare() offset.
+     * @param contentLength Content-Length, or UNKNOWN_LENGTH
+     * @param validator ETag, else Last-Modified, else empty (not resumable)
+     */
+    bool begin(int status, const std::string& contentRange, int64_t contentLength,
+               const std::string& validator, std::string& error);
+
+    // Append body bytes; full chunks are written out as they fill
+    bool write(const char* data, size_t length, std::string& error);
+
+    // Write the last chunk, check the length and move the part file into
+    // place. With an unknown length the body ends when the transport says so.
+    bool finish(std::string& error);
+
+    uint32_t bytes() const { return received_; }     // File size so far
+    uint32_t resumed() const { return resumed_; }    // Bytes reused from a part file
+    uint32_t checksum() const { return crc_; }       // CRC-32 of bytes()
+    uint32_t chunksWritten() const { return chunks_; }
+    int64_t total() const { return total_; }
+
+    // The platform answer for http.download:
+    // {"status":"success","bytes":n,"resumed":n,"crc32":"hex","filepath":"..."}
+    std::string report(const std::string& filepath) const;
+    static std::string errorReport(const std::string& message);
+
+private:
+    bool flushChunk(std::string& error);
+    void abandon();
+
+    std::string path_;
+    std::string partPath_;
+    std::string tagPath_;
+    std::FILE* file_;
+    std::vector<char> chunk_;
+    size_t filled_;
+    std::string validator_;
+    uint32_t offset_;                   // From prepare()
+    uint32_t received_;
+    uint32_t resumed_;
+    uint32_t crc_;
+    uint32_t chunks_;
+    int64_t total_;
+    bool finished_;
+    ProgressHandler progress_;
+};
+
+} // namespace vm
+} // namespace dialos
+
+#endif // DIALOS_VM_HTTP_DOWNLOAD_H
@@ -0,0 +1,133 @@
+/**
+ * dialScript Idle Manager
+ *
+ * System-wide tickless idle. Every loop that can block (one per VM
+ * runtime, plus anything else that keeps deadlines) registers as a source
+ * and reports, after each pass, how long it may wait: the value a
+ * VMScheduler::tick() returns already folds in VM sleeps and os.timer.*
+ * deadlines. A source with async I/O in flight reports holdAwake, since the
+ * radio or worker it waits on must keep running.
+ *
+ * The host's idle loop asks for a plan and enters the deepest power state
+ * the earliest deadline allows: light sleep when nothing holds the system
+ * awake and the next wakeup is far enough away to pay for entering it,
+ * otherwise a plain blocking wait. Residency in each state is accounted so
+ * the effect on battery life can be measured.
+ *
+ * Time is supplied by the caller (milliseconds, 32-bit wrapping) and the
+ * sleep itself is a callback, so host tests simulate sleeping by advancing
+ * a virtual clock. All methods are thread-safe.
+ */
+
+#ifndef DIALOS_VM_IDLE_MANAGER_H
+#define DIALOS_VM_IDLE_MANAGER_H
+
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace dialos {
+namespace vm {
+
+// Power states, shallowest first
+enum class PowerState {
+    ACTIVE,         // Some source has work due now
+    IDLE,           // Blocked until the next deadline; wakes on any interrupt
+    LIGHT_SLEEP     // CPU halted until the deadline or a wake source fires
+};
+
+class IdleManager {
+public:
+    typedef int SourceId;
+    static const SourceId INVALID_SOURCE = -1;
+    static const uint32_t NO_DEADLINE = 0xFFFFFFFF;      // Nothing to wake for
+    static const uint32_t DEFAULT_LIGHT_SLEEP_MIN_MS = 20;
+    static const int STATE_COUNT = 3;
+
+    // What the idle loop should do next
+    struct Plan {
+        PowerState state;
+        uint32_t sleepMs;           // Until the earliest deadline (NO_DEADLINE = none)
+        SourceId wakeSource;        // Source owning that deadline (INVALID_SOURCE = none)
+    };
+
+    // Residency per PowerState (indexed by static_cast<int>(state))
+    struct Stats {
+        uint64_t residencyMs[STATE_COUNT];
+        uint32_t entries[STATE_COUNT];  // Times each state was entered by idle()
+
+        uint64_t totalMs() const;
+        // Share of total time spent in `state`, 0..100
+        uint32_t percent(PowerState state) const;
+    };
+
+    // Performs the sleep: blocks for at most `ms` (NO_DEADLINE = until woken)
+    // in `state` and returns the milliseconds actually spent asleep
+    typedef std::function<uint32_t(PowerState state, uint32_t ms)> SleepFn;
+
+    // Interrupts an IDLE sleep that an update() made too shallow (a hold was
+    // released, so light sleep is now possible). Runs under the manager's
+    // lock and must not call back into it.
+    typedef std::function<void()> WakeHandler;
+
+    // Light sleep is only planned for waits of at least lightSleepMinMs:
+    // shorter ones don't recover the cost of entering and leaving it
+    explicit IdleManager(uint32_t lightSleepMinMs = DEFAULT_LIGHT_SLEEP_MIN_MS);
+
+    // Sources start ACTIVE (due now) until their first update()
+    SourceId addSource(const std::string& name);
+    void removeSource(SourceId id);
+    std::string getSourceName(SourceId id) const;
+
+    // Report a source's next wakeup: `waitMs` from `now` (0 = busy,
+    // NO_DEADLINE = only an external event can create work)
+    void update(SourceId id, uint32_t now, uint32_t waitMs, bool holdAwake = false);
+
+    // Deepest state the earliest deadline allows at `now`
+    Plan plan(uint32_t now) const;
+
+    // Plan, sleep through `sleep` unless ACTIVE, and account the residency.
+    // Time since the previous idle() is counted as ACTIVE. Returns the plan.
+    Plan idle(uint32_t now, const SleepFn& sleep);
+
+    void setWakeHandler(WakeHandler handler);
+
+    // Allow or forbid light sleep system-wide (e.g. while the display is lit)
+    void setLightSleepEnabled(bool enabled);
+    bool isLightSleepEnabled() const;
+
+    Stats getStats() const;
+    void resetStats(uint32_t now);
+
+private:
+    struct Source {
+        SourceId id;
+        std::string name;
+        bool reported;              // false until the first update(): due now
+        bool hasDeadline;           // false = waits for an external event only
+        uint32_t deadline;          // Absolute, when hasDeadline
+        bool holdAwake;
+    };
+
+    Plan planLocked(uint32_t now) const;
+    Source* find(SourceId id);
+    const Source* find(SourceId id) const;
+
+    mutable std::mutex mutex_;
+    std::vector<Source> sources_;
+    SourceId nextId_;
+    uint32_t lightSleepMinMs_;
+    bool lightSleepEnabled_;
+    WakeHandler wake_;
+    PowerState sleeping_;           // State of the idle() sleep in progress (ACTIVE = none)
+    Stats stats_;
+    uint32_t lastAccounted_;        // End of the last accounted interval
+    bool accounting_;               // lastAccounted_ is valid
+};
+
+} // namespace vm
+} // namespace dialos
+
+#endif // DIALOS_VM_IDLE_MANAGER_H
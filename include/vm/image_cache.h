@@ -0,0 +1,80 @@
+/**
+ * dialScript Image Cache
+ *
+ * Decoded images shared by every VM in the process, keyed by where they
+ * came from ("file:/icons/wifi.qoi", or a hash of inline data). An applet
+ * that loads its icons on every launch, or several applets showing the
+ * same icon, decode it once.
+ *
+ * Images are handed out as shared pointers, so one stays alive while any
+ * VM (or a display list waiting to be drawn) uses it. Images nobody holds
+ * stay cached within a byte budget and are dropped least recently used
+ * first. Files are not watched: replacing an image file on disk takes a
+ * clear() (or a different path) to show up.
+ *
+ * Thread-safe.
+ */
+
+#ifndef DIALOS_VM_IMAGE_CACHE_H
+#define DIALOS_VM_IMAGE_CACHE_H
+
+#include "vm/image_codec.h"
+#include <cstdint>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace dialos {
+namespace vm {
+
+class ImageCache {
+public:
+    typedef std::shared_ptr<const Image> ImagePtr;
+
+    struct Stats {
+        uint32_t hits = 0;
+        uint32_t decodes = 0;
+        uint32_t evictions = 0;
+        size_t bytes = 0;           // Decoded size of everything cached
+    };
+
+    explicit ImageCache(size_t budgetBytes);
+
+    // The process-wide cache the VMs use
+    static ImageCache& shared();
+
+    // Cached image for `key`, or nullptr
+    ImagePtr find(const std::string& key);
+
+    // Cached image for `key`, decoding `data` (see image_codec.h) on a
+    // miss. nullptr with `error` set if it doesn't decode.
+    ImagePtr load(const std::string& key, const uint8_t* data, size_t size, std::string& error);
+
+    // Key for inline image data: a hash of the bytes plus their length
+    static std::string dataKey(const uint8_t* data, size_t size);
+
+    void setBudget(size_t bytes);
+    void clear();
+    Stats getStats() const;
+
+private:
+    struct Entry {
+        ImagePtr image;
+        std::list<std::string>::iterator use;   // Position in recent_
+    };
+
+    void trim();    // Evict unused images until within the budget (lock held)
+
+    mutable std::mutex mutex_;
+    size_t budget_;
+    std::map<std::string, Entry> entries_;
+    std::list<std::string> recent_;             // Most recently used first
+    Stats stats_;
+};
+
+} // namespace vm
+} // namespace dialos
+
+#endif // DIALOS_VM_IMAGE_CACHE_H
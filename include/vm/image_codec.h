@@ -0,0 +1,63 @@
+/**
+ * dialScript Image Codecs
+ *
+ * Decodes the image formats display.loadImage accepts into RGB565 pixels
+ * ready for a single block copy:
+ *
+ * - Raw: width and height as big-endian uint16, then width*height
+ *   big-endian RGB565 pixels (the display.drawImage array format).
+ * - RLE: "DRLE", width, height (big-endian uint16), then packets. A
+ *   header byte n < 0x80 is followed by n + 1 literal pixels; n >= 0x80
+ *   by one pixel repeated (n & 0x7F) + 1 times. Pixels are big-endian
+ *   RGB565. Flat UI art shrinks to a few percent of its raw size.
+ * - QOI (https://qoiformat.org), so ordinary PNG tooling can produce
+ *   images. Colours are reduced to RGB565; pixels with alpha < 128 become
+ *   transparent.
+ *
+ * Decoding never reads outside the input and rejects images whose pixel
+ * count exceeds MAX_PIXELS.
+ */
+
+#ifndef DIALOS_VM_IMAGE_CODEC_H
+#define DIALOS_VM_IMAGE_CODEC_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace dialos {
+namespace vm {
+
+struct Image {
+    int width = 0;
+    int height = 0;
+    std::vector<uint16_t> pixels;       // Native-endian RGB565, row-major
+    int32_t transparent = -1;           // Colour standing in for transparent pixels, -1 if opaque
+
+    size_t bytes() const { return pixels.size() * sizeof(uint16_t) + sizeof(Image); }
+};
+
+namespace image {
+
+static const size_t MAX_PIXELS = 1024 * 1024;
+
+// Decode any of the formats above; on failure `error` says why
+bool decode(const uint8_t* data, size_t size, Image& out, std::string& error);
+
+// Encoders, for tools and tests. `pixels` are native-endian RGB565.
+std::vector<uint8_t> encodeRaw(int width, int height, const uint16_t* pixels);
+std::vector<uint8_t> encodeRle(int width, int height, const uint16_t* pixels);
+// `rgba` is width*height RGBA8888 pixels
+std::vector<uint8_t> encodeQoi(int width, int height, const uint8_t* rgba);
+
+// Standard base64 (padding optional, whitespace ignored), as found in
+// "data:...;base64," strings
+bool decodeBase64(const std::string& text, std::vector<uint8_t>& out);
+
+} // namespace image
+
+} // namespace vm
+} // namespace dialos
+
+#endif // DIALOS_VM_IMAGE_CODEC_H
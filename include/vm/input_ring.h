@@ -0,0 +1,112 @@
+/**
+ * dialScript Input Ring
+ *
+ * Lock-free single-producer/single-consumer queue of timestamped input
+ * events. The producer is an interrupt or driver callback sampling the
+ * hardware (encoder, button, touch); the consumer is the VM runtime, which
+ * turns each event into a callback for the applets that listen for it.
+ * Neither side blocks or allocates, so the producer keeps recording steps
+ * while a VM is in the middle of a long slice.
+ *
+ * Exactly one thread may push and one may pop. A platform with several
+ * producers or consumers uses one ring per producer/consumer pair.
+ */
+
+#ifndef DIALOS_VM_INPUT_RING_H
+#define DIALOS_VM_INPUT_RING_H
+
+#include "vm/vm_value.h"
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+namespace dialos {
+namespace vm {
+
+enum class InputEventType : uint8_t {
+    ENCODER_TURN,   // a = steps since the previous event (signed)
+    BUTTON,         // a = 1 pressed, 0 released
+    TOUCH_PRESS,    // a = x, b = y
+    TOUCH_RELEASE,  // a = x, b = y
+    TOUCH_DRAG      // a = x, b = y
+};
+
+struct InputEvent {
+    InputEventType type;
+    int16_t a;
+    int16_t b;
+    uint32_t timestampMs;   // Producer's clock when the change was seen
+};
+
+class InputRing {
+public:
+    static const uint32_t CAPACITY = 64;    // Power of two
+
+    InputRing() : head_(0), tail_(0) {}
+
+    // Producer side; false (event not queued) when the ring is full
+    bool push(const InputEvent& event) {
+        uint32_t head = head_.load(std::memory_order_relaxed);
+        if (head - tail_.load(std::memory_order_acquire) == CAPACITY) {
+            return false;
+        }
+        slots_[head & (CAPACITY - 1)] = event;
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side; false when the ring is empty
+    bool pop(InputEvent& event) {
+        uint32_t tail = tail_.load(std::memory_order_relaxed);
+        if (head_.load(std::memory_order_acquire) == tail) {
+            return false;
+        }
+        event = slots_[tail & (CAPACITY - 1)];
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool empty() const {
+        return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_acquire);
+    }
+
+private:
+    InputEvent slots_[CAPACITY];
+    std::atomic<uint32_t> head_;    // Next slot to write (producer only)
+    std::atomic<uint32_t> tail_;    // Next slot to read (consumer only)
+
+    InputRing(const InputRing&);
+    InputRing& operator=(const InputRing&);
+};
+
+// Callback name and arguments an event is delivered with (the same
+// encoder.* / touch.* callbacks the SDL emulator invokes)
+inline const char* inputEventCallback(const InputEvent& event, std::vector<Value>& args) {
+    args.clear();
+    switch (event.type) {
+        case InputEventType::ENCODER_TURN:
+            args.push_back(Value::Int32(event.a));
+            return "encoder.onTurn";
+        case InputEventType::BUTTON:
+            args.push_back(Value::Bool(event.a != 0));
+            return "encoder.onButton";
+        case InputEventType::TOUCH_PRESS:
+            args.push_back(Value::Int32(event.a));
+            args.push_back(Value::Int32(event.b));
+            return "touch.onPress";
+        case InputEventType::TOUCH_RELEASE:
+            args.push_back(Value::Int32(event.a));
+            args.push_back(Value::Int32(event.b));
+            return "touch.onRelease";
+        case InputEventType::TOUCH_DRAG:
+            args.push_back(Value::Int32(event.a));
+            args.push_back(Value::Int32(event.b));
+            return "touch.onDrag";
+    }
+    return "";
+}
+
+} // namespace vm
+} // namespace dialos
+
+#endif // DIALOS_VM_INPUT_RING_H
@@ -0,0 +1,124 @@
+/**
+ * dialScript IPC Bus
+ *
+ * Message passing between applets (os.ipc.*). Every app that joins gets a
+ * bounded mailbox; message bytes live in one shared ring buffer (the
+ * arena) owned by the bus. A send writes the payload into the arena once,
+ * and from then on only the slot changes hands: sender -> mailbox ->
+ * receiver, as a move-only Message. The receiver reads the bytes in place
+ * and the slot is reclaimed when its Message is destroyed.
+ *
+ * A full mailbox or arena rejects the send (back-pressure) instead of
+ * growing, so a flooding sender can't exhaust the heap. All methods are
+ * thread-safe; applets on different cores may share one bus.
+ */
+
+#ifndef DIALOS_VM_IPC_BUS_H
+#define DIALOS_VM_IPC_BUS_H
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace dialos {
+namespace vm {
+
+class IpcBus {
+public:
+    // Called when a message lands in a mailbox. Runs under the bus lock (so
+    // it never fires after leave() returns) and must not call back into it.
+    typedef std::function<void()> WakeHandler;
+
+    enum class SendResult {
+        OK,
+        NO_SUCH_APP,        // Receiver has not joined
+        MAILBOX_FULL,       // Receiver has mailboxDepth unread messages
+        NO_SPACE            // Arena can't fit the payload right now
+    };
+
+    // A received message; owns its arena slot until destroyed
+    class Message {
+    public:
+        Message() : bus_(nullptr), slot_(0), data_(nullptr), length_(0) {}
+        Message(Message&& other);
+        Message& operator=(Message&& other);
+        ~Message() { release(); }
+
+        const char* data() const { return data_; }
+        size_t size() const { return length_; }
+        const std::string& sender() const { return sender_; }
+
+    private:
+        friend class IpcBus;
+        IpcBus* bus_;
+        uint32_t slot_;
+        const char* data_;
+        size_t length_;
+        std::string sender_;
+
+        void release();
+        Message(const Message&);
+        Message& operator=(const Message&);
+    };
+
+    // Messages still held by receivers must not outlive the bus
+    explicit IpcBus(size_t arenaBytes = 4096, size_t mailboxDepth = 8);
+
+    // Membership; leaving drops the app's unread messages
+    bool join(const std::string& appId, WakeHandler wake);
+    void leave(const std::string& appId);
+
+    SendResult send(const std::string& from, const std::string& to, const char* data, size_t length);
+    // Deliver to every other member with room; returns how many got it
+    size_t broadcast(const std::string& from, const char* data, size_t length);
+
+    // Take the oldest unread message of `appId`
+    bool receive(const std::string& appId, Message& out);
+    size_t pending(const std::string& appId) const;
+
+    size_t arenaUsed() const;
+
+private:
+    struct Slot {
+        uint32_t offset;
+        uint32_t size;          // Bytes reserved, including wrap padding
+        bool released;
+    };
+
+    struct Envelope {
+        uint32_t slot;
+        uint32_t offset;
+        uint32_t length;
+        std::string sender;
+    };
+
+    struct Mailbox {
+        std::deque<Envelope> messages;
+        WakeHandler wake;
+    };
+
+    mutable std::mutex mutex_;
+    std::vector<char> arena_;
+    size_t mailboxDepth_;
+    std::map<std::string, Mailbox> mailboxes_;
+
+    // Arena slots in allocation order; released slots are reclaimed once
+    // everything older is released too
+    std::deque<Slot> slots_;
+    uint32_t firstSlot_;        // Id of slots_.front()
+    uint32_t head_;             // Next write offset
+    size_t used_;
+
+    bool allocate(uint32_t length, uint32_t& slot, uint32_t& offset);
+    void releaseSlot(uint32_t slot);
+    SendResult enqueue(Mailbox& box, const std::string& from, const char* data, uint32_t length);
+};
+
+} // namespace vm
+} // namespace dialos
+
+#endif // DIALOS_VM_IPC_BUS_H
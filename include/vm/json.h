@@ -0,0 +1,53 @@
+/**
+ * dialScript JSON
+ *
+ * Single-pass JSON parser that builds VM values straight in a ValuePool,
+ * and the matching serialiser. Backs json.parse/json.stringify, and lets
+ * natives whose platform call answers in JSON hand scripts structured
+ * values instead of text to pick apart.
+ *
+ * Mapping: objects become Objects (class "Object"), arrays Arrays,
+ * strings pooled strings. Numbers without a fraction or exponent that fit
+ * in 32 bits become INT32, all others FLOAT32. Duplicate keys keep the
+ * last value.
+ *
+ * The parser never reads past `length`, and rejects nesting deeper than
+ * MAX_DEPTH so hostile input can't exhaust the (small) native stack.
+ */
+
+#ifndef DIALOS_VM_JSON_H
+#define DIALOS_VM_JSON_H
+
+#include <cstddef>
+#include <string>
+
+namespace dialos {
+namespace vm {
+
+struct Value;
+class ValuePool;
+
+namespace json {
+
+static const int MAX_DEPTH = 32;
+
+// Parse one JSON value (surrounding whitespace allowed) into `out`. On
+// failure - malformed text, too deep, out of heap - returns false and
+// `error` says what went wrong and at which byte.
+bool parse(const char* text, size_t length, ValuePool& pool, Value& out, std::string& error);
+
+// Append `value` as compact JSON to `out`. Functions, NaN and infinities
+// are written as null. Returns false if objects nest deeper than MAX_DEPTH
+// (e.g. an object that contains itself); `out` is then incomplete.
+bool stringify(const Value& value, std::string& out);
+
+// Append `text` as a JSON string literal (quoted, escaped) to `out`; for
+// natives that build their JSON answer by hand
+void appendQuoted(const std::string& text, std::string& out);
+
+} // namespace json
+
+} // namespace vm
+} // namespace dialos
+
+#endif // DIALOS_VM_JSON_H
@@ -0,0 +1,73 @@
+/**
+ * dialScript Module Image
+ *
+ * Read-only, pre-deserialized view of a bytecode module. Built-in applets
+ * get one of these emitted by `compile --c-array` next to their DSBC blob,
+ * so every table lives in flash (.rodata) and the VM can start without
+ * running BytecodeModule::deserialize or allocating the module on the heap.
+ *
+ * All types here are aggregates of pointers and integers so that the
+ * generated descriptors are constant-initialized (C++14 constexpr).
+ */
+
+#ifndef DIALOS_COMPILER_MODULE_IMAGE_H
+#define DIALOS_COMPILER_MODULE_IMAGE_H
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+
+namespace dialos {
+namespace compiler {
+
+// Non-owning string slice (not necessarily NUL-terminated)
+struct StringRef {
+    const char* data;
+    uint16_t length;
+
+    std::string str() const { return std::string(data, length); }
+
+    bool equals(const char* other, size_t otherLength) const {
+        if (length != otherLength) return false;
+        for (size_t i = 0; i < otherLength; i++) {
+            if (data[i] != other[i]) return false;
+        }
+        return true;
+    }
+};
+
+// Function table entry
+struct FunctionRef {
+    StringRef name;
+    uint32_t entryPoint;
+    uint8_t paramCount;
+};
+
+// Flat module descriptor (mirrors BytecodeModule without owning anything)
+struct ModuleImage {
+    // Metadata
+    uint16_t version;
+    uint32_t heapSize;
+    StringRef appName;
+    StringRef appVersion;
+    StringRef author;
+
+    // Code section (usually points into the serialized DSBC blob)
+    const uint8_t* code;
+    uint32_t codeSize;
+
+    // Tables (nullptr when the count is zero)
+    const StringRef* constants;
+    uint16_t constantCount;
+    const StringRef* globals;
+    uint16_t globalCount;
+    const FunctionRef* functions;
+    uint16_t functionCount;
+
+    uint32_t mainEntryPoint;
+};
+
+} // namespace compiler
+} // namespace dialos
+
+#endif // DIALOS_COMPILER_MODULE_IMAGE_H
@@ -11,6 +11,7 @@
 #include <string>
 #include <vector>
 #include <memory>
+#include <functional>
 
 namespace dialos
 {
@@ -19,6 +20,9 @@ namespace dialos
         // Forward declarations to avoid circular dependencies
         class VMState;
         struct Value;
+        class TimerService;
+        class IpcBus;
+        struct Image;
 
         // Native function IDs
         // Organization: High byte = namespace, Low byte = function within namespace
@@ -45,6 +49,18 @@ namespace dialos
             DISPLAY_SET_TITLE = 0x0109,
             DISPLAY_GET_SIZE = 0x010A,
             DISPLAY_DRAW_IMAGE = 0x010B,
+            DISPLAY_LOAD_IMAGE = 0x010C,
+            DISPLAY_DRAW_IMAGE_REGION = 0x010D,
+            DISPLAY_CREATE_LAYER = 0x010E,
+            DISPLAY_CREATE_RECT = 0x010F,
+            DISPLAY_CREATE_CIRCLE = 0x0110,
+            DISPLAY_CREATE_LABEL = 0x0111,
+            DISPLAY_CREATE_SPRITE = 0x0112,
+            DISPLAY_SET_NODE = 0x0113,
+            DISPLAY_MOVE_NODE = 0x0114,
+            DISPLAY_REMOVE_NODE = 0x0115,
+            DISPLAY_RENDER = 0x0116,
+            DISPLAY_MEASURE_TEXT = 0x0117,
 
             // Encoder namespace (0x02xx)
             ENCODER_GET_BUTTON = 0x0200,
@@ -82,6 +98,10 @@ namespace dialos
             FILE_EXISTS = 0x0604,
             FILE_DELETE = 0x0605,
             FILE_SIZE = 0x0606,
+            FILE_READ_LINE = 0x0607,
+            FILE_READ_BYTES = 0x0608,
+            FILE_SEEK = 0x0609,
+            FILE_TELL = 0x060A,
 
             // Directory namespace (0x07xx)
             DIR_LIST = 0x0700,
@@ -151,10 +171,12 @@ namespace dialos
             HTTP_GET = 0x1200,
             HTTP_POST = 0x1201,
             HTTP_DOWNLOAD = 0x1202,
+            HTTP_ON_PROGRESS = 0x1203,
 
             // IPC namespace (0x13xx)
             IPC_SEND = 0x1300,
             IPC_BROADCAST = 0x1301,
+            IPC_ON_MESSAGE = 0x1302,
 
             // App Management namespace (0x14xx) - Cross-platform app store APIs
             APP_INSTALL = 0x1400,           // Install DSB file to app registry
@@ -164,6 +186,10 @@ namespace dialos
             APP_LAUNCH = 0x1404,            // Launch installed app (replace current)
             APP_VALIDATE = 0x1405,          // Validate DSB file integrity
 
+            // JSON namespace (0x15xx)
+            JSON_PARSE = 0x1500,
+            JSON_STRINGIFY = 0x1501,
+
             UNKNOWN = 0xFFFF
         };
 
@@ -209,6 +235,30 @@ namespace dialos
                 return NativeFunctionID::DISPLAY_GET_SIZE;
             if (name == "display.drawImage")
                 return NativeFunctionID::DISPLAY_DRAW_IMAGE;
+            if (name == "display.loadImage")
+                return NativeFunctionID::DISPLAY_LOAD_IMAGE;
+            if (name == "display.drawImageRegion")
+                return NativeFunctionID::DISPLAY_DRAW_IMAGE_REGION;
+            if (name == "display.createLayer")
+                return NativeFunctionID::DISPLAY_CREATE_LAYER;
+            if (name == "display.createRect")
+                return NativeFunctionID::DISPLAY_CREATE_RECT;
+            if (name == "display.createCircle")
+                return NativeFunctionID::DISPLAY_CREATE_CIRCLE;
+            if (name == "display.createLabel")
+                return NativeFunctionID::DISPLAY_CREATE_LABEL;
+            if (name == "display.createSprite")
+                return NativeFunctionID::DISPLAY_CREATE_SPRITE;
+            if (name == "display.setNode")
+                return NativeFunctionID::DISPLAY_SET_NODE;
+            if (name == "display.moveNode")
+                return NativeFunctionID::DISPLAY_MOVE_NODE;
+            if (name == "display.removeNode")
+                return NativeFunctionID::DISPLAY_REMOVE_NODE;
+            if (name == "display.render")
+                return NativeFunctionID::DISPLAY_RENDER;
+            if (name == "display.measureText")
+                return NativeFunctionID::DISPLAY_MEASURE_TEXT;
 
             // Encoder functions (full namespace paths)
             if (name == "encoder.getButton")
@@ -273,6 +323,14 @@ namespace dialos
                 return NativeFunctionID::FILE_DELETE;
             if (name == "file.size")
                 return NativeFunctionID::FILE_SIZE;
+            if (name == "file.readLine")
+                return NativeFunctionID::FILE_READ_LINE;
+            if (name == "file.readBytes")
+                return NativeFunctionID::FILE_READ_BYTES;
+            if (name == "file.seek")
+                return NativeFunctionID::FILE_SEEK;
+            if (name == "file.tell")
+                return NativeFunctionID::FILE_TELL;
 
             // Directory functions (full namespace paths)
             if (name == "dir.list")
@@ -387,12 +445,16 @@ namespace dialos
                 return NativeFunctionID::HTTP_POST;
             if (name == "http.download")
                 return NativeFunctionID::HTTP_DOWNLOAD;
+            if (name == "http.onProgress")
+                return NativeFunctionID::HTTP_ON_PROGRESS;
 
             // IPC functions (full namespace paths)
             if (name == "ipc.send")
                 return NativeFunctionID::IPC_SEND;
             if (name == "ipc.broadcast")
                 return NativeFunctionID::IPC_BROADCAST;
+            if (name == "ipc.onMessage")
+                return NativeFunctionID::IPC_ON_MESSAGE;
 
             // App Management functions (full namespace paths)
             if (name == "app.install")
@@ -408,6 +470,12 @@ namespace dialos
             if (name == "app.validate")
                 return NativeFunctionID::APP_VALIDATE;
 
+            // JSON functions (full namespace paths)
+            if (name == "json.parse")
+                return NativeFunctionID::JSON_PARSE;
+            if (name == "json.stringify")
+                return NativeFunctionID::JSON_STRINGIFY;
+
             return NativeFunctionID::UNKNOWN;
         }
 
@@ -455,6 +523,30 @@ namespace dialos
                 return "getSize";
             case NativeFunctionID::DISPLAY_DRAW_IMAGE:
                 return "drawImage";
+            case NativeFunctionID::DISPLAY_LOAD_IMAGE:
+                return "loadImage";
+            case NativeFunctionID::DISPLAY_DRAW_IMAGE_REGION:
+                return "drawImageRegion";
+            case NativeFunctionID::DISPLAY_CREATE_LAYER:
+                return "createLayer";
+            case NativeFunctionID::DISPLAY_CREATE_RECT:
+                return "createRect";
+            case NativeFunctionID::DISPLAY_CREATE_CIRCLE:
+                return "createCircle";
+            case NativeFunctionID::DISPLAY_CREATE_LABEL:
+                return "createLabel";
+            case NativeFunctionID::DISPLAY_CREATE_SPRITE:
+                return "createSprite";
+            case NativeFunctionID::DISPLAY_SET_NODE:
+                return "setNode";
+            case NativeFunctionID::DISPLAY_MOVE_NODE:
+                return "moveNode";
+            case NativeFunctionID::DISPLAY_REMOVE_NODE:
+                return "removeNode";
+            case NativeFunctionID::DISPLAY_RENDER:
+                return "render";
+            case NativeFunctionID::DISPLAY_MEASURE_TEXT:
+                return "measureText";
 
             // Encoder
             case NativeFunctionID::ENCODER_GET_BUTTON:
@@ -509,6 +601,14 @@ namespace dialos
                 return "delete";
             case NativeFunctionID::FILE_SIZE:
                 return "size";
+            case NativeFunctionID::FILE_READ_LINE:
+                return "readLine";
+            case NativeFunctionID::FILE_READ_BYTES:
+                return "readBytes";
+            case NativeFunctionID::FILE_SEEK:
+                return "seek";
+            case NativeFunctionID::FILE_TELL:
+                return "tell";
 
             // Directory
             case NativeFunctionID::DIR_LIST:
@@ -615,12 +715,16 @@ namespace dialos
                 return "post";
             case NativeFunctionID::HTTP_DOWNLOAD:
                 return "download";
+            case NativeFunctionID::HTTP_ON_PROGRESS:
+                return "onProgress";
 
             // IPC
             case NativeFunctionID::IPC_SEND:
                 return "send";
             case NativeFunctionID::IPC_BROADCAST:
                 return "broadcast";
+            case NativeFunctionID::IPC_ON_MESSAGE:
+                return "onMessage";
 
             // App Management
             case NativeFunctionID::APP_INSTALL:
@@ -636,11 +740,21 @@ namespace dialos
             case NativeFunctionID::APP_VALIDATE:
                 return "validate";
 
+            // JSON
+            case NativeFunctionID::JSON_PARSE:
+                return "parse";
+            case NativeFunctionID::JSON_STRINGIFY:
+                return "stringify";
+
             default:
                 return "unknown";
             }
         }
 
+        // Handle for a native started in the background (0 = not async)
+        typedef uint32_t AsyncToken;
+        static const AsyncToken NO_ASYNC = 0;
+
         // Platform abstraction interface
         class PlatformInterface
         {
@@ -686,6 +800,18 @@ namespace dialos
             virtual int display_getHeight() = 0;
             virtual void display_setTitle(const std::string & /*title*/) {}
             virtual void display_drawImage(int /*x*/, int /*y*/, const std::vector<uint8_t> & /*imageData*/) {}
+            // Draw the w x h region at (sx, sy) of a decoded image (see
+            // image_codec.h; the region lies inside it) at (x, y), skipping
+            // pixels equal to `transparent` (-1: none). Platforms should
+            // override this with a block copy; the default goes through
+            // display_drawImage row by row, or display_drawPixel when keyed.
+            virtual void display_drawBitmap(int x, int y, const std::shared_ptr<const Image> &image,
+                                            int sx, int sy, int w, int h, int32_t transparent);
+            // Limit drawing (display_clear included) to a rectangle until
+            // display_clearClip. Returns false if the platform can't clip;
+            // the scene compositor then repaints the whole screen instead.
+            virtual bool display_setClip(int /*x*/, int /*y*/, int /*w*/, int /*h*/) { return false; }
+            virtual void display_clearClip() {}
 
             // ===== Encoder Operations =====
             virtual bool encoder_getButton() = 0;
@@ -717,6 +843,13 @@ namespace dialos
             virtual bool file_exists(const std::string & /*path*/) { return false; }
             virtual bool file_delete(const std::string & /*path*/) { return false; }
             virtual int file_size(const std::string & /*path*/) { return -1; }
+            // Buffered reads on a handle opened for reading (see file_reader.h).
+            // readLine: false at the end of the file; readBytes: bytes read, -1
+            // for a bad handle; seek/tell: byte offset from the start
+            virtual bool file_readLine(int /*handle*/, std::string & /*line*/) { return false; }
+            virtual int file_readBytes(int /*handle*/, char * /*dest*/, int /*size*/) { return -1; }
+            virtual bool file_seek(int /*handle*/, int /*position*/) { return false; }
+            virtual int file_tell(int /*handle*/) { return -1; }
 
             // ===== Directory Operations =====
             virtual std::vector<std::string> dir_list(const std::string & /*path*/) { return {}; }
@@ -742,11 +875,12 @@ namespace dialos
             virtual void buzzer_stop() {}
 
             // ===== Timer Operations =====
-            // Note: timer_setInterval accepts a callback Value and interval in ms
-            virtual int timer_setTimeout(int /*ms*/) { return -1; }
-            virtual int timer_setInterval(const Value& /*callback*/, int /*ms*/) { return -1; }
-            virtual void timer_clearTimeout(int /*id*/) {}
-            virtual void timer_clearInterval(int /*id*/) {}
+            // Backed by a shared TimerService; platforms only need system_getTime()
+            // and a host loop that calls processTimers()
+            virtual int timer_setTimeout(const Value& callback, int ms);
+            virtual int timer_setInterval(const Value& callback, int ms);
+            virtual void timer_clearTimeout(int id);
+            virtual void timer_clearInterval(int id);
 
             // ===== Memory Operations =====
             virtual int memory_getAvailable() { return 0; }
@@ -785,8 +919,9 @@ namespace dialos
             virtual std::string http_download(const std::string & /*url*/, const std::string & /*filepath*/) { return "{}"; }
 
             // ===== IPC Operations =====
-            virtual bool ipc_send(const std::string & /*appId*/, const std::string & /*message*/) { return false; }
-            virtual void ipc_broadcast(const std::string & /*message*/) {}
+            // Go through the bus given to attachIpc(); without one, sends fail
+            virtual bool ipc_send(const std::string &appId, const std::string &message);
+            virtual void ipc_broadcast(const std::string &message);
 
             // ===== App Management Operations =====
             // Cross-platform app store APIs - designed for both SDL and ESP32
@@ -800,9 +935,23 @@ namespace dialos
             // ===== Callback System =====
             /**
              * Set the VM instance for callback invocation
-             * Must be called during VM initialization before callbacks can be invoked
+             * Must be called during VM initialization before callbacks can be invoked.
+             * A platform instance is the context of exactly one VM; VMs that
+             * run in parallel must each get their own platform.
              */
             void setVM(VMState* vm) { vm_ = vm; }
+            VMState* getVM() const { return vm_; }
+
+            // ===== Slice Hooks =====
+            /**
+             * Called by VMScheduler around each VM's turn (event delivery,
+             * timers and the instruction slice). Platforms whose hardware is
+             * shared with VMs running on other cores take their resource locks
+             * lazily inside a slice and release them in endSlice(), so a burst
+             * of draw calls costs one lock round-trip instead of one per call.
+             */
+            virtual void beginSlice() {}
+            virtual void endSlice() {}
 
             /**
              * Register a callback function for an event
@@ -827,6 +976,85 @@ namespace dialos
              */
             bool invokeCallback(const std::string& eventName, const std::vector<Value>& args);
 
+            // ===== Async Natives =====
+            /**
+             * Start a slow native (file.read, wifi.connect, http.*) in the
+             * background. Arguments arrive as strings (ints in decimal).
+             * @return a token that completeAsync() will later report, or
+             *         NO_ASYNC to have the VM call the native synchronously
+             */
+            virtual AsyncToken async_begin(NativeFunctionID /*id*/, const std::vector<std::string> & /*args*/) { return NO_ASYNC; }
+
+            /**
+             * Report the result of an async native. Safe to call from any
+             * thread; the result is handed to the VM by processAsyncCompletions().
+             * Payloads use the synchronous native's return format ("true"/"false"
+             * for booleans).
+             */
+            void completeAsync(AsyncToken token, const std::string &payload);
+
+            /**
+             * Resume parked VM frames / run result callbacks for completed
+             * operations. Call from the thread that runs the VM.
+             * @return true if anything completed
+             */
+            bool processAsyncCompletions();
+            bool hasPendingAsync() const;
+
+            // Called (from the completing thread) whenever a result is queued,
+            // so a host blocked waiting for work can wake up
+            void setAsyncWakeHandler(std::function<void()> handler);
+
+            /**
+             * Report how far a download of `url` got (any thread; total is -1
+             * if unknown). Reports are coalesced per URL - only the latest
+             * figures reach the script - and delivered to the
+             * http.onProgress(url, received, total) callback by
+             * processAsyncCompletions(), ahead of the download's result.
+             */
+            void http_reportProgress(const std::string &url, uint32_t received, int64_t total);
+
+            // ===== Timer Dispatch =====
+            /**
+             * Run the callbacks of all timers that are due
+             * @return true if any timer fired
+             */
+            bool processTimers();
+
+            /**
+             * Milliseconds until the next timer is due
+             * @return 0 if one is overdue, NO_TIMER_DEADLINE if none are pending
+             */
+            uint32_t getNextTimerDelay();
+            bool hasTimers() const;
+            static const uint32_t NO_TIMER_DEADLINE = 0xFFFFFFFF;
+
+            // Timers of this VM (created on first use)
+            TimerService &timerService();
+
+            // ===== Snapshot Support =====
+            // Registered callbacks by event name, and removal of all of them;
+            // VMState::snapshot()/restore() carry the registry with the VM
+            std::vector<std::pair<std::string, Value>> getCallbacks() const;
+            void clearCallbacks();
+
+            // ===== IPC Delivery =====
+            /**
+             * Join `bus` as `appId` (nullptr leaves). Incoming messages wake
+             * the host through the async wake handler and are delivered to
+             * the ipc.onMessage callback by processIpc().
+             * @return false if another platform already joined as `appId`
+             */
+            bool attachIpc(IpcBus* bus, const std::string& appId);
+
+            /**
+             * Deliver queued messages to ipc.onMessage(message, fromAppId).
+             * Call from the thread that runs the VM.
+             * @return true if any message was delivered
+             */
+            bool processIpc();
+            bool hasPendingIpc() const;
+
         protected:
             // VM reference for callback invocation
             VMState* vm_ = nullptr;
@@ -835,6 +1063,31 @@ namespace dialos
             // Using unique_ptr to avoid needing complete Value type in header
             struct CallbackRegistry;
             std::unique_ptr<CallbackRegistry> callbacks_;
+
+            // Pending os.timer.* timers (created on first use)
+            std::unique_ptr<TimerService> timers_;
+
+            // Async natives: token allocation, worker threads and the
+            // completion queue (created on first use)
+            struct AsyncState;
+            std::unique_ptr<AsyncState> async_;
+            AsyncState &asyncState();
+
+            // Run `work` on a worker thread and complete `token` with its
+            // result. Implementations of async_begin() use this; `work` must
+            // not touch VM state.
+            AsyncToken startAsyncWorker(std::function<std::string()> work);
+
+            // Join all worker threads. Derived platforms whose workers call
+            // back into derived members must call this from their destructor.
+            void joinAsyncWorkers();
+
+            // Call the async wake handler (any thread)
+            void wakeHost();
+
+            // IPC bus membership (see attachIpc)
+            IpcBus* ipc_ = nullptr;
+            std::string ipcAppId_;
         };
 
     } // namespace vm
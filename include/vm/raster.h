@@ -0,0 +1,63 @@
+/**
+ * dialScript Raster Kernels
+ *
+ * The inner loops of software drawing, on runs of RGB565 pixels: solid
+ * fills, copies of big-endian image data (the display.drawImage byte
+ * order), colour-keyed copies, constant-alpha blends, and the span widths
+ * of a disc. The framebuffer and sprite code build every primitive out of
+ * these, so making them fast makes all drawing fast.
+ *
+ * Each kernel has a plain per-pixel version in raster::scalar, which is
+ * the reference. The main entry points use the widest vector unit the
+ * build targets - AVX2 or SSE2 on x86, NEON on ARM - and fall back to
+ * 32-bit word operations (two pixels at a time) elsewhere, which is what
+ * the ESP32's Xtensa core handles best. The backend is chosen at compile
+ * time; every backend gives bit-identical results to the reference.
+ *
+ * Pointers need no particular alignment, counts may be anything.
+ */
+
+#ifndef DIALOS_VM_RASTER_H
+#define DIALOS_VM_RASTER_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace dialos {
+namespace vm {
+namespace raster {
+
+// Name of the compiled-in backend: "avx2", "sse2", "neon" or "word"
+const char* backend();
+
+// dst[i] = color
+void fill(uint16_t* dst, size_t count, uint16_t color);
+
+// dst[i] = big-endian pixel i of `src` (2 bytes per pixel)
+void copyBigEndian(uint16_t* dst, const uint8_t* src, size_t count);
+
+// dst[i] = src[i], except where src[i] == key (transparent)
+void copyKeyed(uint16_t* dst, const uint16_t* src, size_t count, uint16_t key);
+
+// dst[i] = src[i] over dst[i] at `alpha` (0 keeps dst, 255 gives src), per
+// channel: d + (((s - d) * a) >> 8) with a = alpha + (alpha >> 7)
+void blend(uint16_t* dst, const uint16_t* src, size_t count, uint8_t alpha);
+
+// Largest |dx| with dx^2 + dy^2 <= radius^2, or -1 if row `dy` misses the
+// disc entirely. A filled disc is the rows dy = -r..r, each spanning
+// centre - w .. centre + w.
+int circleHalfWidth(int radius, int dy);
+
+// Reference versions of the kernels above, one pixel at a time
+namespace scalar {
+void fill(uint16_t* dst, size_t count, uint16_t color);
+void copyBigEndian(uint16_t* dst, const uint8_t* src, size_t count);
+void copyKeyed(uint16_t* dst, const uint16_t* src, size_t count, uint16_t key);
+void blend(uint16_t* dst, const uint16_t* src, size_t count, uint8_t alpha);
+} // namespace scalar
+
+} // namespace raster
+} // namespace vm
+} // namespace dialos
+
+#endif // DIALOS_VM_RASTER_H
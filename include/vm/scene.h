@@ -0,0 +1,130 @@
+/**
+ * dialScript Retained Scene
+ *
+ * A tree of layers holding rects, circles, text labels and sprites that a
+ * script creates once and then only updates (display.createRect,
+ * display.moveNode, ...). render() works out which screen areas changed
+ * since the last call and repaints just those: each area is clipped,
+ * filled with the background and every node overlapping it is drawn
+ * again in paint order. A frame that moves one sprite costs one native
+ * call from the script and a few primitives on the platform, instead of
+ * a redraw of the whole scene.
+ *
+ * Node positions are relative to their layer; moving or hiding a layer
+ * moves or hides everything in it. Siblings paint in z order, ties in
+ * creation order. The scene owns the areas it repaints: anything drawn
+ * there directly is painted over on the next change. Platforms that
+ * can't clip (PlatformInterface::display_setClip) get the whole screen
+ * repainted instead.
+ *
+ * Node ids are small integers, reused once a node is removed. Not
+ * thread-safe; each VM has its own scene.
+ */
+
+#ifndef DIALOS_VM_SCENE_H
+#define DIALOS_VM_SCENE_H
+
+#include "vm/display_list.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace dialos {
+namespace vm {
+
+struct Image;
+class PlatformInterface;
+
+class Scene {
+public:
+    static const int32_t ROOT = 0;              // The layer every scene starts with
+    static const size_t MAX_NODES = 1024;
+    static const size_t MAX_REGIONS = 8;        // Dirty areas kept apart before merging them all
+
+    enum class Kind : uint8_t { LAYER, RECT, CIRCLE, TEXT, SPRITE };
+
+    // What a script can change; fields a kind doesn't use are ignored
+    struct Node {
+        Kind kind = Kind::LAYER;
+        bool visible = true;
+        bool filled = true;             // RECT, CIRCLE
+        uint8_t size = 1;               // TEXT
+        int32_t z = 0;
+        int32_t x = 0, y = 0;           // In the parent layer; CIRCLE: centre
+        int32_t w = 0, h = 0;           // RECT, SPRITE (0: the whole image); CIRCLE: radius in w
+        int32_t sx = 0, sy = 0;         // SPRITE: region of the image
+        uint32_t color = 0xFFFF;
+        int32_t transparent = -1;       // SPRITE colour key, -1: the image's own
+        std::string text;
+        std::shared_ptr<const Image> image;
+    };
+
+    struct Stats {
+        uint32_t renders = 0;           // render() calls that repainted something
+        uint32_t regions = 0;           // Areas repainted
+        uint32_t primitives = 0;        // Platform draw calls issued
+        uint64_t pixels = 0;            // Total area repainted
+    };
+
+    Scene(int width, int height);
+
+    // New node in layer `parent`; its id, or 0 if `parent` is not a layer
+    // or the scene is full
+    int32_t create(Kind kind, int32_t parent);
+    // Node `id` to change (call update() afterwards), or nullptr
+    Node* get(int32_t id);
+    void update(int32_t id);
+    // Remove a node, and everything in it if it is a layer
+    bool remove(int32_t id);
+
+    void setBackground(uint32_t color);
+    // Repaint everything on the next render (the screen was drawn over)
+    void invalidate() { repaintAll_ = true; }
+
+    // Repaint what changed since the last call; returns the number of
+    // areas repainted (0 if nothing changed)
+    int render(PlatformInterface& platform);
+
+    size_t size() const { return live_; }
+    const Stats& getStats() const { return stats_; }
+
+private:
+    struct Slot {
+        Node node;
+        bool live = false;
+        bool changed = true;
+        bool resort = false;            // LAYER: a child was added
+        int32_t parent = ROOT;
+        int32_t sortedZ = 0;            // z when the parent last sorted its children
+        uint32_t serial = 0;            // Creation order
+        std::vector<int32_t> children;  // LAYER, in paint order
+        Rect drawn;                     // Screen area at the last render
+        int32_t left = 0, top = 0;      // Screen position of x, y
+    };
+
+    Slot* slot(int32_t id);
+    // Compute screen areas under layer `id` and collect what changed
+    void walk(int32_t id, int32_t left, int32_t top, bool visible, bool changed);
+    Rect bounds(const Slot& slot) const;
+    void markDirty(const Rect& area);
+    void paint(PlatformInterface& platform, const Slot& slot);
+    void release(int32_t id);
+
+    int width_;
+    int height_;
+    uint32_t background_;
+    bool repaintAll_;
+    uint32_t nextSerial_;
+    size_t live_;
+    std::vector<Slot> slots_;           // slots_[id]; slots_[ROOT] is the root layer
+    std::vector<int32_t> free_;
+    std::vector<int32_t> paintOrder_;   // Visible leaves, rebuilt by every render
+    std::vector<Rect> dirty_;
+    Stats stats_;
+};
+
+} // namespace vm
+} // namespace dialos
+
+#endif // DIALOS_VM_SCENE_H
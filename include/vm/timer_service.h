@@ -0,0 +1,102 @@
+/**
+ * dialScript Timer Service
+ *
+ * Platform-independent backing store for os.timer.*. Pending timers sit in
+ * a binary min-heap keyed on their deadline, so scheduling, cancelling and
+ * firing are O(log n) and the next deadline is O(1). Intervals re-arm from
+ * their previous deadline rather than from the time they actually fired,
+ * so a late poll does not accumulate drift.
+ *
+ * Time is supplied by the caller (milliseconds, 32-bit wrapping), which
+ * keeps the service usable with a virtual clock in host tests.
+ */
+
+#ifndef DIALOS_VM_TIMER_SERVICE_H
+#define DIALOS_VM_TIMER_SERVICE_H
+
+#include "vm/vm_value.h"
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <vector>
+
+namespace dialos {
+namespace vm {
+
+class TimerService {
+public:
+    typedef int TimerId;
+    static const TimerId INVALID_TIMER = -1;
+    static const uint32_t NO_DEADLINE = 0xFFFFFFFF;  // No timer pending
+
+    // Invoked for every timer that fires
+    typedef std::function<void(TimerId id, const Value& callback)> FireHandler;
+
+    TimerService();
+
+    // Scheduling (delays below 1ms are rounded up to 1ms for intervals)
+    TimerId setTimeout(const Value& callback, uint32_t now, uint32_t delayMs);
+    TimerId setInterval(const Value& callback, uint32_t now, uint32_t intervalMs);
+    bool cancel(TimerId id);
+    void clear();
+
+    // Milliseconds from `now` until the earliest timer is due
+    // (0 = overdue, NO_DEADLINE = none pending)
+    uint32_t nextDelay(uint32_t now);
+
+    // Fire every timer due at `now` in deadline order. Timers created by a
+    // callback wait for the next call, so a zero-delay timer cannot starve
+    // the caller. Returns the number of timers fired.
+    size_t fireDue(uint32_t now, const FireHandler& fire);
+
+    size_t size() const { return timers_.size(); }
+    bool empty() const { return timers_.empty(); }
+
+    // A pending timer relative to some `now` (VM snapshots)
+    struct Pending {
+        TimerId id;
+        Value callback;
+        uint32_t delayMs;               // Until it is due (0 = overdue)
+        uint32_t intervalMs;            // 0 = one-shot
+    };
+
+    // Pending timers in firing order
+    std::vector<Pending> pending(uint32_t now);
+    TimerId getNextId() const { return nextId_; }
+    // Replace all timers, keeping their ids (scripts may hold them)
+    void restore(const std::vector<Pending>& timers, TimerId nextId, uint32_t now);
+
+private:
+    struct Timer {
+        Value callback;
+        uint64_t deadline;
+        uint32_t intervalMs;            // 0 = one-shot
+        uint32_t seq;                   // Matches the live heap entry
+    };
+
+    // Heap entries are not removed on cancel/re-arm; entries whose seq no
+    // longer matches their timer are discarded when they reach the top
+    struct HeapEntry {
+        uint64_t deadline;
+        uint32_t seq;                   // Tie-break: FIFO for equal deadlines
+        TimerId id;
+    };
+
+    std::vector<HeapEntry> heap_;
+    std::map<TimerId, Timer> timers_;
+    TimerId nextId_;
+    uint32_t nextSeq_;
+    uint32_t lastNow_;
+    uint64_t epoch_;                    // Wrap count of the 32-bit clock << 32
+
+    uint64_t extend(uint32_t now);      // Widen a 32-bit timestamp
+    TimerId add(const Value& callback, uint64_t deadline, uint32_t intervalMs);
+    void push(TimerId id, Timer& timer);
+    bool dropStale();                   // Pop stale entries; false if heap empty
+    void compact();
+};
+
+} // namespace vm
+} // namespace dialos
+
+#endif // DIALOS_VM_TIMER_SERVICE_H
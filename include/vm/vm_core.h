@@ -10,11 +10,21 @@
 #include "vm/vm_value.h"
 #include "vm/platform.h"
 #include "vm/bytecode.h"
+#include "vm/module_image.h"
+#include "vm/scene.h"
 #include <vector>
 #include <map>
 #include <string>
 #include <functional>
 #include <cstring>
+#include <memory>
+
+// Instruction and native call counters (for the headless reporter). Host
+// builds only: on the device they would cost a 64-bit increment per
+// instruction for numbers nothing reads.
+#if !defined(ARDUINO) && !defined(DIALOS_VM_NO_PROFILE)
+#define DIALOS_VM_PROFILE
+#endif
 
 namespace dialos {
 namespace vm {
@@ -24,7 +34,7 @@ struct CallFrame {
     size_t returnPC;                      // Return program counter
     std::map<uint8_t, Value> locals;      // Local variables
     size_t stackBase;                     // Base of stack for this frame
-    std::string functionName;             // For debugging
+    compiler::StringRef functionName = {nullptr, 0};  // Into the module's function table
 };
 
 // Exception handler
@@ -47,6 +57,17 @@ class VMState {
 public:
     VMState(const compiler::BytecodeModule& module, ValuePool& pool, PlatformInterface& platform);
     
+    // Run directly from a pre-deserialized (flash-resident) module image.
+    // The image and everything it points to must outlive the VM.
+    VMState(const compiler::ModuleImage& image, ValuePool& pool, PlatformInterface& platform);
+    
+    // Unbinds the platform so late callbacks/timers can't reach a dead VM
+    ~VMState();
+    
+    // image_ may point into this VM's own tables, so a copy would dangle
+    VMState(const VMState&) = delete;
+    VMState& operator=(const VMState&) = delete;
+    
     // Execute instructions (returns after maxInstructions or yield)
     VMResult execute(uint32_t maxInstructions = 1000);
     
@@ -60,7 +81,7 @@ public:
     size_t getStackSize() const { return stack_.size(); }
     const std::vector<CallFrame>& getCallStack() const { return callStack_; }
     size_t getCallStackDepth() const { return callStack_.size(); }
-    const std::map<std::string, Value>& getGlobals() const { return globals_; }
+    const ValueMap& getGlobals() const { return globals_; }
     std::string getError() const { return error_; }
     bool isRunning() const { return running_; }
     bool hasError() const { return !error_.empty(); }
@@ -69,14 +90,53 @@ public:
     size_t getHeapAvailable() const { return pool_.getAvailable(); }
     // Total heap size configured for this VM
     size_t getHeapSize() const { return pool_.getHeapSize(); }
+    // Platform the VM dispatches natives and callbacks through
+    PlatformInterface& getPlatform() const { return platform_; }
+    
+    // Execution counters since construction: instructions executed
+    // (callbacks included) and calls per native function name. Zero and
+    // empty unless DIALOS_VM_PROFILE is defined.
+#ifdef DIALOS_VM_PROFILE
+    uint64_t getInstructionCount() const { return instructionCount_; }
+#else
+    uint64_t getInstructionCount() const { return 0; }
+#endif
+    std::map<std::string, uint64_t> getNativeCallCounts() const;
     
     // Sleep state
     bool isSleeping() const { return sleeping_; }
+    uint64_t getSleepUntil() const { return sleepUntil_; }  // Wake deadline (valid while sleeping)
     void checkSleepState();  // Check if sleep period has ended
     
+    // Async natives
+    // True while the current frame is parked in an async native; execute()
+    // yields until the platform completes it
+    bool isAwaiting() const { return awaitingToken_ != NO_ASYNC; }
+    // Deliver an async result: resumes the parked frame, or calls the
+    // callback passed to the native. Unknown tokens are ignored.
+    void completeAsync(AsyncToken token, const std::string& payload);
+    
+    // Pooled string value (for data handed in by the host, e.g. IPC
+    // messages); null if the heap is exhausted
+    Value makeString(const char* data, size_t length);
+    
+    // Free pooled strings that nothing on the stack, in locals or in
+    // globals (directly or through objects/arrays) refers to
+    void collectStrings();
+    
     // Reset VM
     void reset();
     
+    // Snapshots: everything the script can observe (stack, call frames,
+    // globals and the heap graph they reach, registered callbacks, pending
+    // timers, loaded images) in a compact image. A VM built from the same
+    // module can restore() it and carry on where this one stopped; sleeps
+    // and timers resume with the time they had left. Fails while a callback
+    // is running, an async native is in flight or the scene holds nodes
+    // (they aren't part of the image).
+    bool snapshot(std::vector<uint8_t>& out);
+    bool restore(const uint8_t* data, size_t size);
+    
     // Callback invocation
     // Invoke a function value with given arguments (for immediate callback execution)
     bool invokeFunction(const Value& callback, const std::vector<Value>& args);
@@ -85,8 +145,14 @@ public:
     VMResult step() { return executeInstruction(); }
     
 private:
-    // Bytecode module
-    const compiler::BytecodeModule& module_;
+    // Bytecode module (null when running from a ModuleImage; only used for debug info)
+    const compiler::BytecodeModule* module_;
+    
+    // Flat view of the module tables; every lookup goes through this
+    compiler::ModuleImage image_;
+    std::vector<compiler::StringRef> ownedStrings_;     // Backing for image_ when built from a BytecodeModule
+    std::vector<compiler::FunctionRef> ownedFunctions_;
+    std::vector<NativeFunctionID> nativeIds_;           // By function table index (UNKNOWN if not a native)
     
     // Memory
     ValuePool& pool_;
@@ -95,10 +161,11 @@ private:
     PlatformInterface& platform_;
     
     // Execution state
-    std::vector<uint8_t> code_;
+    const uint8_t* code_;
+    size_t codeSize_;
     std::vector<Value> stack_;
     std::vector<CallFrame> callStack_;
-    std::map<std::string, Value> globals_;
+    ValueMap globals_;
     std::vector<ExceptionHandler> exceptionHandlers_;
     
     size_t pc_;
@@ -109,15 +176,85 @@ private:
     bool sleeping_;
     uint64_t sleepUntil_;  // Timestamp when sleep ends
     
+    // Async native state
+    AsyncToken awaitingToken_;            // Parked frame's operation (NO_ASYNC if none)
+    NativeFunctionID awaitingNative_;     // Native the frame is parked in
+    struct AsyncCallback {
+        NativeFunctionID native;
+        Value callback;
+    };
+    std::map<AsyncToken, AsyncCallback> asyncCallbacks_;  // Callback-style calls in flight
+    int callbackDepth_;                   // >0 while invokeFunction runs; frames can't park
+    
+    // collectStrings() scratch, kept between collections
+    std::vector<std::string*> liveStrings_;
+    uint32_t markEpoch_;                  // Stamped on objects/arrays walked by the current pass
+    
+#ifdef DIALOS_VM_PROFILE
+    // Profiling counters (see getInstructionCount)
+    uint64_t instructionCount_;
+    std::vector<uint32_t> nativeCalls_;   // By function table index
+#endif
+    
+    // Images from display.loadImage; an Image object's "id" is index + 1.
+    // imageKeys_ holds their ImageCache keys, which snapshots carry.
+    std::vector<std::shared_ptr<const Image>> images_;
+    std::vector<std::string> imageKeys_;
+    
+    // Retained nodes from display.create*, made on first use
+    std::unique_ptr<Scene> scene_;
+    
+    // Objects display.getSize, display.measureText and touch.getPosition
+    // return, made on first use and refilled by every later call, so
+    // polling them each frame allocates nothing
+    Object* sizeResult_;
+    Object* textSizeResult_;
+    Object* touchResult_;
+    
     // Instruction execution
     VMResult executeInstruction();
     
+    // Shared constructor tail (globals and built-in 'os' object)
+    void initialize();
+    
+    // Module table accessors
+    std::string functionNameAt(size_t index) const {
+        return index < image_.functionCount ? image_.functions[index].name.str() : "<callback>";
+    }
+    
     // Helper methods
     Value loadConstant(uint16_t index);
     Value loadGlobal(uint16_t index);
     void storeGlobal(uint16_t index, const Value& value);
     void setError(const std::string& msg);
     
+    // Slow natives (file.read, wifi.connect, http.*) that may run async
+    VMResult callSlowNative(NativeFunctionID id, uint8_t argCount);
+    std::string runSlowNative(NativeFunctionID id, const std::vector<std::string>& args);
+    Value slowNativeResult(NativeFunctionID id, const std::string& payload);
+    Value makeDownloadResult(const std::string& text);
+    
+    // json.parse and natives answering in JSON: the value `text` holds,
+    // built straight in the pool; null (with a console warning) if it
+    // isn't valid JSON
+    Value parseJson(const std::string& text);
+    
+    // display.loadImage: decode (or find in the shared cache) an image from
+    // a path, a "data:...;base64," string or a byte array
+    Value loadImage(const Value& source);
+    std::shared_ptr<const Image> loadImageFile(const std::string& path, std::string& error);
+    std::shared_ptr<const Image> imageFor(const Value& value) const;
+    
+    // display.create*/setNode/render: the VM's scene, and copying a
+    // props object ({x, y, color, text, visible, ...}) onto a node
+    Scene& scene();
+    void applyNodeProps(Scene::Node& node, const Value& props);
+    
+    // Object to return a native's fields in: `into` if the script passed
+    // one, else the VM's reusable `cached` result (nullptr when the heap
+    // is full)
+    Object* resultObject(Object*& cached, const char* className, const Value& into);
+    
     // Template formatting
     std::string formatTemplate(const std::string& template_str, const std::vector<Value>& args);
     
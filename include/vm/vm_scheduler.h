@@ -0,0 +1,151 @@
+/**
+ * dialScript VM Scheduler
+ *
+ * Runs many VMState instances cooperatively inside a single host task.
+ * Each VM gets an instruction budget per slice; a pass over all VMs is
+ * bounded by a time budget. VMs that are sleeping are skipped until their
+ * deadline, and VMs that have finished their main code can stay resident
+ * to service events (callbacks) delivered through an optional poll hook or
+ * posted with postEvent(), and os.timer.* callbacks as their timers expire.
+ * A VM parked in an async native (http.get, ...) is skipped until its
+ * platform completes the operation.
+ *
+ * The scheduler never spins: tick() reports how long the host loop may
+ * block, and postEvent() calls the wake handler so a host blocked on that
+ * deadline (task notification, SDL_WaitEventTimeout, ...) resumes at once.
+ *
+ * The scheduler does not own the VMs, pools or platforms it runs, and is
+ * not thread-safe: hosts posting from other tasks must serialise access.
+ */
+
+#ifndef DIALOS_VM_SCHEDULER_H
+#define DIALOS_VM_SCHEDULER_H
+
+#include "vm/vm_core.h"
+#include <vector>
+#include <string>
+#include <functional>
+
+namespace dialos {
+namespace vm {
+
+// Order in which ready VMs are given slices
+enum class SchedulePolicy {
+    ROUND_ROBIN,    // Rotate the starting VM every pass
+    PRIORITY        // Highest priority first; round-robin within a level
+};
+
+// Scheduler-side state of a VM
+enum class VMTaskStatus {
+    READY,          // Has work to do now
+    SLEEPING,       // Waiting for a sleep deadline
+    WAITING_ASYNC,  // Parked in an async native until the platform completes it
+    WAITING_EVENT,  // Main code done, kept alive for callbacks
+    FINISHED,       // Done, nothing left to run
+    FAILED          // Runtime error; kept for inspection
+};
+
+class VMScheduler {
+public:
+    typedef int TaskId;
+    static const TaskId INVALID_TASK = -1;
+    static const uint32_t NO_DEADLINE = 0xFFFFFFFF;  // Nothing to wake for
+    static const uint32_t OOM_RETRY_MS = 5000;       // Back-off before restarting an OOM'd VM
+
+    // Per-VM configuration
+    struct TaskConfig {
+        std::string name;
+        uint8_t priority;               // Higher runs first under PRIORITY
+        uint32_t instructionBudget;     // Max instructions per slice
+        bool repeat;                    // Restart main code when it finishes
+        uint32_t repeatIntervalMs;      // Delay before a repeat
+        bool keepAlive;                 // Stay resident for events after finishing
+
+        TaskConfig() : priority(0), instructionBudget(1000), repeat(false),
+                       repeatIntervalMs(0), keepAlive(false) {}
+    };
+
+    // Per-VM bookkeeping exposed for diagnostics
+    struct TaskInfo {
+        TaskId id;
+        TaskConfig config;
+        VMTaskStatus status;
+        uint32_t wakeAt;                // Deadline while SLEEPING
+        uint32_t slices;                // Slices executed
+        uint32_t runCount;              // Times main code ran to completion
+        uint32_t timeUsedMs;            // Wall time spent in execute()
+        uint32_t eventsDelivered;       // Posted events handed to callbacks
+    };
+
+    // Delivers pending events to a VM (invoking callbacks); returns true if
+    // anything was delivered
+    typedef std::function<bool()> EventPoll;
+
+    // Wakes a host loop blocked on the deadline returned by tick(). Also
+    // called from platform worker threads when an async native completes.
+    typedef std::function<void()> WakeHandler;
+
+    explicit VMScheduler(PlatformInterface& clock, SchedulePolicy policy = SchedulePolicy::ROUND_ROBIN);
+    ~VMScheduler();  // Detaches the async wake handlers installed by add()
+
+    // Task management
+    TaskId add(VMState& vm, const TaskConfig& config);
+    bool remove(TaskId id);
+    void setEventPoll(TaskId id, EventPoll poll);  // Called every pass while the VM is live
+
+    // Events
+    // Queue a callback invocation (e.g. "encoder.onTurn") for the next pass
+    // and wake the host. Returns false if the task is gone or finished.
+    bool postEvent(TaskId id, const std::string& eventName, const std::vector<Value>& args);
+    void setWakeHandler(WakeHandler handler) { wake_ = handler; }
+
+    // Scheduling
+    // Run one pass over the VMs. Returns how many ms the caller may block
+    // before the next pass has work (0 = call again immediately,
+    // NO_DEADLINE = only an external event can create work).
+    uint32_t tick();
+
+    // Pass-level time budget in ms (0 = unlimited)
+    void setTimeBudget(uint32_t ms) { timeBudgetMs_ = ms; }
+    void setPolicy(SchedulePolicy policy) { policy_ = policy; }
+
+    // Queries
+    size_t getTaskCount() const { return tasks_.size(); }
+    size_t getLiveTaskCount() const;
+    const TaskInfo* getTaskInfo(TaskId id) const;
+    VMState* getVM(TaskId id) const;
+
+private:
+    struct PendingEvent {
+        std::string name;
+        std::vector<Value> args;
+    };
+
+    struct Task {
+        TaskInfo info;
+        VMState* vm;
+        EventPoll poll;
+        std::vector<PendingEvent> events;   // Posted, not yet delivered
+        bool pendingRestart;            // Reset the VM when wakeAt passes
+    };
+
+    PlatformInterface& clock_;
+    SchedulePolicy policy_;
+    uint32_t timeBudgetMs_;
+    std::vector<Task> tasks_;
+    TaskId nextId_;
+    size_t cursor_;                     // Round-robin start position
+    WakeHandler wake_;
+
+    Task* find(TaskId id);
+    const Task* find(TaskId id) const;
+    void deliverEvents(Task& task);
+    void refreshStatus(Task& task, uint32_t now);
+    void runSlice(Task& task, uint32_t now);
+    void buildRunOrder(std::vector<size_t>& order) const;
+};
+
+} // namespace vm
+} // namespace dialos
+
+#endif // DIALOS_VM_SCHEDULER_H
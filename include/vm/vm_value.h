@@ -7,10 +7,13 @@
 #ifndef DIALOS_VM_VALUE_H
 #define DIALOS_VM_VALUE_H
 
+#include <algorithm>
 #include <cstdint>
 #include <string>
 #include <vector>
 #include <map>
+#include <set>
+#include <unordered_map>
 #include <memory>
 
 namespace dialos {
@@ -134,10 +137,32 @@ struct Value {
     bool equals(const Value& other) const;
 };
 
+// A name that lives elsewhere (e.g. in a module's string table)
+struct NameView {
+    const char* data;
+    size_t length;
+};
+
+// Lets name-keyed maps be searched with a NameView, so looking up a
+// global or a field by its module name doesn't build a std::string
+struct NameLess {
+    typedef void is_transparent;
+    bool operator()(const std::string& a, const std::string& b) const { return a < b; }
+    bool operator()(const std::string& a, const NameView& b) const {
+        return a.compare(0, std::string::npos, b.data, b.length) < 0;
+    }
+    bool operator()(const NameView& a, const std::string& b) const {
+        return b.compare(0, std::string::npos, a.data, a.length) > 0;
+    }
+};
+
+typedef std::map<std::string, Value, NameLess> ValueMap;
+
 // Object type (key-value map)
 struct Object {
-    std::map<std::string, Value> fields;
+    ValueMap fields;
     std::string className;
+    uint32_t mark = 0;  // Last string collection that reached it
     
     Object() : className("Object") {}
     explicit Object(const std::string& name) : className(name) {}
@@ -146,6 +171,7 @@ struct Object {
 // Array type (dynamic array)
 struct Array {
     std::vector<Value> elements;
+    uint32_t mark = 0;  // Last string collection that reached it
     
     Array() {}
     explicit Array(size_t size) : elements(size) {}
@@ -165,16 +191,26 @@ public:
     }
     
     std::string* allocateString(const std::string& str) {
-        // String interning: check if we already have this string
-        for (size_t i = 0; i < strings_.size(); ++i) {
-            if (*strings_[i] == str) {
-                stringRefCounts_[i]++; // Increment reference count
-                return strings_[i]; // Reuse existing string
+        return allocateString(str.data(), str.length());
+    }
+    
+    // Allocate straight from a byte range (e.g. an IPC message) without an
+    // intermediate std::string
+    std::string* allocateString(const char* data, size_t length) {
+        // String interning: check if we already have this string. Looked up
+        // by hash, so a script reading a file line by line doesn't rescan
+        // every live string per line.
+        uint32_t hash = hashString(data, length);
+        auto range = stringIndex_.equal_range(hash);
+        for (auto it = range.first; it != range.second; ++it) {
+            if (strings_[it->second]->compare(0, std::string::npos, data, length) == 0) {
+                stringRefCounts_[it->second]++; // Increment reference count
+                return strings_[it->second]; // Reuse existing string
             }
         }
         
         // Not found, allocate new string
-        size_t size = str.length() + sizeof(std::string);
+        size_t size = length + sizeof(std::string);
         if (allocated_ + size > heapSize_) {
             // Try garbage collection first
             garbageCollectStrings();
@@ -183,7 +219,8 @@ public:
             }
         }
         
-        auto* s = new std::string(str);
+        auto* s = new std::string(data, length);
+        stringIndex_.insert(std::make_pair(hash, strings_.size()));
         strings_.push_back(s);
         stringRefCounts_.push_back(1); // Initialize reference count
         allocated_ += size;
@@ -242,28 +279,56 @@ public:
         }
     }
     
-    void garbageCollectStrings() {
+    // Free pooled strings. With `live` (strings the VM still references,
+    // sorted by address), those are kept; without it everything goes.
+    void garbageCollectStrings(const std::vector<std::string*>* live = nullptr) {
         // Simple heuristic: reset all reference counts and clean up
         // This works because we're called at callback boundaries when temporaries should be gone
-        for (size_t i = 0; i < stringRefCounts_.size(); ++i) {
-            stringRefCounts_[i] = 0;  // Reset all reference counts
-        }
-        
-        // Remove all strings with zero reference count (now all of them)
-        for (auto* str : strings_) {
+        size_t kept = 0;
+        for (size_t i = 0; i < strings_.size(); ++i) {
+            std::string* str = strings_[i];
+            bool keep = live && std::binary_search(live->begin(), live->end(), str);
+            // Drop the string's index entry, or move it along with the string
+            auto range = stringIndex_.equal_range(hashString(str->data(), str->length()));
+            for (auto it = range.first; it != range.second; ++it) {
+                if (it->second == i) {
+                    if (keep) {
+                        it->second = kept;
+                    } else {
+                        stringIndex_.erase(it);
+                    }
+                    break;
+                }
+            }
+            if (keep) {
+                strings_[kept] = str;
+                stringRefCounts_[kept] = 0;
+                kept++;
+                continue;
+            }
             size_t size = str->length() + sizeof(std::string);
             allocated_ -= size;
             delete str;
         }
-        strings_.clear();
-        stringRefCounts_.clear();
+        strings_.resize(kept);
+        stringRefCounts_.resize(kept);
     }
     
 private:
+    // FNV-1a
+    static uint32_t hashString(const char* data, size_t length) {
+        uint32_t hash = 2166136261u;
+        for (size_t i = 0; i < length; ++i) {
+            hash = (hash ^ static_cast<uint8_t>(data[i])) * 16777619u;
+        }
+        return hash;
+    }
+    
     size_t heapSize_;
     size_t allocated_;
     std::vector<std::string*> strings_;
     std::vector<int> stringRefCounts_;  // Reference counts for strings
+    std::unordered_multimap<uint32_t, size_t> stringIndex_;  // Hash -> index in strings_
     std::vector<Object*> objects_;
     std::vector<Array*> arrays_;
     std::vector<Function*> functions_;
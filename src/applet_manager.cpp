@@ -1,5 +1,6 @@
 #include "applet_manager.h"
 
+#include <algorithm>
 #include <cstdio>
 #include <cstring>
 
@@ -7,8 +8,80 @@ using namespace dialOS;
 
 AppletManager* AppletManager::instance = nullptr;
 
+namespace {
+// Payload bytes shared by all mailboxes, and unread messages per applet
+const size_t IPC_ARENA_BYTES = 4096;
+const size_t IPC_MAILBOX_DEPTH = 8;
+
+// One bus for every applet on every runtime (os.ipc.*)
+dialos::vm::IpcBus &ipcBus() {
+  static dialos::vm::IpcBus bus(IPC_ARENA_BYTES, IPC_MAILBOX_DEPTH);
+  return bus;
+}
+
+// Snapshots of suspended applets, shared by all runtimes so an applet can
+// resume on either core. The oldest is dropped when the pool is full; that
+// applet then starts cold next time.
+const size_t MAX_WARM_APPLETS = 4;
+
+class WarmPool {
+public:
+  WarmPool() : lock(xSemaphoreCreateMutex()) {}
+
+  void put(const char *name, std::vector<uint8_t> &image) {
+    xSemaphoreTake(lock, portMAX_DELAY);
+    drop(name);
+    if (entries.size() >= MAX_WARM_APPLETS) {
+      entries.erase(entries.begin());
+    }
+    entries.push_back(Entry());
+    entries.back().name = name;
+    entries.back().image.swap(image);
+    xSemaphoreGive(lock);
+  }
+
+  bool take(const char *name, std::vector<uint8_t> &image) {
+    xSemaphoreTake(lock, portMAX_DELAY);
+    bool found = false;
+    for (size_t i = 0; i < entries.size(); i++) {
+      if (entries[i].name == name) {
+        image.swap(entries[i].image);
+        entries.erase(entries.begin() + i);
+        found = true;
+        break;
+      }
+    }
+    xSemaphoreGive(lock);
+    return found;
+  }
+
+private:
+  struct Entry {
+    std::string name;
+    std::vector<uint8_t> image;
+  };
+
+  void drop(const char *name) {
+    for (size_t i = 0; i < entries.size(); i++) {
+      if (entries[i].name == name) {
+        entries.erase(entries.begin() + i);
+        return;
+      }
+    }
+  }
+
+  std::vector<Entry> entries;  // oldest first
+  SemaphoreHandle_t lock;
+};
+
+WarmPool &warmPool() {
+  static WarmPool pool;
+  return pool;
+}
+} // namespace
+
 AppletManager::AppletManager()
-: selectionIndex(0), lastChangeMs(0), lastEncoderValue(0)
+: selectionIndex(0), lastChangeMs(0), lastEncoderValue(0), foreground(nullptr)
 {
     // applets.push_back({"hello_world", "Builtin hello world applet", 1024, true, false, 0});
     // applets.push_back({"counter_applet", "Builtin counter applet", 2048, true, true, 1000});
@@ -21,141 +94,341 @@ AppletManager::~AppletManager() {
     // nothing to free yet
 }
 
-// Generalized VM task for running any applet
-// param should be a pointer to VMApplet from the registry
-void vmAppletTask(byte taskId, void *param) {
-  
-  // Get or create per-task state
-  static std::map<byte, VMTaskState*> taskStates;
-  
-  if (taskStates.find(taskId) == taskStates.end()) {
-    taskStates[taskId] = new VMTaskState();
-  }
-  
-  VMTaskState* state = taskStates[taskId];
-  SystemServices *sys = Kernel::instance().getSystemServices();
+// ===================== VM Runtime =====================
 
-  // Prevent re-execution after finishing for one-shot applets
-  if (state->hasFinished) {
-    TaskScheduler::sleepMs(1000); // Sleep if finished
-    return;
+VMRuntime &VMRuntime::forCore(int core) {
+  // All runtimes are created together on first use (thread-safe static init)
+  static std::vector<VMRuntime *> runtimes = []() {
+    std::vector<VMRuntime *> all;
+    for (int i = 0; i < CORE_COUNT; i++) {
+      all.push_back(new VMRuntime(i));
+    }
+    return all;
+  }();
+  return *runtimes[core];
+}
+
+VMRuntime &VMRuntime::select(int coreHint) {
+  if (coreHint >= 0 && coreHint < CORE_COUNT) {
+    return forCore(coreHint);
+  }
+  VMRuntime *best = &forCore(0);
+  for (int i = 1; i < CORE_COUNT; i++) {
+    VMRuntime &candidate = forCore(i);
+    if (candidate.getAppletCount() < best->getAppletCount()) {
+      best = &candidate;
+    }
   }
+  return *best;
+}
 
-  // Get applet descriptor
-  VMApplet *applet = (VMApplet *)param;
-  if (!applet) {
-    sys->log(LogLevel::ERROR, "VM task started with null applet");
-    return;
+VMRuntime::VMRuntime(int core)
+    : core(core), scheduler(clock), lock(xSemaphoreCreateMutex()), task(nullptr),
+      lastFrameMs(0) {
+  // Posted events end the idle wait immediately
+  scheduler.setWakeHandler([this]() { wake(); });
+  // So does input queued by the sampling callback
+  input = InputSource::instance().attach(
+      [](void *context) { static_cast<VMRuntime *>(context)->wake(); }, this);
+  char name[16];
+  snprintf(name, sizeof(name), "VM_Runtime%d", core);
+  idleSource = PowerManager::instance().getIdleManager().addSource(name);
+}
+
+void VMRuntime::wake() {
+  // Busy until the next pass reports a new deadline, so the system can't
+  // enter light sleep on the strength of a stale one
+  PowerManager::instance().getIdleManager().update(idleSource, millis(), 0);
+  if (task && task->getHandle()) {
+    xTaskNotifyGive(task->getHandle());
   }
+}
 
-  // Initialize platform (shared across all applets)
-  if (!state->platform) {
-    state->platform = new ESP32Platform();
+Task *VMRuntime::start() {
+  if (task) {
+    return task;
   }
+  TaskScheduler *taskScheduler = Kernel::instance().getScheduler();
+  char name[16];
+  snprintf(name, sizeof(name), "VM_Runtime%d", core);
+  task = taskScheduler->createTask(name, VMRuntime::taskEntry, this,
+                                   16384, TaskPriority::NORMAL, core);
+  return task;
+}
 
-  // Initialize VM on first run
-  if (!state->initialized) {
-    sys->logf(LogLevel::INFO, "Starting VM task for applet: %s (%d bytes)", applet->name,
-              applet->bytecodeSize);
+void VMRuntime::taskEntry(byte taskId, void *param) {
+  static_cast<VMRuntime *>(param)->run();
+}
 
+VMAppletInstance *VMRuntime::load(const VMApplet *applet, bool &resumed) {
+  SystemServices *sys = Kernel::instance().getSystemServices();
+  sys->logf(LogLevel::INFO, "Starting VM for applet: %s (%d bytes)", applet->name,
+            applet->bytecodeSize);
+
+  VMAppletInstance *inst = new VMAppletInstance();
+  inst->applet = applet;
+  inst->platform = new dialos::vm::ESP32Platform();
+
+  uint32_t launchStartUs = micros();
+  uint32_t heapSize = 0;
+
+  if (applet->module) {
+    // Built-in applet: run straight from the flash-resident image, no
+    // deserialize step and no heap copy of the module tables
+    heapSize = applet->module->heapSize;
+    inst->pool = new dialos::vm::ValuePool(heapSize);
+    inst->vmState = new dialos::vm::VMState(*applet->module, *inst->pool, *inst->platform);
+  } else {
     // Deserialize bytecode
     std::vector<uint8_t> bytecode(applet->bytecode,
                                   applet->bytecode + applet->bytecodeSize);
-    state->module = new dialos::compiler::BytecodeModule();
+    inst->module = new dialos::compiler::BytecodeModule();
     try {
-      *state->module = dialos::compiler::BytecodeModule::deserialize(bytecode);
+      *inst->module = dialos::compiler::BytecodeModule::deserialize(bytecode);
       sys->logf(LogLevel::INFO, "Applet '%s' loaded successfully",
                 applet->name);
     } catch (const std::exception &e) {
       sys->logf(LogLevel::ERROR, "Failed to load applet '%s': %s",
                 applet->name, e.what());
-      delete state->module;
-      state->module = nullptr;
-      return;
+      destroy(inst);
+      return nullptr;
     }
 
     // Create value pool and VM state
-    state->pool = new dialos::vm::ValuePool(state->module->metadata.heapSize);
-    state->vmState = new dialos::vm::VMState(*state->module, *state->pool, *state->platform);
-    state->vmState->reset();
-    sys->logf(LogLevel::INFO, "VM initialized for '%s', heap: %d bytes",
-              applet->name, state->module->metadata.heapSize);
-    // Invoke app.onLoad callback if registered so the app can perform startup setup
-    // (e.g., register encoders, timers). Use an empty args vector.
-    state->platform->invokeCallback("app.onLoad", std::vector<dialos::vm::Value>());
-    state->platform->console_log("Invoked app.onLoad callback if registered");
-    state->initialized = true;
+    heapSize = inst->module->metadata.heapSize;
+    inst->pool = new dialos::vm::ValuePool(heapSize);
+    inst->vmState = new dialos::vm::VMState(*inst->module, *inst->pool, *inst->platform);
   }
-  
-  // FreeRTOS tasks run in infinite loops
-  while (true) {
-    // Prevent re-execution after finishing for one-shot applets
-    if (state->hasFinished) {
-      TaskScheduler::sleepMs(1000); // Sleep if finished
+  // Resume a suspended applet from its snapshot instead of rerunning main
+  std::vector<uint8_t> image;
+  resumed = warmPool().take(applet->name, image) &&
+            inst->vmState->restore(image.data(), image.size());
+  if (!resumed) {
+    inst->vmState->reset();
+  }
+  if (!inst->platform->attachIpc(&ipcBus(), applet->name)) {
+    sys->logf(LogLevel::WARNING, "Applet '%s' already has a mailbox; IPC disabled",
+              applet->name);
+  }
+  sys->logf(LogLevel::INFO, "VM initialized for '%s', heap: %d bytes, launch: %lu us (%s%s)",
+            applet->name, heapSize, (unsigned long)(micros() - launchStartUs),
+            applet->module ? "flash image" : "deserialized", resumed ? ", resumed" : "");
+  return inst;
+}
+
+void VMRuntime::destroy(VMAppletInstance *inst) {
+  delete inst->vmState;
+  delete inst->pool;
+  delete inst->module;
+  delete inst->platform;
+  delete inst;
+}
+
+void VMRuntime::launch(const VMApplet *applet) {
+  // Loading and app.onLoad run on the runtime task (its stack, its
+  // scheduler), not on the caller's
+  xSemaphoreTake(lock, portMAX_DELAY);
+  launches.push_back(applet);
+  xSemaphoreGive(lock);
+  wake();
+}
+
+void VMRuntime::startApplets() {
+  SystemServices *sys = Kernel::instance().getSystemServices();
+  std::vector<const VMApplet *> queued;
+  xSemaphoreTake(lock, portMAX_DELAY);
+  queued.swap(launches);
+  xSemaphoreGive(lock);
+
+  for (const VMApplet *applet : queued) {
+    bool resumed = false;
+    VMAppletInstance *inst = load(applet, resumed);
+    if (!inst) {
+      sys->logf(LogLevel::ERROR, "Failed to launch applet: %s", applet->name);
+      continue;
+    }
+
+    dialos::vm::VMScheduler::TaskConfig config;
+    config.name = applet->name;
+    config.instructionBudget = INSTRUCTION_BUDGET;
+    config.repeat = applet->repeat;
+    config.repeatIntervalMs = applet->executeInterval;
+    // Stay resident after main; reap() drops applets with no callbacks or timers
+    config.keepAlive = true;
+
+    xSemaphoreTake(lock, portMAX_DELAY);
+    inst->schedulerId = scheduler.add(*inst->vmState, config);
+    applets.push_back(inst);
+    // Delivered before the applet's first slice, like any other event
+    scheduler.postEvent(inst->schedulerId, resumed ? "app.onResume" : "app.onLoad",
+                        std::vector<dialos::vm::Value>());
+    xSemaphoreGive(lock);
+  }
+}
+
+bool VMRuntime::suspend(const char *appletName) {
+  // app.onSuspend and the snapshot run on the runtime task, not the caller's
+  xSemaphoreTake(lock, portMAX_DELAY);
+  const VMApplet *found = nullptr;
+  for (VMAppletInstance *inst : applets) {
+    if (strcmp(inst->applet->name, appletName) == 0) {
+      found = inst->applet;
+    }
+  }
+  for (const VMApplet *applet : launches) {
+    if (strcmp(applet->name, appletName) == 0) {
+      found = applet;
+    }
+  }
+  if (found) {
+    suspensions.push_back(found);
+  }
+  xSemaphoreGive(lock);
+  if (found) {
+    wake();
+  }
+  return found != nullptr;
+}
+
+void VMRuntime::suspendApplets() {
+  SystemServices *sys = Kernel::instance().getSystemServices();
+  xSemaphoreTake(lock, portMAX_DELAY);
+  std::vector<const VMApplet *> queued;
+  queued.swap(suspensions);
+  for (const VMApplet *applet : queued) {
+    size_t i = 0;
+    while (i < applets.size() && applets[i]->applet != applet) {
+      i++;
+    }
+    if (i == applets.size()) {
+      // Not loaded yet: try again after this pass has started it. Otherwise
+      // it finished (and was reaped) meanwhile.
+      if (std::find(launches.begin(), launches.end(), applet) != launches.end()) {
+        suspensions.push_back(applet);
+      }
       continue;
     }
-    
-    if (!state->initialized) {
-      // Should not happen, but safety check
-      TaskScheduler::sleepMs(100);
+    VMAppletInstance *inst = applets[i];
+
+    uint32_t startUs = micros();
+    std::vector<dialos::vm::Value> noArgs;
+    inst->platform->invokeCallback("app.onSuspend", noArgs);
+    std::vector<uint8_t> image;
+    if (!inst->vmState->snapshot(image)) {
+      // Busy (e.g. waiting on an async native): leave it running
+      inst->platform->invokeCallback("app.onResume", noArgs);
+      sys->logf(LogLevel::WARNING, "Applet '%s' can't be suspended right now", applet->name);
       continue;
     }
-    
-    // Reset VM for repeated execution (except first time)
-    // Only reset for applets that are designed to repeat
-    if (state->executionCount > 0 && applet->repeat) {
-      state->vmState->reset();
+    size_t imageSize = image.size();
+    warmPool().put(applet->name, image);
+    scheduler.remove(inst->schedulerId);
+    applets.erase(applets.begin() + i);
+    destroy(inst);
+    sys->logf(LogLevel::INFO, "Applet '%s' suspended: %u byte snapshot in %lu us", applet->name,
+              (unsigned)imageSize, (unsigned long)(micros() - startUs));
+  }
+  xSemaphoreGive(lock);
+}
+
+size_t VMRuntime::getAppletCount() {
+  xSemaphoreTake(lock, portMAX_DELAY);
+  size_t count = applets.size() + launches.size();
+  xSemaphoreGive(lock);
+  return count;
+}
+
+void VMRuntime::reap() {
+  SystemServices *sys = Kernel::instance().getSystemServices();
+
+  for (size_t i = 0; i < applets.size();) {
+    VMAppletInstance *inst = applets[i];
+    const dialos::vm::VMScheduler::TaskInfo *info = scheduler.getTaskInfo(inst->schedulerId);
+    if (info && info->status == dialos::vm::VMTaskStatus::FAILED) {
+      std::string err = inst->vmState->getError();
+      sys->logf(LogLevel::ERROR, "VM error in '%s': %s", inst->applet->name,
+                err.empty() ? "Unknown error" : err.c_str());
+    } else if (info && (info->status == dialos::vm::VMTaskStatus::FINISHED ||
+                        (info->status == dialos::vm::VMTaskStatus::WAITING_EVENT &&
+                         !inst->platform->hasInputListeners() &&
+                         !inst->platform->hasTimers() &&
+                         !inst->platform->hasPendingAsync() &&
+                         !inst->platform->getCallback("ipc.onMessage")))) {
+      sys->logf(LogLevel::INFO, "Applet '%s' finished", inst->applet->name);
+    } else {
+      i++;
+      continue;
     }
 
-    // Execute VM (up to 1000 instructions per task tick)
-    dialos::vm::VMResult result = state->vmState->execute(1000);
-
-    // Handle execution result
-    if (result == dialos::vm::VMResult::FINISHED) {
-      state->executionCount++;
-
-      // Handle repeat or one-shot execution
-      if (applet->repeat && applet->executeInterval > 0) {
-        // For repeating applets with intervals, reset and wait
-        state->vmState->reset();
-        TaskScheduler::sleepMs(applet->executeInterval);
-      } else if (!applet->repeat) {
-        // One-shot applet finished - don't reset, just mark as finished
-        sys->logf(LogLevel::INFO, "Applet '%s' finished (task %d)",
-                  applet->name, taskId);
-        state->hasFinished = true;
-        // Sleep for a while before checking again
-        TaskScheduler::sleepMs(1000);
-      } else {
-        // repeat=true but interval=0, run continuously with reset
-        state->vmState->reset();
-        // Small delay to prevent busy loop
-        TaskScheduler::sleepMs(10);
+    // One-shot applets are done for good: give their RAM back
+    scheduler.remove(inst->schedulerId);
+    applets.erase(applets.begin() + i);
+    destroy(inst);
+  }
+}
+
+void VMRuntime::drainInput() {
+  if (!input) {
+    return;
+  }
+  // Deliver in order to every applet listening for the event; the scheduler
+  // runs the callbacks on each VM's next turn
+  dialos::vm::InputRing *rings[] = {&input->hardware, &input->touch};
+  std::vector<dialos::vm::Value> args;
+  for (dialos::vm::InputRing *ring : rings) {
+    dialos::vm::InputEvent event;
+    while (ring->pop(event)) {
+      const char *name = dialos::vm::inputEventCallback(event, args);
+      for (VMAppletInstance *inst : applets) {
+        if (inst->platform->getCallback(name)) {
+          scheduler.postEvent(inst->schedulerId, name, args);
+        }
       }
-    } else if (result == dialos::vm::VMResult::ERROR) {
-      const char *errMsg = state->vmState->getError().c_str();
-      sys->logf(LogLevel::ERROR, "VM error in '%s' (task %d): %s", applet->name, taskId,
-                errMsg && *errMsg ? errMsg : "Unknown error");
-      // Sleep and retry
-      TaskScheduler::sleepMs(5000);
-    } else if (result == dialos::vm::VMResult::OUT_OF_MEMORY) {
-      sys->logf(LogLevel::ERROR, "Applet '%s' (task %d) out of memory", applet->name, taskId);
-      state->vmState->reset();
-      TaskScheduler::sleepMs(5000);
-    } else if (result == dialos::vm::VMResult::YIELD) {
-      // VM yielded, continue soon
-      TaskScheduler::sleepMs(10);
     }
-    // VMResult::OK - continue executing immediately next tick with small delay
-    else {
-      TaskScheduler::sleepMs(1);
+  }
+}
+
+void VMRuntime::run() {
+  // FreeRTOS tasks run in infinite loops
+  while (true) {
+    // Suspend first, so a switch frees the old applet before loading the new one
+    suspendApplets();
+    startApplets();
+    xSemaphoreTake(lock, portMAX_DELAY);
+    drainInput();
+    uint32_t waitMs = scheduler.tick();
+    reap();
+    // Async I/O in flight keeps the radio (and so the system) awake
+    bool holdAwake = false;
+    for (VMAppletInstance *inst : applets) {
+      holdAwake = holdAwake || inst->platform->hasPendingAsync();
+    }
+    xSemaphoreGive(lock);
+
+    // Frame end: flush before blocking, and at a capped rate while busy
+    if (waitMs != 0 || millis() - lastFrameMs >= FRAME_INTERVAL_MS) {
+      dialos::vm::ESP32Platform::presentFrame();
+      lastFrameMs = millis();
+    }
+    PowerManager::instance().getIdleManager().update(idleSource, millis(), waitMs, holdAwake);
+
+    if (waitMs == 0) {
+      // More work pending; let equal-priority tasks in before the next pass
+      taskYIELD();
+      continue;
     }
+
+    // Block until the earliest deadline or until launch(), postEvent() or
+    // new input wakes us; with nothing scheduled this waits indefinitely
+    TickType_t ticks = waitMs == dialos::vm::VMScheduler::NO_DEADLINE
+                           ? portMAX_DELAY
+                           : pdMS_TO_TICKS(waitMs);
+    ulTaskNotifyTake(pdTRUE, ticks > 0 ? ticks : 1);
   }
 }
 
-// Helper function to create a VM task for an applet by name
-Task *createVMTask(const char *appletName) {
-  TaskScheduler *scheduler = Kernel::instance().getScheduler();
+// Helper function to launch an applet by name on a VM runtime
+Task *createVMTask(const char *appletName, int coreHint) {
   SystemServices *sys = Kernel::instance().getSystemServices();
 
   // Find applet in registry
@@ -173,23 +446,28 @@ Task *createVMTask(const char *appletName) {
     return nullptr;
   }
 
-  // Create task with applet-specific name
-  char taskName[32];
-  snprintf(taskName, sizeof(taskName), "VM_%s", applet->name);
-
-  Task *task = scheduler->createTask(taskName, vmAppletTask, (void *)applet,
-                                     16384, TaskPriority::NORMAL);
-
-  if (task) {
-    sys->logf(LogLevel::INFO, "Created VM task for applet: %s", applet->name);
-  } else {
-    sys->logf(LogLevel::ERROR, "Failed to create task for applet: %s",
-              applet->name);
+  VMRuntime &runtime = VMRuntime::select(coreHint);
+  Task *task = runtime.start();
+  if (!task) {
+    sys->logf(LogLevel::ERROR, "Failed to create VM runtime task");
+    return nullptr;
   }
 
+  runtime.launch(applet);
+  sys->logf(LogLevel::INFO, "Launching applet '%s' on VM runtime %d (%d running)",
+            applet->name, runtime.getCore(), (int)runtime.getAppletCount());
   return task;
 }
 
+bool suspendVMApplet(const char *appletName) {
+  for (int core = 0; core < VMRuntime::CORE_COUNT; core++) {
+    if (VMRuntime::forCore(core).suspend(appletName)) {
+      return true;
+    }
+  }
+  return false;
+}
+
 void AppletManager::start() {
     if (instance) return;
     instance = new AppletManager();
@@ -306,9 +584,14 @@ void AppletManager::run(byte taskId) {
         if ((millis() - lastChangeMs) >= selectionConfirmMs) {
             AvailableApplet &app = applets[selectionIndex];
             if (app.installed) {
+                // Switching apps: park the current one in the warm pool
+                if (foreground && strcmp(foreground, app.name) != 0) {
+                    suspendVMApplet(foreground);
+                }
                 sys->logf(LogLevel::INFO, "AppletMgr: launching '%s'", app.name);
                 Task *t = createVMTask(app.name);
                 if (t) {
+                    foreground = app.name;
                     sys->logf(LogLevel::INFO, "AppletMgr: launched '%s'", app.name);
                 } else {
                     sys->logf(LogLevel::WARNING, "AppletMgr: failed to launch '%s' via registry", app.name);
@@ -0,0 +1,188 @@
+#include "display_canvas.h"
+#include "glyph_cache.h"
+#include "kernel/kernel.h"
+#include "kernel/system.h"
+#include <algorithm>
+#include <cstring>
+#include <esp_heap_caps.h>
+
+using dialos::vm::DisplayList;
+using dialos::vm::Rect;
+
+DisplayCanvas &DisplayCanvas::instance() {
+  static DisplayCanvas canvas;
+  return canvas;
+}
+
+DisplayCanvas::DisplayCanvas()
+    : canvas(&M5Dial.Display), buffer(nullptr), staging{nullptr, nullptr},
+      nextStaging(0), attempted(false), tiles(WIDTH, HEIGHT), pendingCommands(0),
+      pendingDirty(0), pendingRasterUs(0) {}
+
+bool DisplayCanvas::begin() {
+  if (attempted) {
+    return buffer != nullptr;
+  }
+  attempted = true;
+
+  canvas.setColorDepth(16);
+  canvas.setPsram(false);  // DMA can't read from PSRAM
+  buffer = static_cast<uint16_t *>(canvas.createSprite(WIDTH, HEIGHT));
+  for (int i = 0; i < 2; i++) {
+    staging[i] = static_cast<uint16_t *>(
+        heap_caps_malloc(WIDTH * BAND_ROWS * sizeof(uint16_t), MALLOC_CAP_DMA));
+  }
+  if (!buffer || !staging[0] || !staging[1]) {
+    canvas.deleteSprite();
+    buffer = nullptr;
+    for (int i = 0; i < 2; i++) {
+      heap_caps_free(staging[i]);
+      staging[i] = nullptr;
+    }
+    dialOS::Kernel::instance().getSystemServices()->log(
+        dialOS::LogLevel::WARNING, "Display canvas: out of DMA memory, drawing directly");
+    return false;
+  }
+  canvas.fillScreen(TFT_BLACK);
+  return true;
+}
+
+void DisplayCanvas::draw(const DisplayList &list) {
+  if (!buffer) {
+    return;
+  }
+  uint32_t start = micros();
+  Rect clip(0, 0, WIDTH, HEIGHT);
+  for (const DisplayList::Command &command : list.commands()) {
+    switch (command.op) {
+    case DisplayList::Op::CLEAR:
+      canvas.fillScreen(command.color);
+      break;
+    case DisplayList::Op::TEXT:
+      if (!GlyphCache::instance().drawText(canvas, command.x, command.y, list.text(command),
+                                           command.color, command.size)) {
+        canvas.setTextSize(command.size);
+        canvas.setTextColor(command.color);
+        canvas.setCursor(command.x, command.y);
+        canvas.print(list.text(command).c_str());
+      }
+      break;
+    case DisplayList::Op::RECT:
+      if (command.filled) {
+        canvas.fillRect(command.x, command.y, command.w, command.h, command.color);
+      } else {
+        canvas.drawRect(command.x, command.y, command.w, command.h, command.color);
+      }
+      break;
+    case DisplayList::Op::CIRCLE:
+      if (command.filled) {
+        canvas.fillCircle(command.x, command.y, command.w, command.color);
+      } else {
+        canvas.drawCircle(command.x, command.y, command.w, command.color);
+      }
+      break;
+    case DisplayList::Op::LINE:
+      canvas.drawLine(command.x, command.y, command.w, command.h, command.color);
+      break;
+    case DisplayList::Op::PIXEL:
+      canvas.drawPixel(command.x, command.y, command.color);
+      break;
+    case DisplayList::Op::IMAGE:
+      // Big-endian RGB565 is the sprite's own byte order: one block copy
+      canvas.pushImage(command.x, command.y, command.w, command.h,
+                       reinterpret_cast<const lgfx::swap565_t *>(list.imageData(command)));
+      break;
+    case DisplayList::Op::BITMAP: {
+      const DisplayList::Bitmap &bitmap = list.bitmap(command);
+      pushBitmap(canvas, command.x, command.y, *bitmap.image, bitmap.sx, bitmap.sy,
+                 command.w, command.h,
+                 command.color == DisplayList::NO_KEY ? -1 : static_cast<int32_t>(command.color));
+      break;
+    }
+    case DisplayList::Op::CLIP:
+      if (command.w > 0) {
+        clip = Rect(command.x, command.y, command.w, command.h);
+        canvas.setClipRect(clip.x, clip.y, clip.w, clip.h);
+      } else {
+        clip = Rect(0, 0, WIDTH, HEIGHT);
+        canvas.clearClipRect();
+      }
+      continue;
+    }
+    tiles.mark(list.bounds(command).intersected(clip));
+  }
+  canvas.clearClipRect();
+  pendingCommands += list.commands().size();
+  pendingDirty += list.dirty().area();
+  pendingRasterUs += micros() - start;
+}
+
+size_t DisplayCanvas::flush() {
+  if (!buffer || !tiles.any()) {
+    return 0;
+  }
+  uint32_t start = micros();
+  stats.rects = 0;
+
+  M5Dial.Display.startWrite();
+  size_t pixels = tiles.collect(buffer, WIDTH, [this](const Rect &area) { pushRect(area); });
+  M5Dial.Display.waitDMA();  // the canvas may change once the lock is released
+  M5Dial.Display.endWrite();
+
+  stats.commands = pendingCommands;
+  stats.dirtyPixels = pendingDirty;
+  stats.rasterUs = pendingRasterUs;
+  stats.spiBytes = pixels * sizeof(uint16_t);
+  stats.flushUs = micros() - start;
+  stats.totalSpiBytes += stats.spiBytes;
+  pendingCommands = 0;
+  pendingDirty = 0;
+  pendingRasterUs = 0;
+  if (pixels > 0) {
+    stats.frames++;
+  }
+  return stats.spiBytes;
+}
+
+void DisplayCanvas::pushBitmap(lgfx::LovyanGFX &target, int32_t x, int32_t y,
+                               const dialos::vm::Image &image, int32_t sx, int32_t sy,
+                               int32_t w, int32_t h, int32_t transparent) {
+  // Decoded images are native-endian RGB565
+  const lgfx::rgb565_t *pixels =
+      reinterpret_cast<const lgfx::rgb565_t *>(image.pixels.data()) + sy * image.width + sx;
+  bool wholeRows = sx == 0 && w == image.width;
+  int32_t rows = wholeRows ? 1 : h;
+  int32_t rowHeight = wholeRows ? h : 1;
+  for (int32_t row = 0; row < rows; row++) {
+    const lgfx::rgb565_t *src = pixels + row * image.width;
+    if (transparent < 0) {
+      target.pushImage(x, y + row, w, rowHeight, src);
+    } else {
+      target.pushImage(x, y + row, w, rowHeight, src, static_cast<uint32_t>(transparent));
+    }
+  }
+}
+
+void DisplayCanvas::pushRect(const Rect &area) {
+  if (area.x == 0 && area.w == WIDTH) {
+    // Full-width rows are contiguous in the canvas: send them in place
+    M5Dial.Display.pushImageDMA(area.x, area.y, area.w, area.h,
+                                reinterpret_cast<const lgfx::swap565_t *>(buffer + area.y * WIDTH));
+    stats.rects++;
+    return;
+  }
+  // Otherwise gather a band of rows into a bounce buffer. The bus finishes
+  // one transfer before it starts the next, so by the time a buffer comes
+  // round again its previous transfer is done.
+  for (int32_t y = area.y; y < area.y + area.h; y += BAND_ROWS) {
+    int32_t rows = std::min<int32_t>(BAND_ROWS, area.y + area.h - y);
+    uint16_t *band = staging[nextStaging];
+    nextStaging ^= 1;
+    for (int32_t row = 0; row < rows; row++) {
+      memcpy(band + row * area.w, buffer + (y + row) * WIDTH + area.x, area.w * sizeof(uint16_t));
+    }
+    M5Dial.Display.pushImageDMA(area.x, y, area.w, rows,
+                                reinterpret_cast<const lgfx::swap565_t *>(band));
+    stats.rects++;
+  }
+}
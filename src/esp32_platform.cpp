@@ -1,4 +1,8 @@
 #include "esp32_platform.h"
+#include "display_canvas.h"
+#include "glyph_cache.h"
+#include "vm/file_reader.h"
+#include "vm/vm_value.h"
 #include "Encoder.h"
 #include "kernel/kernel.h"
 #include "kernel/system.h"
@@ -7,10 +11,132 @@
 #include <Arduino.h>
 #include <M5Dial.h>
 #include <Wire.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
 #include <vector>
 
 using namespace dialos::vm;
 
+namespace {
+
+// Frames between display statistics log lines
+const uint32_t FRAME_STATS_INTERVAL = 300;
+
+// Locks for hardware shared by VM runtimes on different cores. Recursive,
+// so a call that already holds a lock can re-enter through another native.
+struct SharedResources {
+  SemaphoreHandle_t display = xSemaphoreCreateRecursiveMutex();
+  SemaphoreHandle_t i2c = xSemaphoreCreateRecursiveMutex();
+  SemaphoreHandle_t fs = xSemaphoreCreateRecursiveMutex();
+};
+
+SharedResources &shared() {
+  static SharedResources resources;
+  return resources;
+}
+
+// Read the RAM file behind `handle` in place, from the handle's position.
+// Nothing is copied into a read-ahead buffer: the file already is one.
+bool viewFile(dialOS::RamFS &ramfs, int handle, FileReader &reader) {
+  const uint8_t *data = nullptr;
+  size_t size = 0;
+  if (!ramfs.view(handle, &data, &size)) {
+    return false;
+  }
+  reader.view(reinterpret_cast<const char *>(data), static_cast<uint32_t>(size));
+  size_t position = ramfs.tell(handle);
+  return reader.seek(static_cast<uint32_t>(position < size ? position : size));
+}
+
+// Holds a shared resource for the rest of the scope
+class ResourceGuard {
+public:
+  explicit ResourceGuard(SemaphoreHandle_t lock) : lock(lock) {
+    xSemaphoreTakeRecursive(lock, portMAX_DELAY);
+  }
+  ~ResourceGuard() { xSemaphoreGiveRecursive(lock); }
+
+private:
+  SemaphoreHandle_t lock;
+};
+
+} // namespace
+
+// ===== Slice Hooks =====
+ESP32Platform::DisplayLock::DisplayLock(ESP32Platform &platform)
+    : platform(platform), batched(platform.inSlice) {
+  if (!platform.displayHeld) {
+    xSemaphoreTakeRecursive(shared().display, portMAX_DELAY);
+    M5Dial.Display.startWrite();
+    platform.displayHeld = batched;
+  }
+}
+
+ESP32Platform::DisplayLock::~DisplayLock() {
+  if (!batched) {
+    // Called outside a scheduler slice (e.g. app.onLoad): don't batch
+    M5Dial.Display.endWrite();
+    xSemaphoreGiveRecursive(shared().display);
+  }
+}
+
+void ESP32Platform::beginSlice() {
+  inSlice = true;
+}
+
+void ESP32Platform::endSlice() {
+  inSlice = false;
+  if (displayHeld) {
+    displayHeld = false;
+    M5Dial.Display.endWrite();
+    xSemaphoreGiveRecursive(shared().display);
+  }
+  if (!displayList.empty()) {
+    ResourceGuard display(shared().display);
+    DisplayCanvas::instance().draw(displayList);
+    displayList.reset();
+  }
+}
+
+bool ESP32Platform::useCanvas() {
+  if (!canvasChecked) {
+    ResourceGuard display(shared().display);
+    canvasActive = DisplayCanvas::instance().begin();
+    canvasChecked = true;
+  }
+  return canvasActive;
+}
+
+void ESP32Platform::presentFrame() {
+  DisplayCanvas &canvas = DisplayCanvas::instance();
+  if (!canvas.isActive()) {
+    return;
+  }
+  ResourceGuard display(shared().display);
+  if (canvas.flush() == 0) {
+    return;
+  }
+  const DisplayCanvas::Stats &stats = canvas.getStats();
+  if (stats.frames % FRAME_STATS_INTERVAL == 1) {
+    dialOS::Kernel::instance().getSystemServices()->logf(
+        dialOS::LogLevel::DEBUG,
+        "Display frame %u: %u commands, %u px dirty, %u SPI bytes in %u DMA transfers, "
+        "raster %u us, flush %u us",
+        (unsigned)stats.frames, (unsigned)stats.commands, (unsigned)stats.dirtyPixels,
+        (unsigned)stats.spiBytes, (unsigned)stats.rects, (unsigned)stats.rasterUs,
+        (unsigned)stats.flushUs);
+  }
+}
+
+// ===== Event Sources =====
+bool ESP32Platform::hasInputListeners() const {
+  return getCallback("encoder.onTurn") != nullptr ||
+         getCallback("encoder.onButton") != nullptr ||
+         getCallback("touch.onPress") != nullptr ||
+         getCallback("touch.onRelease") != nullptr ||
+         getCallback("touch.onDrag") != nullptr;
+}
+
 // ===== Console Operations =====
 void ESP32Platform::console_print(const std::string &message) {
   Serial.print(message.c_str());
@@ -39,12 +165,25 @@ void ESP32Platform::console_error(const std::string &message) {
 
 // ===== Display Operations =====
 void ESP32Platform::display_clear(uint32_t color) {
-  M5Dial.Display.fillScreen(color);
+  if (useCanvas()) {
+    displayList.clear(color);
+  } else {
+    DisplayLock display(*this);
+    M5Dial.Display.fillScreen(color);
+  }
   console_log("Display cleared: " + std::to_string(color));
 }
 
 void ESP32Platform::display_drawText(int x, int y, const std::string &text, uint32_t color,
                       int size) {
+  if (useCanvas()) {
+    displayList.drawText(x, y, text, color, size);
+    return;
+  }
+  DisplayLock display(*this);
+  if (GlyphCache::instance().drawText(M5Dial.Display, x, y, text, color, size)) {
+    return;
+  }
   M5Dial.Display.setTextSize(size);
   M5Dial.Display.setTextColor(color);
   M5Dial.Display.setCursor(x, y);
@@ -52,6 +191,11 @@ void ESP32Platform::display_drawText(int x, int y, const std::string &text, uint
 }
 
 void ESP32Platform::display_drawRect(int x, int y, int w, int h, uint32_t color, bool filled) {
+  if (useCanvas()) {
+    displayList.drawRect(x, y, w, h, color, filled);
+    return;
+  }
+  DisplayLock display(*this);
   if (filled) {
     M5Dial.Display.fillRect(x, y, w, h, color);
   } else {
@@ -60,6 +204,11 @@ void ESP32Platform::display_drawRect(int x, int y, int w, int h, uint32_t color,
 }
 
 void ESP32Platform::display_drawCircle(int x, int y, int r, uint32_t color, bool filled) {
+  if (useCanvas()) {
+    displayList.drawCircle(x, y, r, color, filled);
+    return;
+  }
+  DisplayLock display(*this);
   if (filled) {
     M5Dial.Display.fillCircle(x, y, r, color);
   } else {
@@ -68,14 +217,25 @@ void ESP32Platform::display_drawCircle(int x, int y, int r, uint32_t color, bool
 }
 
 void ESP32Platform::display_drawLine(int x1, int y1, int x2, int y2, uint32_t color) {
+  if (useCanvas()) {
+    displayList.drawLine(x1, y1, x2, y2, color);
+    return;
+  }
+  DisplayLock display(*this);
   M5Dial.Display.drawLine(x1, y1, x2, y2, color);
 }
 
 void ESP32Platform::display_drawPixel(int x, int y, uint32_t color) {
+  if (useCanvas()) {
+    displayList.drawPixel(x, y, color);
+    return;
+  }
+  DisplayLock display(*this);
   M5Dial.Display.drawPixel(x, y, color);
 }
 
 void ESP32Platform::display_setBrightness(int level) {
+  DisplayLock display(*this);
   M5Dial.Display.setBrightness(level);
 }
 
@@ -88,8 +248,17 @@ int ESP32Platform::display_getHeight() {
 }
 
 void ESP32Platform::display_setTitle(const std::string& title) {
+  if (useCanvas()) {
+    displayList.drawRect(0, 0, DisplayCanvas::WIDTH, 20, 0x0000, true);
+    displayList.drawText(5, 5, title, 0xFFFF, 1);
+    return;
+  }
+  DisplayLock display(*this);
   // Draw title at top of screen with background
   M5Dial.Display.fillRect(0, 0, M5Dial.Display.width(), 20, 0x0000); // Black background
+  if (GlyphCache::instance().drawText(M5Dial.Display, 5, 5, title, 0xFFFF, 1)) {
+    return;
+  }
   M5Dial.Display.setTextSize(1);
   M5Dial.Display.setTextColor(0xFFFF); // White text
   M5Dial.Display.setCursor(5, 5);
@@ -97,8 +266,13 @@ void ESP32Platform::display_setTitle(const std::string& title) {
 }
 
 void ESP32Platform::display_drawImage(int x, int y, const std::vector<uint8_t>& imageData) {
-  // For now, implement as a simple bitmap drawing
-  // Assumes imageData is in a simple format: width(2), height(2), RGB565 pixel data
+  if (useCanvas()) {
+    // Rasterised with one block copy instead of a drawPixel per pixel
+    displayList.drawImage(x, y, imageData);
+    return;
+  }
+  DisplayLock display(*this);
+  // Format: width(2), height(2), big-endian RGB565 pixel data
   if (imageData.size() < 4) return;
   
   uint16_t width = (imageData[0] << 8) | imageData[1];
@@ -106,14 +280,39 @@ void ESP32Platform::display_drawImage(int x, int y, const std::vector<uint8_t>&
   
   if (imageData.size() < 4 + (width * height * 2)) return; // RGB565 = 2 bytes per pixel
   
-  // Draw the image pixel by pixel
-  for (int row = 0; row < height; row++) {
-    for (int col = 0; col < width; col++) {
-      int index = 4 + ((row * width + col) * 2);
-      uint16_t color = (imageData[index] << 8) | imageData[index + 1];
-      M5Dial.Display.drawPixel(x + col, y + row, color);
-    }
+  // Big-endian is the panel's byte order: one clipped block write
+  M5Dial.Display.pushImage(x, y, width, height,
+                           reinterpret_cast<const lgfx::swap565_t *>(imageData.data() + 4));
+}
+
+void ESP32Platform::display_drawBitmap(int x, int y, const std::shared_ptr<const Image> &image,
+                                       int sx, int sy, int w, int h, int32_t transparent) {
+  if (useCanvas()) {
+    // Recorded by reference; the canvas takes it in one pushImage
+    displayList.drawBitmap(x, y, image, sx, sy, w, h, transparent);
+    return;
   }
+  DisplayLock display(*this);
+  DisplayCanvas::pushBitmap(M5Dial.Display, x, y, *image, sx, sy, w, h, transparent);
+}
+
+bool ESP32Platform::display_setClip(int x, int y, int w, int h) {
+  if (useCanvas()) {
+    displayList.setClip(Rect(x, y, w, h));
+    return true;
+  }
+  DisplayLock display(*this);
+  M5Dial.Display.setClipRect(x, y, w, h);
+  return true;
+}
+
+void ESP32Platform::display_clearClip() {
+  if (useCanvas()) {
+    displayList.clearClip();
+    return;
+  }
+  DisplayLock display(*this);
+  M5Dial.Display.clearClipRect();
 }
 
 // ===== Encoder Operations =====
@@ -211,6 +410,7 @@ int ESP32Platform::gpio_analogRead(int pin) {
 
 // ===== I2C Operations =====
 std::vector<int> ESP32Platform::i2c_scan() {
+  ResourceGuard bus(shared().i2c);
   std::vector<int> devices;
   for (int address = 1; address < 127; address++) {
     Wire.beginTransmission(address);
@@ -222,6 +422,7 @@ std::vector<int> ESP32Platform::i2c_scan() {
 }
 
 bool ESP32Platform::i2c_write(int address, const std::vector<uint8_t>& data) {
+  ResourceGuard bus(shared().i2c);
   Wire.beginTransmission(address);
   for (uint8_t byte : data) {
     Wire.write(byte);
@@ -230,6 +431,7 @@ bool ESP32Platform::i2c_write(int address, const std::vector<uint8_t>& data) {
 }
 
 std::vector<uint8_t> ESP32Platform::i2c_read(int address, int length) {
+  ResourceGuard bus(shared().i2c);
   std::vector<uint8_t> data;
   Wire.requestFrom(address, length);
   while (Wire.available()) {
@@ -272,6 +474,7 @@ void ESP32Platform::buzzer_stop() {
 
 // ===== RFID Operations =====
 std::string ESP32Platform::rfid_read() {
+  ResourceGuard bus(shared().i2c);
   // M5Dial has WS1850S RFID reader on I2C
   // WS1850S I2C address is typically 0x24
   const int RFID_ADDRESS = 0x24;
@@ -302,6 +505,7 @@ std::string ESP32Platform::rfid_read() {
 }
 
 bool ESP32Platform::rfid_isPresent() {
+  ResourceGuard bus(shared().i2c);
   // Try to communicate with WS1850S to check if card is present
   const int RFID_ADDRESS = 0x24;
   
@@ -355,6 +559,7 @@ bool ESP32Platform::power_isCharging() {
 
 // ===== File Operations using RAMFS =====
 int ESP32Platform::file_open(const std::string& path, const std::string& mode) {
+  ResourceGuard fs(shared().fs);
   // Convert string mode to RAMFS FileMode
   dialOS::FileMode fileMode;
   if (mode == "r" || mode == "read") {
@@ -385,6 +590,7 @@ int ESP32Platform::file_open(const std::string& path, const std::string& mode) {
 }
 
 std::string ESP32Platform::file_read(int handle, int size) {
+  ResourceGuard fs(shared().fs);
   auto* ramfs = dialOS::Kernel::instance().getRamFS();
   if (!ramfs) {
     return "";
@@ -399,6 +605,7 @@ std::string ESP32Platform::file_read(int handle, int size) {
 }
 
 int ESP32Platform::file_write(int handle, const std::string& data) {
+  ResourceGuard fs(shared().fs);
   auto* ramfs = dialOS::Kernel::instance().getRamFS();
   if (!ramfs) {
     return -1;
@@ -409,6 +616,7 @@ int ESP32Platform::file_write(int handle, const std::string& data) {
 }
 
 void ESP32Platform::file_close(int handle) {
+  ResourceGuard fs(shared().fs);
   auto* ramfs = dialOS::Kernel::instance().getRamFS();
   if (ramfs) {
     ramfs->close(handle);
@@ -416,6 +624,7 @@ void ESP32Platform::file_close(int handle) {
 }
 
 bool ESP32Platform::file_exists(const std::string& path) {
+  ResourceGuard fs(shared().fs);
   auto* ramfs = dialOS::Kernel::instance().getRamFS();
   if (!ramfs) {
     return false;
@@ -425,6 +634,7 @@ bool ESP32Platform::file_exists(const std::string& path) {
 }
 
 bool ESP32Platform::file_delete(const std::string& path) {
+  ResourceGuard fs(shared().fs);
   // Get current task ID
   uint32_t taskId = 0;
   auto* kernel = &dialOS::Kernel::instance();
@@ -441,6 +651,7 @@ bool ESP32Platform::file_delete(const std::string& path) {
 }
 
 int ESP32Platform::file_size(const std::string& path) {
+  ResourceGuard fs(shared().fs);
   auto* ramfs = dialOS::Kernel::instance().getRamFS();
   if (!ramfs) {
     return -1;
@@ -449,8 +660,54 @@ int ESP32Platform::file_size(const std::string& path) {
   return static_cast<int>(ramfs->getSize(path.c_str()));
 }
 
+bool ESP32Platform::file_readLine(int handle, std::string& line) {
+  ResourceGuard fs(shared().fs);
+  auto* ramfs = dialOS::Kernel::instance().getRamFS();
+  FileReader reader;
+  if (!ramfs || !viewFile(*ramfs, handle, reader)) {
+    return false;
+  }
+  bool got = reader.readLine(line);
+  ramfs->seek(handle, reader.tell());
+  return got;
+}
+
+int ESP32Platform::file_readBytes(int handle, char* dest, int size) {
+  ResourceGuard fs(shared().fs);
+  auto* ramfs = dialOS::Kernel::instance().getRamFS();
+  FileReader reader;
+  if (!ramfs || !viewFile(*ramfs, handle, reader)) {
+    return -1;
+  }
+  size_t got = reader.read(dest, size > 0 ? size : 0);
+  ramfs->seek(handle, reader.tell());
+  return static_cast<int>(got);
+}
+
+bool ESP32Platform::file_seek(int handle, int position) {
+  ResourceGuard fs(shared().fs);
+  auto* ramfs = dialOS::Kernel::instance().getRamFS();
+  FileReader reader;
+  if (!ramfs || position < 0 || !viewFile(*ramfs, handle, reader) ||
+      !reader.seek(static_cast<uint32_t>(position))) {
+    return false;
+  }
+  return ramfs->seek(handle, reader.tell());
+}
+
+int ESP32Platform::file_tell(int handle) {
+  ResourceGuard fs(shared().fs);
+  auto* ramfs = dialOS::Kernel::instance().getRamFS();
+  FileReader reader;
+  if (!ramfs || !viewFile(*ramfs, handle, reader)) {
+    return -1;
+  }
+  return static_cast<int>(reader.tell());
+}
+
 // ===== Directory Operations =====
 std::vector<std::string> ESP32Platform::dir_list(const std::string& path) {
+  ResourceGuard fs(shared().fs);
   auto* ramfs = dialOS::Kernel::instance().getRamFS();
   if (!ramfs) {
     return {};
@@ -499,6 +756,7 @@ bool ESP32Platform::dir_create(const std::string& path) {
 }
 
 bool ESP32Platform::dir_delete(const std::string& path) {
+  ResourceGuard fs(shared().fs);
   // For RAMFS, we could delete all files that start with the path prefix
   auto* ramfs = dialOS::Kernel::instance().getRamFS();
   if (!ramfs) {
@@ -531,6 +789,7 @@ bool ESP32Platform::dir_delete(const std::string& path) {
 }
 
 bool ESP32Platform::dir_exists(const std::string& path) {
+  ResourceGuard fs(shared().fs);
   // For RAMFS, we'll check if any files start with the path prefix
   auto* ramfs = dialOS::Kernel::instance().getRamFS();
   if (!ramfs) {
@@ -0,0 +1,122 @@
+#include "glyph_cache.h"
+#include "kernel/kernel.h"
+#include "kernel/system.h"
+
+GlyphCache &GlyphCache::instance() {
+  static GlyphCache cache;
+  return cache;
+}
+
+GlyphCache::GlyphCache()
+    : scratch(&M5Dial.Display), attempted(false), ready(false) {}
+
+bool GlyphCache::prepare() {
+  if (attempted) {
+    return ready;
+  }
+  attempted = true;
+  scratch.setColorDepth(8);
+  scratch.setPsram(false);
+  ready = scratch.createSprite(CELL_WIDTH, CELL_HEIGHT) != nullptr;
+  if (!ready) {
+    dialOS::Kernel::instance().getSystemServices()->log(
+        dialOS::LogLevel::WARNING, "Glyph cache: no memory for the scratch sprite, printing text");
+    return false;
+  }
+  scratch.setTextSize(1);
+  scratch.setTextWrap(false);
+  scratch.setTextColor(TFT_WHITE);
+  return true;
+}
+
+bool GlyphCache::cacheable(const std::string &text) {
+  for (char c : text) {
+    if ((c < FIRST || c > LAST) && c != '\n' && c != '\r') {
+      return false;
+    }
+  }
+  return true;
+}
+
+const GlyphCache::Glyph &GlyphCache::glyph(char c) {
+  Glyph &entry = glyphs[c - FIRST];
+  if (!entry.cached) {
+    rasterise(entry, c);
+  }
+  return entry;
+}
+
+void GlyphCache::rasterise(Glyph &entry, char c) {
+  const char text[2] = {c, '\0'};
+  scratch.fillScreen(TFT_BLACK);
+  scratch.setCursor(0, 0);
+  scratch.print(text);
+
+  // Horizontal runs of each row; a run directly under one of the same
+  // span extends it downwards instead
+  entry.first = static_cast<uint16_t>(blocks.size());
+  for (int y = 0; y < CELL_HEIGHT; y++) {
+    int x = 0;
+    while (x < CELL_WIDTH) {
+      if (scratch.readPixel(x, y) == 0) {
+        x++;
+        continue;
+      }
+      int start = x;
+      while (x < CELL_WIDTH && scratch.readPixel(x, y) != 0) {
+        x++;
+      }
+      bool extended = false;
+      for (size_t i = entry.first; i < blocks.size() && !extended; i++) {
+        Block &block = blocks[i];
+        if (block.x == start && block.w == x - start && block.y + block.h == y) {
+          block.h++;
+          extended = true;
+        }
+      }
+      if (!extended) {
+        Block block = {static_cast<uint8_t>(start), static_cast<uint8_t>(y),
+                       static_cast<uint8_t>(x - start), 1};
+        blocks.push_back(block);
+      }
+    }
+  }
+  entry.count = static_cast<uint8_t>(blocks.size() - entry.first);
+  entry.cached = true;
+  stats.glyphs++;
+  stats.rects += entry.count;
+}
+
+bool GlyphCache::drawText(lgfx::LovyanGFX &target, int32_t x, int32_t y,
+                          const std::string &text, uint32_t color, int size) {
+  if (!cacheable(text) || !prepare()) {
+    return false;
+  }
+  size = size < 1 ? 1 : size;
+  int32_t cellW = CELL_WIDTH * size;
+  int32_t cellH = CELL_HEIGHT * size;
+  int32_t right = target.width();
+  for (char c : text) {
+    if (c == '\n') {
+      x = 0;
+      y += cellH;
+      continue;
+    }
+    if (c == '\r') {
+      continue;
+    }
+    if (x + cellW > right) {
+      x = 0;
+      y += cellH;
+    }
+    const Glyph &entry = glyph(c);
+    for (uint16_t i = entry.first; i < entry.first + entry.count; i++) {
+      const Block &block = blocks[i];
+      target.fillRect(x + block.x * size, y + block.y * size, block.w * size,
+                      block.h * size, color);
+    }
+    x += cellW;
+  }
+  stats.drawn++;
+  return true;
+}
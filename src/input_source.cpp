@@ -0,0 +1,144 @@
+#include "input_source.h"
+#include "Encoder.h"
+#include <M5Dial.h>
+
+using dialos::vm::InputEvent;
+using dialos::vm::InputEventType;
+
+// M5Dial's encoder push button (active low)
+static const int BUTTON_PIN = 42;
+
+InputSource &InputSource::instance() {
+  static InputSource source;
+  return source;
+}
+
+InputSource::InputSource()
+    : consumerCount(0), timer(nullptr), lastCount(0), touchDown(false),
+      touchX(0), touchY(0) {}
+
+bool InputSource::start() {
+  if (timer) {
+    return true;
+  }
+  lastCount = get_encoder();
+
+  esp_timer_create_args_t args = {};
+  args.callback = &InputSource::onSample;
+  args.arg = this;
+  args.dispatch_method = ESP_TIMER_TASK;
+  args.name = "input";
+  args.skip_unhandled_events = true;
+  if (esp_timer_create(&args, &timer) != ESP_OK) {
+    timer = nullptr;
+    return false;
+  }
+  return esp_timer_start_periodic(timer, SAMPLE_PERIOD_US) == ESP_OK;
+}
+
+void InputSource::pause() {
+  if (timer) {
+    esp_timer_stop(timer);
+  }
+}
+
+void InputSource::resume() {
+  // The first sample picks up whatever happened while paused
+  if (timer && !esp_timer_is_active(timer)) {
+    esp_timer_start_periodic(timer, SAMPLE_PERIOD_US);
+  }
+}
+
+InputSource::Consumer *InputSource::attach(WakeFn wake, void *context) {
+  int index = consumerCount.load();
+  if (index >= MAX_CONSUMERS) {
+    return nullptr;
+  }
+  Consumer &consumer = consumers[index];
+  consumer.wake = wake;
+  consumer.context = context;
+  consumer.reportedButton = digitalRead(BUTTON_PIN) == LOW;
+  // Producers only see the slot once it is fully set up
+  consumerCount.store(index + 1, std::memory_order_release);
+  return &consumer;
+}
+
+void InputSource::onSample(void *arg) {
+  static_cast<InputSource *>(arg)->sampleHardware();
+}
+
+void InputSource::notify(Consumer &consumer) {
+  if (consumer.wake) {
+    consumer.wake(consumer.context);
+  }
+}
+
+void InputSource::sampleHardware() {
+  int16_t count = get_encoder();
+  int16_t steps = static_cast<int16_t>(count - lastCount);
+  lastCount = count;
+  bool button = digitalRead(BUTTON_PIN) == LOW;
+  uint32_t now = millis();
+
+  int consumerTotal = consumerCount.load(std::memory_order_acquire);
+  for (int i = 0; i < consumerTotal; i++) {
+    Consumer &consumer = consumers[i];
+    bool queued = false;
+
+    consumer.pendingSteps += steps;
+    if (consumer.pendingSteps != 0) {
+      int32_t clamped = consumer.pendingSteps;
+      if (clamped > INT16_MAX) clamped = INT16_MAX;
+      if (clamped < INT16_MIN) clamped = INT16_MIN;
+      InputEvent event = {InputEventType::ENCODER_TURN, static_cast<int16_t>(clamped), 0, now};
+      if (consumer.hardware.push(event)) {
+        consumer.pendingSteps -= clamped;
+        queued = true;
+      }
+    }
+
+    if (button != consumer.reportedButton) {
+      InputEvent event = {InputEventType::BUTTON, static_cast<int16_t>(button ? 1 : 0), 0, now};
+      if (consumer.hardware.push(event)) {
+        consumer.reportedButton = button;
+        queued = true;
+      }
+    }
+
+    if (queued) {
+      notify(consumer);
+    }
+  }
+}
+
+void InputSource::sampleTouch() {
+  auto detail = M5Dial.Touch.getDetail();
+  bool down = detail.isPressed();
+  int16_t x = static_cast<int16_t>(detail.x);
+  int16_t y = static_cast<int16_t>(detail.y);
+
+  InputEvent event = {InputEventType::TOUCH_DRAG, x, y, static_cast<uint32_t>(millis())};
+  if (down && !touchDown) {
+    event.type = InputEventType::TOUCH_PRESS;
+  } else if (!down && touchDown) {
+    // Report the release where the finger was last seen
+    event.type = InputEventType::TOUCH_RELEASE;
+    event.a = touchX;
+    event.b = touchY;
+  } else if (!down || (x == touchX && y == touchY)) {
+    return;
+  }
+  touchDown = down;
+  if (down) {
+    touchX = x;
+    touchY = y;
+  }
+
+  // Touch is sampled at loop() rate; a full ring drops the sample
+  int consumerTotal = consumerCount.load(std::memory_order_acquire);
+  for (int i = 0; i < consumerTotal; i++) {
+    if (consumers[i].touch.push(event)) {
+      notify(consumers[i]);
+    }
+  }
+}
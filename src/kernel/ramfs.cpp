@@ -252,6 +252,17 @@ size_t RamFS::tell(int handle) {
     return handles[handle].position;
 }
 
+bool RamFS::view(int handle, const uint8_t** data, size_t* size) {
+    if (!isValidHandle(handle) || !data || !size) {
+        return false;
+    }
+    
+    FileEntry* entry = handles[handle].entry;
+    *data = entry->data;
+    *size = entry->data ? entry->size : 0;
+    return true;
+}
+
 bool RamFS::exists(const char* path) {
     return findFile(path) != nullptr;
 }
@@ -7,9 +7,10 @@ namespace dialOS {
 uint32_t Task::nextId = 1;
 
 Task::Task(const char* taskName, void (*function)(byte, void*), void* param, 
-           size_t stack, TaskPriority prio)
+           size_t stack, TaskPriority prio, int coreId)
     : id(nextId++)
     , priority(prio)
+    , core(coreId)
     , taskHandle(nullptr)
     , taskFunction(function)
     , parameter(param)
@@ -18,14 +19,15 @@ Task::Task(const char* taskName, void (*function)(byte, void*), void* param,
     strncpy(name, taskName, sizeof(name) - 1);
     name[sizeof(name) - 1] = '\0';
     
-    // Create FreeRTOS task
-    BaseType_t result = xTaskCreate(
+    // Create FreeRTOS task, pinned when a core was requested
+    BaseType_t result = xTaskCreatePinnedToCore(
         taskWrapper,                    // Task function
         taskName,                       // Task name
         stackSize / sizeof(StackType_t), // Stack size in words
         this,                           // Task parameters (this Task object)
         static_cast<UBaseType_t>(priority), // Priority
-        &taskHandle                     // Task handle
+        &taskHandle,                    // Task handle
+        core == ANY_CORE ? tskNO_AFFINITY : static_cast<BaseType_t>(core)
     );
     
     if (result != pdPASS) {
@@ -107,7 +109,8 @@ bool TaskScheduler::init() {
 }
 
 Task* TaskScheduler::createTask(const char* name, void (*function)(byte, void*), 
-                                void* param, size_t stackSize, TaskPriority priority) {
+                                void* param, size_t stackSize, TaskPriority priority,
+                                int core) {
     if (taskCount >= MAX_TASKS) {
         Kernel::instance().getSystemServices()->log(LogLevel::ERROR, "Maximum tasks reached");
         return nullptr;
@@ -118,7 +121,7 @@ Task* TaskScheduler::createTask(const char* name, void (*function)(byte, void*),
         return nullptr;
     }
     
-    Task* task = new Task(name, function, param, stackSize, priority);
+    Task* task = new Task(name, function, param, stackSize, priority, core);
     if (!task || !task->getHandle()) {
         Kernel::instance().getSystemServices()->log(LogLevel::ERROR, "Failed to create task");
         if (task) delete task;
@@ -1,4 +1,6 @@
 #include "Encoder.h"
+#include "input_source.h"
+#include "power_manager.h"
 #include "kernel/kernel.h"
 #include "kernel/memory.h"
 #include "kernel/ramfs.h"
@@ -304,8 +306,10 @@ void setup() {
   M5Dial.Display.setCursor(20, 100);
   M5Dial.Display.println("Booting...");
 
-  // Initialize custom encoder driver
+  // Initialize custom encoder driver and start sampling input for the VMs
   init_encoder();
+  InputSource::instance().start();
+  PowerManager::instance().start();
 
   Serial.println("M5Dial hardware initialized");
 
@@ -375,8 +379,9 @@ void setup() {
 }
 
 void loop() {
-  // Update M5Dial state
+  // Update M5Dial state and queue touch changes for the VM runtimes
   M5Dial.update();
+  InputSource::instance().sampleTouch();
 
   if (!kernelEnabled) {
     // Fallback: simple display update
@@ -389,7 +394,7 @@ void loop() {
     }
   }
 
-  // FreeRTOS handles task scheduling automatically
-  // Just a small delay to prevent busy waiting
-  delay(1);
+  // Sleep until the earliest VM deadline or an input wakes us (tickless
+  // idle); with a finger on the screen this keeps polling touch every 1 ms
+  PowerManager::instance().idle();
 }
\ No newline at end of file
@@ -0,0 +1,150 @@
+#include "power_manager.h"
+#include "input_source.h"
+#include "kernel/kernel.h"
+#include "kernel/system.h"
+#include <M5Dial.h>
+#include <driver/gpio.h>
+#include <esp_sleep.h>
+
+using dialos::vm::IdleManager;
+using dialos::vm::PowerState;
+using namespace dialOS;
+
+// Pins that end an idle wait: encoder A/B, encoder push button (active
+// low) and the touch controller's interrupt line (active low)
+static const gpio_num_t WAKE_PINS[] = {GPIO_NUM_40, GPIO_NUM_41, GPIO_NUM_42, GPIO_NUM_14};
+static const size_t WAKE_PIN_COUNT = sizeof(WAKE_PINS) / sizeof(WAKE_PINS[0]);
+
+PowerManager &PowerManager::instance() {
+  static PowerManager manager;
+  return manager;
+}
+
+PowerManager::PowerManager()
+    : touchSource(IdleManager::INVALID_SOURCE), loopTask(nullptr), lastStatsMs(0) {}
+
+void PowerManager::start() {
+  if (loopTask) {
+    return;
+  }
+  loopTask = xTaskGetCurrentTaskHandle();
+  touchSource = manager.addSource("touch");
+  // A released hold (e.g. an HTTP request completing) can make a running
+  // IDLE wait too shallow: re-plan so light sleep can start
+  manager.setWakeHandler([this]() { wake(); });
+  lastStatsMs = millis();
+  manager.resetStats(lastStatsMs);
+}
+
+void PowerManager::wake() {
+  if (loopTask) {
+    xTaskNotifyGive(loopTask);
+  }
+}
+
+void IRAM_ATTR PowerManager::onWakePin(void *arg) {
+  PowerManager *self = static_cast<PowerManager *>(arg);
+  BaseType_t woken = pdFALSE;
+  vTaskNotifyGiveFromISR(self->loopTask, &woken);
+  if (woken) {
+    portYIELD_FROM_ISR();
+  }
+}
+
+void PowerManager::idle() {
+  uint32_t now = millis();
+  // Touch is polled by loop(): keep the 1 ms cadence while a finger is down
+  manager.update(touchSource, now,
+                 InputSource::instance().isTouchDown() ? 1 : IdleManager::NO_DEADLINE);
+  manager.setLightSleepEnabled(M5Dial.Display.getBrightness() == 0);
+
+  IdleManager::Plan plan = manager.idle(now, [this](PowerState state, uint32_t ms) {
+    return sleep(state, ms);
+  });
+  if (plan.state == PowerState::ACTIVE) {
+    // A runtime has work; give it the CPU before sampling touch again
+    vTaskDelay(1);
+  }
+
+  now = millis();
+  if (now - lastStatsMs >= STATS_PERIOD_MS) {
+    logStats(now);
+  }
+}
+
+uint32_t PowerManager::sleep(PowerState state, uint32_t ms) {
+  uint32_t start = millis();
+  bool pauseInput = ms >= INPUT_PAUSE_MIN_MS;
+  if (pauseInput) {
+    InputSource::instance().pause();
+  }
+
+  if (state == PowerState::LIGHT_SLEEP) {
+    lightSleep(ms);
+  } else {
+    // Blocks in the FreeRTOS idle task (WFI) until the deadline, a wake
+    // pin, or a runtime asking for a re-plan
+    if (pauseInput) {
+      armWakeInterrupts();
+    }
+    TickType_t ticks = ms == IdleManager::NO_DEADLINE ? portMAX_DELAY : pdMS_TO_TICKS(ms);
+    ulTaskNotifyTake(pdTRUE, ticks > 0 ? ticks : 1);
+    if (pauseInput) {
+      disarmWakeInterrupts();
+    }
+  }
+
+  if (pauseInput) {
+    InputSource::instance().resume();
+  }
+  return millis() - start;
+}
+
+void PowerManager::lightSleep(uint32_t ms) {
+  // Arduino's prebuilt sdkconfig has no FreeRTOS tickless idle, so light
+  // sleep is entered here explicitly. GPIO wakeup is level triggered: arm
+  // each pin for the level it is not at now, so any edge wakes us.
+  for (size_t i = 0; i < WAKE_PIN_COUNT; i++) {
+    gpio_int_type_t level = gpio_get_level(WAKE_PINS[i]) ? GPIO_INTR_LOW_LEVEL : GPIO_INTR_HIGH_LEVEL;
+    gpio_wakeup_enable(WAKE_PINS[i], level);
+  }
+  esp_sleep_enable_gpio_wakeup();
+  if (ms != IdleManager::NO_DEADLINE) {
+    esp_sleep_enable_timer_wakeup(static_cast<uint64_t>(ms) * 1000);
+  }
+
+  esp_light_sleep_start();
+
+  esp_sleep_disable_wakeup_source(ESP_SLEEP_WAKEUP_ALL);
+  for (size_t i = 0; i < WAKE_PIN_COUNT; i++) {
+    gpio_wakeup_disable(WAKE_PINS[i]);
+  }
+}
+
+void PowerManager::armWakeInterrupts() {
+  for (size_t i = 0; i < WAKE_PIN_COUNT; i++) {
+    attachInterruptArg(WAKE_PINS[i], &PowerManager::onWakePin, this, CHANGE);
+  }
+}
+
+void PowerManager::disarmWakeInterrupts() {
+  for (size_t i = 0; i < WAKE_PIN_COUNT; i++) {
+    detachInterrupt(WAKE_PINS[i]);
+  }
+}
+
+void PowerManager::logStats(uint32_t now) {
+  IdleManager::Stats stats = manager.getStats();
+  SystemServices *sys = Kernel::instance().getSystemServices();
+  if (sys) {
+    sys->logf(LogLevel::INFO,
+              "Power: active %u%%, idle %u%% (%u waits), light sleep %u%% (%u entries)",
+              (unsigned)stats.percent(PowerState::ACTIVE),
+              (unsigned)stats.percent(PowerState::IDLE),
+              (unsigned)stats.entries[static_cast<int>(PowerState::IDLE)],
+              (unsigned)stats.percent(PowerState::LIGHT_SLEEP),
+              (unsigned)stats.entries[static_cast<int>(PowerState::LIGHT_SLEEP)]);
+  }
+  manager.resetStats(now);
+  lastStatsMs = now;
+}
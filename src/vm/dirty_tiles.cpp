@@ -0,0 +1,120 @@
+/**
+ * dialScript Dirty Tiles Implementation
+ */
+
+#include "../../include/vm/dirty_tiles.h"
+#include <algorithm>
+
+namespace dialos {
+namespace vm {
+
+const int DirtyTiles::TILE_SIZE;
+
+DirtyTiles::DirtyTiles(int width, int height)
+    : width_(width), height_(height),
+      columns_((width + TILE_SIZE - 1) / TILE_SIZE),
+      rows_((height + TILE_SIZE - 1) / TILE_SIZE),
+      marked_(columns_ * rows_, 0),
+      hashes_(columns_ * rows_, 0),
+      known_(columns_ * rows_, 0),
+      markedCount_(0) {}
+
+void DirtyTiles::mark(const Rect& area) {
+    Rect clipped = area.intersected(Rect(0, 0, width_, height_));
+    if (clipped.empty()) {
+        return;
+    }
+    int firstColumn = clipped.x / TILE_SIZE;
+    int lastColumn = (clipped.x + clipped.w - 1) / TILE_SIZE;
+    int firstRow = clipped.y / TILE_SIZE;
+    int lastRow = (clipped.y + clipped.h - 1) / TILE_SIZE;
+    for (int row = firstRow; row <= lastRow; row++) {
+        for (int column = firstColumn; column <= lastColumn; column++) {
+            uint8_t& tile = marked_[row * columns_ + column];
+            if (!tile) {
+                tile = 1;
+                markedCount_++;
+            }
+        }
+    }
+}
+
+void DirtyTiles::invalidate() {
+    std::fill(known_.begin(), known_.end(), 0);
+}
+
+Rect DirtyTiles::tileRect(int column, int row) const {
+    return Rect(column * TILE_SIZE, row * TILE_SIZE, TILE_SIZE, TILE_SIZE)
+        .intersected(Rect(0, 0, width_, height_));
+}
+
+uint32_t DirtyTiles::hashTile(const uint16_t* pixels, int stride, int column, int row) const {
+    // FNV-1a over the tile's pixels
+    Rect area = tileRect(column, row);
+    uint32_t hash = 2166136261u;
+    for (int32_t y = area.y; y < area.y + area.h; y++) {
+        const uint16_t* line = pixels + y * stride + area.x;
+        for (int32_t x = 0; x < area.w; x++) {
+            hash = (hash ^ line[x]) * 16777619u;
+        }
+    }
+    return hash;
+}
+
+size_t DirtyTiles::collect(const uint16_t* pixels, int stride, const PushHandler& push) {
+    if (markedCount_ == 0) {
+        return 0;
+    }
+
+    size_t pushed = 0;
+    std::vector<Rect> open;             // Runs of the previous tile row, still growing down
+    std::vector<Rect> current;
+    for (int row = 0; row < rows_; row++) {
+        current.clear();
+        for (int column = 0; column < columns_; column++) {
+            int index = row * columns_ + column;
+            bool changed = false;
+            if (marked_[index]) {
+                marked_[index] = 0;
+                uint32_t hash = hashTile(pixels, stride, column, row);
+                changed = !known_[index] || hashes_[index] != hash;
+                hashes_[index] = hash;
+                known_[index] = 1;
+            }
+            if (!changed) {
+                continue;
+            }
+            Rect tile = tileRect(column, row);
+            if (!current.empty() && current.back().x + current.back().w == tile.x) {
+                current.back().w += tile.w;
+            } else {
+                current.push_back(tile);
+            }
+        }
+
+        // Extend runs that line up with one from the row above; report the rest
+        for (Rect& run : current) {
+            for (auto it = open.begin(); it != open.end(); ++it) {
+                if (it->x == run.x && it->w == run.w) {
+                    run = Rect(it->x, it->y, it->w, it->h + run.h);
+                    open.erase(it);
+                    break;
+                }
+            }
+        }
+        for (const Rect& done : open) {
+            pushed += done.area();
+            push(done);
+        }
+        open.swap(current);
+    }
+    for (const Rect& done : open) {
+        pushed += done.area();
+        push(done);
+    }
+    markedCount_ = 0;
+    return pushed;
+}
+
+} // namespace vm
+} // namespace dialos
@@ -0,0 +1,202 @@
+/**
+ * dialScript Display List Implementation
+ */
+
+#include "../../include/vm/display_list.h"
+#include <algorithm>
+#include <cstdlib>
+
+namespace dialos {
+namespace vm {
+
+Rect Rect::united(const Rect& other) const {
+    if (empty()) {
+        return other;
+    }
+    if (other.empty()) {
+        return *this;
+    }
+    int32_t left = std::min(x, other.x);
+    int32_t top = std::min(y, other.y);
+    int32_t right = std::max(x + w, other.x + other.w);
+    int32_t bottom = std::max(y + h, other.y + other.h);
+    return Rect(left, top, right - left, bottom - top);
+}
+
+Rect Rect::intersected(const Rect& other) const {
+    int32_t left = std::max(x, other.x);
+    int32_t top = std::max(y, other.y);
+    int32_t right = std::min(x + w, other.x + other.w);
+    int32_t bottom = std::min(y + h, other.y + other.h);
+    if (right <= left || bottom <= top) {
+        return Rect();
+    }
+    return Rect(left, top, right - left, bottom - top);
+}
+
+const int DisplayList::GLYPH_WIDTH;
+const int DisplayList::GLYPH_HEIGHT;
+
+void DisplayList::add(const Command& command) {
+    commands_.push_back(command);
+    Rect area = bounds(command);
+    dirty_ = dirty_.united(clip_.empty() ? area : area.intersected(clip_));
+}
+
+void DisplayList::clear(uint32_t color) {
+    if (!clip_.empty()) {
+        drawRect(clip_.x, clip_.y, clip_.w, clip_.h, color, true);
+        return;
+    }
+    // Everything recorded so far is painted over
+    reset();
+    Command command = {Op::CLEAR, true, 0, 0, 0, width_, height_, color, 0};
+    add(command);
+}
+
+void DisplayList::drawText(int x, int y, const std::string& text, uint32_t color, int size) {
+    Command command = {Op::TEXT, false, static_cast<uint8_t>(std::max(1, std::min(size, 255))),
+                       x, y, 0, 0, color, static_cast<uint32_t>(texts_.size())};
+    texts_.push_back(text);
+    add(command);
+}
+
+void DisplayList::drawRect(int x, int y, int w, int h, uint32_t color, bool filled) {
+    Command command = {Op::RECT, filled, 0, x, y, w, h, color, 0};
+    add(command);
+}
+
+void DisplayList::drawCircle(int x, int y, int r, uint32_t color, bool filled) {
+    Command command = {Op::CIRCLE, filled, 0, x, y, r, 0, color, 0};
+    add(command);
+}
+
+void DisplayList::drawLine(int x1, int y1, int x2, int y2, uint32_t color) {
+    Command command = {Op::LINE, false, 0, x1, y1, x2, y2, color, 0};
+    add(command);
+}
+
+void DisplayList::drawPixel(int x, int y, uint32_t color) {
+    Command command = {Op::PIXEL, false, 0, x, y, 1, 1, color, 0};
+    add(command);
+}
+
+void DisplayList::drawImage(int x, int y, const std::vector<uint8_t>& image) {
+    if (image.size() < 4) {
+        return;
+    }
+    int32_t w = (image[0] << 8) | image[1];
+    int32_t h = (image[2] << 8) | image[3];
+    size_t bytes = static_cast<size_t>(w) * h * 2;
+    if (w == 0 || h == 0 || image.size() < 4 + bytes) {
+        return;
+    }
+    Command command = {Op::IMAGE, false, 0, x, y, w, h, 0, static_cast<uint32_t>(data_.size())};
+    data_.insert(data_.end(), image.begin() + 4, image.begin() + 4 + bytes);
+    add(command);
+}
+
+void DisplayList::drawBitmap(int x, int y, const std::shared_ptr<const Image>& image, int sx, int sy, int w,
+                             int h, int32_t transparent) {
+    if (!image || w <= 0 || h <= 0) {
+        return;
+    }
+    uint32_t key = transparent < 0 ? NO_KEY : static_cast<uint32_t>(transparent);
+    Command command = {Op::BITMAP, false, 0, x, y, w, h, key, static_cast<uint32_t>(bitmaps_.size())};
+    Bitmap bitmap = {image, sx, sy};
+    bitmaps_.push_back(bitmap);
+    add(command);
+}
+
+void DisplayList::setClip(const Rect& area) {
+    // An empty clip would mean "unclipped"; keep a 1x1 stand-in off screen
+    clip_ = area.intersected(Rect(0, 0, width_, height_));
+    if (clip_.empty()) {
+        clip_ = Rect(-1, -1, 1, 1);
+    }
+    Command command = {Op::CLIP, false, 0, clip_.x, clip_.y, clip_.w, clip_.h, 0, 0};
+    commands_.push_back(command);
+}
+
+void DisplayList::clearClip() {
+    if (clip_.empty()) {
+        return;
+    }
+    clip_ = Rect();
+    Command command = {Op::CLIP, false, 0, 0, 0, 0, 0, 0, 0};
+    commands_.push_back(command);
+}
+
+Rect DisplayList::textBounds(int x, int y, const std::string& text, int size, int width, int height) {
+    int32_t cellW = GLYPH_WIDTH * size;
+    int32_t cellH = GLYPH_HEIGHT * size;
+    int32_t textW = cellW * static_cast<int32_t>(text.size());
+    if (text.find('\n') != std::string::npos || x + textW > width) {
+        // Wrapped lines restart at the left edge
+        return Rect(0, y, width, height - y);
+    }
+    return Rect(x, y, textW, cellH);
+}
+
+void DisplayList::measureText(const std::string& text, int size, int32_t& width, int32_t& height) {
+    int32_t longest = 0;
+    int32_t column = 0;
+    int32_t lines = 1;
+    for (char c : text) {
+        if (c == '\n') {
+            lines++;
+            column = 0;
+        } else if (c != '\r') {
+            longest = std::max(longest, ++column);
+        }
+    }
+    width = longest * GLYPH_WIDTH * size;
+    height = lines * GLYPH_HEIGHT * size;
+}
+
+Rect DisplayList::bounds(const Command& command) const {
+    Rect area;
+    switch (command.op) {
+        case Op::CLEAR:
+            area = Rect(0, 0, width_, height_);
+            break;
+        case Op::TEXT:
+            area = textBounds(command.x, command.y, texts_[command.payload], command.size, width_, height_);
+            break;
+        case Op::RECT:
+            // Negative sizes extend up/left, as on the panel
+            area = Rect(command.w < 0 ? command.x + command.w + 1 : command.x,
+                        command.h < 0 ? command.y + command.h + 1 : command.y,
+                        std::abs(command.w), std::abs(command.h));
+            break;
+        case Op::PIXEL:
+        case Op::IMAGE:
+        case Op::BITMAP:
+            area = Rect(command.x, command.y, command.w, command.h);
+            break;
+        case Op::CIRCLE:
+            area = Rect(command.x - command.w, command.y - command.w, command.w * 2 + 1, command.w * 2 + 1);
+            break;
+        case Op::LINE: {
+            int32_t left = std::min(command.x, command.w);
+            int32_t top = std::min(command.y, command.h);
+            area = Rect(left, top, std::abs(command.w - command.x) + 1, std::abs(command.h - command.y) + 1);
+            break;
+        }
+        case Op::CLIP:
+            break;
+    }
+    return area.intersected(Rect(0, 0, width_, height_));
+}
+
+void DisplayList::reset() {
+    commands_.clear();
+    texts_.clear();
+    data_.clear();
+    bitmaps_.clear();
+    clip_ = Rect();
+    dirty_ = Rect();
+}
+
+} // namespace vm
+} // namespace dialos
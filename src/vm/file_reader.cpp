@@ -0,0 +1,118 @@
+/**
+ * dialScript Buffered File Reader Implementation
+ */
+
+#include "../../include/vm/file_reader.h"
+#include <cstring>
+
+namespace dialos {
+namespace vm {
+
+const size_t FileReader::BUFFER_SIZE;
+
+FileReader::FileReader()
+    : window_(nullptr), windowStart_(0), windowLength_(0), position_(0), size_(0), fills_(0) {}
+
+void FileReader::attach(Source source, uint32_t size) {
+    source_ = source;
+    buffer_.resize(BUFFER_SIZE);
+    window_ = buffer_.data();
+    windowStart_ = 0;
+    windowLength_ = 0;
+    position_ = 0;
+    size_ = size;
+}
+
+void FileReader::view(const char* data, uint32_t size) {
+    source_ = nullptr;
+    buffer_.clear();
+    window_ = data;
+    windowStart_ = 0;
+    windowLength_ = size;
+    size_ = size;
+    if (position_ > size_) {
+        position_ = size_;
+    }
+}
+
+bool FileReader::fill() {
+    if (!source_ || position_ >= size_) {
+        return false;
+    }
+    size_t want = size_ - position_ < BUFFER_SIZE ? size_ - position_ : BUFFER_SIZE;
+    windowStart_ = position_;
+    windowLength_ = static_cast<uint32_t>(source_(position_, buffer_.data(), want));
+    fills_++;
+    if (windowLength_ == 0) {
+        // The file got shorter than when it was opened
+        size_ = position_;
+        return false;
+    }
+    return true;
+}
+
+bool FileReader::readLine(std::string& line) {
+    line.clear();
+    if (position_ >= size_) {
+        return false;
+    }
+    while (position_ < size_) {
+        if (!covered() && !fill()) {
+            break;
+        }
+        const char* start = window_ + (position_ - windowStart_);
+        size_t available = windowStart_ + windowLength_ - position_;
+        const char* newline = static_cast<const char*>(std::memchr(start, '\n', available));
+        if (newline != nullptr) {
+            line.append(start, newline - start);
+            position_ += static_cast<uint32_t>(newline - start) + 1;
+            break;
+        }
+        line.append(start, available);
+        position_ += static_cast<uint32_t>(available);
+    }
+    if (!line.empty() && line.back() == '\r') {
+        line.pop_back();
+    }
+    return true;
+}
+
+size_t FileReader::read(char* dest, size_t size) {
+    size_t done = 0;
+    while (done < size && position_ < size_) {
+        if (!covered()) {
+            // A whole buffer's worth or more goes straight to the caller
+            if (source_ && size - done >= BUFFER_SIZE) {
+                size_t n = source_(position_, dest + done, size - done);
+                fills_++;
+                if (n == 0) {
+                    size_ = position_;
+                    break;
+                }
+                done += n;
+                position_ += static_cast<uint32_t>(n);
+                continue;
+            }
+            if (!fill()) {
+                break;
+            }
+        }
+        size_t available = windowStart_ + windowLength_ - position_;
+        size_t n = size - done < available ? size - done : available;
+        std::memcpy(dest + done, window_ + (position_ - windowStart_), n);
+        done += n;
+        position_ += static_cast<uint32_t>(n);
+    }
+    return done;
+}
+
+bool FileReader::seek(uint32_t position) {
+    if (position > size_) {
+        return false;
+    }
+    position_ = position;
+    return true;
+}
+
+} // namespace vm
+} // namespace dialos
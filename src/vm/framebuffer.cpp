@@ -0,0 +1,485 @@
+/**
+ * dialScript Software Framebuffer Implementation
+ */
+
+#include "../../include/vm/framebuffer.h"
+#include "../../include/vm/raster.h"
+#include "../../include/vm/image_codec.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <utility>
+
+namespace dialos {
+namespace vm {
+
+namespace {
+
+// Built-in 5x7 font, ' '..'~': five column bytes per glyph, bit 0 at the
+// top. The sixth column of the 6x8 cell is spacing.
+const int FONT_FIRST = 32;
+const int FONT_LAST = 126;
+const uint8_t FONT[(FONT_LAST - FONT_FIRST + 1) * 5] = {
+    0x00, 0x00, 0x00, 0x00, 0x00,   // ' '
+    0x00, 0x00, 0x5F, 0x00, 0x00,   // '!'
+    0x00, 0x07, 0x00, 0x07, 0x00,   // '"'
+    0x14, 0x7F, 0x14, 0x7F, 0x14,   // '#'
+    0x24, 0x2A, 0x7F, 0x2A, 0x12,   // '$'
+    0x23, 0x13, 0x08, 0x64, 0x62,   // '%'
+    0x36, 0x49, 0x56, 0x20, 0x50,   // '&'
+    0x00, 0x08, 0x07, 0x03, 0x00,   // '\''
+    0x00, 0x1C, 0x22, 0x41, 0x00,   // '('
+    0x00, 0x41, 0x22, 0x1C, 0x00,   // ')'
+    0x2A, 0x1C, 0x7F, 0x1C, 0x2A,   // '*'
+    0x08, 0x08, 0x3E, 0x08, 0x08,   // '+'
+    0x00, 0x80, 0x70, 0x30, 0x00,   // ','
+    0x08, 0x08, 0x08, 0x08, 0x08,   // '-'
+    0x00, 0x00, 0x60, 0x60, 0x00,   // '.'
+    0x20, 0x10, 0x08, 0x04, 0x02,   // '/'
+    0x3E, 0x51, 0x49, 0x45, 0x3E,   // '0'
+    0x00, 0x42, 0x7F, 0x40, 0x00,   // '1'
+    0x72, 0x49, 0x49, 0x49, 0x46,   // '2'
+    0x21, 0x41, 0x49, 0x4D, 0x33,   // '3'
+    0x18, 0x14, 0x12, 0x7F, 0x10,   // '4'
+    0x27, 0x45, 0x45, 0x45, 0x39,   // '5'
+    0x3C, 0x4A, 0x49, 0x49, 0x31,   // '6'
+    0x41, 0x21, 0x11, 0x09, 0x07,   // '7'
+    0x36, 0x49, 0x49, 0x49, 0x36,   // '8'
+    0x46, 0x49, 0x49, 0x29, 0x1E,   // '9'
+    0x00, 0x00, 0x14, 0x00, 0x00,   // ':'
+    0x00, 0x40, 0x34, 0x00, 0x00,   // ';'
+    0x00, 0x08, 0x14, 0x22, 0x41,   // '<'
+    0x14, 0x14, 0x14, 0x14, 0x14,   // '='
+    0x00, 0x41, 0x22, 0x14, 0x08,   // '>'
+    0x02, 0x01, 0x59, 0x09, 0x06,   // '?'
+    0x3E, 0x41, 0x5D, 0x59, 0x4E,   // '@'
+    0x7C, 0x12, 0x11, 0x12, 0x7C,   // 'A'
+    0x7F, 0x49, 0x49, 0x49, 0x36,   // 'B'
+    0x3E, 0x41, 0x41, 0x41, 0x22,   // 'C'
+    0x7F, 0x41, 0x41, 0x41, 0x3E,   // 'D'
+    0x7F, 0x49, 0x49, 0x49, 0x41,   // 'E'
+    0x7F, 0x09, 0x09, 0x09, 0x01,   // 'F'
+    0x3E, 0x41, 0x41, 0x51, 0x73,   // 'G'
+    0x7F, 0x08, 0x08, 0x08, 0x7F,   // 'H'
+    0x00, 0x41, 0x7F, 0x41, 0x00,   // 'I'
+    0x20, 0x40, 0x41, 0x3F, 0x01,   // 'J'
+    0x7F, 0x08, 0x14, 0x22, 0x41,   // 'K'
+    0x7F, 0x40, 0x40, 0x40, 0x40,   // 'L'
+    0x7F, 0x02, 0x1C, 0x02, 0x7F,   // 'M'
+    0x7F, 0x04, 0x08, 0x10, 0x7F,   // 'N'
+    0x3E, 0x41, 0x41, 0x41, 0x3E,   // 'O'
+    0x7F, 0x09, 0x09, 0x09, 0x06,   // 'P'
+    0x3E, 0x41, 0x51, 0x21, 0x5E,   // 'Q'
+    0x7F, 0x09, 0x19, 0x29, 0x46,   // 'R'
+    0x26, 0x49, 0x49, 0x49, 0x32,   // 'S'
+    0x03, 0x01, 0x7F, 0x01, 0x03,   // 'T'
+    0x3F, 0x40, 0x40, 0x40, 0x3F,   // 'U'
+    0x1F, 0x20, 0x40, 0x20, 0x1F,   // 'V'
+    0x3F, 0x40, 0x38, 0x40, 0x3F,   // 'W'
+    0x63, 0x14, 0x08, 0x14, 0x63,   // 'X'
+    0x03, 0x04, 0x78, 0x04, 0x03,   // 'Y'
+    0x61, 0x59, 0x49, 0x4D, 0x43,   // 'Z'
+    0x00, 0x7F, 0x41, 0x41, 0x41,   // '['
+    0x02, 0x04, 0x08, 0x10, 0x20,   // '\\'
+    0x00, 0x41, 0x41, 0x41, 0x7F,   // ']'
+    0x04, 0x02, 0x01, 0x02, 0x04,   // '^'
+    0x40, 0x40, 0x40, 0x40, 0x40,   // '_'
+    0x00, 0x03, 0x07, 0x08, 0x00,   // '`'
+    0x20, 0x54, 0x54, 0x78, 0x40,   // 'a'
+    0x7F, 0x28, 0x44, 0x44, 0x38,   // 'b'
+    0x38, 0x44, 0x44, 0x44, 0x28,   // 'c'
+    0x38, 0x44, 0x44, 0x28, 0x7F,   // 'd'
+    0x38, 0x54, 0x54, 0x54, 0x18,   // 'e'
+    0x00, 0x08, 0x7E, 0x09, 0x02,   // 'f'
+    0x18, 0xA4, 0xA4, 0x9C, 0x78,   // 'g'
+    0x7F, 0x08, 0x04, 0x04, 0x78,   // 'h'
+    0x00, 0x44, 0x7D, 0x40, 0x00,   // 'i'
+    0x20, 0x40, 0x40, 0x3D, 0x00,   // 'j'
+    0x7F, 0x10, 0x28, 0x44, 0x00,   // 'k'
+    0x00, 0x41, 0x7F, 0x40, 0x00,   // 'l'
+    0x7C, 0x04, 0x78, 0x04, 0x78,   // 'm'
+    0x7C, 0x08, 0x04, 0x04, 0x78,   // 'n'
+    0x38, 0x44, 0x44, 0x44, 0x38,   // 'o'
+    0xFC, 0x18, 0x24, 0x24, 0x18,   // 'p'
+    0x18, 0x24, 0x24, 0x18, 0xFC,   // 'q'
+    0x7C, 0x08, 0x04, 0x04, 0x08,   // 'r'
+    0x48, 0x54, 0x54, 0x54, 0x24,   // 's'
+    0x04, 0x04, 0x3F, 0x44, 0x24,   // 't'
+    0x3C, 0x40, 0x40, 0x20, 0x7C,   // 'u'
+    0x1C, 0x20, 0x40, 0x20, 0x1C,   // 'v'
+    0x3C, 0x40, 0x30, 0x40, 0x3C,   // 'w'
+    0x44, 0x28, 0x10, 0x28, 0x44,   // 'x'
+    0x4C, 0x90, 0x90, 0x90, 0x7C,   // 'y'
+    0x44, 0x64, 0x54, 0x4C, 0x44,   // 'z'
+    0x00, 0x08, 0x36, 0x41, 0x00,   // '{'
+    0x00, 0x00, 0x77, 0x00, 0x00,   // '|'
+    0x00, 0x41, 0x36, 0x08, 0x00,   // '}'
+    0x02, 0x01, 0x02, 0x04, 0x02,   // '~'
+};
+
+} // namespace
+
+Framebuffer::Framebuffer(int width, int height)
+    : width_(width), height_(height),
+      pixels_(static_cast<size_t>(width) * height, 0), clip_(0, 0, width, height), changed_(true) {}
+
+void Framebuffer::clear(uint16_t color) {
+    if (clip_.w == width_ && clip_.h == height_) {
+        raster::fill(pixels_.data(), pixels_.size(), color);
+        changed_ = true;
+        return;
+    }
+    fillBlock(clip_.x, clip_.y, clip_.w, clip_.h, color);
+}
+
+void Framebuffer::setClip(const Rect& area) {
+    clip_ = area.intersected(Rect(0, 0, width_, height_));
+}
+
+void Framebuffer::clearClip() {
+    clip_ = Rect(0, 0, width_, height_);
+}
+
+uint16_t Framebuffer::pixel(int x, int y) const {
+    if (x < 0 || y < 0 || x >= width_ || y >= height_) {
+        return 0;
+    }
+    return pixels_[y * width_ + x];
+}
+
+void Framebuffer::drawPixel(int x, int y, uint16_t color) {
+    if (x < clip_.x || y < clip_.y || x >= clip_.x + clip_.w || y >= clip_.y + clip_.h) {
+        return;
+    }
+    pixels_[y * width_ + x] = color;
+    changed_ = true;
+}
+
+void Framebuffer::fillSpan(int x, int y, int w, uint16_t color) {
+    if (y < clip_.y || y >= clip_.y + clip_.h) {
+        return;
+    }
+    int left = std::max(x, clip_.x);
+    int right = std::min(x + w, clip_.x + clip_.w);
+    if (right <= left) {
+        return;
+    }
+    raster::fill(pixels_.data() + y * width_ + left, right - left, color);
+    changed_ = true;
+}
+
+void Framebuffer::fillBlock(int x, int y, int w, int h, uint16_t color) {
+    int top = std::max(y, clip_.y);
+    int bottom = std::min(y + h, clip_.y + clip_.h);
+    for (int row = top; row < bottom; row++) {
+        fillSpan(x, row, w, color);
+    }
+}
+
+void Framebuffer::drawLine(int x1, int y1, int x2, int y2, uint16_t color) {
+    if (y1 == y2) {
+        fillSpan(std::min(x1, x2), y1, std::abs(x2 - x1) + 1, color);
+        return;
+    }
+    if (x1 == x2) {
+        fillBlock(x1, std::min(y1, y2), 1, std::abs(y2 - y1) + 1, color);
+        return;
+    }
+    // Bresenham, always stepping along the longer axis left to right
+    bool steep = std::abs(y2 - y1) > std::abs(x2 - x1);
+    if (steep) {
+        std::swap(x1, y1);
+        std::swap(x2, y2);
+    }
+    if (x1 > x2) {
+        std::swap(x1, x2);
+        std::swap(y1, y2);
+    }
+    int dx = x2 - x1;
+    int dy = std::abs(y2 - y1);
+    int err = dx / 2;
+    int ystep = y1 < y2 ? 1 : -1;
+    for (; x1 <= x2; x1++) {
+        if (steep) {
+            drawPixel(y1, x1, color);
+        } else {
+            drawPixel(x1, y1, color);
+        }
+        err -= dy;
+        if (err < 0) {
+            y1 += ystep;
+            err += dx;
+        }
+    }
+}
+
+void Framebuffer::drawRect(int x, int y, int w, int h, uint16_t color, bool filled) {
+    // Negative sizes extend up/left, as on the panel
+    if (w < 0) {
+        x += w + 1;
+        w = -w;
+    }
+    if (h < 0) {
+        y += h + 1;
+        h = -h;
+    }
+    if (w == 0 || h == 0) {
+        return;
+    }
+    if (filled) {
+        fillBlock(x, y, w, h, color);
+        return;
+    }
+    fillSpan(x, y, w, color);
+    fillSpan(x, y + h - 1, w, color);
+    fillBlock(x, y, 1, h, color);
+    fillBlock(x + w - 1, y, 1, h, color);
+}
+
+void Framebuffer::drawCircle(int x, int y, int r, uint16_t color, bool filled) {
+    if (r < 0) {
+        return;
+    }
+    // Midpoint circle: f tracks the error, ddF_x/ddF_y its increments
+    int f = 1 - r;
+    int ddF_x = 1;
+    int ddF_y = -2 * r;
+    int cx = 0;
+    int cy = r;
+
+    if (filled) {
+        // The panel library fills columns either side of the centre. The
+        // midpoint disc is symmetric about its diagonal, so the same pixels
+        // come out of rows, which are contiguous and go through fillSpan.
+        fillSpan(x - r, y, 2 * r + 1, color);
+        int px = cx;
+        int py = cy;
+        while (cx < cy) {
+            if (f >= 0) {
+                cy--;
+                ddF_y += 2;
+                f += ddF_y;
+            }
+            cx++;
+            ddF_x += 2;
+            f += ddF_x;
+            // The outer rows only when the one below moved in, so no row
+            // is filled twice
+            if (cx < cy + 1) {
+                fillSpan(x - cy, y + cx, 2 * cy + 1, color);
+                fillSpan(x - cy, y - cx, 2 * cy + 1, color);
+            }
+            if (cy != py) {
+                fillSpan(x - px, y + py, 2 * px + 1, color);
+                fillSpan(x - px, y - py, 2 * px + 1, color);
+                py = cy;
+            }
+            px = cx;
+        }
+        return;
+    }
+
+    drawPixel(x, y + r, color);
+    drawPixel(x, y - r, color);
+    drawPixel(x + r, y, color);
+    drawPixel(x - r, y, color);
+    while (cx < cy) {
+        if (f >= 0) {
+            cy--;
+            ddF_y += 2;
+            f += ddF_y;
+        }
+        cx++;
+        ddF_x += 2;
+        f += ddF_x;
+        drawPixel(x + cx, y + cy, color);
+        drawPixel(x - cx, y + cy, color);
+        drawPixel(x + cx, y - cy, color);
+        drawPixel(x - cx, y - cy, color);
+        drawPixel(x + cy, y + cx, color);
+        drawPixel(x - cy, y + cx, color);
+        drawPixel(x + cy, y - cx, color);
+        drawPixel(x - cy, y - cx, color);
+    }
+}
+
+void Framebuffer::drawGlyph(int x, int y, char c, uint16_t color, int size) {
+    int index = static_cast<unsigned char>(c);
+    if (index < FONT_FIRST || index > FONT_LAST) {
+        return;
+    }
+    const uint8_t* columns = &FONT[(index - FONT_FIRST) * 5];
+    for (int col = 0; col < 5; col++) {
+        uint8_t bits = columns[col];
+        for (int row = 0; bits != 0; row++, bits >>= 1) {
+            if (bits & 1) {
+                fillBlock(x + col * size, y + row * size, size, size, color);
+            }
+        }
+    }
+}
+
+void Framebuffer::drawText(int x, int y, const std::string& text, uint16_t color, int size) {
+    size = std::max(1, std::min(size, 255));
+    int cellW = DisplayList::GLYPH_WIDTH * size;
+    int cellH = DisplayList::GLYPH_HEIGHT * size;
+    for (char c : text) {
+        if (c == '\n') {
+            x = 0;
+            y += cellH;
+            continue;
+        }
+        if (c == '\r') {
+            continue;
+        }
+        if (x + cellW > width_) {
+            x = 0;
+            y += cellH;
+        }
+        drawGlyph(x, y, c, color, size);
+        x += cellW;
+    }
+}
+
+void Framebuffer::drawImage(int x, int y, const std::vector<uint8_t>& image) {
+    if (image.size() < 4) {
+        return;
+    }
+    int w = (image[0] << 8) | image[1];
+    int h = (image[2] << 8) | image[3];
+    if (image.size() < 4 + static_cast<size_t>(w) * h * 2) {
+        return;
+    }
+    blitBigEndian(x, y, w, h, image.data() + 4);
+}
+
+bool Framebuffer::clipBlock(int& x, int& y, int& w, int& h, int& skipX, int& skipY) const {
+    skipX = std::max(0, clip_.x - x);
+    skipY = std::max(0, clip_.y - y);
+    int right = std::min(x + w, clip_.x + clip_.w);
+    int bottom = std::min(y + h, clip_.y + clip_.h);
+    x += skipX;
+    y += skipY;
+    w = right - x;
+    h = bottom - y;
+    return w > 0 && h > 0;
+}
+
+void Framebuffer::blitBigEndian(int x, int y, int w, int h, const uint8_t* data) {
+    int stride = w;
+    int skipX, skipY;
+    if (!clipBlock(x, y, w, h, skipX, skipY)) {
+        return;
+    }
+    for (int row = 0; row < h; row++) {
+        const uint8_t* src = data + ((row + skipY) * stride + skipX) * 2;
+        raster::copyBigEndian(pixels_.data() + (y + row) * width_ + x, src, w);
+    }
+    changed_ = true;
+}
+
+void Framebuffer::pushImage(int x, int y, int w, int h, const uint16_t* pixels, int32_t transparent,
+                            int stride) {
+    if (stride <= 0) {
+        stride = w;
+    }
+    int skipX, skipY;
+    if (!clipBlock(x, y, w, h, skipX, skipY)) {
+        return;
+    }
+    for (int row = 0; row < h; row++) {
+        const uint16_t* src = pixels + (row + skipY) * stride + skipX;
+        uint16_t* dst = pixels_.data() + (y + row) * width_ + x;
+        if (transparent < 0) {
+            std::memcpy(dst, src, w * sizeof(uint16_t));
+        } else {
+            raster::copyKeyed(dst, src, w, static_cast<uint16_t>(transparent));
+        }
+    }
+    changed_ = true;
+}
+
+void Framebuffer::blendImage(int x, int y, int w, int h, const uint16_t* pixels, uint8_t alpha) {
+    int stride = w;
+    int skipX, skipY;
+    if (!clipBlock(x, y, w, h, skipX, skipY)) {
+        return;
+    }
+    for (int row = 0; row < h; row++) {
+        raster::blend(pixels_.data() + (y + row) * width_ + x,
+                      pixels + (row + skipY) * stride + skipX, w, alpha);
+    }
+    changed_ = true;
+}
+
+void Framebuffer::draw(const DisplayList& list) {
+    for (const DisplayList::Command& command : list.commands()) {
+        uint16_t color = static_cast<uint16_t>(command.color);
+        switch (command.op) {
+            case DisplayList::Op::CLEAR:
+                clear(color);
+                break;
+            case DisplayList::Op::TEXT:
+                drawText(command.x, command.y, list.text(command), color, command.size);
+                break;
+            case DisplayList::Op::RECT:
+                drawRect(command.x, command.y, command.w, command.h, color, command.filled);
+                break;
+            case DisplayList::Op::CIRCLE:
+                drawCircle(command.x, command.y, command.w, color, command.filled);
+                break;
+            case DisplayList::Op::LINE:
+                drawLine(command.x, command.y, command.w, command.h, color);
+                break;
+            case DisplayList::Op::PIXEL:
+                drawPixel(command.x, command.y, color);
+                break;
+            case DisplayList::Op::IMAGE:
+                blitBigEndian(command.x, command.y, command.w, command.h, list.imageData(command));
+                break;
+            case DisplayList::Op::BITMAP: {
+                const DisplayList::Bitmap& bitmap = list.bitmap(command);
+                const Image& image = *bitmap.image;
+                pushImage(command.x, command.y, command.w, command.h,
+                          image.pixels.data() + bitmap.sy * image.width + bitmap.sx,
+                          command.color == DisplayList::NO_KEY ? -1 : static_cast<int32_t>(command.color),
+                          image.width);
+                break;
+            }
+            case DisplayList::Op::CLIP:
+                if (command.w > 0) {
+                    setClip(Rect(command.x, command.y, command.w, command.h));
+                } else {
+                    clearClip();
+                }
+                break;
+        }
+    }
+    clearClip();
+}
+
+void Framebuffer::copyCircular(uint16_t* out, int stride, int radius, uint16_t outside) const {
+    int cx = width_ / 2;
+    int cy = height_ / 2;
+    for (int y = 0; y < height_; y++) {
+        uint16_t* dst = out + y * stride;
+        const uint16_t* src = pixels_.data() + y * width_;
+        int dy = y - cy;
+        int left = width_;
+        int right = width_;
+        int half = raster::circleHalfWidth(radius, dy);
+        if (half >= 0) {
+            left = std::max(0, cx - half);
+            right = std::min(width_, cx + half + 1);
+        }
+        raster::fill(dst, left, outside);
+        if (right > left) {
+            std::memcpy(dst + left, src + left, (right - left) * sizeof(uint16_t));
+        }
+        int rest = std::max(left, right);
+        raster::fill(dst + rest, width_ - rest, outside);
+    }
+}
+
+} // namespace vm
+} // namespace dialos
@@ -0,0 +1,347 @@
+/**
+ * dialScript HTTP Response Cache Implementation
+ */
+
+#include "../../include/vm/http_cache.h"
+#include "../../include/vm/http_download.h"
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <iterator>
+
+namespace dialos {
+namespace vm {
+
+namespace {
+
+const char* const INDEX_NAME = "index";
+const char* const INDEX_HEADER = "dialos-http-cache 1";
+
+// Index fields are tab-separated, one entry per line
+bool storable(const std::string& text) {
+    return text.find_first_of("\t\r\n") == std::string::npos;
+}
+
+std::vector<std::string> split(const std::string& line, char separator) {
+    std::vector<std::string> fields;
+    size_t start = 0;
+    while (true) {
+        size_t end = line.find(separator, start);
+        fields.push_back(line.substr(start, end == std::string::npos ? std::string::npos : end - start));
+        if (end == std::string::npos) {
+            return fields;
+        }
+        start = end + 1;
+    }
+}
+
+} // namespace
+
+bool HttpCache::DirectoryStore::load(const std::string& name, std::string& data) {
+    std::FILE* file = std::fopen((dir_ + "/" + name).c_str(), "rb");
+    if (file == nullptr) {
+        return false;
+    }
+    data.clear();
+    char buffer[4096];
+    size_t n;
+    while ((n = std::fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        data.append(buffer, n);
+    }
+    bool ok = !std::ferror(file);
+    std::fclose(file);
+    return ok;
+}
+
+bool HttpCache::DirectoryStore::save(const std::string& name, const std::string& data) {
+    std::FILE* file = std::fopen((dir_ + "/" + name).c_str(), "wb");
+    if (file == nullptr) {
+        return false;
+    }
+    bool ok = std::fwrite(data.data(), 1, data.size(), file) == data.size();
+    return std::fclose(file) == 0 && ok;
+}
+
+void HttpCache::DirectoryStore::remove(const std::string& name) {
+    std::remove((dir_ + "/" + name).c_str());
+}
+
+HttpCache::HttpCache(std::unique_ptr<Store> store, size_t budgetBytes)
+    : store_(std::move(store)), budget_(budgetBytes), indexDirty_(false),
+      clock_([]() { return static_cast<int64_t>(std::time(nullptr)); }) {
+    loadIndex();
+}
+
+HttpCache::~HttpCache() {
+    flush();
+}
+
+bool HttpCache::get(const std::string& url, const Fetcher& fetch, Response& response, std::string& error,
+                    Source* source) {
+    int64_t now = clock_();
+    Entry cached;
+    bool haveEntry = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = entries_.find(url);
+        if (it != entries_.end()) {
+            cached = *it->second;
+            haveEntry = true;
+        }
+    }
+
+    // A body that went missing or was cut short makes the entry useless
+    std::string body;
+    if (haveEntry && (!store_->load(cached.name, body) || body.size() != cached.size)) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = entries_.find(url);
+        if (it != entries_.end()) {
+            drop(it->second);
+            writeIndex();
+        }
+        haveEntry = false;
+    }
+
+    if (haveEntry && now < cached.expires) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = entries_.find(url);
+        if (it != entries_.end()) {
+            recent_.splice(recent_.begin(), recent_, it->second);
+            indexDirty_ = true;
+        }
+        stats_.hits++;
+        stats_.bytesSaved += body.size();
+        response.status = 200;
+        response.body = std::move(body);
+        response.etag = cached.etag;
+        response.lastModified = cached.lastModified;
+        response.cacheControl = cached.cacheControl;
+        if (source != nullptr) {
+            *source = Source::CACHE;
+        }
+        return true;
+    }
+
+    Headers conditional;
+    if (haveEntry && !cached.etag.empty()) {
+        conditional.push_back(std::make_pair("If-None-Match", cached.etag));
+    }
+    if (haveEntry && !cached.lastModified.empty()) {
+        conditional.push_back(std::make_pair("If-Modified-Since", cached.lastModified));
+    }
+    Response fetched;
+    if (!fetch(conditional, fetched, error)) {
+        return false;
+    }
+
+    if (haveEntry && fetched.status == 304) {
+        // Still current: new freshness, and any validator the 304 carries
+        if (!fetched.cacheControl.empty()) {
+            cached.cacheControl = fetched.cacheControl;
+        }
+        if (!fetched.etag.empty()) {
+            cached.etag = fetched.etag;
+        }
+        if (!fetched.lastModified.empty()) {
+            cached.lastModified = fetched.lastModified;
+        }
+        bool noStore = false;
+        cached.expires = now + maxAge(cached.cacheControl, noStore);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto it = entries_.find(url);
+            if (it != entries_.end() && storable(cached.etag) && storable(cached.lastModified) &&
+                storable(cached.cacheControl)) {
+                *it->second = cached;
+                recent_.splice(recent_.begin(), recent_, it->second);
+                writeIndex();
+            }
+            stats_.revalidated++;
+            stats_.bytesSaved += body.size();
+        }
+        response.status = 200;
+        response.body = std::move(body);
+        response.etag = cached.etag;
+        response.lastModified = cached.lastModified;
+        response.cacheControl = cached.cacheControl;
+        if (source != nullptr) {
+            *source = Source::REVALIDATED;
+        }
+        return true;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stats_.misses++;
+    }
+    if (fetched.status == 200) {
+        store(url, fetched, now);
+    }
+    response = std::move(fetched);
+    if (source != nullptr) {
+        *source = Source::NETWORK;
+    }
+    return true;
+}
+
+void HttpCache::store(const std::string& url, const Response& response, int64_t now) {
+    bool noStore = false;
+    int64_t age = maxAge(response.cacheControl, noStore);
+    bool keep = !noStore && (age > 0 || !response.etag.empty() || !response.lastModified.empty()) &&
+                response.body.size() <= budget_ && storable(url) && storable(response.etag) &&
+                storable(response.lastModified) && storable(response.cacheControl);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto existing = entries_.find(url);
+    bool replaced = existing != entries_.end();
+    if (replaced) {
+        drop(existing->second);
+    }
+    if (!keep) {
+        if (replaced) {
+            writeIndex();
+        }
+        return;
+    }
+
+    Entry entry;
+    entry.url = url;
+    entry.name = nameFor(url);
+    entry.size = response.body.size();
+    entry.expires = now + age;
+    entry.etag = response.etag;
+    entry.lastModified = response.lastModified;
+    entry.cacheControl = response.cacheControl;
+
+    // Two URLs hashing alike can't both stay
+    for (auto it = recent_.begin(); it != recent_.end(); ++it) {
+        if (it->name == entry.name) {
+            drop(it);
+            break;
+        }
+    }
+    trim(entry.size);
+    if (store_->save(entry.name, response.body)) {
+        recent_.push_front(entry);
+        entries_[url] = recent_.begin();
+        stats_.bytes += entry.size;
+        stats_.entries = entries_.size();
+    }
+    writeIndex();
+}
+
+void HttpCache::drop(EntryRef entry) {
+    store_->remove(entry->name);
+    stats_.bytes -= entry->size;
+    entries_.erase(entry->url);
+    recent_.erase(entry);
+    stats_.entries = entries_.size();
+}
+
+void HttpCache::trim(size_t incoming) {
+    while (!recent_.empty() && stats_.bytes + incoming > budget_) {
+        drop(std::prev(recent_.end()));
+        stats_.evictions++;
+    }
+}
+
+void HttpCache::loadIndex() {
+    std::string text;
+    if (!store_->load(INDEX_NAME, text)) {
+        return;
+    }
+    std::vector<std::string> lines = split(text, '\n');
+    if (lines.empty() || lines[0] != INDEX_HEADER) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (size_t i = 1; i < lines.size(); i++) {
+        // name, size, expires, etag, last-modified, cache-control, url
+        std::vector<std::string> fields = split(lines[i], '\t');
+        if (fields.size() != 7 || entries_.count(fields[6]) != 0) {
+            continue;
+        }
+        Entry entry;
+        entry.name = fields[0];
+        entry.size = static_cast<size_t>(std::strtoul(fields[1].c_str(), nullptr, 10));
+        entry.expires = std::strtoll(fields[2].c_str(), nullptr, 10);
+        entry.etag = fields[3];
+        entry.lastModified = fields[4];
+        entry.cacheControl = fields[5];
+        entry.url = fields[6];
+        recent_.push_back(entry);
+        entries_[entry.url] = std::prev(recent_.end());
+        stats_.bytes += entry.size;
+    }
+    stats_.entries = entries_.size();
+    if (stats_.bytes > budget_) {
+        trim(0);
+        writeIndex();
+    }
+}
+
+void HttpCache::writeIndex() {
+    std::string text = INDEX_HEADER;
+    text += "\n";
+    for (const Entry& entry : recent_) {
+        text += entry.name + "\t" + std::to_string(entry.size) + "\t" + std::to_string(entry.expires) + "\t" +
+                entry.etag + "\t" + entry.lastModified + "\t" + entry.cacheControl + "\t" + entry.url + "\n";
+    }
+    store_->save(INDEX_NAME, text);
+    indexDirty_ = false;
+}
+
+void HttpCache::setBudget(size_t bytes) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    budget_ = bytes;
+    if (stats_.bytes > budget_) {
+        trim(0);
+        writeIndex();
+    }
+}
+
+void HttpCache::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    while (!recent_.empty()) {
+        drop(recent_.begin());
+    }
+    writeIndex();
+}
+
+void HttpCache::flush() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (indexDirty_) {
+        writeIndex();
+    }
+}
+
+HttpCache::Stats HttpCache::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+int64_t HttpCache::maxAge(const std::string& cacheControl, bool& noStore) {
+    std::string directives = cacheControl;
+    for (char& c : directives) {
+        c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    }
+    noStore = directives.find("no-store") != std::string::npos;
+    if (noStore || directives.find("no-cache") != std::string::npos) {
+        return 0;
+    }
+    size_t pos = directives.find("max-age=");
+    if (pos == std::string::npos) {
+        return 0;
+    }
+    return std::strtoll(directives.c_str() + pos + 8, nullptr, 10);
+}
+
+std::string HttpCache::nameFor(const std::string& url) {
+    char name[16];
+    std::snprintf(name, sizeof(name), "%08x.body", static_cast<unsigned>(crc32(0, url.data(), url.size())));
+    return name;
+}
+
+} // namespace vm
+} // namespace dialos
@@ -0,0 +1,269 @@
+/**
+ * dialScript HTTP Download Writer Implementation
+ */
+
+#include "../../include/vm/http_download.h"
+#include "../../include/vm/json.h"
+#include <cstdlib>
+#include <cstring>
+
+namespace dialos {
+namespace vm {
+
+namespace {
+
+struct CrcTable {
+    uint32_t entries[256];
+    CrcTable() {
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; k++) {
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            }
+            entries[i] = c;
+        }
+    }
+};
+
+// "bytes <first>-<last>/<total>" (total may be "*")
+bool parseContentRange(const std::string& text, uint32_t& first, int64_t& total) {
+    const char* p = text.c_str();
+    if (text.compare(0, 6, "bytes ") != 0) {
+        return false;
+    }
+    char* end = nullptr;
+    first = static_cast<uint32_t>(std::strtoul(p + 6, &end, 10));
+    if (end == p + 6 || *end != '-') {
+        return false;
+    }
+    const char* slash = std::strchr(end, '/');
+    if (slash == nullptr) {
+        return false;
+    }
+    if (slash[1] == '*') {
+        total = DownloadWriter::UNKNOWN_LENGTH;
+        return true;
+    }
+    total = std::strtoll(slash + 1, &end, 10);
+    return end != slash + 1;
+}
+
+} // namespace
+
+const size_t DownloadWriter::CHUNK_SIZE;
+const int64_t DownloadWriter::UNKNOWN_LENGTH;
+
+uint32_t crc32(uint32_t crc, const void* data, size_t length) {
+    // Built on first use; downloads run on worker threads, statics are safe
+    static const CrcTable table;
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    crc = ~crc;
+    for (size_t i = 0; i < length; i++) {
+        crc = table.entries[(crc ^ bytes[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+DownloadWriter::DownloadWriter(const std::string& path)
+    : path_(path), partPath_(path + ".part"), tagPath_(path + ".etag"), file_(nullptr), filled_(0),
+      offset_(0), received_(0), resumed_(0), crc_(0), chunks_(0), total_(UNKNOWN_LENGTH), finished_(false) {}
+
+DownloadWriter::~DownloadWriter() {
+    if (!finished_) {
+        abandon();
+    }
+}
+
+uint32_t DownloadWriter::prepare() {
+    offset_ = 0;
+    crc_ = 0;
+    validator_.clear();
+
+    // The validator the part file was fetched under
+    if (std::FILE* tag = std::fopen(tagPath_.c_str(), "rb")) {
+        char line[256];
+        size_t n = std::fread(line, 1, sizeof(line) - 1, tag);
+        std::fclose(tag);
+        line[n] = '\0';
+        validator_ = line;
+    }
+    std::FILE* part = std::fopen(partPath_.c_str(), "rb");
+    if (part == nullptr) {
+        validator_.clear();
+        return 0;
+    }
+    if (validator_.empty()) {
+        // Nothing to prove the bytes are still current
+        std::fclose(part);
+        std::remove(partPath_.c_str());
+        return 0;
+    }
+
+    // Checksum the prefix so the reported CRC covers the whole file
+    chunk_.resize(CHUNK_SIZE);
+    size_t n;
+    while ((n = std::fread(chunk_.data(), 1, CHUNK_SIZE, part)) > 0) {
+        crc_ = crc32(crc_, chunk_.data(), n);
+        offset_ += static_cast<uint32_t>(n);
+    }
+    std::fclose(part);
+    if (offset_ == 0) {
+        crc_ = 0;
+        validator_.clear();
+    }
+    return offset_;
+}
+
+bool DownloadWriter::begin(int status, const std::string& contentRange, int64_t contentLength,
+                           const std::string& validator, std::string& error) {
+    const char* mode = "wb";
+    if (status == 206 && offset_ > 0) {
+        uint32_t first = 0;
+        if (!parseContentRange(contentRange, first, total_) || first != offset_) {
+            error = "Range answer doesn't continue the partial file";
+            std::remove(partPath_.c_str());
+            std::remove(tagPath_.c_str());
+            return false;
+        }
+        mode = "ab";
+        received_ = resumed_ = offset_;
+    } else if (status == 200) {
+        // Whole body: start over, whatever was there
+        received_ = resumed_ = 0;
+        crc_ = 0;
+        total_ = contentLength;
+    } else {
+        error = "HTTP " + std::to_string(status);
+        if (status == 416) {
+            std::remove(partPath_.c_str());
+            std::remove(tagPath_.c_str());
+        }
+        return false;
+    }
+
+    // Record the validator first: a part file without one is never resumed
+    if (validator.empty() || validator.size() >= 256) {
+        std::remove(tagPath_.c_str());
+    } else if (std::FILE* tag = std::fopen(tagPath_.c_str(), "wb")) {
+        std::fwrite(validator.data(), 1, validator.size(), tag);
+        std::fclose(tag);
+    }
+    validator_ = validator;
+
+    file_ = std::fopen(partPath_.c_str(), mode);
+    if (file_ == nullptr) {
+        error = "Cannot open " + partPath_;
+        return false;
+    }
+    // Chunks are the unit of writing; stdio buffering would only copy them
+    std::setvbuf(file_, nullptr, _IONBF, 0);
+    chunk_.resize(CHUNK_SIZE);
+    filled_ = 0;
+    if (total_ != UNKNOWN_LENGTH && received_ > total_) {
+        error = "Partial file is larger than the resource";
+        return false;
+    }
+    return true;
+}
+
+bool DownloadWriter::write(const char* data, size_t length, std::string& error) {
+    if (file_ == nullptr) {
+        error = "Download not started";
+        return false;
+    }
+    if (total_ != UNKNOWN_LENGTH && received_ + static_cast<int64_t>(length) > total_) {
+        error = "More data than the announced length";
+        return false;
+    }
+    crc_ = crc32(crc_, data, length);
+    while (length > 0) {
+        size_t take = CHUNK_SIZE - filled_;
+        if (take > length) {
+            take = length;
+        }
+        std::memcpy(chunk_.data() + filled_, data, take);
+        filled_ += take;
+        received_ += static_cast<uint32_t>(take);
+        data += take;
+        length -= take;
+        if (filled_ == CHUNK_SIZE && !flushChunk(error)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool DownloadWriter::flushChunk(std::string& error) {
+    if (filled_ > 0) {
+        if (std::fwrite(chunk_.data(), 1, filled_, file_) != filled_) {
+            error = "Write to " + partPath_ + " failed";
+            return false;
+        }
+        filled_ = 0;
+        chunks_++;
+    }
+    if (progress_) {
+        progress_(received_, total_);
+    }
+    return true;
+}
+
+bool DownloadWriter::finish(std::string& error) {
+    if (file_ == nullptr) {
+        error = "Download not started";
+        return false;
+    }
+    if ((filled_ > 0 || chunks_ == 0) && !flushChunk(error)) {
+        return false;
+    }
+    std::fclose(file_);
+    file_ = nullptr;
+    if (total_ != UNKNOWN_LENGTH && received_ != total_) {
+        // Keep the part file: the next attempt picks up from here
+        error = "Transfer ended after " + std::to_string(received_) + " of " + std::to_string(total_) + " bytes";
+        return false;
+    }
+    std::remove(path_.c_str());
+    if (std::rename(partPath_.c_str(), path_.c_str()) != 0) {
+        error = "Cannot move the download to " + path_;
+        return false;
+    }
+    std::remove(tagPath_.c_str());
+    finished_ = true;
+    return true;
+}
+
+void DownloadWriter::abandon() {
+    if (file_ == nullptr) {
+        return;
+    }
+    if (filled_ > 0) {
+        std::fwrite(chunk_.data(), 1, filled_, file_);
+        filled_ = 0;
+    }
+    std::fclose(file_);
+    file_ = nullptr;
+    if (received_ == 0 || validator_.empty()) {
+        std::remove(partPath_.c_str());
+    }
+}
+
+std::string DownloadWriter::report(const std::string& filepath) const {
+    char crc[9];
+    std::snprintf(crc, sizeof(crc), "%08x", static_cast<unsigned>(crc_));
+    std::string out = "{\"status\":\"success\",\"bytes\":" + std::to_string(received_) +
+                      ",\"resumed\":" + std::to_string(resumed_) + ",\"crc32\":\"" + crc + "\",\"filepath\":";
+    json::appendQuoted(filepath, out);
+    out += "}";
+    return out;
+}
+
+std::string DownloadWriter::errorReport(const std::string& message) {
+    std::string out = "{\"status\":\"error\",\"message\":";
+    json::appendQuoted(message, out);
+    out += "}";
+    return out;
+}
+
+} // namespace vm
+} // namespace dialos
@@ -0,0 +1,191 @@
+/**
+ * dialScript Idle Manager Implementation
+ */
+
+#include "../../include/vm/idle_manager.h"
+#include <algorithm>
+
+namespace dialos {
+namespace vm {
+
+const IdleManager::SourceId IdleManager::INVALID_SOURCE;
+const uint32_t IdleManager::NO_DEADLINE;
+const uint32_t IdleManager::DEFAULT_LIGHT_SLEEP_MIN_MS;
+const int IdleManager::STATE_COUNT;
+
+uint64_t IdleManager::Stats::totalMs() const {
+    uint64_t total = 0;
+    for (int i = 0; i < STATE_COUNT; i++) {
+        total += residencyMs[i];
+    }
+    return total;
+}
+
+uint32_t IdleManager::Stats::percent(PowerState state) const {
+    uint64_t total = totalMs();
+    if (total == 0) {
+        return 0;
+    }
+    return static_cast<uint32_t>(residencyMs[static_cast<int>(state)] * 100 / total);
+}
+
+IdleManager::IdleManager(uint32_t lightSleepMinMs)
+    : nextId_(0), lightSleepMinMs_(lightSleepMinMs), lightSleepEnabled_(true),
+      sleeping_(PowerState::ACTIVE), lastAccounted_(0), accounting_(false) {
+    stats_ = Stats();
+}
+
+IdleManager::SourceId IdleManager::addSource(const std::string& name) {
+    std::lock_guard<std::mutex> guard(mutex_);
+    Source source;
+    source.id = nextId_++;
+    source.name = name;
+    source.reported = false;
+    source.hasDeadline = false;
+    source.deadline = 0;
+    source.holdAwake = false;
+    sources_.push_back(source);
+    return source.id;
+}
+
+void IdleManager::removeSource(SourceId id) {
+    std::lock_guard<std::mutex> guard(mutex_);
+    sources_.erase(std::remove_if(sources_.begin(), sources_.end(),
+                                  [id](const Source& s) { return s.id == id; }),
+                   sources_.end());
+}
+
+std::string IdleManager::getSourceName(SourceId id) const {
+    std::lock_guard<std::mutex> guard(mutex_);
+    const Source* source = find(id);
+    return source ? source->name : std::string();
+}
+
+void IdleManager::update(SourceId id, uint32_t now, uint32_t waitMs, bool holdAwake) {
+    std::lock_guard<std::mutex> guard(mutex_);
+    Source* source = find(id);
+    if (!source) {
+        return;
+    }
+    source->reported = true;
+    source->hasDeadline = waitMs != NO_DEADLINE;
+    source->deadline = now + (source->hasDeadline ? waitMs : 0);
+    source->holdAwake = holdAwake;
+
+    if (sleeping_ == PowerState::IDLE && wake_ && planLocked(now).state == PowerState::LIGHT_SLEEP) {
+        wake_();
+    }
+}
+
+IdleManager::Plan IdleManager::plan(uint32_t now) const {
+    std::lock_guard<std::mutex> guard(mutex_);
+    return planLocked(now);
+}
+
+IdleManager::Plan IdleManager::planLocked(uint32_t now) const {
+    Plan result;
+    result.state = PowerState::IDLE;
+    result.sleepMs = NO_DEADLINE;
+    result.wakeSource = INVALID_SOURCE;
+
+    bool holdAwake = false;
+    for (const auto& source : sources_) {
+        holdAwake = holdAwake || source.holdAwake;
+        uint32_t remaining;
+        if (!source.reported) {
+            remaining = 0;
+        } else if (!source.hasDeadline) {
+            continue;
+        } else {
+            int32_t left = static_cast<int32_t>(source.deadline - now);
+            remaining = left > 0 ? static_cast<uint32_t>(left) : 0;
+        }
+        if (remaining < result.sleepMs) {
+            result.sleepMs = remaining;
+            result.wakeSource = source.id;
+        }
+    }
+
+    if (result.sleepMs == 0) {
+        result.state = PowerState::ACTIVE;
+    } else if (!holdAwake && lightSleepEnabled_ && result.sleepMs >= lightSleepMinMs_) {
+        result.state = PowerState::LIGHT_SLEEP;
+    }
+    return result;
+}
+
+IdleManager::Plan IdleManager::idle(uint32_t now, const SleepFn& sleep) {
+    Plan result;
+    {
+        std::lock_guard<std::mutex> guard(mutex_);
+        if (accounting_) {
+            stats_.residencyMs[static_cast<int>(PowerState::ACTIVE)] +=
+                static_cast<uint32_t>(now - lastAccounted_);
+        }
+        lastAccounted_ = now;
+        accounting_ = true;
+        result = planLocked(now);
+        if (result.state == PowerState::ACTIVE) {
+            return result;
+        }
+        stats_.entries[static_cast<int>(result.state)]++;
+        sleeping_ = result.state;
+    }
+
+    // Sleep without the lock so sources can keep reporting meanwhile
+    uint32_t slept = sleep(result.state, result.sleepMs);
+
+    std::lock_guard<std::mutex> guard(mutex_);
+    sleeping_ = PowerState::ACTIVE;
+    stats_.residencyMs[static_cast<int>(result.state)] += slept;
+    lastAccounted_ += slept;
+    return result;
+}
+
+void IdleManager::setWakeHandler(WakeHandler handler) {
+    std::lock_guard<std::mutex> guard(mutex_);
+    wake_ = handler;
+}
+
+void IdleManager::setLightSleepEnabled(bool enabled) {
+    std::lock_guard<std::mutex> guard(mutex_);
+    lightSleepEnabled_ = enabled;
+}
+
+bool IdleManager::isLightSleepEnabled() const {
+    std::lock_guard<std::mutex> guard(mutex_);
+    return lightSleepEnabled_;
+}
+
+IdleManager::Stats IdleManager::getStats() const {
+    std::lock_guard<std::mutex> guard(mutex_);
+    return stats_;
+}
+
+void IdleManager::resetStats(uint32_t now) {
+    std::lock_guard<std::mutex> guard(mutex_);
+    stats_ = Stats();
+    lastAccounted_ = now;
+    accounting_ = true;
+}
+
+IdleManager::Source* IdleManager::find(SourceId id) {
+    for (auto& source : sources_) {
+        if (source.id == id) {
+            return &source;
+        }
+    }
+    return nullptr;
+}
+
+const IdleManager::Source* IdleManager::find(SourceId id) const {
+    for (const auto& source : sources_) {
+        if (source.id == id) {
+            return &source;
+        }
+    }
+    return nullptr;
+}
+
+} // namespace vm
+} // namespace dialos
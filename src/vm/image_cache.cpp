@@ -0,0 +1,113 @@
+/**
+ * dialScript Image Cache Implementation
+ */
+
+#include "../../include/vm/image_cache.h"
+#include <cstdio>
+
+namespace dialos {
+namespace vm {
+
+namespace {
+
+#if defined(ARDUINO)
+const size_t SHARED_BUDGET = 96 * 1024;         // A screenful of icons
+#else
+const size_t SHARED_BUDGET = 16 * 1024 * 1024;
+#endif
+
+} // namespace
+
+ImageCache::ImageCache(size_t budgetBytes) : budget_(budgetBytes) {}
+
+ImageCache& ImageCache::shared() {
+    static ImageCache cache(SHARED_BUDGET);
+    return cache;
+}
+
+ImageCache::ImagePtr ImageCache::find(const std::string& key) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = entries_.find(key);
+    if (it == entries_.end()) {
+        return nullptr;
+    }
+    recent_.splice(recent_.begin(), recent_, it->second.use);
+    stats_.hits++;
+    return it->second.image;
+}
+
+ImageCache::ImagePtr ImageCache::load(const std::string& key, const uint8_t* data, size_t size,
+                                      std::string& error) {
+    ImagePtr cached = find(key);
+    if (cached) {
+        return cached;
+    }
+
+    // Decode outside the lock; if another thread raced us, keep its copy
+    std::shared_ptr<Image> decoded = std::make_shared<Image>();
+    if (!image::decode(data, size, *decoded, error)) {
+        return nullptr;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats_.decodes++;
+    auto it = entries_.find(key);
+    if (it != entries_.end()) {
+        return it->second.image;
+    }
+    recent_.push_front(key);
+    Entry entry;
+    entry.image = decoded;
+    entry.use = recent_.begin();
+    entries_[key] = entry;
+    stats_.bytes += decoded->bytes();
+    trim();
+    return decoded;
+}
+
+std::string ImageCache::dataKey(const uint8_t* data, size_t size) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < size; i++) {
+        hash = (hash ^ data[i]) * 16777619u;
+    }
+    char key[32];
+    std::snprintf(key, sizeof(key), "data:%08x:%u", hash, static_cast<unsigned>(size));
+    return key;
+}
+
+void ImageCache::setBudget(size_t bytes) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    budget_ = bytes;
+    trim();
+}
+
+void ImageCache::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    entries_.clear();
+    recent_.clear();
+    stats_.bytes = 0;
+}
+
+ImageCache::Stats ImageCache::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+void ImageCache::trim() {
+    // Oldest first; images still held elsewhere can't be freed, so skip them
+    auto it = recent_.end();
+    while (stats_.bytes > budget_ && it != recent_.begin()) {
+        --it;
+        auto entry = entries_.find(*it);
+        if (entry->second.image.use_count() > 1) {
+            continue;
+        }
+        stats_.bytes -= entry->second.image->bytes();
+        stats_.evictions++;
+        entries_.erase(entry);
+        it = recent_.erase(it);
+    }
+}
+
+} // namespace vm
+} // namespace dialos
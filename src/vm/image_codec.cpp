@@ -0,0 +1,391 @@
+/**
+ * dialScript Image Codecs Implementation
+ */
+
+#include "../../include/vm/image_codec.h"
+#include "../../include/vm/raster.h"
+#include <cstring>
+
+namespace dialos {
+namespace vm {
+namespace image {
+
+namespace {
+
+const uint8_t RLE_MAGIC[4] = {'D', 'R', 'L', 'E'};
+const uint8_t QOI_MAGIC[4] = {'q', 'o', 'i', 'f'};
+const size_t QOI_HEADER = 14;
+const uint8_t QOI_END[8] = {0, 0, 0, 0, 0, 0, 0, 1};
+
+const uint8_t QOI_OP_INDEX = 0x00;
+const uint8_t QOI_OP_DIFF = 0x40;
+const uint8_t QOI_OP_LUMA = 0x80;
+const uint8_t QOI_OP_RUN = 0xC0;
+const uint8_t QOI_OP_RGB = 0xFE;
+const uint8_t QOI_OP_RGBA = 0xFF;
+const uint8_t QOI_MASK = 0xC0;
+
+// Preferred stand-in for transparent pixels (magenta), if the image
+// doesn't use it
+const uint16_t DEFAULT_KEY = 0xF81F;
+
+struct Rgba {
+    uint8_t r, g, b, a;
+
+    bool operator==(const Rgba& other) const {
+        return r == other.r && g == other.g && b == other.b && a == other.a;
+    }
+    bool operator!=(const Rgba& other) const { return !(*this == other); }
+    int hash() const { return (r * 3 + g * 5 + b * 7 + a * 11) % 64; }
+    uint16_t rgb565() const { return static_cast<uint16_t>(((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3)); }
+};
+
+uint16_t readU16(const uint8_t* p) {
+    return static_cast<uint16_t>((p[0] << 8) | p[1]);
+}
+
+uint32_t readU32(const uint8_t* p) {
+    return (static_cast<uint32_t>(p[0]) << 24) | (p[1] << 16) | (p[2] << 8) | p[3];
+}
+
+void writeU16(std::vector<uint8_t>& out, uint32_t value) {
+    out.push_back(static_cast<uint8_t>(value >> 8));
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+void writeU32(std::vector<uint8_t>& out, uint32_t value) {
+    writeU16(out, value >> 16);
+    writeU16(out, value);
+}
+
+bool startImage(uint32_t width, uint32_t height, Image& out, std::string& error) {
+    if (width == 0 || height == 0 || static_cast<uint64_t>(width) * height > MAX_PIXELS) {
+        error = "bad image size " + std::to_string(width) + "x" + std::to_string(height);
+        return false;
+    }
+    out.width = static_cast<int>(width);
+    out.height = static_cast<int>(height);
+    out.pixels.assign(static_cast<size_t>(width) * height, 0);
+    out.transparent = -1;
+    return true;
+}
+
+bool decodeRaw(const uint8_t* data, size_t size, Image& out, std::string& error) {
+    if (!startImage(readU16(data), readU16(data + 2), out, error)) {
+        return false;
+    }
+    if (size - 4 < out.pixels.size() * 2) {
+        error = "raw image is truncated";
+        return false;
+    }
+    raster::copyBigEndian(out.pixels.data(), data + 4, out.pixels.size());
+    return true;
+}
+
+bool decodeRle(const uint8_t* data, size_t size, Image& out, std::string& error) {
+    if (size < 8 || !startImage(readU16(data + 4), readU16(data + 6), out, error)) {
+        if (error.empty()) {
+            error = "RLE header is truncated";
+        }
+        return false;
+    }
+    const uint8_t* p = data + 8;
+    const uint8_t* end = data + size;
+    uint16_t* dst = out.pixels.data();
+    size_t left = out.pixels.size();
+    while (left > 0) {
+        if (p >= end) {
+            error = "RLE data is truncated";
+            return false;
+        }
+        uint8_t header = *p++;
+        size_t count = (header & 0x7F) + 1;
+        if (count > left) {
+            error = "RLE data overruns the image";
+            return false;
+        }
+        if (header & 0x80) {
+            if (end - p < 2) {
+                error = "RLE data is truncated";
+                return false;
+            }
+            raster::fill(dst, count, readU16(p));
+            p += 2;
+        } else {
+            if (static_cast<size_t>(end - p) < count * 2) {
+                error = "RLE data is truncated";
+                return false;
+            }
+            raster::copyBigEndian(dst, p, count);
+            p += count * 2;
+        }
+        dst += count;
+        left -= count;
+    }
+    return true;
+}
+
+// Pick a colour the image doesn't use to stand in for transparency
+uint16_t pickKey(const std::vector<uint16_t>& pixels, const std::vector<bool>& clear) {
+    std::vector<uint32_t> used(65536 / 32, 0);
+    for (size_t i = 0; i < pixels.size(); i++) {
+        if (!clear[i]) {
+            used[pixels[i] >> 5] |= 1u << (pixels[i] & 31);
+        }
+    }
+    if (!(used[DEFAULT_KEY >> 5] & (1u << (DEFAULT_KEY & 31)))) {
+        return DEFAULT_KEY;
+    }
+    for (uint32_t color = 0; color < 65536; color++) {
+        if (!(used[color >> 5] & (1u << (color & 31)))) {
+            return static_cast<uint16_t>(color);
+        }
+    }
+    return DEFAULT_KEY;     // Every colour is used: can't happen below 64K pixels
+}
+
+bool decodeQoi(const uint8_t* data, size_t size, Image& out, std::string& error) {
+    if (size < QOI_HEADER + sizeof(QOI_END)) {
+        error = "QOI header is truncated";
+        return false;
+    }
+    if (!startImage(readU32(data + 4), readU32(data + 8), out, error)) {
+        return false;
+    }
+    const uint8_t* p = data + QOI_HEADER;
+    const uint8_t* end = data + size - sizeof(QOI_END);     // Chunks never run into the end marker
+
+    Rgba index[64];
+    std::memset(index, 0, sizeof(index));
+    Rgba px = {0, 0, 0, 255};
+    int run = 0;
+    std::vector<bool> clear;
+    bool anyClear = false;
+
+    for (size_t i = 0; i < out.pixels.size(); i++) {
+        if (run > 0) {
+            run--;
+        } else {
+            if (p >= end) {
+                error = "QOI data is truncated";
+                return false;
+            }
+            uint8_t b1 = *p++;
+            if (b1 == QOI_OP_RGB || b1 == QOI_OP_RGBA) {
+                size_t need = b1 == QOI_OP_RGB ? 3 : 4;
+                if (static_cast<size_t>(end - p) < need) {
+                    error = "QOI data is truncated";
+                    return false;
+                }
+                px.r = p[0];
+                px.g = p[1];
+                px.b = p[2];
+                if (b1 == QOI_OP_RGBA) {
+                    px.a = p[3];
+                }
+                p += need;
+            } else if ((b1 & QOI_MASK) == QOI_OP_INDEX) {
+                px = index[b1];
+            } else if ((b1 & QOI_MASK) == QOI_OP_DIFF) {
+                px.r = static_cast<uint8_t>(px.r + ((b1 >> 4) & 0x03) - 2);
+                px.g = static_cast<uint8_t>(px.g + ((b1 >> 2) & 0x03) - 2);
+                px.b = static_cast<uint8_t>(px.b + (b1 & 0x03) - 2);
+            } else if ((b1 & QOI_MASK) == QOI_OP_LUMA) {
+                if (p >= end) {
+                    error = "QOI data is truncated";
+                    return false;
+                }
+                uint8_t b2 = *p++;
+                int vg = (b1 & 0x3F) - 32;
+                px.r = static_cast<uint8_t>(px.r + vg - 8 + ((b2 >> 4) & 0x0F));
+                px.g = static_cast<uint8_t>(px.g + vg);
+                px.b = static_cast<uint8_t>(px.b + vg - 8 + (b2 & 0x0F));
+            } else {
+                run = b1 & 0x3F;
+            }
+            index[px.hash()] = px;
+        }
+
+        out.pixels[i] = px.rgb565();
+        if (px.a < 128) {
+            if (!anyClear) {
+                clear.assign(out.pixels.size(), false);
+                anyClear = true;
+            }
+            clear[i] = true;
+        }
+    }
+
+    if (anyClear) {
+        uint16_t key = pickKey(out.pixels, clear);
+        for (size_t i = 0; i < out.pixels.size(); i++) {
+            if (clear[i]) {
+                out.pixels[i] = key;
+            }
+        }
+        out.transparent = key;
+    }
+    return true;
+}
+
+int base64Value(char c) {
+    if (c >= 'A' && c <= 'Z') return c - 'A';
+    if (c >= 'a' && c <= 'z') return c - 'a' + 26;
+    if (c >= '0' && c <= '9') return c - '0' + 52;
+    if (c == '+') return 62;
+    if (c == '/') return 63;
+    return -1;
+}
+
+} // namespace
+
+bool decode(const uint8_t* data, size_t size, Image& out, std::string& error) {
+    error.clear();
+    if (size >= 4 && std::memcmp(data, QOI_MAGIC, 4) == 0) {
+        return decodeQoi(data, size, out, error);
+    }
+    if (size >= 4 && std::memcmp(data, RLE_MAGIC, 4) == 0) {
+        return decodeRle(data, size, out, error);
+    }
+    if (size < 4) {
+        error = "image data is too short";
+        return false;
+    }
+    return decodeRaw(data, size, out, error);
+}
+
+std::vector<uint8_t> encodeRaw(int width, int height, const uint16_t* pixels) {
+    std::vector<uint8_t> out;
+    size_t count = static_cast<size_t>(width) * height;
+    out.reserve(4 + count * 2);
+    writeU16(out, width);
+    writeU16(out, height);
+    for (size_t i = 0; i < count; i++) {
+        writeU16(out, pixels[i]);
+    }
+    return out;
+}
+
+std::vector<uint8_t> encodeRle(int width, int height, const uint16_t* pixels) {
+    std::vector<uint8_t> out(RLE_MAGIC, RLE_MAGIC + 4);
+    writeU16(out, width);
+    writeU16(out, height);
+    size_t count = static_cast<size_t>(width) * height;
+    size_t i = 0;
+    while (i < count) {
+        size_t run = 1;
+        while (i + run < count && run < 128 && pixels[i + run] == pixels[i]) {
+            run++;
+        }
+        if (run >= 2) {
+            out.push_back(static_cast<uint8_t>(0x80 | (run - 1)));
+            writeU16(out, pixels[i]);
+            i += run;
+            continue;
+        }
+        // Literals up to the next pair of equal pixels
+        size_t literals = 1;
+        while (i + literals < count && literals < 128 &&
+               !(i + literals + 1 < count && pixels[i + literals] == pixels[i + literals + 1])) {
+            literals++;
+        }
+        out.push_back(static_cast<uint8_t>(literals - 1));
+        for (size_t k = 0; k < literals; k++) {
+            writeU16(out, pixels[i + k]);
+        }
+        i += literals;
+    }
+    return out;
+}
+
+std::vector<uint8_t> encodeQoi(int width, int height, const uint8_t* rgba) {
+    std::vector<uint8_t> out(QOI_MAGIC, QOI_MAGIC + 4);
+    writeU32(out, width);
+    writeU32(out, height);
+    out.push_back(4);       // RGBA
+    out.push_back(0);       // sRGB
+
+    Rgba index[64];
+    std::memset(index, 0, sizeof(index));
+    Rgba prev = {0, 0, 0, 255};
+    int run = 0;
+    size_t count = static_cast<size_t>(width) * height;
+    for (size_t i = 0; i < count; i++) {
+        Rgba px = {rgba[i * 4], rgba[i * 4 + 1], rgba[i * 4 + 2], rgba[i * 4 + 3]};
+        if (px == prev) {
+            run++;
+            if (run == 62 || i + 1 == count) {
+                out.push_back(static_cast<uint8_t>(QOI_OP_RUN | (run - 1)));
+                run = 0;
+            }
+            continue;
+        }
+        if (run > 0) {
+            out.push_back(static_cast<uint8_t>(QOI_OP_RUN | (run - 1)));
+            run = 0;
+        }
+        int slot = px.hash();
+        if (index[slot] == px) {
+            out.push_back(static_cast<uint8_t>(QOI_OP_INDEX | slot));
+        } else {
+            index[slot] = px;
+            if (px.a == prev.a) {
+                int vr = static_cast<int8_t>(px.r - prev.r);
+                int vg = static_cast<int8_t>(px.g - prev.g);
+                int vb = static_cast<int8_t>(px.b - prev.b);
+                int vgr = vr - vg;
+                int vgb = vb - vg;
+                if (vr > -3 && vr < 2 && vg > -3 && vg < 2 && vb > -3 && vb < 2) {
+                    out.push_back(static_cast<uint8_t>(QOI_OP_DIFF | (vr + 2) << 4 | (vg + 2) << 2 | (vb + 2)));
+                } else if (vgr > -9 && vgr < 8 && vg > -33 && vg < 32 && vgb > -9 && vgb < 8) {
+                    out.push_back(static_cast<uint8_t>(QOI_OP_LUMA | (vg + 32)));
+                    out.push_back(static_cast<uint8_t>((vgr + 8) << 4 | (vgb + 8)));
+                } else {
+                    out.push_back(QOI_OP_RGB);
+                    out.push_back(px.r);
+                    out.push_back(px.g);
+                    out.push_back(px.b);
+                }
+            } else {
+                out.push_back(QOI_OP_RGBA);
+                out.push_back(px.r);
+                out.push_back(px.g);
+                out.push_back(px.b);
+                out.push_back(px.a);
+            }
+        }
+        prev = px;
+    }
+    out.insert(out.end(), QOI_END, QOI_END + sizeof(QOI_END));
+    return out;
+}
+
+bool decodeBase64(const std::string& text, std::vector<uint8_t>& out) {
+    out.clear();
+    out.reserve(text.size() * 3 / 4);
+    uint32_t bits = 0;
+    int count = 0;
+    for (char c : text) {
+        if (c == '=') {
+            break;
+        }
+        if (c == ' ' || c == '\n' || c == '\r' || c == '\t') {
+            continue;
+        }
+        int value = base64Value(c);
+        if (value < 0) {
+            return false;
+        }
+        bits = (bits << 6) | static_cast<uint32_t>(value);
+        count += 6;
+        if (count >= 8) {
+            count -= 8;
+            out.push_back(static_cast<uint8_t>(bits >> count));
+        }
+    }
+    return true;
+}
+
+} // namespace image
+} // namespace vm
+} // namespace dialos
@@ -0,0 +1,208 @@
+/**
+ * dialScript IPC Bus Implementation
+ */
+
+#include "../../include/vm/ipc_bus.h"
+#include <cstring>
+
+namespace dialos {
+namespace vm {
+
+IpcBus::Message::Message(Message&& other)
+    : bus_(other.bus_), slot_(other.slot_), data_(other.data_), length_(other.length_),
+      sender_(std::move(other.sender_)) {
+    other.bus_ = nullptr;
+}
+
+IpcBus::Message& IpcBus::Message::operator=(Message&& other) {
+    if (this != &other) {
+        release();
+        bus_ = other.bus_;
+        slot_ = other.slot_;
+        data_ = other.data_;
+        length_ = other.length_;
+        sender_ = std::move(other.sender_);
+        other.bus_ = nullptr;
+    }
+    return *this;
+}
+
+void IpcBus::Message::release() {
+    if (bus_) {
+        std::lock_guard<std::mutex> guard(bus_->mutex_);
+        bus_->releaseSlot(slot_);
+        bus_ = nullptr;
+        data_ = nullptr;
+        length_ = 0;
+    }
+}
+
+IpcBus::IpcBus(size_t arenaBytes, size_t mailboxDepth)
+    : arena_(arenaBytes), mailboxDepth_(mailboxDepth), firstSlot_(0), head_(0), used_(0) {
+}
+
+bool IpcBus::join(const std::string& appId, WakeHandler wake) {
+    std::lock_guard<std::mutex> guard(mutex_);
+    if (mailboxes_.count(appId)) {
+        return false;
+    }
+    mailboxes_[appId].wake = wake;
+    return true;
+}
+
+void IpcBus::leave(const std::string& appId) {
+    std::lock_guard<std::mutex> guard(mutex_);
+    auto it = mailboxes_.find(appId);
+    if (it == mailboxes_.end()) {
+        return;
+    }
+    for (const Envelope& envelope : it->second.messages) {
+        releaseSlot(envelope.slot);
+    }
+    mailboxes_.erase(it);
+}
+
+bool IpcBus::allocate(uint32_t length, uint32_t& slot, uint32_t& offset) {
+    uint32_t capacity = static_cast<uint32_t>(arena_.size());
+    uint32_t size = length > 0 ? length : 1;
+    if (slots_.empty()) {
+        head_ = 0;
+    }
+    uint32_t tail = slots_.empty() ? 0 : slots_.front().offset;
+
+    if (slots_.empty() || head_ > tail) {
+        // Free space is [head, end) plus [0, tail)
+        if (capacity - head_ >= size) {
+            offset = head_;
+        } else if (tail > size) {
+            // Pad out the end so the payload stays contiguous
+            Slot padding = {head_, capacity - head_, true};
+            slots_.push_back(padding);
+            used_ += padding.size;
+            offset = 0;
+        } else {
+            return false;
+        }
+    } else {
+        // Wrapped: free space is [head, tail)
+        if (tail - head_ >= size) {
+            offset = head_;
+        } else {
+            return false;
+        }
+    }
+
+    Slot reserved = {offset, size, false};
+    slots_.push_back(reserved);
+    slot = firstSlot_ + static_cast<uint32_t>(slots_.size()) - 1;
+    head_ = offset + size;
+    used_ += size;
+    return true;
+}
+
+void IpcBus::releaseSlot(uint32_t slot) {
+    uint32_t index = slot - firstSlot_;
+    if (index >= slots_.size()) {
+        return;
+    }
+    slots_[index].released = true;
+    while (!slots_.empty() && slots_.front().released) {
+        used_ -= slots_.front().size;
+        slots_.pop_front();
+        firstSlot_++;
+    }
+}
+
+IpcBus::SendResult IpcBus::enqueue(Mailbox& box, const std::string& from, const char* data, uint32_t length) {
+    if (box.messages.size() >= mailboxDepth_) {
+        return SendResult::MAILBOX_FULL;
+    }
+    Envelope envelope;
+    if (!allocate(length, envelope.slot, envelope.offset)) {
+        return SendResult::NO_SPACE;
+    }
+    // The one copy: sender's bytes into the shared arena
+    if (length > 0) {
+        std::memcpy(&arena_[envelope.offset], data, length);
+    }
+    envelope.length = length;
+    envelope.sender = from;
+    box.messages.push_back(std::move(envelope));
+    return SendResult::OK;
+}
+
+IpcBus::SendResult IpcBus::send(const std::string& from, const std::string& to, const char* data, size_t length) {
+    std::lock_guard<std::mutex> guard(mutex_);
+    auto it = mailboxes_.find(to);
+    if (it == mailboxes_.end()) {
+        return SendResult::NO_SUCH_APP;
+    }
+    if (length > arena_.size()) {
+        return SendResult::NO_SPACE;
+    }
+    SendResult result = enqueue(it->second, from, data, static_cast<uint32_t>(length));
+    if (result == SendResult::OK && it->second.wake) {
+        it->second.wake();
+    }
+    return result;
+}
+
+size_t IpcBus::broadcast(const std::string& from, const char* data, size_t length) {
+    std::lock_guard<std::mutex> guard(mutex_);
+    if (length > arena_.size()) {
+        return 0;
+    }
+    size_t delivered = 0;
+    for (auto& kv : mailboxes_) {
+        if (kv.first == from) {
+            continue;
+        }
+        if (enqueue(kv.second, from, data, static_cast<uint32_t>(length)) == SendResult::OK) {
+            delivered++;
+            if (kv.second.wake) {
+                kv.second.wake();
+            }
+        }
+    }
+    return delivered;
+}
+
+bool IpcBus::receive(const std::string& appId, Message& out) {
+    std::lock_guard<std::mutex> guard(mutex_);
+    auto it = mailboxes_.find(appId);
+    if (it == mailboxes_.end() || it->second.messages.empty()) {
+        return false;
+    }
+    Envelope& envelope = it->second.messages.front();
+
+    // Hand the slot over; `out` releases whatever it held before
+    Message message;
+    message.bus_ = this;
+    message.slot_ = envelope.slot;
+    message.data_ = &arena_[0] + envelope.offset;
+    message.length_ = envelope.length;
+    message.sender_ = std::move(envelope.sender);
+    it->second.messages.pop_front();
+
+    if (out.bus_ == this) {
+        // Release under the lock we already hold
+        releaseSlot(out.slot_);
+        out.bus_ = nullptr;
+    }
+    out = std::move(message);
+    return true;
+}
+
+size_t IpcBus::pending(const std::string& appId) const {
+    std::lock_guard<std::mutex> guard(mutex_);
+    auto it = mailboxes_.find(appId);
+    return it == mailboxes_.end() ? 0 : it->second.messages.size();
+}
+
+size_t IpcBus::arenaUsed() const {
+    std::lock_guard<std::mutex> guard(mutex_);
+    return used_;
+}
+
+} // namespace vm
+} // namespace dialos
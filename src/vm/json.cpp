@@ -0,0 +1,447 @@
+/**
+ * dialScript JSON Implementation
+ */
+
+#include "../../include/vm/json.h"
+#include "../../include/vm/vm_value.h"
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace dialos {
+namespace vm {
+namespace json {
+
+namespace {
+
+class Parser {
+public:
+    Parser(const char* text, size_t length, ValuePool& pool)
+        : pos_(text), start_(text), end_(text + length), pool_(pool) {}
+
+    bool parseDocument(Value& out, std::string& error) {
+        skipSpace();
+        if (!parseValue(out, 0)) {
+            error = error_ + " at byte " + std::to_string(pos_ - start_);
+            return false;
+        }
+        skipSpace();
+        if (pos_ != end_) {
+            error = "Unexpected text after the value at byte " + std::to_string(pos_ - start_);
+            return false;
+        }
+        return true;
+    }
+
+private:
+    bool fail(const char* message) {
+        error_ = message;
+        return false;
+    }
+
+    void skipSpace() {
+        while (pos_ < end_ && (*pos_ == ' ' || *pos_ == '\t' || *pos_ == '\n' || *pos_ == '\r')) {
+            pos_++;
+        }
+    }
+
+    bool literal(const char* word, size_t length) {
+        if (static_cast<size_t>(end_ - pos_) < length || std::memcmp(pos_, word, length) != 0) {
+            return fail("Invalid literal");
+        }
+        pos_ += length;
+        return true;
+    }
+
+    bool parseValue(Value& out, int depth) {
+        if (pos_ >= end_) {
+            return fail("Unexpected end of input");
+        }
+        switch (*pos_) {
+            case '{':
+                return parseObject(out, depth + 1);
+            case '[':
+                return parseArray(out, depth + 1);
+            case '"': {
+                std::string text;
+                if (!parseString(text)) {
+                    return false;
+                }
+                std::string* pooled = pool_.allocateString(text);
+                if (!pooled) {
+                    return fail("Out of memory");
+                }
+                out = Value::StringFromPool(pooled);
+                return true;
+            }
+            case 't':
+                out = Value::Bool(true);
+                return literal("true", 4);
+            case 'f':
+                out = Value::Bool(false);
+                return literal("false", 5);
+            case 'n':
+                out = Value::Null();
+                return literal("null", 4);
+            default:
+                return parseNumber(out);
+        }
+    }
+
+    bool parseObject(Value& out, int depth) {
+        if (depth > MAX_DEPTH) {
+            return fail("Nested too deeply");
+        }
+        vm::Object* obj = pool_.allocateObject("Object");
+        if (!obj) {
+            return fail("Out of memory");
+        }
+        out = Value::Object(obj);
+        pos_++;
+        skipSpace();
+        if (pos_ < end_ && *pos_ == '}') {
+            pos_++;
+            return true;
+        }
+        std::string key;
+        while (true) {
+            skipSpace();
+            if (pos_ >= end_ || *pos_ != '"') {
+                return fail("Expected a key");
+            }
+            if (!parseString(key)) {
+                return false;
+            }
+            skipSpace();
+            if (pos_ >= end_ || *pos_ != ':') {
+                return fail("Expected ':'");
+            }
+            pos_++;
+            skipSpace();
+            Value member;
+            if (!parseValue(member, depth)) {
+                return false;
+            }
+            obj->fields[key] = member;
+            skipSpace();
+            if (pos_ < end_ && *pos_ == ',') {
+                pos_++;
+            } else if (pos_ < end_ && *pos_ == '}') {
+                pos_++;
+                return true;
+            } else {
+                return fail("Expected ',' or '}'");
+            }
+        }
+    }
+
+    bool parseArray(Value& out, int depth) {
+        if (depth > MAX_DEPTH) {
+            return fail("Nested too deeply");
+        }
+        vm::Array* arr = pool_.allocateArray();
+        if (!arr) {
+            return fail("Out of memory");
+        }
+        out = Value::Array(arr);
+        pos_++;
+        skipSpace();
+        if (pos_ < end_ && *pos_ == ']') {
+            pos_++;
+            return true;
+        }
+        while (true) {
+            skipSpace();
+            Value element;
+            if (!parseValue(element, depth)) {
+                return false;
+            }
+            arr->elements.push_back(element);
+            skipSpace();
+            if (pos_ < end_ && *pos_ == ',') {
+                pos_++;
+            } else if (pos_ < end_ && *pos_ == ']') {
+                pos_++;
+                return true;
+            } else {
+                return fail("Expected ',' or ']'");
+            }
+        }
+    }
+
+    bool hex4(uint32_t& code) {
+        if (end_ - pos_ < 4) {
+            return fail("Truncated \\u escape");
+        }
+        code = 0;
+        for (int i = 0; i < 4; i++) {
+            char c = *pos_++;
+            code <<= 4;
+            if (c >= '0' && c <= '9') {
+                code |= c - '0';
+            } else if (c >= 'a' && c <= 'f') {
+                code |= c - 'a' + 10;
+            } else if (c >= 'A' && c <= 'F') {
+                code |= c - 'A' + 10;
+            } else {
+                return fail("Invalid \\u escape");
+            }
+        }
+        return true;
+    }
+
+    static void appendUtf8(std::string& out, uint32_t code) {
+        if (code < 0x80) {
+            out += static_cast<char>(code);
+        } else if (code < 0x800) {
+            out += static_cast<char>(0xC0 | (code >> 6));
+            out += static_cast<char>(0x80 | (code & 0x3F));
+        } else if (code < 0x10000) {
+            out += static_cast<char>(0xE0 | (code >> 12));
+            out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (code & 0x3F));
+        } else {
+            out += static_cast<char>(0xF0 | (code >> 18));
+            out += static_cast<char>(0x80 | ((code >> 12) & 0x3F));
+            out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (code & 0x3F));
+        }
+    }
+
+    bool parseString(std::string& out) {
+        out.clear();
+        pos_++;
+        while (true) {
+            // Copy the plain run up to the next quote or escape in one go
+            const char* run = pos_;
+            while (pos_ < end_ && *pos_ != '"' && *pos_ != '\\' && static_cast<unsigned char>(*pos_) >= 0x20) {
+                pos_++;
+            }
+            out.append(run, pos_ - run);
+            if (pos_ >= end_) {
+                return fail("Unterminated string");
+            }
+            char c = *pos_++;
+            if (c == '"') {
+                return true;
+            }
+            if (c != '\\') {
+                pos_--;
+                return fail("Control character in string");
+            }
+            if (pos_ >= end_) {
+                return fail("Unterminated string");
+            }
+            switch (*pos_++) {
+                case '"': out += '"'; break;
+                case '\\': out += '\\'; break;
+                case '/': out += '/'; break;
+                case 'b': out += '\b'; break;
+                case 'f': out += '\f'; break;
+                case 'n': out += '\n'; break;
+                case 'r': out += '\r'; break;
+                case 't': out += '\t'; break;
+                case 'u': {
+                    uint32_t code;
+                    if (!hex4(code)) {
+                        return false;
+                    }
+                    // A surrogate pair encodes one code point above U+FFFF
+                    if (code >= 0xD800 && code < 0xDC00 && end_ - pos_ >= 6 && pos_[0] == '\\' && pos_[1] == 'u') {
+                        const char* mark = pos_;
+                        pos_ += 2;
+                        uint32_t low;
+                        if (!hex4(low)) {
+                            return false;
+                        }
+                        if (low >= 0xDC00 && low < 0xE000) {
+                            code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+                        } else {
+                            pos_ = mark;
+                        }
+                    }
+                    appendUtf8(out, code);
+                    break;
+                }
+                default:
+                    pos_--;
+                    return fail("Invalid escape");
+            }
+        }
+    }
+
+    bool parseNumber(Value& out) {
+        const char* begin = pos_;
+        bool integral = true;
+        if (pos_ < end_ && *pos_ == '-') {
+            pos_++;
+        }
+        if (pos_ >= end_ || *pos_ < '0' || *pos_ > '9') {
+            return fail("Unexpected character");
+        }
+        if (*pos_ == '0') {
+            pos_++;
+        } else {
+            while (pos_ < end_ && *pos_ >= '0' && *pos_ <= '9') {
+                pos_++;
+            }
+        }
+        if (pos_ < end_ && *pos_ == '.') {
+            integral = false;
+            pos_++;
+            if (pos_ >= end_ || *pos_ < '0' || *pos_ > '9') {
+                return fail("Expected a digit");
+            }
+            while (pos_ < end_ && *pos_ >= '0' && *pos_ <= '9') {
+                pos_++;
+            }
+        }
+        if (pos_ < end_ && (*pos_ == 'e' || *pos_ == 'E')) {
+            integral = false;
+            pos_++;
+            if (pos_ < end_ && (*pos_ == '+' || *pos_ == '-')) {
+                pos_++;
+            }
+            if (pos_ >= end_ || *pos_ < '0' || *pos_ > '9') {
+                return fail("Expected a digit");
+            }
+            while (pos_ < end_ && *pos_ >= '0' && *pos_ <= '9') {
+                pos_++;
+            }
+        }
+
+        // The input needn't be NUL-terminated: convert a copy
+        std::string digits(begin, pos_ - begin);
+        if (integral && digits.size() <= 11) {
+            long long whole = std::strtoll(digits.c_str(), nullptr, 10);
+            if (whole >= INT32_MIN && whole <= INT32_MAX) {
+                out = Value::Int32(static_cast<int32_t>(whole));
+                return true;
+            }
+        }
+        out = Value::Float32(static_cast<float>(std::strtod(digits.c_str(), nullptr)));
+        return true;
+    }
+
+    const char* pos_;
+    const char* start_;
+    const char* end_;
+    ValuePool& pool_;
+    std::string error_;
+};
+
+} // namespace
+
+void appendQuoted(const std::string& text, std::string& out) {
+    static const char HEX[] = "0123456789abcdef";
+    out += '"';
+    for (char c : text) {
+        switch (c) {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            case '\b': out += "\\b"; break;
+            case '\f': out += "\\f"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    out += "\\u00";
+                    out += HEX[(c >> 4) & 0xF];
+                    out += HEX[c & 0xF];
+                } else {
+                    out += c;
+                }
+        }
+    }
+    out += '"';
+}
+
+namespace {
+
+bool write(const Value& value, std::string& out, int depth) {
+    switch (value.type) {
+        case ValueType::BOOL:
+            out += value.boolVal ? "true" : "false";
+            return true;
+        case ValueType::INT32:
+            out += std::to_string(value.int32Val);
+            return true;
+        case ValueType::FLOAT32: {
+            if (!std::isfinite(value.float32Val)) {
+                out += "null";
+                return true;
+            }
+            char number[32];
+            std::snprintf(number, sizeof(number), "%.9g", static_cast<double>(value.float32Val));
+            out += number;
+            return true;
+        }
+        case ValueType::STRING:
+            appendQuoted(value.stringVal ? *value.stringVal : std::string(), out);
+            return true;
+        case ValueType::OBJECT: {
+            if (!value.objVal) {
+                break;
+            }
+            if (depth >= MAX_DEPTH) {
+                return false;
+            }
+            out += '{';
+            bool first = true;
+            for (const auto& field : value.objVal->fields) {
+                if (!first) {
+                    out += ',';
+                }
+                first = false;
+                appendQuoted(field.first, out);
+                out += ':';
+                if (!write(field.second, out, depth + 1)) {
+                    return false;
+                }
+            }
+            out += '}';
+            return true;
+        }
+        case ValueType::ARRAY: {
+            if (!value.arrayVal) {
+                break;
+            }
+            if (depth >= MAX_DEPTH) {
+                return false;
+            }
+            out += '[';
+            for (size_t i = 0; i < value.arrayVal->elements.size(); i++) {
+                if (i > 0) {
+                    out += ',';
+                }
+                if (!write(value.arrayVal->elements[i], out, depth + 1)) {
+                    return false;
+                }
+            }
+            out += ']';
+            return true;
+        }
+        default:
+            break;
+    }
+    out += "null";
+    return true;
+}
+
+} // namespace
+
+bool parse(const char* text, size_t length, ValuePool& pool, Value& out, std::string& error) {
+    Parser parser(text, length, pool);
+    return parser.parseDocument(out, error);
+}
+
+bool stringify(const Value& value, std::string& out) {
+    return write(value, out, 0);
+}
+
+} // namespace json
+} // namespace vm
+} // namespace dialos
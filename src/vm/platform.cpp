@@ -7,9 +7,14 @@
 #include "vm/platform.h"
 #include "vm/vm_value.h"
 #include "vm/vm_core.h"
+#include "vm/timer_service.h"
+#include "vm/ipc_bus.h"
+#include "vm/image_codec.h"
 #include <map>
 #include <sstream>
 #include <iomanip>
+#include <mutex>
+#include <thread>
 
 namespace dialos
 {
@@ -20,11 +25,57 @@ namespace dialos
             std::map<std::string, Value> callbacks;
         };
 
+        // Async native bookkeeping (shared between the VM thread and workers)
+        struct PlatformInterface::AsyncState {
+            std::mutex mutex;
+            AsyncToken nextToken = 1;
+            size_t pending = 0;                                 // Started, not yet processed
+            std::vector<std::pair<AsyncToken, std::string>> completed;
+            std::map<AsyncToken, std::thread> workers;
+            std::function<void()> wake;
+            // Latest download progress per URL, not yet delivered
+            struct Progress {
+                std::string url;
+                uint32_t received;
+                int64_t total;
+            };
+            std::vector<Progress> progress;
+        };
+
+        const uint32_t PlatformInterface::NO_TIMER_DEADLINE;
+
         // Constructor
         PlatformInterface::PlatformInterface() = default;
 
         // Destructor (must be defined in .cpp where CallbackRegistry is complete)
-        PlatformInterface::~PlatformInterface() = default;
+        PlatformInterface::~PlatformInterface()
+        {
+            attachIpc(nullptr, std::string());
+            joinAsyncWorkers();
+        }
+
+        void PlatformInterface::display_drawBitmap(int x, int y, const std::shared_ptr<const Image>& image,
+                                                   int sx, int sy, int w, int h, int32_t transparent)
+        {
+            std::vector<uint8_t> row;
+            for (int r = 0; r < h; r++) {
+                const uint16_t* src = image->pixels.data() + (sy + r) * image->width + sx;
+                if (transparent >= 0) {
+                    for (int c = 0; c < w; c++) {
+                        if (src[c] != transparent) {
+                            display_drawPixel(x + c, y + r, src[c]);
+                        }
+                    }
+                    continue;
+                }
+                row.assign({static_cast<uint8_t>(w >> 8), static_cast<uint8_t>(w), 0, 1});
+                for (int c = 0; c < w; c++) {
+                    row.push_back(static_cast<uint8_t>(src[c] >> 8));
+                    row.push_back(static_cast<uint8_t>(src[c]));
+                }
+                display_drawImage(x, y + r, row);
+            }
+        }
 
         void PlatformInterface::registerCallback(const std::string& eventName, const Value& callback)
         {
@@ -56,8 +107,9 @@ namespace dialos
         {
             // console_log("[DEBUG] Event occurred: " + eventName);
             
-            // Check if VM is initialized and still running
-            if (vm_ == nullptr || !vm_->isRunning())
+            // Check if VM is initialized and healthy. A VM whose main code has
+            // finished may still service callbacks (resident applets).
+            if (vm_ == nullptr || vm_->hasError())
             {
                 // console_log("[DEBUG] VM not running for event: " + eventName);
                 return false;
@@ -93,6 +145,309 @@ namespace dialos
             return success;
         }
 
+        std::vector<std::pair<std::string, Value>> PlatformInterface::getCallbacks() const
+        {
+            std::vector<std::pair<std::string, Value>> result;
+            if (callbacks_) {
+                for (const auto& kv : callbacks_->callbacks) {
+                    result.push_back(kv);
+                }
+            }
+            return result;
+        }
+
+        void PlatformInterface::clearCallbacks()
+        {
+            if (callbacks_) {
+                callbacks_->callbacks.clear();
+            }
+        }
+
+        TimerService& PlatformInterface::timerService()
+        {
+            if (!timers_) {
+                timers_ = std::unique_ptr<TimerService>(new TimerService());
+            }
+            return *timers_;
+        }
+
+        int PlatformInterface::timer_setTimeout(const Value& callback, int ms)
+        {
+            return timerService().setTimeout(callback, system_getTime(), ms > 0 ? static_cast<uint32_t>(ms) : 0);
+        }
+
+        int PlatformInterface::timer_setInterval(const Value& callback, int ms)
+        {
+            return timerService().setInterval(callback, system_getTime(), ms > 0 ? static_cast<uint32_t>(ms) : 1);
+        }
+
+        void PlatformInterface::timer_clearTimeout(int id)
+        {
+            if (timers_) {
+                timers_->cancel(id);
+            }
+        }
+
+        void PlatformInterface::timer_clearInterval(int id)
+        {
+            if (timers_) {
+                timers_->cancel(id);
+            }
+        }
+
+        PlatformInterface::AsyncState& PlatformInterface::asyncState()
+        {
+            if (!async_) {
+                async_ = std::unique_ptr<AsyncState>(new AsyncState());
+            }
+            return *async_;
+        }
+
+        AsyncToken PlatformInterface::startAsyncWorker(std::function<std::string()> work)
+        {
+            AsyncState& state = asyncState();
+            std::lock_guard<std::mutex> guard(state.mutex);
+            AsyncToken token = state.nextToken++;
+            if (state.nextToken == NO_ASYNC) {
+                state.nextToken = 1;
+            }
+            state.pending++;
+            state.workers[token] = std::thread([this, token, work]() {
+                completeAsync(token, work());
+            });
+            return token;
+        }
+
+        void PlatformInterface::completeAsync(AsyncToken token, const std::string& payload)
+        {
+            AsyncState& state = *async_;
+            std::function<void()> wake;
+            {
+                std::lock_guard<std::mutex> guard(state.mutex);
+                state.completed.push_back(std::make_pair(token, payload));
+                wake = state.wake;
+            }
+            if (wake) {
+                wake();
+            }
+        }
+
+        bool PlatformInterface::processAsyncCompletions()
+        {
+            if (!async_) {
+                return false;
+            }
+
+            std::vector<std::pair<AsyncToken, std::string>> completed;
+            std::vector<AsyncState::Progress> progress;
+            std::vector<std::thread> finished;
+            {
+                std::lock_guard<std::mutex> guard(async_->mutex);
+                completed.swap(async_->completed);
+                progress.swap(async_->progress);
+                for (const auto& result : completed) {
+                    auto it = async_->workers.find(result.first);
+                    if (it != async_->workers.end()) {
+                        finished.push_back(std::move(it->second));
+                        async_->workers.erase(it);
+                    }
+                    if (async_->pending > 0) {
+                        async_->pending--;
+                    }
+                }
+            }
+
+            // Workers have already produced their result; joining is immediate
+            for (auto& worker : finished) {
+                worker.join();
+            }
+            // Progress first: a download's last report precedes its result
+            bool delivered = false;
+            for (const auto& report : progress) {
+                if (vm_ == nullptr || getCallback("http.onProgress") == nullptr) {
+                    break;
+                }
+                std::vector<Value> args;
+                args.push_back(vm_->makeString(report.url.data(), report.url.size()));
+                args.push_back(Value::Int32(static_cast<int32_t>(report.received)));
+                args.push_back(Value::Int32(static_cast<int32_t>(report.total)));
+                delivered = invokeCallback("http.onProgress", args) || delivered;
+            }
+            for (const auto& result : completed) {
+                if (vm_ != nullptr) {
+                    vm_->completeAsync(result.first, result.second);
+                }
+            }
+            return delivered || !completed.empty();
+        }
+
+        bool PlatformInterface::hasPendingAsync() const
+        {
+            if (!async_) {
+                return false;
+            }
+            std::lock_guard<std::mutex> guard(async_->mutex);
+            return async_->pending > 0;
+        }
+
+        void PlatformInterface::setAsyncWakeHandler(std::function<void()> handler)
+        {
+            AsyncState& state = asyncState();
+            std::lock_guard<std::mutex> guard(state.mutex);
+            state.wake = handler;
+        }
+
+        void PlatformInterface::http_reportProgress(const std::string& url, uint32_t received, int64_t total)
+        {
+            AsyncState& state = asyncState();
+            std::function<void()> wake;
+            {
+                std::lock_guard<std::mutex> guard(state.mutex);
+                for (auto& report : state.progress) {
+                    if (report.url == url) {
+                        // Already queued (and the host woken): just update it
+                        report.received = received;
+                        report.total = total;
+                        return;
+                    }
+                }
+                AsyncState::Progress report = {url, received, total};
+                state.progress.push_back(report);
+                wake = state.wake;
+            }
+            if (wake) {
+                wake();
+            }
+        }
+
+        void PlatformInterface::joinAsyncWorkers()
+        {
+            if (!async_) {
+                return;
+            }
+            std::map<AsyncToken, std::thread> workers;
+            {
+                std::lock_guard<std::mutex> guard(async_->mutex);
+                workers.swap(async_->workers);
+            }
+            for (auto& kv : workers) {
+                kv.second.join();
+            }
+        }
+
+        void PlatformInterface::wakeHost()
+        {
+            if (!async_) {
+                return;
+            }
+            std::function<void()> wake;
+            {
+                std::lock_guard<std::mutex> guard(async_->mutex);
+                wake = async_->wake;
+            }
+            if (wake) {
+                wake();
+            }
+        }
+
+        bool PlatformInterface::attachIpc(IpcBus* bus, const std::string& appId)
+        {
+            if (ipc_) {
+                ipc_->leave(ipcAppId_);
+                ipc_ = nullptr;
+                ipcAppId_.clear();
+            }
+            if (bus == nullptr) {
+                return true;
+            }
+            // Senders run on other VMs' threads; create the wake slot up front
+            asyncState();
+            if (!bus->join(appId, [this]() { wakeHost(); })) {
+                return false;
+            }
+            ipc_ = bus;
+            ipcAppId_ = appId;
+            return true;
+        }
+
+        bool PlatformInterface::ipc_send(const std::string& appId, const std::string& message)
+        {
+            if (!ipc_) {
+                return false;
+            }
+            return ipc_->send(ipcAppId_, appId, message.data(), message.size()) == IpcBus::SendResult::OK;
+        }
+
+        void PlatformInterface::ipc_broadcast(const std::string& message)
+        {
+            if (ipc_) {
+                ipc_->broadcast(ipcAppId_, message.data(), message.size());
+            }
+        }
+
+        bool PlatformInterface::hasPendingIpc() const
+        {
+            // Messages wait in the mailbox until the app registers a handler
+            return ipc_ && ipc_->pending(ipcAppId_) > 0 && getCallback("ipc.onMessage") != nullptr;
+        }
+
+        bool PlatformInterface::processIpc()
+        {
+            if (!ipc_ || vm_ == nullptr || getCallback("ipc.onMessage") == nullptr) {
+                return false;
+            }
+
+            bool delivered = false;
+            IpcBus::Message message;
+            while (!vm_->hasError() && ipc_->receive(ipcAppId_, message)) {
+                // The payload is read straight out of the bus arena into the
+                // receiving VM's pool; its slot is freed by the next receive
+                std::vector<Value> args;
+                args.push_back(vm_->makeString(message.data(), message.size()));
+                args.push_back(vm_->makeString(message.sender().data(), message.sender().size()));
+                if (invokeCallback("ipc.onMessage", args)) {
+                    delivered = true;
+                }
+            }
+            return delivered;
+        }
+
+        bool PlatformInterface::processTimers()
+        {
+            if (!timers_ || timers_->empty() || vm_ == nullptr || vm_->hasError()) {
+                return false;
+            }
+
+            size_t fired = timers_->fireDue(system_getTime(), [this](TimerService::TimerId id, const Value& callback) {
+                // A callback that faulted the VM stops the rest of the round
+                if (vm_->hasError()) {
+                    return;
+                }
+                if (!vm_->invokeFunction(callback, std::vector<Value>())) {
+                    console_warn("Timer callback id=" + std::to_string(id) + " failed to invoke");
+                }
+            });
+
+            if (vm_->hasError()) {
+                // No point scheduling further callbacks into a faulted VM
+                timers_->clear();
+            }
+            return fired > 0;
+        }
+
+        uint32_t PlatformInterface::getNextTimerDelay()
+        {
+            if (!timers_) {
+                return NO_TIMER_DEADLINE;
+            }
+            return timers_->nextDelay(system_getTime());
+        }
+
+        bool PlatformInterface::hasTimers() const
+        {
+            return timers_ && !timers_->empty();
+        }
+
         void PlatformInterface::dumpVMState(const VMState &vm, size_t pc, const std::string &reason)
         {
             std::stringstream ss;
@@ -111,7 +466,7 @@ namespace dialos
             const auto &callstack = vm.getCallStack();
             for (size_t i = 0; i < callstack.size(); ++i) {
                 const auto &cf = callstack[i];
-                ss << "  Frame[" << i << "] func=" << cf.functionName << " stackBase=" << cf.stackBase << " locals={";
+                ss << "  Frame[" << i << "] func=" << cf.functionName.str() << " stackBase=" << cf.stackBase << " locals={";
                 bool first = true;
                 for (const auto &loc : cf.locals) {
                     if (!first) ss << ", "; first = false;
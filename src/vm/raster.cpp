@@ -0,0 +1,285 @@
+/**
+ * dialScript Raster Kernels Implementation
+ *
+ * Every vector kernel runs its main loop over whole vectors and leaves the
+ * last few pixels to the scalar reference, so the tails need no special
+ * cases. With AVX2 the 16-pixel loop is followed by the SSE2 one.
+ */
+
+#include "../../include/vm/raster.h"
+#include <cstring>
+
+#if !defined(DIALOS_RASTER_SCALAR)
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define DIALOS_RASTER_AVX2
+#define DIALOS_RASTER_SSE2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define DIALOS_RASTER_SSE2
+#elif defined(__ARM_NEON) && defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#include <arm_neon.h>
+#define DIALOS_RASTER_NEON
+#endif
+#endif
+
+// The word path swaps bytes inside a 32-bit load, which assumes the
+// pixels land in memory little-endian
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define DIALOS_RASTER_WORD_SWAP
+#endif
+
+namespace dialos {
+namespace vm {
+namespace raster {
+
+namespace {
+
+inline uint16_t blendPixel(uint16_t d, uint16_t s, int a) {
+    int dr = d >> 11, dg = (d >> 5) & 0x3F, db = d & 0x1F;
+    int sr = s >> 11, sg = (s >> 5) & 0x3F, sb = s & 0x1F;
+    int r = dr + (((sr - dr) * a) >> 8);
+    int g = dg + (((sg - dg) * a) >> 8);
+    int b = db + (((sb - db) * a) >> 8);
+    return static_cast<uint16_t>((r << 11) | (g << 5) | b);
+}
+
+// Floor of the square root, bit by bit (no floating point on the device)
+inline uint32_t isqrt(uint32_t n) {
+    uint32_t root = 0;
+    uint32_t bit = 1u << 30;
+    while (bit > n) {
+        bit >>= 2;
+    }
+    while (bit != 0) {
+        if (n >= root + bit) {
+            n -= root + bit;
+            root = (root >> 1) + bit;
+        } else {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+    return root;
+}
+
+} // namespace
+
+namespace scalar {
+
+void fill(uint16_t* dst, size_t count, uint16_t color) {
+    for (size_t i = 0; i < count; i++) {
+        dst[i] = color;
+    }
+}
+
+void copyBigEndian(uint16_t* dst, const uint8_t* src, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        dst[i] = static_cast<uint16_t>((src[i * 2] << 8) | src[i * 2 + 1]);
+    }
+}
+
+void copyKeyed(uint16_t* dst, const uint16_t* src, size_t count, uint16_t key) {
+    for (size_t i = 0; i < count; i++) {
+        if (src[i] != key) {
+            dst[i] = src[i];
+        }
+    }
+}
+
+void blend(uint16_t* dst, const uint16_t* src, size_t count, uint8_t alpha) {
+    int a = alpha + (alpha >> 7);
+    for (size_t i = 0; i < count; i++) {
+        dst[i] = blendPixel(dst[i], src[i], a);
+    }
+}
+
+} // namespace scalar
+
+const char* backend() {
+#if defined(DIALOS_RASTER_AVX2)
+    return "avx2";
+#elif defined(DIALOS_RASTER_SSE2)
+    return "sse2";
+#elif defined(DIALOS_RASTER_NEON)
+    return "neon";
+#else
+    return "word";
+#endif
+}
+
+void fill(uint16_t* dst, size_t count, uint16_t color) {
+    size_t i = 0;
+#if defined(DIALOS_RASTER_AVX2)
+    const __m256i wide = _mm256_set1_epi16(static_cast<short>(color));
+    for (; i + 16 <= count; i += 16) {
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), wide);
+    }
+#endif
+#if defined(DIALOS_RASTER_SSE2)
+    const __m128i value = _mm_set1_epi16(static_cast<short>(color));
+    for (; i + 8 <= count; i += 8) {
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), value);
+    }
+#elif defined(DIALOS_RASTER_NEON)
+    const uint16x8_t value = vdupq_n_u16(color);
+    for (; i + 8 <= count; i += 8) {
+        vst1q_u16(dst + i, value);
+    }
+#else
+    // Align to a word, then store two pixels at a time
+    if (count > 0 && (reinterpret_cast<uintptr_t>(dst) & 2) != 0) {
+        dst[i++] = color;
+    }
+    const uint32_t pair = color | (static_cast<uint32_t>(color) << 16);
+    for (; i + 2 <= count; i += 2) {
+        std::memcpy(dst + i, &pair, sizeof(pair));
+    }
+#endif
+    scalar::fill(dst + i, count - i, color);
+}
+
+void copyBigEndian(uint16_t* dst, const uint8_t* src, size_t count) {
+    size_t i = 0;
+#if defined(DIALOS_RASTER_AVX2)
+    for (; i + 16 <= count; i += 16) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i * 2));
+        v = _mm256_or_si256(_mm256_slli_epi16(v, 8), _mm256_srli_epi16(v, 8));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), v);
+    }
+#endif
+#if defined(DIALOS_RASTER_SSE2)
+    for (; i + 8 <= count; i += 8) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 2));
+        v = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), v);
+    }
+#elif defined(DIALOS_RASTER_NEON)
+    for (; i + 8 <= count; i += 8) {
+        uint8x16_t v = vrev16q_u8(vld1q_u8(src + i * 2));
+        vst1q_u16(dst + i, vreinterpretq_u16_u8(v));
+    }
+#elif defined(DIALOS_RASTER_WORD_SWAP)
+    for (; i + 2 <= count; i += 2) {
+        uint32_t word;
+        std::memcpy(&word, src + i * 2, sizeof(word));
+        word = ((word & 0x00FF00FFu) << 8) | ((word >> 8) & 0x00FF00FFu);
+        std::memcpy(dst + i, &word, sizeof(word));
+    }
+#endif
+    scalar::copyBigEndian(dst + i, src + i * 2, count - i);
+}
+
+void copyKeyed(uint16_t* dst, const uint16_t* src, size_t count, uint16_t key) {
+    size_t i = 0;
+#if defined(DIALOS_RASTER_AVX2)
+    const __m256i wideKey = _mm256_set1_epi16(static_cast<short>(key));
+    for (; i + 16 <= count; i += 16) {
+        __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+        __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + i));
+        __m256i keep = _mm256_cmpeq_epi16(s, wideKey);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_blendv_epi8(s, d, keep));
+    }
+#endif
+#if defined(DIALOS_RASTER_SSE2)
+    const __m128i keyValue = _mm_set1_epi16(static_cast<short>(key));
+    for (; i + 8 <= count; i += 8) {
+        __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+        __m128i keep = _mm_cmpeq_epi16(s, keyValue);
+        __m128i out = _mm_or_si128(_mm_and_si128(keep, d), _mm_andnot_si128(keep, s));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), out);
+    }
+#elif defined(DIALOS_RASTER_NEON)
+    const uint16x8_t keyValue = vdupq_n_u16(key);
+    for (; i + 8 <= count; i += 8) {
+        uint16x8_t s = vld1q_u16(src + i);
+        uint16x8_t d = vld1q_u16(dst + i);
+        vst1q_u16(dst + i, vbslq_u16(vceqq_u16(s, keyValue), d, s));
+    }
+#endif
+    scalar::copyKeyed(dst + i, src + i, count - i, key);
+}
+
+void blend(uint16_t* dst, const uint16_t* src, size_t count, uint8_t alpha) {
+    // Channels are unpacked into 16-bit lanes; (s - d) * a stays within
+    // +-63 * 256, so the low half of the product and an arithmetic shift
+    // give exactly the scalar result
+    size_t i = 0;
+#if defined(DIALOS_RASTER_SSE2) || defined(DIALOS_RASTER_NEON)
+    const short a = static_cast<short>(alpha + (alpha >> 7));
+#endif
+#if defined(DIALOS_RASTER_AVX2)
+    const __m256i wideA = _mm256_set1_epi16(a);
+    const __m256i wideG = _mm256_set1_epi16(0x3F);
+    const __m256i wideB = _mm256_set1_epi16(0x1F);
+    for (; i + 16 <= count; i += 16) {
+        __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+        __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + i));
+        __m256i dr = _mm256_srli_epi16(d, 11);
+        __m256i dg = _mm256_and_si256(_mm256_srli_epi16(d, 5), wideG);
+        __m256i db = _mm256_and_si256(d, wideB);
+        __m256i r = _mm256_sub_epi16(_mm256_srli_epi16(s, 11), dr);
+        __m256i g = _mm256_sub_epi16(_mm256_and_si256(_mm256_srli_epi16(s, 5), wideG), dg);
+        __m256i b = _mm256_sub_epi16(_mm256_and_si256(s, wideB), db);
+        r = _mm256_add_epi16(dr, _mm256_srai_epi16(_mm256_mullo_epi16(r, wideA), 8));
+        g = _mm256_add_epi16(dg, _mm256_srai_epi16(_mm256_mullo_epi16(g, wideA), 8));
+        b = _mm256_add_epi16(db, _mm256_srai_epi16(_mm256_mullo_epi16(b, wideA), 8));
+        __m256i out = _mm256_or_si256(_mm256_or_si256(_mm256_slli_epi16(r, 11), _mm256_slli_epi16(g, 5)), b);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), out);
+    }
+#endif
+#if defined(DIALOS_RASTER_SSE2)
+    const __m128i alphaValue = _mm_set1_epi16(a);
+    const __m128i maskG = _mm_set1_epi16(0x3F);
+    const __m128i maskB = _mm_set1_epi16(0x1F);
+    for (; i + 8 <= count; i += 8) {
+        __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+        __m128i dr = _mm_srli_epi16(d, 11);
+        __m128i dg = _mm_and_si128(_mm_srli_epi16(d, 5), maskG);
+        __m128i db = _mm_and_si128(d, maskB);
+        __m128i r = _mm_sub_epi16(_mm_srli_epi16(s, 11), dr);
+        __m128i g = _mm_sub_epi16(_mm_and_si128(_mm_srli_epi16(s, 5), maskG), dg);
+        __m128i b = _mm_sub_epi16(_mm_and_si128(s, maskB), db);
+        r = _mm_add_epi16(dr, _mm_srai_epi16(_mm_mullo_epi16(r, alphaValue), 8));
+        g = _mm_add_epi16(dg, _mm_srai_epi16(_mm_mullo_epi16(g, alphaValue), 8));
+        b = _mm_add_epi16(db, _mm_srai_epi16(_mm_mullo_epi16(b, alphaValue), 8));
+        __m128i out = _mm_or_si128(_mm_or_si128(_mm_slli_epi16(r, 11), _mm_slli_epi16(g, 5)), b);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), out);
+    }
+#elif defined(DIALOS_RASTER_NEON)
+    const int16x8_t alphaValue = vdupq_n_s16(a);
+    const uint16x8_t maskG = vdupq_n_u16(0x3F);
+    const uint16x8_t maskB = vdupq_n_u16(0x1F);
+    for (; i + 8 <= count; i += 8) {
+        uint16x8_t s = vld1q_u16(src + i);
+        uint16x8_t d = vld1q_u16(dst + i);
+        int16x8_t dr = vreinterpretq_s16_u16(vshrq_n_u16(d, 11));
+        int16x8_t dg = vreinterpretq_s16_u16(vandq_u16(vshrq_n_u16(d, 5), maskG));
+        int16x8_t db = vreinterpretq_s16_u16(vandq_u16(d, maskB));
+        int16x8_t r = vsubq_s16(vreinterpretq_s16_u16(vshrq_n_u16(s, 11)), dr);
+        int16x8_t g = vsubq_s16(vreinterpretq_s16_u16(vandq_u16(vshrq_n_u16(s, 5), maskG)), dg);
+        int16x8_t b = vsubq_s16(vreinterpretq_s16_u16(vandq_u16(s, maskB)), db);
+        r = vaddq_s16(dr, vshrq_n_s16(vmulq_s16(r, alphaValue), 8));
+        g = vaddq_s16(dg, vshrq_n_s16(vmulq_s16(g, alphaValue), 8));
+        b = vaddq_s16(db, vshrq_n_s16(vmulq_s16(b, alphaValue), 8));
+        uint16x8_t out = vorrq_u16(vorrq_u16(vshlq_n_u16(vreinterpretq_u16_s16(r), 11),
+                                             vshlq_n_u16(vreinterpretq_u16_s16(g), 5)),
+                                   vreinterpretq_u16_s16(b));
+        vst1q_u16(dst + i, out);
+    }
+#endif
+    scalar::blend(dst + i, src + i, count - i, alpha);
+}
+
+int circleHalfWidth(int radius, int dy) {
+    if (radius < 0 || dy < -radius || dy > radius) {
+        return -1;
+    }
+    return static_cast<int>(isqrt(static_cast<uint32_t>(radius * radius - dy * dy)));
+}
+
+} // namespace raster
+} // namespace vm
+} // namespace dialos
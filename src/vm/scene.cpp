@@ -0,0 +1,275 @@
+/**
+ * dialScript Retained Scene Implementation
+ */
+
+#include "../../include/vm/scene.h"
+#include "../../include/vm/image_codec.h"
+#include "../../include/vm/platform.h"
+#include <algorithm>
+#include <cstdlib>
+
+namespace dialos {
+namespace vm {
+
+namespace {
+
+bool sameRect(const Rect& a, const Rect& b) {
+    return a.x == b.x && a.y == b.y && a.w == b.w && a.h == b.h;
+}
+
+bool overlaps(const Rect& a, const Rect& b) {
+    return !a.intersected(b).empty();
+}
+
+// Sprite region, clipped to the image
+void spriteRegion(const Scene::Node& node, int32_t& w, int32_t& h) {
+    const Image& image = *node.image;
+    int32_t maxW = std::max(0, image.width - node.sx);
+    int32_t maxH = std::max(0, image.height - node.sy);
+    w = node.w > 0 ? std::min(node.w, maxW) : maxW;
+    h = node.h > 0 ? std::min(node.h, maxH) : maxH;
+}
+
+} // namespace
+
+const int32_t Scene::ROOT;
+const size_t Scene::MAX_NODES;
+const size_t Scene::MAX_REGIONS;
+
+Scene::Scene(int width, int height)
+    : width_(width), height_(height), background_(0), repaintAll_(true), nextSerial_(1), live_(0),
+      slots_(1) {
+    slots_[ROOT].live = true;
+}
+
+Scene::Slot* Scene::slot(int32_t id) {
+    if (id < 0 || static_cast<size_t>(id) >= slots_.size() || !slots_[id].live) {
+        return nullptr;
+    }
+    return &slots_[id];
+}
+
+int32_t Scene::create(Kind kind, int32_t parent) {
+    Slot* layer = slot(parent);
+    if (!layer || layer->node.kind != Kind::LAYER || live_ >= MAX_NODES) {
+        return 0;
+    }
+    int32_t id;
+    if (!free_.empty()) {
+        id = free_.back();
+        free_.pop_back();
+    } else {
+        id = static_cast<int32_t>(slots_.size());
+        slots_.emplace_back();
+    }
+    // emplace_back may have moved the parent
+    slots_[parent].children.push_back(id);
+    slots_[parent].resort = true;
+    Slot& created = slots_[id];
+    created = Slot();
+    created.node.kind = kind;
+    created.live = true;
+    created.parent = parent;
+    created.serial = nextSerial_++;
+    live_++;
+    return id;
+}
+
+Scene::Node* Scene::get(int32_t id) {
+    Slot* found = id == ROOT ? nullptr : slot(id);
+    return found ? &found->node : nullptr;
+}
+
+void Scene::update(int32_t id) {
+    Slot* found = slot(id);
+    if (found) {
+        found->changed = true;
+    }
+}
+
+bool Scene::remove(int32_t id) {
+    Slot* found = id == ROOT ? nullptr : slot(id);
+    if (!found) {
+        return false;
+    }
+    std::vector<int32_t>& siblings = slots_[found->parent].children;
+    siblings.erase(std::find(siblings.begin(), siblings.end(), id));
+    release(id);
+    return true;
+}
+
+void Scene::release(int32_t id) {
+    Slot& gone = slots_[id];
+    for (int32_t child : gone.children) {
+        release(child);
+    }
+    markDirty(gone.drawn);
+    gone = Slot();
+    free_.push_back(id);
+    live_--;
+}
+
+void Scene::setBackground(uint32_t color) {
+    if (color != background_) {
+        background_ = color;
+        repaintAll_ = true;
+    }
+}
+
+Rect Scene::bounds(const Slot& slot) const {
+    const Node& node = slot.node;
+    switch (node.kind) {
+        case Kind::RECT:
+            // Negative sizes extend up/left, as on the panel
+            return Rect(node.w < 0 ? slot.left + node.w + 1 : slot.left,
+                        node.h < 0 ? slot.top + node.h + 1 : slot.top, std::abs(node.w), std::abs(node.h));
+        case Kind::CIRCLE:
+            return Rect(slot.left - node.w, slot.top - node.w, node.w * 2 + 1, node.w * 2 + 1);
+        case Kind::TEXT:
+            return DisplayList::textBounds(slot.left, slot.top, node.text, node.size, width_, height_);
+        case Kind::SPRITE: {
+            if (!node.image) {
+                return Rect();
+            }
+            int32_t w, h;
+            spriteRegion(node, w, h);
+            return Rect(slot.left, slot.top, w, h);
+        }
+        case Kind::LAYER:
+            break;
+    }
+    return Rect();
+}
+
+void Scene::markDirty(const Rect& area) {
+    Rect merged = area.intersected(Rect(0, 0, width_, height_));
+    if (merged.empty()) {
+        return;
+    }
+    // Fold in every area it overlaps, until none is left
+    for (size_t i = 0; i < dirty_.size();) {
+        if (overlaps(dirty_[i], merged)) {
+            merged = merged.united(dirty_[i]);
+            dirty_.erase(dirty_.begin() + i);
+            i = 0;
+        } else {
+            i++;
+        }
+    }
+    dirty_.push_back(merged);
+    if (dirty_.size() > MAX_REGIONS) {
+        Rect all;
+        for (const Rect& region : dirty_) {
+            all = all.united(region);
+        }
+        dirty_.assign(1, all);
+    }
+}
+
+void Scene::walk(int32_t id, int32_t left, int32_t top, bool visible, bool changed) {
+    std::vector<int32_t>& children = slots_[id].children;
+    bool reordered = slots_[id].resort;
+    slots_[id].resort = false;
+    for (int32_t child : children) {
+        reordered = reordered || slots_[child].node.z != slots_[child].sortedZ;
+    }
+    if (reordered) {
+        std::stable_sort(children.begin(), children.end(), [this](int32_t a, int32_t b) {
+            const Slot& first = slots_[a];
+            const Slot& second = slots_[b];
+            return first.node.z != second.node.z ? first.node.z < second.node.z : first.serial < second.serial;
+        });
+    }
+
+    for (int32_t child : children) {
+        Slot& current = slots_[child];
+        bool shown = visible && current.node.visible;
+        bool moved = changed || current.changed || current.node.z != current.sortedZ;
+        current.changed = false;
+        current.sortedZ = current.node.z;
+        current.left = left + current.node.x;
+        current.top = top + current.node.y;
+
+        if (current.node.kind == Kind::LAYER) {
+            walk(child, current.left, current.top, shown, moved);
+            continue;
+        }
+        Rect area = shown ? bounds(current).intersected(Rect(0, 0, width_, height_)) : Rect();
+        if (moved || !sameRect(area, current.drawn)) {
+            markDirty(current.drawn);
+            markDirty(area);
+            current.drawn = area;
+        }
+        if (!area.empty()) {
+            paintOrder_.push_back(child);
+        }
+    }
+}
+
+void Scene::paint(PlatformInterface& platform, const Slot& slot) {
+    const Node& node = slot.node;
+    switch (node.kind) {
+        case Kind::RECT:
+            platform.display_drawRect(slot.left, slot.top, node.w, node.h, node.color, node.filled);
+            break;
+        case Kind::CIRCLE:
+            platform.display_drawCircle(slot.left, slot.top, node.w, node.color, node.filled);
+            break;
+        case Kind::TEXT:
+            platform.display_drawText(slot.left, slot.top, node.text, node.color, node.size);
+            break;
+        case Kind::SPRITE: {
+            int32_t w, h;
+            spriteRegion(node, w, h);
+            platform.display_drawBitmap(slot.left, slot.top, node.image, node.sx, node.sy, w, h,
+                                        node.transparent >= 0 ? node.transparent : node.image->transparent);
+            break;
+        }
+        case Kind::LAYER:
+            return;
+    }
+    stats_.primitives++;
+}
+
+int Scene::render(PlatformInterface& platform) {
+    paintOrder_.clear();
+    walk(ROOT, 0, 0, true, false);
+    Rect screen(0, 0, width_, height_);
+    if (repaintAll_) {
+        dirty_.assign(1, screen);
+        repaintAll_ = false;
+    }
+    if (dirty_.empty()) {
+        return 0;
+    }
+
+    bool clipped = platform.display_setClip(screen.x, screen.y, screen.w, screen.h);
+    if (!clipped) {
+        dirty_.assign(1, screen);
+    }
+    for (const Rect& area : dirty_) {
+        if (clipped) {
+            platform.display_setClip(area.x, area.y, area.w, area.h);
+        }
+        platform.display_drawRect(area.x, area.y, area.w, area.h, background_, true);
+        stats_.primitives++;
+        for (int32_t id : paintOrder_) {
+            if (overlaps(slots_[id].drawn, area)) {
+                paint(platform, slots_[id]);
+            }
+        }
+        stats_.pixels += area.area();
+    }
+    if (clipped) {
+        platform.display_clearClip();
+    }
+
+    int regions = static_cast<int>(dirty_.size());
+    stats_.renders++;
+    stats_.regions += regions;
+    dirty_.clear();
+    return regions;
+}
+
+} // namespace vm
+} // namespace dialos
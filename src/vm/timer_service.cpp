@@ -0,0 +1,213 @@
+/**
+ * dialScript Timer Service Implementation
+ */
+
+#include "../../include/vm/timer_service.h"
+#include <algorithm>
+
+namespace dialos {
+namespace vm {
+
+const TimerService::TimerId TimerService::INVALID_TIMER;
+const uint32_t TimerService::NO_DEADLINE;
+
+namespace {
+
+// std::*_heap build a max-heap; invert to keep the earliest deadline on top
+struct LaterFirst {
+    template <typename Entry>
+    bool operator()(const Entry& a, const Entry& b) const {
+        if (a.deadline != b.deadline) {
+            return a.deadline > b.deadline;
+        }
+        return a.seq > b.seq;
+    }
+};
+
+} // namespace
+
+TimerService::TimerService()
+    : nextId_(1), nextSeq_(0), lastNow_(0), epoch_(0) {
+}
+
+uint64_t TimerService::extend(uint32_t now) {
+    if (now < lastNow_ && lastNow_ - now > 0x80000000u) {
+        // The millisecond clock wrapped (every ~49.7 days)
+        epoch_ += 0x100000000ull;
+    }
+    lastNow_ = now;
+    return epoch_ + now;
+}
+
+TimerService::TimerId TimerService::setTimeout(const Value& callback, uint32_t now, uint32_t delayMs) {
+    return add(callback, extend(now) + delayMs, 0);
+}
+
+TimerService::TimerId TimerService::setInterval(const Value& callback, uint32_t now, uint32_t intervalMs) {
+    if (intervalMs == 0) {
+        intervalMs = 1;
+    }
+    return add(callback, extend(now) + intervalMs, intervalMs);
+}
+
+TimerService::TimerId TimerService::add(const Value& callback, uint64_t deadline, uint32_t intervalMs) {
+    TimerId id = nextId_++;
+    Timer timer;
+    timer.callback = callback;
+    timer.deadline = deadline;
+    timer.intervalMs = intervalMs;
+    timer.seq = 0;
+    Timer& stored = timers_.insert(std::make_pair(id, timer)).first->second;
+    push(id, stored);
+    return id;
+}
+
+void TimerService::push(TimerId id, Timer& timer) {
+    timer.seq = nextSeq_++;
+    HeapEntry entry;
+    entry.deadline = timer.deadline;
+    entry.seq = timer.seq;
+    entry.id = id;
+    heap_.push_back(entry);
+    std::push_heap(heap_.begin(), heap_.end(), LaterFirst());
+}
+
+bool TimerService::cancel(TimerId id) {
+    if (timers_.erase(id) == 0) {
+        return false;
+    }
+    // The heap entry goes stale; rebuild once stale entries dominate
+    if (heap_.size() > 2 * timers_.size() + 16) {
+        compact();
+    }
+    return true;
+}
+
+void TimerService::clear() {
+    timers_.clear();
+    heap_.clear();
+}
+
+void TimerService::compact() {
+    heap_.clear();
+    for (const auto& kv : timers_) {
+        HeapEntry entry;
+        entry.deadline = kv.second.deadline;
+        entry.seq = kv.second.seq;
+        entry.id = kv.first;
+        heap_.push_back(entry);
+    }
+    std::make_heap(heap_.begin(), heap_.end(), LaterFirst());
+}
+
+bool TimerService::dropStale() {
+    while (!heap_.empty()) {
+        const HeapEntry& top = heap_.front();
+        auto it = timers_.find(top.id);
+        if (it != timers_.end() && it->second.seq == top.seq) {
+            return true;
+        }
+        std::pop_heap(heap_.begin(), heap_.end(), LaterFirst());
+        heap_.pop_back();
+    }
+    return false;
+}
+
+uint32_t TimerService::nextDelay(uint32_t now) {
+    if (!dropStale()) {
+        return NO_DEADLINE;
+    }
+    uint64_t current = extend(now);
+    uint64_t deadline = heap_.front().deadline;
+    if (deadline <= current) {
+        return 0;
+    }
+    uint64_t delay = deadline - current;
+    return delay >= NO_DEADLINE ? NO_DEADLINE - 1 : static_cast<uint32_t>(delay);
+}
+
+std::vector<TimerService::Pending> TimerService::pending(uint32_t now) {
+    uint64_t current = extend(now);
+    std::vector<std::pair<uint64_t, TimerId>> order;
+    for (const auto& kv : timers_) {
+        // Deadline, then heap seq, is the order fireDue() would use
+        order.push_back(std::make_pair(kv.second.deadline, kv.first));
+    }
+    std::sort(order.begin(), order.end(), [this](const std::pair<uint64_t, TimerId>& a,
+                                                 const std::pair<uint64_t, TimerId>& b) {
+        if (a.first != b.first) {
+            return a.first < b.first;
+        }
+        return timers_.at(a.second).seq < timers_.at(b.second).seq;
+    });
+
+    std::vector<Pending> result;
+    for (const auto& entry : order) {
+        const Timer& timer = timers_.at(entry.second);
+        Pending pending;
+        pending.id = entry.second;
+        pending.callback = timer.callback;
+        pending.delayMs = timer.deadline > current ? static_cast<uint32_t>(timer.deadline - current) : 0;
+        pending.intervalMs = timer.intervalMs;
+        result.push_back(pending);
+    }
+    return result;
+}
+
+void TimerService::restore(const std::vector<Pending>& timers, TimerId nextId, uint32_t now) {
+    clear();
+    uint64_t current = extend(now);
+    for (const Pending& pending : timers) {
+        Timer timer;
+        timer.callback = pending.callback;
+        timer.deadline = current + pending.delayMs;
+        timer.intervalMs = pending.intervalMs;
+        timer.seq = 0;
+        Timer& stored = timers_.insert(std::make_pair(pending.id, timer)).first->second;
+        push(pending.id, stored);
+        if (pending.id >= nextId) {
+            nextId = pending.id + 1;
+        }
+    }
+    nextId_ = nextId;
+}
+
+size_t TimerService::fireDue(uint32_t now, const FireHandler& fire) {
+    uint64_t current = extend(now);
+    uint32_t roundSeq = nextSeq_;
+    size_t fired = 0;
+
+    while (dropStale()) {
+        HeapEntry top = heap_.front();
+        // Entries pushed during this round (new timers) wait for the next one
+        if (top.deadline > current || static_cast<int32_t>(top.seq - roundSeq) >= 0) {
+            break;
+        }
+        std::pop_heap(heap_.begin(), heap_.end(), LaterFirst());
+        heap_.pop_back();
+
+        auto it = timers_.find(top.id);
+        Value callback = it->second.callback;
+        if (it->second.intervalMs > 0) {
+            // Re-arm from the scheduled deadline, not from `now`; if whole
+            // periods were missed, skip them instead of firing a burst
+            Timer& timer = it->second;
+            timer.deadline += timer.intervalMs;
+            if (timer.deadline <= current) {
+                uint64_t missed = (current - timer.deadline) / timer.intervalMs + 1;
+                timer.deadline += missed * timer.intervalMs;
+            }
+            push(top.id, timer);
+        } else {
+            timers_.erase(it);
+        }
+
+        // Update state before the callback, which may cancel or add timers
+        fire(top.id, callback);
+        fired++;
+    }
+    return fired;
+}
+
+} // namespace vm
+} // namespace dialos
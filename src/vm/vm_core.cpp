@@ -5,6 +5,9 @@
  */
 
 #include "../../include/vm/vm_core.h"
+#include "../../include/vm/image_cache.h"
+#include "../../include/vm/json.h"
+#include <algorithm>
 #include <cstring>
 #include <sstream>
 #include <iostream>
@@ -15,19 +18,103 @@
 namespace dialos {
 namespace vm {
 
+namespace {
+
+compiler::StringRef makeRef(const std::string& str) {
+    compiler::StringRef ref = {str.data(), static_cast<uint16_t>(str.size())};
+    return ref;
+}
+
+// Key for looking a module name up in globals or object fields
+NameView nameView(const compiler::StringRef& ref) {
+    NameView view = {ref.data, ref.length};
+    return view;
+}
+
+} // namespace
+
 VMState::VMState(const compiler::BytecodeModule& module, ValuePool& pool, PlatformInterface& platform)
-    : module_(module), pool_(pool), platform_(platform), pc_(module.mainEntryPoint), running_(false), 
+    : module_(&module), pool_(pool), platform_(platform), pc_(module.mainEntryPoint), running_(false), 
       sleeping_(false), sleepUntil_(0) {
     
+    // Build a flat image over the module's tables so the interpreter has a
+    // single lookup path for both file-loaded and built-in modules
+    ownedStrings_.reserve(module.constants.size() + module.globals.size());
+    for (const auto& str : module.constants) {
+        ownedStrings_.push_back(makeRef(str));
+    }
+    for (const auto& name : module.globals) {
+        ownedStrings_.push_back(makeRef(name));
+    }
+    ownedFunctions_.reserve(module.functions.size());
+    for (size_t i = 0; i < module.functions.size(); i++) {
+        compiler::FunctionRef fn = {
+            makeRef(module.functions[i]),
+            i < module.functionEntryPoints.size() ? module.functionEntryPoints[i] : 0,
+            static_cast<uint8_t>(i < module.functionParamCounts.size() ? module.functionParamCounts[i] : 0)
+        };
+        ownedFunctions_.push_back(fn);
+    }
+    
+    image_.version = module.metadata.version;
+    image_.heapSize = module.metadata.heapSize;
+    image_.appName = makeRef(module.metadata.appName);
+    image_.appVersion = makeRef(module.metadata.appVersion);
+    image_.author = makeRef(module.metadata.author);
+    image_.code = module.code.data();
+    image_.codeSize = static_cast<uint32_t>(module.code.size());
+    image_.constants = ownedStrings_.data();
+    image_.constantCount = static_cast<uint16_t>(module.constants.size());
+    image_.globals = ownedStrings_.data() + module.constants.size();
+    image_.globalCount = static_cast<uint16_t>(module.globals.size());
+    image_.functions = ownedFunctions_.data();
+    image_.functionCount = static_cast<uint16_t>(ownedFunctions_.size());
+    image_.mainEntryPoint = module.mainEntryPoint;
+    
+    initialize();
+}
+
+VMState::VMState(const compiler::ModuleImage& image, ValuePool& pool, PlatformInterface& platform)
+    : module_(nullptr), image_(image), pool_(pool), platform_(platform), pc_(image.mainEntryPoint),
+      running_(false), sleeping_(false), sleepUntil_(0) {
+    initialize();
+}
+
+VMState::~VMState() {
+    if (platform_.getVM() == this) {
+        platform_.setVM(nullptr);
+    }
+}
+
+void VMState::initialize() {
     // Set VM reference in platform for callback invocation
     platform_.setVM(this);
     
-    // Copy code from module
-    code_ = module_.code;
+    awaitingToken_ = NO_ASYNC;
+    awaitingNative_ = NativeFunctionID::HTTP_GET;
+    callbackDepth_ = 0;
+    markEpoch_ = 0;
+#ifdef DIALOS_VM_PROFILE
+    instructionCount_ = 0;
+    nativeCalls_.assign(image_.functionCount, 0);
+#endif
+    sizeResult_ = nullptr;
+    textSizeResult_ = nullptr;
+    touchResult_ = nullptr;
+    
+    // Native calls dispatch on an ID; look each name up once, not per call
+    nativeIds_.resize(image_.functionCount);
+    for (uint16_t i = 0; i < image_.functionCount; i++) {
+        nativeIds_[i] = getNativeFunctionID(image_.functions[i].name.str());
+    }
+    
+    // Execute straight out of the module (no copy; built-in code stays in flash)
+    code_ = image_.code;
+    codeSize_ = image_.codeSize;
     
     // Initialize globals with null
-    for (const auto& name : module_.globals) {
-        globals_[name] = Value::Null();
+    for (uint16_t i = 0; i < image_.globalCount; i++) {
+        globals_[image_.globals[i].str()] = Value::Null();
     }
     
     // Initialize built-in 'os' object if present
@@ -107,10 +194,13 @@ VMState::VMState(const compiler::BytecodeModule& module, ValuePool& pool, Platfo
 }
 
 void VMState::reset() {
-    pc_ = module_.mainEntryPoint;
+    pc_ = image_.mainEntryPoint;
     running_ = true;
     sleeping_ = false;
     sleepUntil_ = 0;
+    // Results of operations started by the previous run are dropped
+    awaitingToken_ = NO_ASYNC;
+    asyncCallbacks_.clear();
     stack_.clear();
     callStack_.clear();
     exceptionHandlers_.clear();
@@ -124,6 +214,158 @@ void VMState::reset() {
     }
 }
 
+Value VMState::loadImage(const Value& source) {
+    ImageCache& cache = ImageCache::shared();
+    ImageCache::ImagePtr image;
+    std::string key;
+    std::string error;
+    
+    if (source.isString()) {
+        const std::string& text = *source.stringVal;
+        if (text.compare(0, 5, "data:") == 0) {
+            // data:[type];base64,payload - inline in the constant pool
+            size_t comma = text.find(',');
+            std::vector<uint8_t> bytes;
+            if (comma == std::string::npos || text.rfind(";base64", comma) == std::string::npos ||
+                !image::decodeBase64(text.substr(comma + 1), bytes)) {
+                error = "malformed data: string";
+            } else {
+                key = ImageCache::dataKey(bytes.data(), bytes.size());
+                image = cache.load(key, bytes.data(), bytes.size(), error);
+            }
+        } else {
+            key = "file:" + text;
+            image = loadImageFile(text, error);
+        }
+    } else if (source.isArray()) {
+        std::vector<uint8_t> bytes;
+        bytes.reserve(source.arrayVal->elements.size());
+        for (const Value& v : source.arrayVal->elements) {
+            bytes.push_back(v.isInt32() ? static_cast<uint8_t>(v.int32Val) : 0);
+        }
+        key = ImageCache::dataKey(bytes.data(), bytes.size());
+        image = cache.load(key, bytes.data(), bytes.size(), error);
+    } else {
+        error = "expected a path, a data: string or a byte array";
+    }
+    
+    if (!image) {
+        platform_.console_warn("loadImage: " + error);
+        return Value::Null();
+    }
+    
+    // One handle per image, however often it is loaded
+    size_t index = 0;
+    while (index < images_.size() && images_[index] != image) {
+        index++;
+    }
+    if (index == images_.size()) {
+        images_.push_back(image);
+        imageKeys_.push_back(key);
+    }
+    Object* imageObj = pool_.allocateObject("Image");
+    if (!imageObj) {
+        return Value::Null();
+    }
+    imageObj->fields["width"] = Value::Int32(image->width);
+    imageObj->fields["height"] = Value::Int32(image->height);
+    imageObj->fields["id"] = Value::Int32(static_cast<int32_t>(index + 1));
+    return Value::Object(imageObj);
+}
+
+std::shared_ptr<const Image> VMState::loadImageFile(const std::string& path, std::string& error) {
+    ImageCache& cache = ImageCache::shared();
+    std::string key = "file:" + path;
+    ImageCache::ImagePtr image = cache.find(key);
+    if (image) {
+        return image;
+    }
+    int size = platform_.file_size(path);
+    int handle = size > 0 ? platform_.file_open(path, "r") : -1;
+    if (handle < 0) {
+        error = "can't open " + path;
+        return nullptr;
+    }
+    std::string data = platform_.file_read(handle, size);
+    platform_.file_close(handle);
+    return cache.load(key, reinterpret_cast<const uint8_t*>(data.data()), data.size(), error);
+}
+
+std::shared_ptr<const Image> VMState::imageFor(const Value& value) const {
+    if (!value.isObject() || value.objVal->className != "Image") {
+        return nullptr;
+    }
+    auto it = value.objVal->fields.find("id");
+    if (it == value.objVal->fields.end() || !it->second.isInt32() || it->second.int32Val < 1 ||
+        static_cast<size_t>(it->second.int32Val) > images_.size()) {
+        return nullptr;
+    }
+    return images_[it->second.int32Val - 1];
+}
+
+Scene& VMState::scene() {
+    if (!scene_) {
+        scene_.reset(new Scene(platform_.display_getWidth(), platform_.display_getHeight()));
+    }
+    return *scene_;
+}
+
+Object* VMState::resultObject(Object*& cached, const char* className, const Value& into) {
+    if (into.isObject() && into.objVal) {
+        return into.objVal;
+    }
+    if (!cached) {
+        cached = pool_.allocateObject(className);
+    }
+    return cached;
+}
+
+void VMState::applyNodeProps(Scene::Node& node, const Value& props) {
+    if (!props.isObject()) {
+        return;
+    }
+    for (const auto& field : props.objVal->fields) {
+        const std::string& name = field.first;
+        const Value& value = field.second;
+        if (name == "text") {
+            node.text = value.toString();
+        } else if (name == "visible") {
+            node.visible = value.isTruthy();
+        } else if (name == "filled") {
+            node.filled = value.isTruthy();
+        } else if (name == "image") {
+            std::shared_ptr<const Image> image = imageFor(value);
+            if (image) {
+                node.image = image;
+            }
+        } else if (value.isInt32()) {
+            int32_t number = value.int32Val;
+            if (name == "x") node.x = number;
+            else if (name == "y") node.y = number;
+            else if (name == "w" || name == "r") node.w = number;
+            else if (name == "h") node.h = number;
+            else if (name == "z") node.z = number;
+            else if (name == "sx") node.sx = number;
+            else if (name == "sy") node.sy = number;
+            else if (name == "color") node.color = static_cast<uint32_t>(number);
+            else if (name == "transparent") node.transparent = number;
+            else if (name == "size") node.size = static_cast<uint8_t>(std::max(1, std::min(number, 255)));
+        }
+    }
+}
+
+std::map<std::string, uint64_t> VMState::getNativeCallCounts() const {
+    std::map<std::string, uint64_t> counts;
+#ifdef DIALOS_VM_PROFILE
+    for (size_t i = 0; i < nativeCalls_.size(); i++) {
+        if (nativeCalls_[i] > 0) {
+            counts[functionNameAt(i)] += nativeCalls_[i];
+        }
+    }
+#endif
+    return counts;
+}
+
 void VMState::checkSleepState() {
     if (sleeping_) {
         uint64_t currentTime = platform_.system_getTime();
@@ -147,8 +389,7 @@ bool VMState::invokeFunction(const Value& callback, const std::vector<Value>& ar
     // Validate argument count
     if (args.size() != func->paramCount) {
         // Set detailed error message for parameter count mismatch
-        std::string functionName = (func->functionIndex < module_.functions.size()) ? 
-                                 module_.functions[func->functionIndex] : "<callback>";
+        std::string functionName = functionNameAt(func->functionIndex);
         error_ = "Parameter count mismatch: function '" + functionName + 
                 "' expects " + std::to_string(func->paramCount) + 
                 " parameter(s), but " + std::to_string(args.size()) + " provided";
@@ -157,11 +398,11 @@ bool VMState::invokeFunction(const Value& callback, const std::vector<Value>& ar
     
     // Get function entry point
     uint32_t functionIndex = func->functionIndex;
-    if (functionIndex >= module_.functionEntryPoints.size()) {
+    if (functionIndex >= image_.functionCount) {
         return false;
     }
     
-    uint32_t entryPC = module_.functionEntryPoints[functionIndex];
+    uint32_t entryPC = image_.functions[functionIndex].entryPoint;
     
     // Save current state
     uint32_t savedPC = static_cast<uint32_t>(pc_);
@@ -171,8 +412,7 @@ bool VMState::invokeFunction(const Value& callback, const std::vector<Value>& ar
     CallFrame frame;
     frame.returnPC = savedPC;
     frame.stackBase = stack_.size();
-    frame.functionName = (functionIndex < module_.functions.size()) ? 
-                         module_.functions[functionIndex] : "<callback>";
+    frame.functionName = image_.functions[functionIndex].name;
     
     // Copy arguments to call frame locals (indexed by parameter number)
     for (uint8_t i = 0; i < args.size(); i++) {
@@ -194,6 +434,9 @@ bool VMState::invokeFunction(const Value& callback, const std::vector<Value>& ar
     bool wasRunning = running_;
     running_ = true;
     
+    // Async natives called from here complete synchronously: a nested
+    // frame can't be parked
+    callbackDepth_++;
     while (callStack_.size() >= callDepthBefore && !hasError() && running_) {
         VMResult result = step();
         if (result == VMResult::ERROR) {
@@ -217,12 +460,14 @@ bool VMState::invokeFunction(const Value& callback, const std::vector<Value>& ar
                 platform_.console_log("[VM] ERROR during callback - halting VM");
                 // Ensure VM is stopped so host/emulator can inspect state and report diagnostics
                 running_ = false;
+                callbackDepth_--;
                 return false;
         }
         if (result == VMResult::FINISHED) {
             break;
         }
     }
+    callbackDepth_--;
     
     // Check if callback execution left an error
     bool hadError = hasError();
@@ -256,12 +501,224 @@ bool VMState::invokeFunction(const Value& callback, const std::vector<Value>& ar
                             std::to_string((int)stackSizeAfter - (int)stackSizeBefore));
     }
     
-    // Clean up unreferenced strings after callback completes
-    pool_.garbageCollectStrings();
+    // Clean up unreferenced strings after callback completes. The callback
+    // may have interrupted main code (or another callback) that still holds
+    // strings, so only the unreachable ones go.
+    collectStrings();
     
     return !hasError();
 }
 
+VMResult VMState::callSlowNative(NativeFunctionID id, uint8_t argCount) {
+    // Argument count and usage message of each slow native
+    uint8_t required = 2;
+    const char* usage = "";
+    switch (id) {
+        case NativeFunctionID::FILE_READ:     usage = "read() requires 2 arguments"; break;
+        case NativeFunctionID::WIFI_CONNECT:  usage = "connect() requires 2 arguments"; break;
+        case NativeFunctionID::HTTP_GET:      usage = "get() requires 1 argument"; required = 1; break;
+        case NativeFunctionID::HTTP_POST:     usage = "post() requires 2 arguments"; break;
+        case NativeFunctionID::HTTP_DOWNLOAD: usage = "download() requires 2 arguments (url, filepath)"; break;
+        default: break;
+    }
+    
+    // An extra trailing function argument selects callback style:
+    // the call returns the token at once and the callback gets the result
+    Value callback = Value::Null();
+    if (argCount > required && peek().isFunction()) {
+        callback = pop();
+        argCount--;
+    }
+    if (argCount < required) {
+        setError(usage);
+        return VMResult::ERROR;
+    }
+    
+    // Pop arguments (last on top); ints travel as decimal strings. file.read
+    // takes only ints: as in the other file natives, a handle that isn't an
+    // int becomes -1 (never a real handle) and a size that isn't one 0.
+    std::vector<std::string> args(required);
+    for (uint8_t i = required; i < argCount; i++) pop();
+    for (int i = required - 1; i >= 0; i--) {
+        Value arg = pop();
+        if (id == NativeFunctionID::FILE_READ && !arg.isInt32()) {
+            args[i] = i == 0 ? "-1" : "0";
+        } else {
+            args[i] = arg.isInt32() ? std::to_string(arg.int32Val) : arg.toString();
+        }
+    }
+    
+    // Frames inside callbacks can't park; run those synchronously
+    bool canPark = callbackDepth_ == 0;
+    AsyncToken token = (canPark || callback.isFunction()) ? platform_.async_begin(id, args) : NO_ASYNC;
+    if (token != NO_ASYNC) {
+        if (callback.isFunction()) {
+            AsyncCallback pending = {id, callback};
+            asyncCallbacks_[token] = pending;
+            push(Value::Int32(static_cast<int32_t>(token)));
+            return VMResult::OK;
+        }
+        // Park: the result is pushed by completeAsync() and execution
+        // resumes at the next instruction
+        awaitingToken_ = token;
+        awaitingNative_ = id;
+        return VMResult::YIELD;
+    }
+    
+    std::string payload = runSlowNative(id, args);
+    if (callback.isFunction()) {
+        // No async support on this platform: call back straight away
+        std::vector<Value> callbackArgs(1, slowNativeResult(id, payload));
+        push(Value::Int32(0));
+        if (!invokeFunction(callback, callbackArgs) && hasError()) {
+            return VMResult::ERROR;
+        }
+        return VMResult::OK;
+    }
+    push(slowNativeResult(id, payload));
+    return VMResult::OK;
+}
+
+std::string VMState::runSlowNative(NativeFunctionID id, const std::vector<std::string>& args) {
+    switch (id) {
+        case NativeFunctionID::FILE_READ:
+            return platform_.file_read(std::atoi(args[0].c_str()), std::atoi(args[1].c_str()));
+        case NativeFunctionID::WIFI_CONNECT:
+            return platform_.wifi_connect(args[0], args[1]) ? "true" : "false";
+        case NativeFunctionID::HTTP_GET:
+            return platform_.http_get(args[0]);
+        case NativeFunctionID::HTTP_POST:
+            return platform_.http_post(args[0], args[1]);
+        case NativeFunctionID::HTTP_DOWNLOAD:
+            return platform_.http_download(args[0], args[1]);
+        default:
+            return "";
+    }
+}
+
+Value VMState::slowNativeResult(NativeFunctionID id, const std::string& payload) {
+    switch (id) {
+        case NativeFunctionID::FILE_READ:
+            return Value::String(payload);
+        case NativeFunctionID::WIFI_CONNECT:
+            return Value::Bool(payload == "true");
+        case NativeFunctionID::HTTP_DOWNLOAD:
+            return makeDownloadResult(payload);
+        default: {
+            std::string* pooledStr = pool_.allocateString(payload);
+            return pooledStr ? Value::StringFromPool(pooledStr) : Value::Null();
+        }
+    }
+}
+
+Value VMState::makeDownloadResult(const std::string& text) {
+    // The platform answers {"status":"success","bytes":n,"resumed":n,
+    // "crc32":"hex","filepath":"..."} or {"status":"error","message":"..."}
+    Value result = parseJson(text);
+    if (!result.isObject()) {
+        Object* resultObj = pool_.allocateObject("HttpDownloadResult");
+        if (!resultObj) {
+            return Value::Null();
+        }
+        resultObj->fields["message"] = makeString("Malformed download result", 25);
+        result = Value::Object(resultObj);
+    }
+    Object* resultObj = result.objVal;
+    resultObj->className = "HttpDownloadResult";
+    auto status = resultObj->fields.find("status");
+    if (status == resultObj->fields.end() || status->second.toString() != "success") {
+        resultObj->fields["status"] = makeString("error", 5);
+    }
+    return result;
+}
+
+Value VMState::parseJson(const std::string& text) {
+    Value result;
+    std::string error;
+    if (!json::parse(text.data(), text.size(), pool_, result, error)) {
+        platform_.console_warn("json.parse: " + error);
+        return Value::Null();
+    }
+    return result;
+}
+
+void VMState::completeAsync(AsyncToken token, const std::string& payload) {
+    if (token == NO_ASYNC) {
+        return;
+    }
+    
+    if (token == awaitingToken_) {
+        // Resume the parked frame as if the native had returned normally
+        awaitingToken_ = NO_ASYNC;
+        push(slowNativeResult(awaitingNative_, payload));
+        return;
+    }
+    
+    auto it = asyncCallbacks_.find(token);
+    if (it == asyncCallbacks_.end()) {
+        return;
+    }
+    AsyncCallback pending = it->second;
+    asyncCallbacks_.erase(it);
+    std::vector<Value> args(1, slowNativeResult(pending.native, payload));
+    invokeFunction(pending.callback, args);
+}
+
+Value VMState::makeString(const char* data, size_t length) {
+    std::string* str = pool_.allocateString(data, length);
+    return str ? Value::StringFromPool(str) : Value::Null();
+}
+
+// Add the pooled strings reachable from `value` to `live`. Objects and
+// arrays already stamped with `epoch` have been walked in this pass.
+static void markStrings(const Value& value, std::vector<std::string*>& live, uint32_t epoch) {
+    switch (value.type) {
+        case ValueType::STRING:
+            live.push_back(value.stringVal);
+            break;
+        case ValueType::OBJECT:
+            if (value.objVal && value.objVal->mark != epoch) {
+                value.objVal->mark = epoch;
+                for (const auto& field : value.objVal->fields) {
+                    markStrings(field.second, live, epoch);
+                }
+            }
+            break;
+        case ValueType::ARRAY:
+            if (value.arrayVal && value.arrayVal->mark != epoch) {
+                value.arrayVal->mark = epoch;
+                for (const auto& element : value.arrayVal->elements) {
+                    markStrings(element, live, epoch);
+                }
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+void VMState::collectStrings() {
+    // Runs after every callback, so the live list keeps its capacity and
+    // visited objects are stamped instead of collected into a set
+    liveStrings_.clear();
+    if (++markEpoch_ == 0) {
+        markEpoch_ = 1;
+    }
+    for (const auto& value : stack_) {
+        markStrings(value, liveStrings_, markEpoch_);
+    }
+    for (const auto& frame : callStack_) {
+        for (const auto& local : frame.locals) {
+            markStrings(local.second, liveStrings_, markEpoch_);
+        }
+    }
+    for (const auto& global : globals_) {
+        markStrings(global.second, liveStrings_, markEpoch_);
+    }
+    std::sort(liveStrings_.begin(), liveStrings_.end());
+    pool_.garbageCollectStrings(&liveStrings_);
+}
+
 Value VMState::pop() {
     if (stack_.empty()) {
         setError("Stack underflow");
@@ -294,13 +751,14 @@ void VMState::setError(const std::string& msg) {
 }
 
 Value VMState::loadConstant(uint16_t index) {
-    if (index >= module_.constants.size()) {
+    if (index >= image_.constantCount) {
         setError("Invalid constant index");
         return Value::Null();
     }
     
     // Allocate string in heap
-    std::string* str = pool_.allocateString(module_.constants[index]);
+    const compiler::StringRef& constant = image_.constants[index];
+    std::string* str = pool_.allocateString(constant.data, constant.length);
     if (!str) {
         setError("Out of memory allocating string constant");
         return Value::Null();
@@ -310,33 +768,38 @@ Value VMState::loadConstant(uint16_t index) {
 }
 
 Value VMState::loadGlobal(uint16_t index) {
-    if (index >= module_.globals.size()) {
+    if (index >= image_.globalCount) {
         setError("Invalid global index");
         return Value::Null();
     }
     
-    const std::string& name = module_.globals[index];
-    auto it = globals_.find(name);
+    const compiler::StringRef& name = image_.globals[index];
+    auto it = globals_.find(nameView(name));
     if (it != globals_.end()) {
         Value v = it->second;
         if (v.isNull()) {
-            platform_.console_log(std::string("loadGlobal: global '") + name + " is null");
+            platform_.console_log(std::string("loadGlobal: global '") + name.str() + " is null");
         }
         return v;
     }
     
-    platform_.console_log(std::string("loadGlobal: global '") + name + " not found, returning null");
+    platform_.console_log(std::string("loadGlobal: global '") + name.str() + " not found, returning null");
     return Value::Null();
 }
 
 void VMState::storeGlobal(uint16_t index, const Value& value) {
-    if (index >= module_.globals.size()) {
+    if (index >= image_.globalCount) {
         setError("Invalid global index");
         return;
     }
     
-    const std::string& name = module_.globals[index];
-    globals_[name] = value;
+    const compiler::StringRef& name = image_.globals[index];
+    auto it = globals_.find(nameView(name));
+    if (it != globals_.end()) {
+        it->second = value;
+    } else {
+        globals_[name.str()] = value;
+    }
     // Logging removed to reduce verbosity during normal operation
 }
 
@@ -351,9 +814,14 @@ VMResult VMState::execute(uint32_t maxInstructions) {
         return VMResult::YIELD;
     }
     
+    // Parked in an async native until the platform completes it
+    if (awaitingToken_ != NO_ASYNC) {
+        return VMResult::YIELD;
+    }
+    
     uint32_t executed = 0;
     
-    while (running_ && executed < maxInstructions && pc_ < code_.size()) {
+    while (running_ && executed < maxInstructions && pc_ < codeSize_) {
         VMResult result = executeInstruction();
         
         if (result != VMResult::OK) {
@@ -369,7 +837,7 @@ VMResult VMState::execute(uint32_t maxInstructions) {
         executed++;
     }
     
-    if (pc_ >= code_.size()) {
+    if (pc_ >= codeSize_) {
         running_ = false;
         return VMResult::FINISHED;
     }
@@ -378,12 +846,15 @@ VMResult VMState::execute(uint32_t maxInstructions) {
 }
 
 VMResult VMState::executeInstruction() {
-    if (pc_ >= code_.size()) {
+    if (pc_ >= codeSize_) {
         running_ = false;
         return VMResult::FINISHED;
     }
     
     compiler::Opcode op = static_cast<compiler::Opcode>(code_[pc_++]);
+#ifdef DIALOS_VM_PROFILE
+    instructionCount_++;
+#endif
     
     switch (op) {
         // ===== Stack Operations =====
@@ -691,20 +1162,14 @@ VMResult VMState::executeInstruction() {
             uint16_t funcIndex = readU16();
             uint8_t argCount = readU8();
             
-            if (funcIndex >= module_.functions.size()) {
+            if (funcIndex >= image_.functionCount) {
                 setError("Invalid function index: " + std::to_string(funcIndex));
                 return VMResult::ERROR;
             }
             
-            // Get function entry point
-            if (funcIndex >= module_.functionEntryPoints.size()) {
-                setError("Function entry point not found for: " + module_.functions[funcIndex]);
-                return VMResult::ERROR;
-            }
-            
-            uint32_t entryPoint = module_.functionEntryPoints[funcIndex];
+            uint32_t entryPoint = image_.functions[funcIndex].entryPoint;
             if (entryPoint == 0 && funcIndex != 0) { // Allow PC 0 for first function
-                setError("Function not defined: " + module_.functions[funcIndex]);
+                setError("Function not defined: " + image_.functions[funcIndex].name.str());
                 return VMResult::ERROR;
             }
             
@@ -712,7 +1177,7 @@ VMResult VMState::executeInstruction() {
             CallFrame frame;
             frame.returnPC = pc_;
             frame.stackBase = stack_.size() - argCount; // Arguments start here
-            frame.functionName = module_.functions[funcIndex];
+            frame.functionName = image_.functions[funcIndex].name;
             
             // Store arguments in local variables (0, 1, 2, ...)
             // Arguments are on stack in order: arg0, arg1, arg2, ...
@@ -736,18 +1201,19 @@ VMResult VMState::executeInstruction() {
             uint16_t funcIndex = readU16();
             uint8_t argCount = readU8();
             
-            if (funcIndex >= module_.functions.size()) {
+            if (funcIndex >= image_.functionCount) {
                 setError("Invalid native function index");
                 return VMResult::ERROR;
             }
+#ifdef DIALOS_VM_PROFILE
+            nativeCalls_[funcIndex]++;
+#endif
             
             // Stack layout: [..., receiver, arg1, arg2, ..., argN]
             // Arguments are on top, receiver is below them
             
-            const std::string& funcName = module_.functions[funcIndex];
-            
-            // Get native function ID from name
-            NativeFunctionID funcID = getNativeFunctionID(funcName);
+            // Resolved from the function's name when the VM was set up
+            NativeFunctionID funcID = nativeIds_[funcIndex];
             
             // Dispatch to native functions using switch (compiler can optimize to jump table)
             switch (funcID) {
@@ -801,6 +1267,10 @@ VMResult VMState::executeInstruction() {
                     Value colorVal = pop();
                     uint32_t color = colorVal.isInt32() ? static_cast<uint32_t>(colorVal.int32Val) : 0;
                     platform_.display_clear(color);
+                    if (scene_) {
+                        // The scene's pixels are gone; paint it all at the next render
+                        scene_->invalidate();
+                    }
                     
                     for (uint8_t i = 1; i < argCount; i++) pop();
                     push(Value::Null());
@@ -1126,20 +1596,10 @@ VMResult VMState::executeInstruction() {
                 }
                 
                 case NativeFunctionID::FILE_READ: {
-                    if (argCount < 2) {
-                        setError("read() requires 2 arguments");
-                        return VMResult::ERROR;
+                    VMResult result = callSlowNative(funcID, argCount);
+                    if (result != VMResult::OK) {
+                        return result;
                     }
-                    Value sizeVal = pop();
-                    Value handleVal = pop();
-                    
-                    std::string data = platform_.file_read(
-                        handleVal.isInt32() ? handleVal.int32Val : -1,
-                        sizeVal.isInt32() ? sizeVal.int32Val : 0
-                    );
-                    
-                    for (uint8_t i = 2; i < argCount; i++) pop();
-                    push(Value::String(data));
                     break;
                 }
                 
@@ -1217,6 +1677,83 @@ VMResult VMState::executeInstruction() {
                     break;
                 }
                 
+                case NativeFunctionID::FILE_READ_LINE: {
+                    if (argCount < 1) {
+                        setError("readLine() requires 1 argument");
+                        return VMResult::ERROR;
+                    }
+                    Value handleVal = pop();
+                    
+                    // null once the file is exhausted
+                    std::string line;
+                    bool got = platform_.file_readLine(handleVal.isInt32() ? handleVal.int32Val : -1, line);
+                    
+                    for (uint8_t i = 1; i < argCount; i++) pop();
+                    push(got ? makeString(line.data(), line.size()) : Value::Null());
+                    break;
+                }
+                
+                case NativeFunctionID::FILE_READ_BYTES: {
+                    if (argCount < 3) {
+                        setError("readBytes() requires 3 arguments (handle, array, count)");
+                        return VMResult::ERROR;
+                    }
+                    Value countVal = pop();
+                    Value arrayVal = pop();
+                    Value handleVal = pop();
+                    if (!arrayVal.isArray()) {
+                        setError("readBytes() requires an array argument");
+                        return VMResult::ERROR;
+                    }
+                    
+                    // The bytes replace the array's contents (0-255 each), so a
+                    // script can read a file block by block into one array
+                    int count = countVal.isInt32() ? countVal.int32Val : 0;
+                    std::vector<char> bytes(count > 0 ? count : 0);
+                    int got = count > 0 ? platform_.file_readBytes(handleVal.isInt32() ? handleVal.int32Val : -1,
+                                                                   bytes.data(), count)
+                                        : 0;
+                    std::vector<Value>& elements = arrayVal.arrayVal->elements;
+                    elements.resize(got > 0 ? got : 0);
+                    for (int i = 0; i < got; i++) {
+                        elements[i] = Value::Int32(static_cast<uint8_t>(bytes[i]));
+                    }
+                    
+                    for (uint8_t i = 3; i < argCount; i++) pop();
+                    push(Value::Int32(got));
+                    break;
+                }
+                
+                case NativeFunctionID::FILE_SEEK: {
+                    if (argCount < 2) {
+                        setError("seek() requires 2 arguments");
+                        return VMResult::ERROR;
+                    }
+                    Value positionVal = pop();
+                    Value handleVal = pop();
+                    
+                    bool moved = platform_.file_seek(handleVal.isInt32() ? handleVal.int32Val : -1,
+                                                     positionVal.isInt32() ? positionVal.int32Val : -1);
+                    
+                    for (uint8_t i = 2; i < argCount; i++) pop();
+                    push(Value::Bool(moved));
+                    break;
+                }
+                
+                case NativeFunctionID::FILE_TELL: {
+                    if (argCount < 1) {
+                        setError("tell() requires 1 argument");
+                        return VMResult::ERROR;
+                    }
+                    Value handleVal = pop();
+                    
+                    int position = platform_.file_tell(handleVal.isInt32() ? handleVal.int32Val : -1);
+                    
+                    for (uint8_t i = 1; i < argCount; i++) pop();
+                    push(Value::Int32(position));
+                    break;
+                }
+                
                 // ===== GPIO Functions =====
                 case NativeFunctionID::GPIO_PIN_MODE: {
                     if (argCount < 2) {
@@ -1415,19 +1952,25 @@ VMResult VMState::executeInstruction() {
                 
                 // ===== Timer Functions =====
                 case NativeFunctionID::TIMER_SET_TIMEOUT: {
-                    if (argCount < 1) {
-                        setError("setTimeout() requires 1 argument");
+                    // Expect: receiver, callback (function), ms (int)
+                    if (argCount < 2) {
+                        setError("setTimeout() requires 2 arguments (callback, ms)");
                         return VMResult::ERROR;
                     }
-                    // Stack layout: [..., receiver, callbackArgs..., arg0]
-                    // Compiler pushes arguments in order so the top of the stack is the last argument (ms)
+
+                    // Pop ms (top), then callback, then receiver
                     Value msVal = pop();
-                    // After popping arguments, the next value is the receiver
+                    Value callback = pop();
 
-                    int timerId = platform_.timer_setTimeout(msVal.isInt32() ? msVal.int32Val : 0);
+                    if (!callback.isFunction()) {
+                        setError("setTimeout() first argument must be a function");
+                        return VMResult::ERROR;
+                    }
 
-                    // Pop any additional args (if more than expected)
-                    for (uint8_t i = 1; i < argCount; i++) pop();
+                    int timerId = platform_.timer_setTimeout(callback, msVal.isInt32() ? msVal.int32Val : 0);
+
+                    // Pop any additional args beyond the expected two
+                    for (uint8_t i = 2; i < argCount; i++) pop();
                     push(Value::Int32(timerId));
                     break;
                 }
@@ -1572,10 +2115,11 @@ VMResult VMState::executeInstruction() {
                 
                 case NativeFunctionID::DISPLAY_GET_SIZE: {
                     
-                    for (uint8_t i = 0; i < argCount; i++) pop();
+                    for (uint8_t i = 1; i < argCount; i++) pop();
+                    Value intoVal = argCount >= 1 ? pop() : Value::Null();
                     
-                    // Create object with width and height
-                    Object* sizeObj = pool_.allocateObject("Size");
+                    // Fill the caller's object or the VM's reusable one
+                    Object* sizeObj = resultObject(sizeResult_, "Size", intoVal);
                     if (sizeObj) {
                         sizeObj->fields["width"] = Value::Int32(platform_.display_getWidth());
                         sizeObj->fields["height"] = Value::Int32(platform_.display_getHeight());
@@ -1586,35 +2130,249 @@ VMResult VMState::executeInstruction() {
                     break;
                 }
                 
-                case NativeFunctionID::DISPLAY_DRAW_IMAGE: {
-                    if (argCount < 3) {
-                        setError("drawImage() requires 3 arguments (x, y, imageData)");
+                case NativeFunctionID::DISPLAY_LOAD_IMAGE: {
+                    if (argCount < 1) {
+                        setError("loadImage() requires 1 argument (path, data: string or byte array)");
                         return VMResult::ERROR;
                     }
-                    
-                    Value imageDataVal = pop();
-                    Value yVal = pop();
-                    Value xVal = pop();
-                    
-                    // Convert image data to byte vector
-                    std::vector<uint8_t> imageData;
-                    if (imageDataVal.isArray()) {
-                        Array* arr = imageDataVal.arrayVal;
-                        for (const Value& v : arr->elements) {
+                    for (uint8_t i = 1; i < argCount; i++) pop();
+                    Value sourceVal = pop();
+                    push(loadImage(sourceVal));
+                    break;
+                }
+                
+                case NativeFunctionID::DISPLAY_DRAW_IMAGE:
+                case NativeFunctionID::DISPLAY_DRAW_IMAGE_REGION: {
+                    bool region = funcID == NativeFunctionID::DISPLAY_DRAW_IMAGE_REGION;
+                    uint8_t required = region ? 7 : 3;
+                    if (argCount < required) {
+                        setError(region ? "drawImageRegion() requires 7 arguments (x, y, image, sx, sy, w, h)"
+                                        : "drawImage() requires 3 arguments (x, y, imageData)");
+                        return VMResult::ERROR;
+                    }
+                    
+                    // x, y, image[, sx, sy, w, h][, transparent]
+                    std::vector<Value> args(argCount);
+                    for (int i = argCount - 1; i >= 0; i--) {
+                        args[i] = pop();
+                    }
+                    auto intArg = [&args](size_t i, int32_t fallback) {
+                        return i < args.size() && args[i].isInt32() ? args[i].int32Val : fallback;
+                    };
+                    int x = intArg(0, 0);
+                    int y = intArg(1, 0);
+                    
+                    std::shared_ptr<const Image> image = imageFor(args[2]);
+                    if (image) {
+                        // Decoded once by loadImage: one block copy
+                        int sx = region ? intArg(3, 0) : 0;
+                        int sy = region ? intArg(4, 0) : 0;
+                        int w = region ? intArg(5, 0) : image->width;
+                        int h = region ? intArg(6, 0) : image->height;
+                        if (sx < 0) {
+                            x -= sx;
+                            w += sx;
+                            sx = 0;
+                        }
+                        if (sy < 0) {
+                            y -= sy;
+                            h += sy;
+                            sy = 0;
+                        }
+                        w = std::min(w, image->width - sx);
+                        h = std::min(h, image->height - sy);
+                        if (w > 0 && h > 0) {
+                            platform_.display_drawBitmap(x, y, image, sx, sy, w, h,
+                                                         intArg(required, image->transparent));
+                        }
+                    } else if (!region && args[2].isArray()) {
+                        // Raw byte array, converted on every call
+                        std::vector<uint8_t> imageData;
+                        imageData.reserve(args[2].arrayVal->elements.size());
+                        for (const Value& v : args[2].arrayVal->elements) {
                             if (v.isInt32()) {
                                 imageData.push_back(static_cast<uint8_t>(v.int32Val));
                             }
                         }
+                        platform_.display_drawImage(x, y, imageData);
                     }
                     
-                    platform_.display_drawImage(
-                        xVal.isInt32() ? xVal.int32Val : 0,
-                        yVal.isInt32() ? yVal.int32Val : 0,
-                        imageData
-                    );
+                    push(Value::Null());
+                    break;
+                }
+                
+                case NativeFunctionID::DISPLAY_CREATE_LAYER:
+                case NativeFunctionID::DISPLAY_CREATE_RECT:
+                case NativeFunctionID::DISPLAY_CREATE_CIRCLE:
+                case NativeFunctionID::DISPLAY_CREATE_LABEL:
+                case NativeFunctionID::DISPLAY_CREATE_SPRITE: {
+                    // layer, then what the matching draw* call takes
+                    Scene::Kind kind;
+                    uint8_t required;
+                    const char* usage;
+                    switch (funcID) {
+                        case NativeFunctionID::DISPLAY_CREATE_RECT:
+                            kind = Scene::Kind::RECT;
+                            required = 6;
+                            usage = "createRect() requires 6 arguments (layer, x, y, w, h, color[, filled])";
+                            break;
+                        case NativeFunctionID::DISPLAY_CREATE_CIRCLE:
+                            kind = Scene::Kind::CIRCLE;
+                            required = 5;
+                            usage = "createCircle() requires 5 arguments (layer, x, y, r, color[, filled])";
+                            break;
+                        case NativeFunctionID::DISPLAY_CREATE_LABEL:
+                            kind = Scene::Kind::TEXT;
+                            required = 5;
+                            usage = "createLabel() requires 5 arguments (layer, x, y, text, color[, size])";
+                            break;
+                        case NativeFunctionID::DISPLAY_CREATE_SPRITE:
+                            kind = Scene::Kind::SPRITE;
+                            required = 4;
+                            usage = "createSprite() requires 4 arguments (layer, x, y, image[, sx, sy, w, h])";
+                            break;
+                        default:
+                            kind = Scene::Kind::LAYER;
+                            required = 0;
+                            usage = "";
+                            break;
+                    }
+                    if (argCount < required) {
+                        setError(usage);
+                        return VMResult::ERROR;
+                    }
+                    std::vector<Value> args(argCount);
+                    for (int i = argCount - 1; i >= 0; i--) {
+                        args[i] = pop();
+                    }
+                    auto intArg = [&args](size_t i, int32_t fallback) {
+                        return i < args.size() && args[i].isInt32() ? args[i].int32Val : fallback;
+                    };
+                    
+                    std::shared_ptr<const Image> image;
+                    if (kind == Scene::Kind::SPRITE) {
+                        image = imageFor(args[3]);
+                        if (!image) {
+                            push(Value::Int32(0));
+                            break;
+                        }
+                    }
+                    int32_t id = scene().create(kind, intArg(0, Scene::ROOT));
+                    Scene::Node* node = scene().get(id);
+                    if (node) {
+                        node->x = intArg(1, 0);
+                        node->y = intArg(2, 0);
+                        switch (kind) {
+                            case Scene::Kind::RECT:
+                                node->w = intArg(3, 0);
+                                node->h = intArg(4, 0);
+                                node->color = static_cast<uint32_t>(intArg(5, 0xFFFF));
+                                node->filled = argCount < 7 || args[6].isTruthy();
+                                break;
+                            case Scene::Kind::CIRCLE:
+                                node->w = intArg(3, 0);
+                                node->color = static_cast<uint32_t>(intArg(4, 0xFFFF));
+                                node->filled = argCount < 6 || args[5].isTruthy();
+                                break;
+                            case Scene::Kind::TEXT:
+                                node->text = args[3].toString();
+                                node->color = static_cast<uint32_t>(intArg(4, 0xFFFF));
+                                node->size = static_cast<uint8_t>(std::max(1, std::min(intArg(5, 1), 255)));
+                                break;
+                            case Scene::Kind::SPRITE:
+                                node->image = image;
+                                node->sx = std::max(0, intArg(4, 0));
+                                node->sy = std::max(0, intArg(5, 0));
+                                node->w = intArg(6, 0);
+                                node->h = intArg(7, 0);
+                                break;
+                            case Scene::Kind::LAYER:
+                                node->x = 0;
+                                node->y = 0;
+                                break;
+                        }
+                    }
+                    push(Value::Int32(id));
+                    break;
+                }
+                
+                case NativeFunctionID::DISPLAY_SET_NODE:
+                case NativeFunctionID::DISPLAY_MOVE_NODE: {
+                    bool move = funcID == NativeFunctionID::DISPLAY_MOVE_NODE;
+                    uint8_t required = move ? 3 : 2;
+                    if (argCount < required) {
+                        setError(move ? "moveNode() requires 3 arguments (node, x, y)"
+                                      : "setNode() requires 2 arguments (node, props)");
+                        return VMResult::ERROR;
+                    }
+                    for (uint8_t i = required; i < argCount; i++) pop();
+                    Value yVal = move ? pop() : Value::Null();
+                    Value propsVal = pop();     // x when moving
+                    Value idVal = pop();
                     
+                    int32_t id = idVal.isInt32() ? idVal.int32Val : 0;
+                    Scene::Node* node = scene().get(id);
+                    if (node) {
+                        if (move) {
+                            node->x = propsVal.isInt32() ? propsVal.int32Val : node->x;
+                            node->y = yVal.isInt32() ? yVal.int32Val : node->y;
+                        } else {
+                            applyNodeProps(*node, propsVal);
+                        }
+                        scene().update(id);
+                    }
+                    push(Value::Bool(node != nullptr));
+                    break;
+                }
+                
+                case NativeFunctionID::DISPLAY_REMOVE_NODE: {
+                    if (argCount < 1) {
+                        setError("removeNode() requires 1 argument (node)");
+                        return VMResult::ERROR;
+                    }
+                    for (uint8_t i = 1; i < argCount; i++) pop();
+                    Value idVal = pop();
+                    push(Value::Bool(idVal.isInt32() && scene().remove(idVal.int32Val)));
+                    break;
+                }
+                
+                case NativeFunctionID::DISPLAY_RENDER: {
+                    for (uint8_t i = 1; i < argCount; i++) pop();
+                    if (argCount >= 1) {
+                        Value backgroundVal = pop();
+                        if (backgroundVal.isInt32()) {
+                            scene().setBackground(static_cast<uint32_t>(backgroundVal.int32Val));
+                        }
+                    }
+                    push(Value::Int32(scene().render(platform_)));
+                    break;
+                }
+                
+                case NativeFunctionID::DISPLAY_MEASURE_TEXT: {
+                    if (argCount < 1) {
+                        setError("measureText() requires at least 1 argument (text, size?)");
+                        return VMResult::ERROR;
+                    }
                     for (uint8_t i = 3; i < argCount; i++) pop();
-                    push(Value::Null());
+                    Value intoVal = argCount >= 3 ? pop() : Value::Null();
+                    int size = 1;
+                    if (argCount >= 2) {
+                        Value sizeVal = pop();
+                        size = sizeVal.isInt32() ? std::max(1, std::min(sizeVal.int32Val, 255)) : 1;
+                    }
+                    Value textVal = pop();
+                    
+                    // Same metrics drawText uses on every platform (6x8 cells)
+                    int32_t width, height;
+                    DisplayList::measureText(textVal.toString(), size, width, height);
+                    Object* sizeObj = resultObject(textSizeResult_, "Size", intoVal);
+                    if (sizeObj) {
+                        sizeObj->fields["width"] = Value::Int32(width);
+                        sizeObj->fields["height"] = Value::Int32(height);
+                        push(Value::Object(sizeObj));
+                    } else {
+                        push(Value::Null());
+                    }
                     break;
                 }
                 
@@ -1624,16 +2382,19 @@ VMResult VMState::executeInstruction() {
                     
                     platform_.system_yield();
                     push(Value::Null());
-                    break;
+                    // End the slice so the host (or VMScheduler) can run other work
+                    return VMResult::YIELD;
                 }
                 
                 // ===== Touch Functions =====
                 case NativeFunctionID::TOUCH_GET_POSITION: {
                     
-                    for (uint8_t i = 0; i < argCount; i++) pop();
+                    for (uint8_t i = 1; i < argCount; i++) pop();
+                    Value intoVal = argCount >= 1 ? pop() : Value::Null();
                     
-                    // Create object with x, y, and pressed state
-                    Object* posObj = pool_.allocateObject("TouchPosition");
+                    // x, y and pressed state, in the caller's object or the
+                    // VM's reusable one
+                    Object* posObj = resultObject(touchResult_, "TouchPosition", intoVal);
                     if (posObj) {
                         posObj->fields["x"] = Value::Int32(platform_.touch_getX());
                         posObj->fields["y"] = Value::Int32(platform_.touch_getY());
@@ -1930,17 +2691,10 @@ VMResult VMState::executeInstruction() {
                 
                 // ===== WiFi Functions =====
                 case NativeFunctionID::WIFI_CONNECT: {
-                    if (argCount < 2) {
-                        setError("connect() requires 2 arguments");
-                        return VMResult::ERROR;
+                    VMResult result = callSlowNative(funcID, argCount);
+                    if (result != VMResult::OK) {
+                        return result;
                     }
-                    Value passwordVal = pop();
-                    Value ssidVal = pop();
-                    
-                    bool connected = platform_.wifi_connect(ssidVal.toString(), passwordVal.toString());
-                    
-                    for (uint8_t i = 2; i < argCount; i++) pop();
-                    push(Value::Bool(connected));
                     break;
                 }
                 
@@ -1992,111 +2746,31 @@ VMResult VMState::executeInstruction() {
                 }
                 
                 // ===== HTTP Functions =====
-                case NativeFunctionID::HTTP_GET: {
-                    if (argCount < 1) {
-                        setError("get() requires 1 argument");
-                        return VMResult::ERROR;
-                    }
-                    Value urlVal = pop();
-                    
-                    std::string response = platform_.http_get(urlVal.toString());
-                    
-                    for (uint8_t i = 1; i < argCount; i++) pop();
-                    std::string* pooledStr = pool_.allocateString(response);
-                    if (pooledStr) {
-                        push(Value::StringFromPool(pooledStr));
-                    } else {
-                        push(Value::Null());
+                case NativeFunctionID::HTTP_GET:
+                case NativeFunctionID::HTTP_POST:
+                case NativeFunctionID::HTTP_DOWNLOAD: {
+                    VMResult result = callSlowNative(funcID, argCount);
+                    if (result != VMResult::OK) {
+                        return result;
                     }
                     break;
                 }
                 
-                case NativeFunctionID::HTTP_POST: {
-                    if (argCount < 2) {
-                        setError("post() requires 2 arguments");
+                case NativeFunctionID::HTTP_ON_PROGRESS: {
+                    if (argCount < 1) {
+                        setError("onProgress() requires 1 argument");
                         return VMResult::ERROR;
                     }
-                    Value dataVal = pop();
-                    Value urlVal = pop();
-                    
-                    std::string response = platform_.http_post(urlVal.toString(), dataVal.toString());
+                    Value callback = pop();
+                    for (uint8_t i = 1; i < argCount; i++) pop();
                     
-                    for (uint8_t i = 2; i < argCount; i++) pop();
-                    std::string* pooledStr = pool_.allocateString(response);
-                    if (pooledStr) {
-                        push(Value::StringFromPool(pooledStr));
-                    } else {
-                        push(Value::Null());
-                    }
-                    break;
-                }
-                
-                case NativeFunctionID::HTTP_DOWNLOAD: {
-                    if (argCount < 2) {
-                        setError("download() requires 2 arguments (url, filepath)");
+                    if (!callback.isFunction()) {
+                        setError("onProgress() requires a function argument");
                         return VMResult::ERROR;
                     }
-                    Value filepathVal = pop();
-                    Value urlVal = pop();
-                    
-                    std::string result = platform_.http_download(urlVal.toString(), filepathVal.toString());
                     
-                    for (uint8_t i = 2; i < argCount; i++) pop();
-                    
-                    // Parse JSON result and convert to DialScript object
-                    Object* resultObj = pool_.allocateObject("HttpDownloadResult");
-                    if (resultObj) {
-                        // Simple JSON parsing for our known format
-                        if (result.find("\"status\":\"success\"") != std::string::npos) {
-                            resultObj->fields["status"] = Value::String("success");
-                            
-                            // Extract bytes value
-                            size_t bytesPos = result.find("\"bytes\":");
-                            if (bytesPos != std::string::npos) {
-                                bytesPos += 8; // skip "bytes":
-                                size_t endPos = result.find(',', bytesPos);
-                                if (endPos == std::string::npos) endPos = result.find('}', bytesPos);
-                                if (endPos != std::string::npos) {
-                                    std::string bytesStr = result.substr(bytesPos, endPos - bytesPos);
-                                    int bytes = std::stoi(bytesStr);
-                                    resultObj->fields["bytes"] = Value::Int32(bytes);
-                                }
-                            }
-                            
-                            // Extract filepath value
-                            size_t pathPos = result.find("\"filepath\":\"");
-                            if (pathPos != std::string::npos) {
-                                pathPos += 12; // skip "filepath":"
-                                size_t endPos = result.find('"', pathPos);
-                                if (endPos != std::string::npos) {
-                                    std::string filepath = result.substr(pathPos, endPos - pathPos);
-                                    std::string* pooledPath = pool_.allocateString(filepath);
-                                    if (pooledPath) {
-                                        resultObj->fields["filepath"] = Value::StringFromPool(pooledPath);
-                                    }
-                                }
-                            }
-                        } else {
-                            resultObj->fields["status"] = Value::String("error");
-                            
-                            // Extract error message
-                            size_t msgPos = result.find("\"message\":\"");
-                            if (msgPos != std::string::npos) {
-                                msgPos += 11; // skip "message":"
-                                size_t endPos = result.find('"', msgPos);
-                                if (endPos != std::string::npos) {
-                                    std::string message = result.substr(msgPos, endPos - msgPos);
-                                    std::string* pooledMsg = pool_.allocateString(message);
-                                    if (pooledMsg) {
-                                        resultObj->fields["message"] = Value::StringFromPool(pooledMsg);
-                                    }
-                                }
-                            }
-                        }
-                        push(Value::Object(resultObj));
-                    } else {
-                        push(Value::Null());
-                    }
+                    platform_.registerCallback("http.onProgress", callback);
+                    push(Value::Null());
                     break;
                 }
                 
@@ -2109,7 +2783,11 @@ VMResult VMState::executeInstruction() {
                     Value messageVal = pop();
                     Value appIdVal = pop();
                     
-                    bool sent = platform_.ipc_send(appIdVal.toString(), messageVal.toString());
+                    // String messages go to the bus by reference; it copies
+                    // the bytes once, into its shared arena
+                    bool sent = messageVal.isString()
+                        ? platform_.ipc_send(appIdVal.toString(), *messageVal.stringVal)
+                        : platform_.ipc_send(appIdVal.toString(), messageVal.toString());
                     
                     for (uint8_t i = 2; i < argCount; i++) pop();
                     push(Value::Bool(sent));
@@ -2123,13 +2801,35 @@ VMResult VMState::executeInstruction() {
                     }
                     Value messageVal = pop();
                     
-                    platform_.ipc_broadcast(messageVal.toString());
+                    if (messageVal.isString()) {
+                        platform_.ipc_broadcast(*messageVal.stringVal);
+                    } else {
+                        platform_.ipc_broadcast(messageVal.toString());
+                    }
                     
                     for (uint8_t i = 1; i < argCount; i++) pop();
                     push(Value::Null());
                     break;
                 }
                 
+                case NativeFunctionID::IPC_ON_MESSAGE: {
+                    if (argCount < 1) {
+                        setError("onMessage() requires 1 argument");
+                        return VMResult::ERROR;
+                    }
+                    Value callback = pop();
+                    for (uint8_t i = 1; i < argCount; i++) pop();
+                    
+                    if (!callback.isFunction()) {
+                        setError("onMessage() requires a function argument");
+                        return VMResult::ERROR;
+                    }
+                    
+                    platform_.registerCallback("ipc.onMessage", callback);
+                    push(Value::Null());
+                    break;
+                }
+                
                 // ===== App Management Functions =====
                 case NativeFunctionID::APP_INSTALL: {
                     if (argCount < 2) {
@@ -2210,6 +2910,37 @@ VMResult VMState::executeInstruction() {
                     break;
                 }
                 
+                // ===== JSON Functions =====
+                case NativeFunctionID::JSON_PARSE: {
+                    if (argCount < 1) {
+                        setError("parse() requires 1 argument (text)");
+                        return VMResult::ERROR;
+                    }
+                    for (uint8_t i = 1; i < argCount; i++) pop();
+                    Value textVal = pop();
+                    // Anything but a string is already a value
+                    push(textVal.isString() && textVal.stringVal ? parseJson(*textVal.stringVal) : textVal);
+                    break;
+                }
+                
+                case NativeFunctionID::JSON_STRINGIFY: {
+                    if (argCount < 1) {
+                        setError("stringify() requires 1 argument (value)");
+                        return VMResult::ERROR;
+                    }
+                    for (uint8_t i = 1; i < argCount; i++) pop();
+                    Value value = pop();
+                    
+                    std::string text;
+                    if (json::stringify(value, text)) {
+                        push(makeString(text.data(), text.size()));
+                    } else {
+                        platform_.console_warn("json.stringify: nested too deeply (or refers to itself)");
+                        push(Value::Null());
+                    }
+                    break;
+                }
+                
                 // ===== Unknown/Unimplemented Functions =====
                 default: {
                     // Unknown native function - pop receiver and arguments, return null
@@ -2247,14 +2978,12 @@ VMResult VMState::executeInstruction() {
             }
             
             // If this function is a constructor, return the 'this' object instead of returnValue
-            bool isConstructor = false;
-            if (!frame.functionName.empty()) {
-                const std::string ctorSuffix = "::constructor";
-                if (frame.functionName.size() >= ctorSuffix.size() &&
-                    frame.functionName.compare(frame.functionName.size() - ctorSuffix.size(), ctorSuffix.size(), ctorSuffix) == 0) {
-                    isConstructor = true;
-                }
-            }
+            static const char ctorSuffix[] = "::constructor";
+            const size_t ctorSuffixLength = sizeof(ctorSuffix) - 1;
+            const compiler::StringRef& returning = frame.functionName;
+            bool isConstructor = returning.length >= ctorSuffixLength &&
+                                 std::memcmp(returning.data + returning.length - ctorSuffixLength, ctorSuffix,
+                                             ctorSuffixLength) == 0;
 
             if (isConstructor) {
                 auto it = frame.locals.find(0);
@@ -2274,14 +3003,14 @@ VMResult VMState::executeInstruction() {
         case compiler::Opcode::LOAD_FUNCTION: {
             uint16_t funcIndex = readU16();
             
-            if (funcIndex >= module_.functions.size()) {
+            if (funcIndex >= image_.functionCount) {
                 setError("Invalid function index: " + std::to_string(funcIndex));
                 return VMResult::ERROR;
             }
             
             // Get parameter count from module
-            uint8_t paramCount = (funcIndex < module_.functionParamCounts.size()) 
-                                ? module_.functionParamCounts[funcIndex] 
+            uint8_t paramCount = (funcIndex < image_.functionCount) 
+                                ? image_.functions[funcIndex].paramCount 
                                 : 0;
             
             Function* fn = pool_.allocateFunction(funcIndex, paramCount);
@@ -2308,7 +3037,7 @@ VMResult VMState::executeInstruction() {
             
             // Validate argument count
             if (argCount != fn->paramCount) {
-                setError("Function '" + module_.functions[fn->functionIndex] + 
+                setError("Function '" + image_.functions[fn->functionIndex].name.str() + 
                         "' expects " + std::to_string(fn->paramCount) + 
                         " arguments, got " + std::to_string(argCount));
                 return VMResult::ERROR;
@@ -2316,12 +3045,12 @@ VMResult VMState::executeInstruction() {
             
             // Get function entry point
             uint16_t funcIndex = fn->functionIndex;
-            if (funcIndex >= module_.functionEntryPoints.size()) {
+            if (funcIndex >= image_.functionCount) {
                 setError("Invalid function entry point");
                 return VMResult::ERROR;
             }
             
-            uint32_t entryPoint = module_.functionEntryPoints[funcIndex];
+            uint32_t entryPoint = image_.functions[funcIndex].entryPoint;
             
             // Create call frame (same as CALL opcode)
             CallFrame frame;
@@ -2343,7 +3072,7 @@ VMResult VMState::executeInstruction() {
 
             // Stack base for arguments (arguments are currently on top of stack)
             frame.stackBase = stack_.size() - argCount;
-            frame.functionName = module_.functions[funcIndex];
+            frame.functionName = image_.functions[funcIndex].name;
 
             // If we have a receiver, make it local 0 and shift argument locals by +1
             if (hasReceiver) {
@@ -2378,12 +3107,12 @@ VMResult VMState::executeInstruction() {
             uint8_t argCount = readU8();
             uint16_t nameIdx = readU16();
 
-            if (nameIdx >= module_.constants.size()) {
+            if (nameIdx >= image_.constantCount) {
                 setError("CALL_METHOD: invalid method name index");
                 return VMResult::ERROR;
             }
 
-            const std::string& methodName = module_.constants[nameIdx];
+            const compiler::StringRef& methodName = image_.constants[nameIdx];
 
             // Pop receiver from stack (it should be below the arguments on the stack)
             // Stack layout before CALL_METHOD: [..., receiver, arg0, arg1, ..., argN]
@@ -2402,11 +3131,11 @@ VMResult VMState::executeInstruction() {
                 try { dbg << " value=" << receiver.toString(); } catch (...) {}
 
                 // Include the method name being called
-                dbg << " method='" << methodName << "'";
+                dbg << " method='" << methodName.str() << "'";
 
                 // If debug info exists in the module, attempt to map PC to source line
-                if (module_.hasDebugInfo()) {
-                    uint32_t srcLine = module_.getSourceLine(pc_);
+                if (module_ && module_->hasDebugInfo()) {
+                    uint32_t srcLine = module_->getSourceLine(pc_);
                     if (srcLine > 0) {
                         dbg << " (source line: " << srcLine << ")";
                     }
@@ -2414,7 +3143,7 @@ VMResult VMState::executeInstruction() {
 
                 // If we have a current call frame, include its function name for context
                 if (!callStack_.empty()) {
-                    dbg << " in function: " << callStack_.back().functionName;
+                    dbg << " in function: " << callStack_.back().functionName.str();
                 }
 
                 platform_.console_log(dbg.str());
@@ -2423,10 +3152,10 @@ VMResult VMState::executeInstruction() {
             }
 
             // Lookup the method in the receiver's fields
-            auto it = receiver.objVal->fields.find(methodName);
+            auto it = receiver.objVal->fields.find(nameView(methodName));
             if (it == receiver.objVal->fields.end()) {
                 // Log available fields for debugging
-                std::string dbg = "Method '" + methodName + "' not found on object of class " + receiver.objVal->className + ": fields=[";
+                std::string dbg = "Method '" + methodName.str() + "' not found on object of class " + receiver.objVal->className + ": fields=[";
                 bool first = true;
                 for (const auto &p : receiver.objVal->fields) {
                     if (!first) dbg += ", ";
@@ -2435,7 +3164,7 @@ VMResult VMState::executeInstruction() {
                 }
                 dbg += "]";
                 platform_.console_log(dbg);
-                setError("Method '" + methodName + "' not found on object");
+                setError("Method '" + methodName.str() + "' not found on object");
                 return VMResult::ERROR;
             }
 
@@ -2444,7 +3173,7 @@ VMResult VMState::executeInstruction() {
             // Method must be a function value
             if (!methodVal.isFunction()) {
                 // Log field type for debugging
-                std::string dbg = "CALL_METHOD: field '" + methodName + "' on class " + receiver.objVal->className + " is present but not a function. Type: ";
+                std::string dbg = "CALL_METHOD: field '" + methodName.str() + "' on class " + receiver.objVal->className + " is present but not a function. Type: ";
                 switch (methodVal.type) {
                     case vm::ValueType::NULL_VAL: dbg += "null"; break;
                     case vm::ValueType::BOOL: dbg += "bool"; break;
@@ -2458,7 +3187,7 @@ VMResult VMState::executeInstruction() {
                     default: dbg += "unknown"; break;
                 }
                 platform_.console_log(dbg);
-                setError("CALL_METHOD: field '" + methodName + "' is not a function");
+                setError("CALL_METHOD: field '" + methodName.str() + "' is not a function");
                 return VMResult::ERROR;
             }
 
@@ -2468,25 +3197,25 @@ VMResult VMState::executeInstruction() {
             if (argCount != fn->paramCount) {
                 // Note: methods compiled with 'this' as local 0 still have paramCount equal to declared params
                 if (argCount != fn->paramCount) {
-                    setError("Method '" + methodName + "' expects " + std::to_string(fn->paramCount) +
+                    setError("Method '" + methodName.str() + "' expects " + std::to_string(fn->paramCount) +
                              " arguments, got " + std::to_string(argCount));
                     return VMResult::ERROR;
                 }
             }
 
             uint16_t funcIndex = fn->functionIndex;
-            if (funcIndex >= module_.functionEntryPoints.size()) {
+            if (funcIndex >= image_.functionCount) {
                 setError("Invalid function entry point for method");
                 return VMResult::ERROR;
             }
 
-            uint32_t entryPoint = module_.functionEntryPoints[funcIndex];
+            uint32_t entryPoint = image_.functions[funcIndex].entryPoint;
 
             // Build call frame: local 0 = receiver, locals 1..N = args
             CallFrame frame;
             frame.returnPC = pc_;
             frame.stackBase = recvPos; // base was where receiver is
-            frame.functionName = module_.functions[funcIndex];
+            frame.functionName = image_.functions[funcIndex].name;
 
             // Store receiver as local 0
             frame.locals[0] = receiver;
@@ -2511,30 +3240,30 @@ VMResult VMState::executeInstruction() {
             uint16_t fieldIndex = readU16();
             Value obj = pop();
             
-            if (fieldIndex >= module_.constants.size()) {
+            if (fieldIndex >= image_.constantCount) {
                 setError("Invalid field name index");
                 return VMResult::ERROR;
             }
             
-            const std::string& fieldName = module_.constants[fieldIndex];
+            const compiler::StringRef& fieldName = image_.constants[fieldIndex];
             
             if (obj.isArray() && obj.arrayVal) {
                 // Handle array properties
-                if (fieldName == "length") {
+                if (fieldName.equals("length", 6)) {
                     push(Value::Int32(static_cast<int32_t>(obj.arrayVal->elements.size())));
                 } else {
                     push(Value::Null());
                 }
             } else if (obj.isString() && obj.stringVal) {
                 // Handle string properties
-                if (fieldName == "length") {
+                if (fieldName.equals("length", 6)) {
                     push(Value::Int32(static_cast<int32_t>(obj.stringVal->length())));
                 } else {
                     push(Value::Null());
                 }
             } else if (obj.isObject() && obj.objVal) {
                 // Handle object properties
-                auto it = obj.objVal->fields.find(fieldName);
+                auto it = obj.objVal->fields.find(nameView(fieldName));
                 if (it != obj.objVal->fields.end()) {
                     push(it->second);
                 } else {
@@ -2576,13 +3305,18 @@ VMResult VMState::executeInstruction() {
                 return VMResult::ERROR;
             }
 
-            if (fieldIndex >= module_.constants.size()) {
+            if (fieldIndex >= image_.constantCount) {
                 setError("Invalid field name index");
                 return VMResult::ERROR;
             }
 
-            const std::string& fieldName = module_.constants[fieldIndex];
-            obj.objVal->fields[fieldName] = value;
+            const compiler::StringRef& fieldName = image_.constants[fieldIndex];
+            auto it = obj.objVal->fields.find(nameView(fieldName));
+            if (it != obj.objVal->fields.end()) {
+                it->second = value;
+            } else {
+                obj.objVal->fields[fieldName.str()] = value;
+            }
             break;
         }
         
@@ -2636,8 +3370,8 @@ VMResult VMState::executeInstruction() {
             uint16_t classIndex = readU16();
             
             std::string className = "Object";
-            if (classIndex < module_.constants.size()) {
-                className = module_.constants[classIndex];
+            if (classIndex < image_.constantCount) {
+                className = image_.constants[classIndex].str();
             }
             
             vm::Object* obj = pool_.allocateObject(className);
@@ -2649,22 +3383,22 @@ VMResult VMState::executeInstruction() {
             // Look for constructor function
             std::string constructorName = className + "::constructor";
             int32_t funcIndex = -1;
-            for (size_t i = 0; i < module_.functions.size(); i++) {
-                if (module_.functions[i] == constructorName) {
+            for (size_t i = 0; i < image_.functionCount; i++) {
+                if (image_.functions[i].name.equals(constructorName.data(), constructorName.size())) {
                     funcIndex = static_cast<int32_t>(i);
                     break;
                 }
             }
             
             // Populate methods on the instance: find functions named Class::method and attach
-            for (size_t i = 0; i < module_.functions.size(); ++i) {
-                const std::string &fname = module_.functions[i];
+            for (size_t i = 0; i < image_.functionCount; ++i) {
+                const std::string &fname = image_.functions[i].name.str();
                 std::string prefix = className + "::";
                 if (fname.size() > prefix.size() && fname.compare(0, prefix.size(), prefix) == 0) {
                     std::string method = fname.substr(prefix.size());
                     if (method == "constructor") continue;
                     // Allocate function value for this method and store on the instance
-                    uint8_t paramCount = (i < module_.functionParamCounts.size()) ? module_.functionParamCounts[i] : 0;
+                    uint8_t paramCount = (i < image_.functionCount) ? image_.functions[i].paramCount : 0;
                     vm::Function* fn = pool_.allocateFunction(static_cast<uint16_t>(i), paramCount);
                     if (fn) {
                         obj->fields[method] = Value::Function(fn);
@@ -2680,7 +3414,7 @@ VMResult VMState::executeInstruction() {
             // Stack layout now: [arg0, arg1, ..., argN-1, object]
             if (funcIndex != -1) {
                 uint16_t ctorIdx = static_cast<uint16_t>(funcIndex);
-                uint32_t entryPoint = module_.functionEntryPoints[ctorIdx];
+                uint32_t entryPoint = image_.functions[ctorIdx].entryPoint;
 
                 // Determine argument count as number of items below the object
                 size_t total = stack_.size();
@@ -2693,7 +3427,7 @@ VMResult VMState::executeInstruction() {
                     CallFrame frame;
                     frame.returnPC = pc_;
                     frame.stackBase = total - (argCount + 1); // position of first arg
-                    frame.functionName = module_.functions[ctorIdx];
+                    frame.functionName = image_.functions[ctorIdx].name;
 
                     // Store 'this' as local 0
                     frame.locals[0] = stack_[frame.stackBase + argCount]; // object
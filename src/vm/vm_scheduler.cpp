@@ -0,0 +1,318 @@
+/**
+ * dialScript VM Scheduler Implementation
+ */
+
+#include "../../include/vm/vm_scheduler.h"
+#include <algorithm>
+
+namespace dialos {
+namespace vm {
+
+const VMScheduler::TaskId VMScheduler::INVALID_TASK;
+const uint32_t VMScheduler::NO_DEADLINE;
+const uint32_t VMScheduler::OOM_RETRY_MS;
+
+VMScheduler::VMScheduler(PlatformInterface& clock, SchedulePolicy policy)
+    : clock_(clock), policy_(policy), timeBudgetMs_(0), nextId_(0), cursor_(0) {
+}
+
+VMScheduler::~VMScheduler() {
+    for (size_t i = 0; i < tasks_.size(); i++) {
+        tasks_[i].vm->getPlatform().setAsyncWakeHandler(nullptr);
+    }
+}
+
+VMScheduler::TaskId VMScheduler::add(VMState& vm, const TaskConfig& config) {
+    // A freshly constructed VM is not running until reset
+    if (!vm.isRunning() && !vm.hasError()) {
+        vm.reset();
+    }
+
+    Task task;
+    task.info.id = nextId_++;
+    task.info.config = config;
+    task.info.status = VMTaskStatus::READY;
+    task.info.wakeAt = 0;
+    task.info.slices = 0;
+    task.info.runCount = 0;
+    task.info.timeUsedMs = 0;
+    task.info.eventsDelivered = 0;
+    task.vm = &vm;
+    task.pendingRestart = false;
+    tasks_.push_back(task);
+
+    // Async completions and IPC messages arrive on other threads; wake the
+    // host so the VM gets them on the next pass
+    vm.getPlatform().setAsyncWakeHandler([this]() {
+        if (wake_) {
+            wake_();
+        }
+    });
+    return task.info.id;
+}
+
+bool VMScheduler::remove(TaskId id) {
+    for (size_t i = 0; i < tasks_.size(); i++) {
+        if (tasks_[i].info.id == id) {
+            tasks_[i].vm->getPlatform().setAsyncWakeHandler(nullptr);
+            tasks_.erase(tasks_.begin() + i);
+            if (cursor_ > i) {
+                cursor_--;
+            }
+            if (cursor_ >= tasks_.size()) {
+                cursor_ = 0;
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+void VMScheduler::setEventPoll(TaskId id, EventPoll poll) {
+    Task* task = find(id);
+    if (task) {
+        task->poll = poll;
+    }
+}
+
+bool VMScheduler::postEvent(TaskId id, const std::string& eventName, const std::vector<Value>& args) {
+    Task* task = find(id);
+    if (!task || task->info.status == VMTaskStatus::FINISHED || task->info.status == VMTaskStatus::FAILED) {
+        return false;
+    }
+
+    PendingEvent event;
+    event.name = eventName;
+    event.args = args;
+    task->events.push_back(event);
+    if (wake_) {
+        wake_();
+    }
+    return true;
+}
+
+size_t VMScheduler::getLiveTaskCount() const {
+    size_t count = 0;
+    for (const auto& task : tasks_) {
+        if (task.info.status != VMTaskStatus::FINISHED && task.info.status != VMTaskStatus::FAILED) {
+            count++;
+        }
+    }
+    return count;
+}
+
+const VMScheduler::TaskInfo* VMScheduler::getTaskInfo(TaskId id) const {
+    const Task* task = find(id);
+    return task ? &task->info : nullptr;
+}
+
+VMState* VMScheduler::getVM(TaskId id) const {
+    const Task* task = find(id);
+    return task ? task->vm : nullptr;
+}
+
+VMScheduler::Task* VMScheduler::find(TaskId id) {
+    for (auto& task : tasks_) {
+        if (task.info.id == id) {
+            return &task;
+        }
+    }
+    return nullptr;
+}
+
+const VMScheduler::Task* VMScheduler::find(TaskId id) const {
+    for (const auto& task : tasks_) {
+        if (task.info.id == id) {
+            return &task;
+        }
+    }
+    return nullptr;
+}
+
+void VMScheduler::buildRunOrder(std::vector<size_t>& order) const {
+    order.clear();
+    for (size_t i = 0; i < tasks_.size(); i++) {
+        order.push_back((cursor_ + i) % tasks_.size());
+    }
+    if (policy_ == SchedulePolicy::PRIORITY) {
+        // Stable sort keeps the round-robin rotation within a priority level
+        std::stable_sort(order.begin(), order.end(), [this](size_t a, size_t b) {
+            return tasks_[a].info.config.priority > tasks_[b].info.config.priority;
+        });
+    }
+}
+
+void VMScheduler::deliverEvents(Task& task) {
+    if (task.events.empty()) {
+        return;
+    }
+
+    // Swap out first: a callback may post further events for the next pass
+    std::vector<PendingEvent> events;
+    events.swap(task.events);
+    PlatformInterface& platform = task.vm->getPlatform();
+    for (const auto& event : events) {
+        if (platform.invokeCallback(event.name, event.args)) {
+            task.info.eventsDelivered++;
+        }
+        if (task.vm->hasError()) {
+            break;
+        }
+    }
+}
+
+void VMScheduler::refreshStatus(Task& task, uint32_t now) {
+    if (task.info.status == VMTaskStatus::WAITING_ASYNC) {
+        if (!task.vm->isAwaiting()) {
+            task.info.status = VMTaskStatus::READY;
+        }
+        return;
+    }
+    if (task.info.status != VMTaskStatus::SLEEPING) {
+        return;
+    }
+
+    if (task.pendingRestart) {
+        // Waiting out a repeat interval or OOM back-off
+        if (static_cast<int32_t>(now - task.info.wakeAt) >= 0) {
+            task.vm->reset();
+            task.pendingRestart = false;
+            task.info.status = VMTaskStatus::READY;
+        }
+        return;
+    }
+
+    task.vm->checkSleepState();
+    if (task.vm->isSleeping()) {
+        task.info.wakeAt = static_cast<uint32_t>(task.vm->getSleepUntil());
+    } else {
+        task.info.status = VMTaskStatus::READY;
+    }
+}
+
+void VMScheduler::runSlice(Task& task, uint32_t now) {
+    TaskInfo& info = task.info;
+
+    uint32_t start = clock_.system_getTime();
+    VMResult result = task.vm->execute(info.config.instructionBudget);
+    info.timeUsedMs += clock_.system_getTime() - start;
+    info.slices++;
+
+    switch (result) {
+        case VMResult::OK:
+        case VMResult::YIELD:
+            if (task.vm->isAwaiting()) {
+                info.status = VMTaskStatus::WAITING_ASYNC;
+            } else if (task.vm->isSleeping()) {
+                info.status = VMTaskStatus::SLEEPING;
+                info.wakeAt = static_cast<uint32_t>(task.vm->getSleepUntil());
+            } else {
+                info.status = VMTaskStatus::READY;
+            }
+            break;
+
+        case VMResult::FINISHED:
+            info.runCount++;
+            if (info.config.repeat) {
+                if (info.config.repeatIntervalMs > 0) {
+                    info.status = VMTaskStatus::SLEEPING;
+                    info.wakeAt = now + info.config.repeatIntervalMs;
+                    task.pendingRestart = true;
+                } else {
+                    task.vm->reset();
+                    info.status = VMTaskStatus::READY;
+                }
+            } else {
+                info.status = info.config.keepAlive ? VMTaskStatus::WAITING_EVENT : VMTaskStatus::FINISHED;
+            }
+            break;
+
+        case VMResult::OUT_OF_MEMORY:
+            info.status = VMTaskStatus::SLEEPING;
+            info.wakeAt = now + OOM_RETRY_MS;
+            task.pendingRestart = true;
+            break;
+
+        case VMResult::ERROR:
+            info.status = VMTaskStatus::FAILED;
+            break;
+    }
+}
+
+uint32_t VMScheduler::tick() {
+    if (tasks_.empty()) {
+        return NO_DEADLINE;
+    }
+
+    uint32_t passStart = clock_.system_getTime();
+    std::vector<size_t> order;
+    buildRunOrder(order);
+
+    bool budgetExhausted = false;
+    for (size_t pos = 0; pos < order.size(); pos++) {
+        uint32_t now = clock_.system_getTime();
+        if (timeBudgetMs_ > 0 && pos > 0 && now - passStart >= timeBudgetMs_) {
+            // Out of time: resume from this VM on the next pass
+            cursor_ = order[pos];
+            budgetExhausted = true;
+            break;
+        }
+
+        Task& task = tasks_[order[pos]];
+        if (task.info.status == VMTaskStatus::FINISHED || task.info.status == VMTaskStatus::FAILED) {
+            continue;
+        }
+
+        // Deliver events first; callbacks run to completion on the VM
+        PlatformInterface& platform = task.vm->getPlatform();
+        platform.beginSlice();
+        deliverEvents(task);
+        platform.processAsyncCompletions();
+        platform.processIpc();
+        platform.processTimers();
+        if (task.poll) {
+            task.poll();
+        }
+        if (task.vm->hasError()) {
+            task.info.status = VMTaskStatus::FAILED;
+            task.events.clear();
+        } else {
+            refreshStatus(task, now);
+            if (task.info.status == VMTaskStatus::READY) {
+                runSlice(task, now);
+            }
+        }
+        platform.endSlice();
+    }
+
+    if (budgetExhausted) {
+        return 0;
+    }
+    cursor_ = (cursor_ + 1) % tasks_.size();
+
+    // Work out how long the caller may block
+    uint32_t now = clock_.system_getTime();
+    uint32_t wait = NO_DEADLINE;
+    for (const auto& task : tasks_) {
+        if (task.info.status == VMTaskStatus::READY) {
+            return 0;
+        }
+        if (task.info.status == VMTaskStatus::FINISHED || task.info.status == VMTaskStatus::FAILED) {
+            continue;
+        }
+        if (!task.events.empty() || task.vm->getPlatform().hasPendingIpc()) {
+            return 0;
+        }
+        if (task.info.status == VMTaskStatus::SLEEPING) {
+            int32_t remaining = static_cast<int32_t>(task.info.wakeAt - now);
+            uint32_t ms = remaining > 0 ? static_cast<uint32_t>(remaining) : 0;
+            wait = std::min(wait, ms);
+        }
+        // os.timer.* deadlines of live VMs
+        wait = std::min(wait, task.vm->getPlatform().getNextTimerDelay());
+    }
+    return wait;
+}
+
+} // namespace vm
+} // namespace dialos
@@ -0,0 +1,496 @@
+/**
+ * dialScript VM Snapshots
+ *
+ * VMState::snapshot() / restore(). Image layout (little endian):
+ *
+ *   "DSVS" u16 version, u32 module fingerprint
+ *   u32 pc, u8 flags (1 = running, 2 = sleeping), u32 sleep ms left
+ *   u32 count, values                          operand stack
+ *   u32 count, frames                          returnPC, stackBase, name, u16 count, (u8 slot, value)
+ *   u32 count, (u32 catchPC, u32 stackSize)    exception handlers
+ *   u32 count, (string name, value)            globals (except "os")
+ *   u32 count, (string event, value)           registered callbacks
+ *   i32 next id, u32 count, (i32 id, u32 ms left, u32 interval, value)
+ *   u32 count, string                          image cache keys (Image "id" - 1)
+ *
+ * Objects, arrays and function values are written in full the first time
+ * they are reached and as a back-reference afterwards, so shared and
+ * cyclic structures come back with the same shape. Images are restored by
+ * their cache key: files are decoded again if they've been evicted, inline
+ * data has to still be cached (the restore fails otherwise).
+ */
+
+#include "../../include/vm/vm_core.h"
+#include "../../include/vm/timer_service.h"
+#include "../../include/vm/image_cache.h"
+#include <map>
+
+namespace dialos {
+namespace vm {
+
+namespace {
+
+const uint16_t SNAPSHOT_VERSION = 2;
+
+const uint8_t FLAG_RUNNING = 0x01;
+const uint8_t FLAG_SLEEPING = 0x02;
+
+enum ValueTag : uint8_t {
+    TAG_NULL,
+    TAG_BOOL,
+    TAG_INT32,
+    TAG_FLOAT32,
+    TAG_STRING,
+    TAG_OBJECT,
+    TAG_ARRAY,
+    TAG_FUNCTION,
+    TAG_REF                 // Back-reference to an object/array/function
+};
+
+// FNV-1a over the code and table sizes: a snapshot only fits the module
+// that produced it
+uint32_t moduleFingerprint(const compiler::ModuleImage& image) {
+    uint32_t hash = 2166136261u;
+    auto mix = [&hash](uint8_t byte) {
+        hash ^= byte;
+        hash *= 16777619u;
+    };
+    for (uint32_t i = 0; i < image.codeSize; i++) {
+        mix(image.code[i]);
+    }
+    mix(static_cast<uint8_t>(image.globalCount));
+    mix(static_cast<uint8_t>(image.functionCount));
+    mix(static_cast<uint8_t>(image.constantCount));
+    return hash;
+}
+
+class SnapshotWriter {
+public:
+    explicit SnapshotWriter(std::vector<uint8_t>& out) : out_(out) {}
+
+    void u8(uint8_t value) { out_.push_back(value); }
+    void u16(uint16_t value) {
+        out_.push_back(value & 0xFF);
+        out_.push_back((value >> 8) & 0xFF);
+    }
+    void u32(uint32_t value) {
+        for (int shift = 0; shift < 32; shift += 8) {
+            out_.push_back((value >> shift) & 0xFF);
+        }
+    }
+    void str(const std::string& value) {
+        u32(static_cast<uint32_t>(value.size()));
+        out_.insert(out_.end(), value.begin(), value.end());
+    }
+
+    void value(const Value& value) {
+        switch (value.type) {
+            case ValueType::BOOL:
+                u8(TAG_BOOL);
+                u8(value.boolVal ? 1 : 0);
+                break;
+            case ValueType::INT32:
+                u8(TAG_INT32);
+                u32(static_cast<uint32_t>(value.int32Val));
+                break;
+            case ValueType::FLOAT32: {
+                uint32_t bits;
+                std::memcpy(&bits, &value.float32Val, sizeof(bits));
+                u8(TAG_FLOAT32);
+                u32(bits);
+                break;
+            }
+            case ValueType::STRING:
+                if (!value.stringVal) {
+                    u8(TAG_NULL);
+                    break;
+                }
+                u8(TAG_STRING);
+                str(*value.stringVal);
+                break;
+            case ValueType::OBJECT:
+                if (reference(value.objVal)) {
+                    break;
+                }
+                u8(TAG_OBJECT);
+                str(value.objVal->className);
+                u32(static_cast<uint32_t>(value.objVal->fields.size()));
+                for (const auto& field : value.objVal->fields) {
+                    str(field.first);
+                    this->value(field.second);
+                }
+                break;
+            case ValueType::ARRAY:
+                if (reference(value.arrayVal)) {
+                    break;
+                }
+                u8(TAG_ARRAY);
+                u32(static_cast<uint32_t>(value.arrayVal->elements.size()));
+                for (const auto& element : value.arrayVal->elements) {
+                    this->value(element);
+                }
+                break;
+            case ValueType::FUNCTION:
+                if (reference(value.functionVal)) {
+                    break;
+                }
+                u8(TAG_FUNCTION);
+                u16(value.functionVal->functionIndex);
+                u8(value.functionVal->paramCount);
+                break;
+            default:
+                // Null, and native function handles (never created by the VM)
+                u8(TAG_NULL);
+                break;
+        }
+    }
+
+private:
+    std::vector<uint8_t>& out_;
+    std::map<const void*, uint32_t> ids_;
+
+    // Null pointers are written as TAG_NULL; seen ones as TAG_REF. Returns
+    // true if nothing more needs to be written for `ptr`.
+    bool reference(const void* ptr) {
+        if (!ptr) {
+            u8(TAG_NULL);
+            return true;
+        }
+        auto it = ids_.find(ptr);
+        if (it != ids_.end()) {
+            u8(TAG_REF);
+            u32(it->second);
+            return true;
+        }
+        uint32_t id = static_cast<uint32_t>(ids_.size());
+        ids_[ptr] = id;
+        return false;
+    }
+};
+
+class SnapshotReader {
+public:
+    SnapshotReader(const uint8_t* data, size_t size, ValuePool& pool)
+        : pos_(data), end_(data + size), pool_(pool), ok_(true) {}
+
+    bool ok() const { return ok_; }
+    bool atEnd() const { return pos_ == end_; }
+
+    uint8_t u8() {
+        if (!need(1)) return 0;
+        return *pos_++;
+    }
+    uint16_t u16() {
+        if (!need(2)) return 0;
+        uint16_t value = static_cast<uint16_t>(pos_[0] | (pos_[1] << 8));
+        pos_ += 2;
+        return value;
+    }
+    uint32_t u32() {
+        if (!need(4)) return 0;
+        uint32_t value = 0;
+        for (int i = 3; i >= 0; i--) {
+            value = (value << 8) | pos_[i];
+        }
+        pos_ += 4;
+        return value;
+    }
+    std::string str() {
+        uint32_t length = u32();
+        if (!need(length)) return std::string();
+        std::string value(reinterpret_cast<const char*>(pos_), length);
+        pos_ += length;
+        return value;
+    }
+    // Element count; each element takes at least one byte
+    uint32_t count() {
+        uint32_t value = u32();
+        return need(value) ? value : 0;
+    }
+
+    Value value() {
+        uint8_t tag = u8();
+        switch (tag) {
+            case TAG_NULL:
+                return Value::Null();
+            case TAG_BOOL:
+                return Value::Bool(u8() != 0);
+            case TAG_INT32:
+                return Value::Int32(static_cast<int32_t>(u32()));
+            case TAG_FLOAT32: {
+                uint32_t bits = u32();
+                float value;
+                std::memcpy(&value, &bits, sizeof(value));
+                return Value::Float32(value);
+            }
+            case TAG_STRING: {
+                uint32_t length = u32();
+                if (!need(length)) break;
+                std::string* str = pool_.allocateString(reinterpret_cast<const char*>(pos_), length);
+                pos_ += length;
+                if (!str) break;
+                return Value::StringFromPool(str);
+            }
+            case TAG_OBJECT: {
+                std::string className = str();
+                Object* obj = ok_ ? pool_.allocateObject(className) : nullptr;
+                if (!obj) break;
+                Value result = Value::Object(obj);
+                seen_.push_back(result);        // Before the fields: they may point back
+                uint32_t fields = count();
+                for (uint32_t i = 0; i < fields && ok_; i++) {
+                    std::string key = str();
+                    obj->fields[key] = value();
+                }
+                return result;
+            }
+            case TAG_ARRAY: {
+                uint32_t size = count();
+                Array* arr = ok_ ? pool_.allocateArray(size) : nullptr;
+                if (!arr) break;
+                Value result = Value::Array(arr);
+                seen_.push_back(result);
+                for (uint32_t i = 0; i < size && ok_; i++) {
+                    arr->elements[i] = value();
+                }
+                return result;
+            }
+            case TAG_FUNCTION: {
+                uint16_t index = u16();
+                uint8_t params = u8();
+                Function* fn = ok_ ? pool_.allocateFunction(index, params) : nullptr;
+                if (!fn) break;
+                Value result = Value::Function(fn);
+                seen_.push_back(result);
+                return result;
+            }
+            case TAG_REF: {
+                uint32_t id = u32();
+                if (id >= seen_.size()) break;
+                return seen_[id];
+            }
+            default:
+                break;
+        }
+        ok_ = false;
+        return Value::Null();
+    }
+
+private:
+    const uint8_t* pos_;
+    const uint8_t* end_;
+    ValuePool& pool_;
+    bool ok_;
+    std::vector<Value> seen_;           // Composite values by id
+
+    bool need(size_t bytes) {
+        if (!ok_ || static_cast<size_t>(end_ - pos_) < bytes) {
+            ok_ = false;
+            return false;
+        }
+        return true;
+    }
+};
+
+} // namespace
+
+bool VMState::snapshot(std::vector<uint8_t>& out) {
+    if (hasError() || callbackDepth_ > 0 || awaitingToken_ != NO_ASYNC || !asyncCallbacks_.empty()) {
+        return false;
+    }
+    // Scene nodes aren't serialised; their ids in globals would dangle
+    if (scene_ && scene_->size() > 0) {
+        return false;
+    }
+
+    uint32_t now = platform_.system_getTime();
+    out.clear();
+    SnapshotWriter writer(out);
+    writer.u8('D');
+    writer.u8('S');
+    writer.u8('V');
+    writer.u8('S');
+    writer.u16(SNAPSHOT_VERSION);
+    writer.u32(moduleFingerprint(image_));
+
+    uint8_t flags = 0;
+    if (running_) flags |= FLAG_RUNNING;
+    if (sleeping_) flags |= FLAG_SLEEPING;
+    writer.u32(static_cast<uint32_t>(pc_));
+    writer.u8(flags);
+    writer.u32(sleeping_ && sleepUntil_ > now ? static_cast<uint32_t>(sleepUntil_ - now) : 0);
+
+    writer.u32(static_cast<uint32_t>(stack_.size()));
+    for (const auto& value : stack_) {
+        writer.value(value);
+    }
+
+    writer.u32(static_cast<uint32_t>(callStack_.size()));
+    for (const auto& frame : callStack_) {
+        writer.u32(static_cast<uint32_t>(frame.returnPC));
+        writer.u32(static_cast<uint32_t>(frame.stackBase));
+        writer.str(frame.functionName.str());
+        writer.u16(static_cast<uint16_t>(frame.locals.size()));
+        for (const auto& local : frame.locals) {
+            writer.u8(local.first);
+            writer.value(local.second);
+        }
+    }
+
+    writer.u32(static_cast<uint32_t>(exceptionHandlers_.size()));
+    for (const auto& handler : exceptionHandlers_) {
+        writer.u32(static_cast<uint32_t>(handler.catchPC));
+        writer.u32(static_cast<uint32_t>(handler.stackSize));
+    }
+
+    // "os" is rebuilt by the constructor of the restoring VM
+    writer.u32(static_cast<uint32_t>(globals_.size() - globals_.count("os")));
+    for (const auto& global : globals_) {
+        if (global.first != "os") {
+            writer.str(global.first);
+            writer.value(global.second);
+        }
+    }
+
+    std::vector<std::pair<std::string, Value>> callbacks = platform_.getCallbacks();
+    writer.u32(static_cast<uint32_t>(callbacks.size()));
+    for (const auto& callback : callbacks) {
+        writer.str(callback.first);
+        writer.value(callback.second);
+    }
+
+    TimerService& timers = platform_.timerService();
+    std::vector<TimerService::Pending> pending = timers.pending(now);
+    writer.u32(static_cast<uint32_t>(timers.getNextId()));
+    writer.u32(static_cast<uint32_t>(pending.size()));
+    for (const auto& timer : pending) {
+        writer.u32(static_cast<uint32_t>(timer.id));
+        writer.u32(timer.delayMs);
+        writer.u32(timer.intervalMs);
+        writer.value(timer.callback);
+    }
+
+    writer.u32(static_cast<uint32_t>(imageKeys_.size()));
+    for (const auto& key : imageKeys_) {
+        writer.str(key);
+    }
+    return true;
+}
+
+bool VMState::restore(const uint8_t* data, size_t size) {
+    reset();
+
+    SnapshotReader reader(data, size, pool_);
+    if (reader.u8() != 'D' || reader.u8() != 'S' || reader.u8() != 'V' || reader.u8() != 'S' ||
+        reader.u16() != SNAPSHOT_VERSION || reader.u32() != moduleFingerprint(image_)) {
+        return false;
+    }
+
+    uint32_t pc = reader.u32();
+    uint8_t flags = reader.u8();
+    uint32_t sleepLeft = reader.u32();
+
+    // Parse everything before touching the VM, so a bad image leaves it reset
+    std::vector<Value> stack(reader.count());
+    for (auto& value : stack) {
+        value = reader.value();
+    }
+
+    std::vector<CallFrame> frames(reader.count());
+    for (auto& frame : frames) {
+        frame.returnPC = reader.u32();
+        frame.stackBase = reader.u32();
+        // Frames refer to their function by its entry in this VM's table
+        std::string name = reader.str();
+        for (uint16_t i = 0; i < image_.functionCount && !name.empty(); i++) {
+            if (image_.functions[i].name.equals(name.data(), name.size())) {
+                frame.functionName = image_.functions[i].name;
+                break;
+            }
+        }
+        uint16_t locals = reader.u16();
+        for (uint16_t i = 0; i < locals && reader.ok(); i++) {
+            uint8_t slot = reader.u8();
+            frame.locals[slot] = reader.value();
+        }
+    }
+
+    std::vector<ExceptionHandler> handlers(reader.count());
+    for (auto& handler : handlers) {
+        handler.catchPC = reader.u32();
+        handler.stackSize = reader.u32();
+    }
+
+    std::map<std::string, Value> globals;
+    uint32_t globalCount = reader.count();
+    for (uint32_t i = 0; i < globalCount && reader.ok(); i++) {
+        std::string name = reader.str();
+        globals[name] = reader.value();
+    }
+
+    std::vector<std::pair<std::string, Value>> callbacks(reader.count());
+    for (auto& callback : callbacks) {
+        callback.first = reader.str();
+        callback.second = reader.value();
+    }
+
+    TimerService::TimerId nextTimerId = static_cast<TimerService::TimerId>(reader.u32());
+    std::vector<TimerService::Pending> timers(reader.count());
+    for (auto& timer : timers) {
+        timer.id = static_cast<TimerService::TimerId>(reader.u32());
+        timer.delayMs = reader.u32();
+        timer.intervalMs = reader.u32();
+        timer.callback = reader.value();
+    }
+
+    std::vector<std::string> imageKeys(reader.count());
+    for (auto& key : imageKeys) {
+        key = reader.str();
+    }
+
+    if (!reader.ok() || !reader.atEnd() || pc > codeSize_) {
+        return false;
+    }
+
+    // Image objects hold an index into images_, so every key has to resolve
+    std::vector<std::shared_ptr<const Image>> images;
+    for (const auto& key : imageKeys) {
+        std::shared_ptr<const Image> image = ImageCache::shared().find(key);
+        if (!image && key.compare(0, 5, "file:") == 0) {
+            std::string error;
+            image = loadImageFile(key.substr(5), error);
+        }
+        if (!image) {
+            return false;
+        }
+        images.push_back(image);
+    }
+
+    // A finished main is restored as "at the end of the code": the next
+    // slice reports FINISHED again, and callbacks work as before
+    pc_ = (flags & FLAG_RUNNING) ? pc : codeSize_;
+    running_ = true;
+    sleeping_ = (flags & FLAG_SLEEPING) != 0;
+    sleepUntil_ = platform_.system_getTime() + static_cast<uint64_t>(sleepLeft);
+    stack_.swap(stack);
+    callStack_.swap(frames);
+    exceptionHandlers_.swap(handlers);
+    images_.swap(images);
+    imageKeys_.swap(imageKeys);
+    for (auto& global : globals) {
+        auto it = globals_.find(global.first);
+        if (it != globals_.end()) {
+            it->second = global.second;
+        }
+    }
+
+    platform_.clearCallbacks();
+    for (const auto& callback : callbacks) {
+        platform_.registerCallback(callback.first, callback.second);
+    }
+    platform_.timerService().restore(timers, nextTimerId, platform_.system_getTime());
+    return true;
+}
+
+} // namespace vm
+} // namespace dialos
@@ -3,6 +3,7 @@
 // This section is auto-generated - do not edit manually
 #include <stdint.h>
 #include <stddef.h>
+#include "vm/module_image.h"
 // Generated bytecode arrays from dialScript (.ds) files
 
 // Generated bytecode array from J:\workspace2\arduino\dialOS\scripts\counter_applet.ds
@@ -26,6 +27,22 @@ const unsigned char COUNTER_APPLET[] = {
     0x01, 0x70, 0xd1, 0xff, 0xff, 0xff, 0xff
 };
 
+static constexpr dialos::compiler::StringRef COUNTER_APPLET_GLOBALS[] = {
+    {"count", 5},
+};
+static constexpr dialos::compiler::FunctionRef COUNTER_APPLET_FUNCTIONS[] = {
+    {{"display.drawText", 16}, 0, 0},
+    {{"system.sleep", 12}, 0, 0},
+};
+static constexpr dialos::compiler::ModuleImage COUNTER_APPLET_MODULE = {
+    1, 8192, {"untitled", 8}, {"1.0.0", 5}, {"", 0},
+    COUNTER_APPLET + 110, 53,
+    nullptr, 0,
+    COUNTER_APPLET_GLOBALS, 1,
+    COUNTER_APPLET_FUNCTIONS, 2,
+    0
+};
+
 // Generated bytecode array from J:\workspace2\arduino\dialOS\scripts\hello_world.ds
 // Total size: 105 bytes
 
@@ -42,6 +59,21 @@ const unsigned char HELLO_WORLD[] = {
     0x17, 0x00, 0x00, 0x81, 0x00, 0x00, 0x01, 0x01, 0xff
 };
 
+static constexpr dialos::compiler::StringRef HELLO_WORLD_CONSTANTS[] = {
+    {"Hello world", 11},
+};
+static constexpr dialos::compiler::FunctionRef HELLO_WORLD_FUNCTIONS[] = {
+    {{"console.println", 15}, 0, 0},
+};
+static constexpr dialos::compiler::ModuleImage HELLO_WORLD_MODULE = {
+    1, 8192, {"untitled", 8}, {"1.0.0", 5}, {"", 0},
+    HELLO_WORLD + 96, 9,
+    HELLO_WORLD_CONSTANTS, 1,
+    nullptr, 0,
+    HELLO_WORLD_FUNCTIONS, 1,
+    0
+};
+
 // Generated bytecode array from J:\workspace2\arduino\dialOS\scripts\timer.ds
 // Total size: 1225 bytes
 
@@ -152,18 +184,72 @@ const unsigned char TIMER[] = {
     0xff
 };
 
+static constexpr dialos::compiler::StringRef TIMER_CONSTANTS[] = {
+    {"running", 7},
+    {"stop", 4},
+    {"start", 5},
+    {"render", 6},
+    {"seconds", 7},
+    {"reset", 5},
+    {"tick", 4},
+    {"isFinished", 10},
+    {"Timer", 5},
+    {"TimerDisplay", 12},
+    {"timer", 5},
+    {"0", 1},
+    {"", 0},
+    {"${0}:${1}${2}", 13},
+    {"Running", 7},
+    {"Paused", 6},
+};
+static constexpr dialos::compiler::StringRef TIMER_GLOBALS[] = {
+    {"timer", 5},
+    {"display", 7},
+    {"now", 3},
+    {"lastTick", 8},
+};
+static constexpr dialos::compiler::FunctionRef TIMER_FUNCTIONS[] = {
+    {{"handleEncoderButton", 19}, 0, 1},
+    {{"buzzer.beep", 11}, 0, 0},
+    {{"handleEncoderTurn", 17}, 69, 1},
+    {{"handleTimerTick", 15}, 145, 0},
+    {{"system.getTime", 14}, 0, 0},
+    {{"Timer::constructor", 18}, 230, 1},
+    {{"Timer::start", 12}, 245, 0},
+    {{"Timer::stop", 11}, 253, 0},
+    {{"Timer::tick", 11}, 261, 0},
+    {{"Timer::reset", 12}, 295, 1},
+    {{"Timer::isFinished", 17}, 310, 0},
+    {{"TimerDisplay::constructor", 25}, 321, 1},
+    {{"TimerDisplay::render", 20}, 330, 0},
+    {{"display.clear", 13}, 0, 0},
+    {{"display.drawText", 16}, 0, 0},
+    {{"encoder.onButton", 16}, 0, 0},
+    {{"encoder.onTurn", 14}, 0, 0},
+    {{"timer.setInterval", 17}, 0, 0},
+};
+static constexpr dialos::compiler::ModuleImage TIMER_MODULE = {
+    1, 8192, {"untitled", 8}, {"1.0.0", 5}, {"", 0},
+    TIMER + 625, 600,
+    TIMER_CONSTANTS, 16,
+    TIMER_GLOBALS, 4,
+    TIMER_FUNCTIONS, 18,
+    532
+};
+
 struct VMApplet {
 
   const char *name;
   const unsigned char *bytecode;
   size_t bytecodeSize;
+  const dialos::compiler::ModuleImage *module;  // pre-deserialized image in flash (nullptr = deserialize bytecode)
   uint32_t executeInterval;  // ms between executions (0 = run once)
   bool repeat;               // true = repeat indefinitely, false = run once
 };
 static VMApplet BUILTIN_APPLET_REGISTRY[] = {
-    {"counter_applet", COUNTER_APPLET, COUNTER_APPLET_SIZE, 0, false},
-    {"hello_world", HELLO_WORLD, HELLO_WORLD_SIZE, 0, false},
-    {"timer", TIMER, TIMER_SIZE, 0, false},
+    {"counter_applet", COUNTER_APPLET, COUNTER_APPLET_SIZE, &COUNTER_APPLET_MODULE, 0, false},
+    {"hello_world", HELLO_WORLD, HELLO_WORLD_SIZE, &HELLO_WORLD_MODULE, 0, false},
+    {"timer", TIMER, TIMER_SIZE, &TIMER_MODULE, 0, false},
 };
 
 static const int BUILTIN_APPLET_REGISTRY_SIZE = sizeof(BUILTIN_APPLET_REGISTRY) / sizeof(VMApplet);